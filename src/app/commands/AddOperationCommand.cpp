@@ -30,9 +30,9 @@ bool AddOperationCommand::execute() {
     }
     document_->setAppliedOpCount(insertIndex + 1);
 
-    if (!regenerateDocument(document_)) {
+    if (!regenerateDocument(document_, {record_.opId})) {
         document_->removeOperation(record_.opId);
-        regenerateDocument(document_);
+        regenerateDocument(document_, {record_.opId});
         return false;
     }
 
@@ -48,9 +48,9 @@ bool AddOperationCommand::undo() {
         return false;
     }
 
-    if (!regenerateDocument(document_)) {
+    if (!regenerateDocument(document_, {record_.opId})) {
         document_->insertOperation(document_->operations().size(), record_);
-        regenerateDocument(document_);
+        regenerateDocument(document_, {record_.opId});
         return false;
     }
 
@@ -5,18 +5,43 @@
 #ifndef ONECAD_APP_COMMANDS_OPERATIONCOMMANDUTILS_H
 #define ONECAD_APP_COMMANDS_OPERATIONCOMMANDUTILS_H
 
+#include "../history/AsyncRegenerator.h"
 #include "../history/RegenerationEngine.h"
 #include "../document/Document.h"
 
+#include <QtGlobal>
+
+#include <string>
+#include <vector>
+
 namespace onecad::app::commands {
 
-inline bool regenerateDocument(Document* document) {
+inline bool incrementalRegenVerificationEnabled() {
+    return qEnvironmentVariableIntValue("ONECAD_VERIFY_INCREMENTAL_REGEN") == 1;
+}
+
+/**
+ * @brief Regenerate the applied history after a command edited it.
+ *
+ * @p dirtyOpIds lists the ops the command touched; only those and their
+ * dependents are re-run. An empty list requests a full replay. With an
+ * AsyncRegenerator attached the run is only queued and this returns true;
+ * failures surface when its snapshot is published.
+ */
+inline bool regenerateDocument(Document* document,
+                               const std::vector<std::string>& dirtyOpIds = {}) {
     if (!document) {
         return false;
     }
+    if (auto* async = document->asyncRegenerator()) {
+        async->requestRegeneration(dirtyOpIds);
+        return true;
+    }
     history::RegenerationEngine engine(document);
-    auto result = engine.regenerateToAppliedCount(document->appliedOpCount());
-    return result.status != history::RegenStatus::CriticalFailure;
+    engine.setVerifyIncremental(incrementalRegenVerificationEnabled());
+    auto result = engine.regenerateIncremental(document->appliedOpCount(), dirtyOpIds);
+    return result.status != history::RegenStatus::CriticalFailure &&
+           result.status != history::RegenStatus::Cancelled;
 }
 
 } // namespace onecad::app::commands
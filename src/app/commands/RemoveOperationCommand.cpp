@@ -34,10 +34,10 @@ bool RemoveOperationCommand::execute() {
         return false;
     }
 
-    if (!regenerateDocument(document_)) {
+    if (!regenerateDocument(document_, {opId_})) {
         document_->insertOperation(static_cast<std::size_t>(removedIndex_), removedRecord_);
         document_->setOperationSuppressed(opId_, wasSuppressed_);
-        regenerateDocument(document_);
+        regenerateDocument(document_, {opId_});
         return false;
     }
 
@@ -54,9 +54,9 @@ bool RemoveOperationCommand::undo() {
     }
     document_->setOperationSuppressed(opId_, wasSuppressed_);
 
-    if (!regenerateDocument(document_)) {
+    if (!regenerateDocument(document_, {opId_})) {
         document_->removeOperation(opId_);
-        regenerateDocument(document_);
+        regenerateDocument(document_, {opId_});
         return false;
     }
 
@@ -4,6 +4,7 @@
  */
 #include "RollbackCommand.h"
 #include "../document/Document.h"
+#include "../history/AsyncRegenerator.h"
 #include "../history/DependencyGraph.h"
 #include "../history/RegenerationEngine.h"
 
@@ -42,8 +43,7 @@ bool RollbackCommand::execute() {
 
     document_->setAppliedOpCount(targetAppliedOpCount_);
 
-    history::RegenerationEngine engine(document_);
-    engine.regenerateToAppliedCount(document_->appliedOpCount());
+    regenerateApplied();
 
     document_->setModified(true);
     return true;
@@ -59,11 +59,19 @@ bool RollbackCommand::undo() {
 
     document_->setAppliedOpCount(previousAppliedOpCount_);
 
-    history::RegenerationEngine engine(document_);
-    engine.regenerateToAppliedCount(document_->appliedOpCount());
+    regenerateApplied();
 
     document_->setModified(true);
     return true;
 }
 
+void RollbackCommand::regenerateApplied() {
+    if (auto* async = document_->asyncRegenerator()) {
+        async->requestRegeneration();
+        return;
+    }
+    history::RegenerationEngine engine(document_);
+    engine.regenerateToAppliedCount(document_->appliedOpCount());
+}
+
 } // namespace onecad::app::commands
@@ -23,6 +23,10 @@ namespace commands {
  * Maintains suppression behavior for downstream operations and also moves the
  * applied operation cursor so new operations insert after the rollback point.
  * Can be undone to restore the prior suppression map and applied cursor.
+ * Both directions regenerate through regenerateToAppliedCount(), which
+ * resumes from the nearest PrefixSnapshotCache entry instead of replaying
+ * the whole prefix, so repeated rollbacks stay cheap. With an
+ * AsyncRegenerator attached the replay is queued instead.
  */
 class RollbackCommand : public Command {
 public:
@@ -32,6 +36,8 @@ public:
     bool undo() override;
 
 private:
+    void regenerateApplied();
+
     Document* document_;
     std::string targetOpId_;
     std::unordered_map<std::string, bool> previousSuppression_;
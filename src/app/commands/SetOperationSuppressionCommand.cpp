@@ -26,9 +26,9 @@ bool SetOperationSuppressionCommand::execute() {
     if (!document_->setOperationSuppressed(opId_, newSuppressed_)) {
         return false;
     }
-    if (!regenerateDocument(document_)) {
+    if (!regenerateDocument(document_, {opId_})) {
         document_->setOperationSuppressed(opId_, oldSuppressed_);
-        regenerateDocument(document_);
+        regenerateDocument(document_, {opId_});
         return false;
     }
     return true;
@@ -41,9 +41,9 @@ bool SetOperationSuppressionCommand::undo() {
     if (!document_->setOperationSuppressed(opId_, oldSuppressed_)) {
         return false;
     }
-    if (!regenerateDocument(document_)) {
+    if (!regenerateDocument(document_, {opId_})) {
         document_->setOperationSuppressed(opId_, newSuppressed_);
-        regenerateDocument(document_);
+        regenerateDocument(document_, {opId_});
         return false;
     }
     return true;
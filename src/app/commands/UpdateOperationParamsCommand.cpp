@@ -30,9 +30,9 @@ bool UpdateOperationParamsCommand::execute() {
     if (!document_->updateOperationParams(opId_, newParams_)) {
         return false;
     }
-    if (!regenerateDocument(document_)) {
+    if (!regenerateDocument(document_, {opId_})) {
         document_->updateOperationParams(opId_, oldParams_);
-        regenerateDocument(document_);
+        regenerateDocument(document_, {opId_});
         return false;
     }
     return true;
@@ -45,9 +45,9 @@ bool UpdateOperationParamsCommand::undo() {
     if (!document_->updateOperationParams(opId_, oldParams_)) {
         return false;
     }
-    if (!regenerateDocument(document_)) {
+    if (!regenerateDocument(document_, {opId_})) {
         document_->updateOperationParams(opId_, newParams_);
-        regenerateDocument(document_);
+        regenerateDocument(document_, {opId_});
         return false;
     }
     return true;
@@ -1,11 +1,20 @@
 #include "Document.h"
+#include "../history/ModelSnapshot.h"
+#include "../history/OperationCheckpointCache.h"
+#include "../history/PrefixSnapshotCache.h"
+#include "../history/RegenProfile.h"
+#include "../history/RegenerationCache.h"
 #include "../../core/sketch/Sketch.h"
 #include "../../core/sketch/FaceBoundaryProjector.h"
+#include "../../render/tessellation/TessellationScheduler.h"
 
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QMetaObject>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cmath>
 #include <QUuid>
 
@@ -25,14 +34,36 @@
 
 namespace onecad::app {
 
+namespace {
+std::atomic<bool> backgroundTessellationByDefault{false};
+
+std::int64_t microsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+}
+} // namespace
+
 Document::Document(QObject* parent)
     : QObject(parent)
 {
     sceneMeshStore_ = std::make_unique<render::SceneMeshStore>();
     tessellationCache_ = std::make_unique<render::TessellationCache>();
+    regenerationCache_ = std::make_unique<history::RegenerationCache>();
+    checkpointCache_ = std::make_unique<history::OperationCheckpointCache>();
+    prefixSnapshots_ = std::make_unique<history::PrefixSnapshotCache>();
+    regenProfile_ = std::make_unique<history::RegenProfile>();
+    if (qEnvironmentVariableIsSet("ONECAD_CHECKPOINT_CACHE_MB")) {
+        const int megabytes = std::max(0, qEnvironmentVariableIntValue("ONECAD_CHECKPOINT_CACHE_MB"));
+        checkpointCache_->setMemoryBudget(static_cast<std::size_t>(megabytes) * 1024u * 1024u);
+    }
+    backgroundTessellation_ = backgroundTessellationByDefault.load();
 }
 
-Document::~Document() = default;
+Document::~Document() {
+    // Joins the tessellation thread; meshes it already posted die with this object.
+    tessellationScheduler_.reset();
+}
 
 std::string Document::addSketch(std::unique_ptr<core::sketch::Sketch> sketch) {
     if (!sketch) {
@@ -172,10 +203,23 @@ void Document::clear() {
     if (previousApplied != appliedOpCount_) {
         emit appliedOpCountChanged(static_cast<qulonglong>(appliedOpCount_));
     }
+    bodyLayer_.reset();
     elementMap_.clear();
+    regenerationCache_->clear();
+    checkpointCache_->clear();
+    prefixSnapshots_->clear();
+    regenProfile_->clear();
     if (sceneMeshStore_) {
         sceneMeshStore_->clear();
     }
+    if (tessellationCache_) {
+        tessellationCache_->clearCache();
+    }
+    pendingMeshes_.clear();
+    pendingFineMeshes_.clear();
+    if (tessellationScheduler_) {
+        tessellationScheduler_->clear();
+    }
     // Clear isolation state
     isolatedItemId_.clear();
     preIsolationBodyVisibility_.clear();
@@ -265,12 +309,59 @@ std::string Document::addBody(const TopoDS_Shape& shape) {
 bool Document::addBodyWithId(const std::string& id,
                              const TopoDS_Shape& shape,
                              const std::string& name) {
+    if (!insertBodyEntry(id, shape, name)) {
+        return false;
+    }
+
+    rebindBodyElements(id, shape);
+    updateBodyMesh(id, shape, false);
+
+    setModified(true);
+    emit bodyAdded(QString::fromStdString(id));
+    return true;
+}
+
+bool Document::restoreBodyShape(const std::string& id, const TopoDS_Shape& shape,
+                                const std::vector<kernel::elementmap::Entry>& elements,
+                                bool emitSignal) {
+    if (shape.IsNull()) {
+        return false;
+    }
+
+    saveBodyLayerEntry(id);
+
+    // Elements come from a checkpoint of this exact shape, so no rebind is needed.
+    auto it = bodies_.find(id);
+    const bool added = it == bodies_.end();
+    if (added) {
+        if (!insertBodyEntry(id, shape, {})) {
+            return false;
+        }
+    } else {
+        it->second.shape = shape;
+    }
+
+    const auto restoreStart = std::chrono::steady_clock::now();
+    elementMap_.restoreBodyEntries(id, elements);
+    bodyUpdateTimers_.elementMapUs += microsSince(restoreStart);
+    updateBodyMesh(id, shape, emitSignal && !added);
+    setModified(true);
+    if (added) {
+        emit bodyAdded(QString::fromStdString(id));
+    }
+    return true;
+}
+
+bool Document::insertBodyEntry(const std::string& id,
+                               const TopoDS_Shape& shape,
+                               const std::string& name) {
     if (shape.IsNull() || id.empty()) {
         return false;
     }
     if (bodies_.find(id) != bodies_.end()) {
         return false;
     }
+    saveBodyLayerEntry(id);
 
     std::string finalName = name;
     auto nameIt = bodyNames_.find(id);
@@ -292,12 +383,6 @@ bool Document::addBodyWithId(const std::string& id,
         bodyVisibilityCache_.erase(visibilityIt);
     }
     bodies_[id] = entry;
-
-    elementMap_.rebindBody(id, shape);
-    updateBodyMesh(id, shape, false);
-
-    setModified(true);
-    emit bodyAdded(QString::fromStdString(id));
     return true;
 }
 
@@ -310,9 +395,10 @@ bool Document::updateBodyShape(const std::string& id, const TopoDS_Shape& shape,
     if (it == bodies_.end()) {
         return false;
     }
+    saveBodyLayerEntry(id);
 
     it->second.shape = shape;
-    elementMap_.rebindBody(id, shape, opId);
+    rebindBodyElements(id, shape, opId);
     updateBodyMesh(id, shape, emitSignal);
     setModified(true);
     return true;
@@ -489,6 +575,7 @@ bool Document::removeBody(const std::string& id) {
     if (it == bodies_.end()) {
         return false;
     }
+    saveBodyLayerEntry(id);
 
     bodyVisibilityCache_.erase(id);
     baseBodyIds_.erase(id);
@@ -497,6 +584,14 @@ bool Document::removeBody(const std::string& id) {
     if (sceneMeshStore_) {
         sceneMeshStore_->removeBody(id);
     }
+    if (tessellationCache_) {
+        tessellationCache_->releaseBody(id);
+    }
+    pendingMeshes_.erase(id);
+    pendingFineMeshes_.erase(id);
+    if (tessellationScheduler_) {
+        tessellationScheduler_->releaseBody(id);
+    }
     elementMap_.removeElementsForBody(id);
 
     setModified(true);
@@ -509,9 +604,11 @@ bool Document::removeBodyPreserveElementMap(const std::string& id) {
     if (it == bodies_.end()) {
         return false;
     }
+    saveBodyLayerEntry(id);
 
     bodyVisibilityCache_[id] = it->second.visible;
     bodies_.erase(it);
+    cancelBodyMesh(id);
     if (sceneMeshStore_) {
         sceneMeshStore_->removeBody(id);
     }
@@ -544,6 +641,7 @@ void Document::setBodyName(const std::string& id, const std::string& name) {
         return;
     }
 
+    saveBodyLayerEntry(id);
     bodyNames_[id] = finalName;
     setModified(true);
     emit bodyRenamed(QString::fromStdString(id), QString::fromStdString(finalName));
@@ -555,6 +653,7 @@ void Document::setBaseBodyIds(const std::unordered_set<std::string>& ids) {
 
 void Document::addBaseBodyId(const std::string& id) {
     if (!id.empty()) {
+        saveBodyLayerEntry(id);
         baseBodyIds_.insert(id);
     }
 }
@@ -914,19 +1013,390 @@ void Document::registerBodyElements(const std::string& bodyId, const TopoDS_Shap
     }
 }
 
+std::unique_ptr<Document> Document::cloneForRegeneration() const {
+    auto clone = std::make_unique<Document>();
+    // Whoever adopts the run's bodies meshes them, with its own caches and scheduler.
+    clone->backgroundTessellation_ = false;
+    clone->meshBodies_ = false;
+
+    for (const auto& [id, sketch] : sketches_) {
+        auto copy = core::sketch::Sketch::fromJson(sketch->toJson());
+        if (!copy) {
+            continue;
+        }
+        clone->sketches_[id] = std::move(copy);
+    }
+    clone->sketchNames_ = sketchNames_;
+    clone->sketchVisibility_ = sketchVisibility_;
+    clone->bodies_ = bodies_;
+    clone->bodyNames_ = bodyNames_;
+    clone->bodyVisibilityCache_ = bodyVisibilityCache_;
+    clone->baseBodyIds_ = baseBodyIds_;
+    clone->operations_ = operations_;
+    clone->suppressedOperations_ = suppressedOperations_;
+    clone->operationFailures_ = operationFailures_;
+    clone->operationMetadata_ = operationMetadata_;
+    clone->appliedOpCount_ = appliedOpCount_;
+    clone->elementMap_ = elementMap_;
+    *clone->regenerationCache_ = *regenerationCache_;
+    clone->nextSketchNumber_ = nextSketchNumber_;
+    clone->nextBodyNumber_ = nextBodyNumber_;
+    clone->regenProfile_->setEnabled(regenProfile_->isEnabled());
+    return clone;
+}
+
+std::unique_ptr<history::ModelSnapshot> Document::makeModelSnapshot() const {
+    auto snapshot = std::make_unique<history::ModelSnapshot>();
+    snapshot->appliedOpCount = appliedOpCount_;
+    for (const auto& [id, body] : bodies_) {
+        snapshot->bodies[id] = body.shape;
+        auto nameIt = bodyNames_.find(id);
+        if (nameIt != bodyNames_.end()) {
+            snapshot->bodyNames[id] = nameIt->second;
+        }
+    }
+    snapshot->nextBodyNumber = nextBodyNumber_;
+    snapshot->elementMap = elementMap_;
+    snapshot->operationFailures = operationFailures_;
+    snapshot->regenerationCache = *regenerationCache_;
+    snapshot->opProfiles = regenProfile_->lastRun();
+    return snapshot;
+}
+
+void Document::applyModelSnapshot(const history::ModelSnapshot& snapshot) {
+    // The snapshot replaces the model as a whole; an open layer's pre-images are moot.
+    bodyLayer_.reset();
+    // Bodies added outside history since the request keep their elements.
+    std::vector<std::pair<std::string, std::vector<kernel::elementmap::Entry>>> foreignElements;
+    for (const auto& [id, body] : bodies_) {
+        (void)body;
+        const bool removed = std::find(snapshot.removedBodyIds.begin(), snapshot.removedBodyIds.end(), id) !=
+                             snapshot.removedBodyIds.end();
+        if (!removed && snapshot.bodies.find(id) == snapshot.bodies.end()) {
+            foreignElements.emplace_back(id, elementMap_.bodyEntries(id));
+        }
+    }
+
+    std::vector<std::string> removedIds;
+    for (const auto& id : snapshot.removedBodyIds) {
+        auto it = bodies_.find(id);
+        if (it == bodies_.end()) {
+            continue;
+        }
+        bodyVisibilityCache_[id] = it->second.visible;
+        bodies_.erase(it);
+        cancelBodyMesh(id);
+        sceneMeshStore_->removeBody(id);
+        removedIds.push_back(id);
+    }
+
+    elementMap_ = snapshot.elementMap;
+    for (const auto& [id, entries] : foreignElements) {
+        elementMap_.restoreBodyEntries(id, entries);
+    }
+
+    std::vector<std::string> addedIds;
+    std::vector<std::string> changedIds;
+    for (const auto& [id, shape] : snapshot.bodies) {
+        auto it = bodies_.find(id);
+        if (it == bodies_.end()) {
+            auto nameIt = snapshot.bodyNames.find(id);
+            if (!insertBodyEntry(id, shape, nameIt != snapshot.bodyNames.end() ? nameIt->second : std::string())) {
+                continue;
+            }
+            addedIds.push_back(id);
+        } else if (!it->second.shape.IsEqual(shape)) {
+            it->second.shape = shape;
+        } else {
+            continue;
+        }
+        changedIds.push_back(id);
+    }
+    // Meshed here rather than on the kernel thread, so unchanged faces come from the cache.
+    for (const auto& id : changedIds) {
+        updateBodyMesh(id, bodies_[id].shape, false);
+    }
+    nextBodyNumber_ = std::max(nextBodyNumber_, snapshot.nextBodyNumber);
+
+    const auto previousFailures = std::move(operationFailures_);
+    operationFailures_ = snapshot.operationFailures;
+    *regenerationCache_ = snapshot.regenerationCache;
+    regenProfile_->adoptRun(snapshot.opProfiles);
+    publishedModelVersion_ = snapshot.version;
+
+    // Everything is in place before anyone is told about it.
+    for (const auto& id : removedIds) {
+        emit bodyRemoved(QString::fromStdString(id));
+    }
+    for (const auto& id : addedIds) {
+        emit bodyAdded(QString::fromStdString(id));
+    }
+    for (const auto& [opId, reason] : previousFailures) {
+        (void)reason;
+        if (operationFailures_.find(opId) == operationFailures_.end()) {
+            emit operationSucceeded(QString::fromStdString(opId));
+        }
+    }
+    for (const auto& [opId, reason] : operationFailures_) {
+        auto previousIt = previousFailures.find(opId);
+        if (previousIt == previousFailures.end() || previousIt->second != reason) {
+            emit operationFailed(QString::fromStdString(opId), QString::fromStdString(reason));
+        }
+    }
+    emit modelSnapshotPublished(static_cast<qulonglong>(publishedModelVersion_));
+}
+
 void Document::updateBodyMesh(const std::string& bodyId,
                               const TopoDS_Shape& shape,
                               bool emitSignal) {
-    if (!sceneMeshStore_ || !tessellationCache_) {
+    if (!sceneMeshStore_ || !tessellationCache_ || !meshBodies_) {
         return;
     }
-    render::SceneMeshStore::Mesh mesh = tessellationCache_->buildMesh(bodyId, shape, elementMap_);
-    sceneMeshStore_->setBodyMesh(bodyId, std::move(mesh));
+    const auto start = std::chrono::steady_clock::now();
+    if (backgroundTessellation_) {
+        if (!tessellationScheduler_) {
+            tessellationScheduler_ = std::make_unique<render::TessellationScheduler>(
+                [this](render::TessellationScheduler::Result&& result) {
+                    QMetaObject::invokeMethod(
+                        this,
+                        [this, result = std::move(result)]() mutable {
+                            if (result.detail == render::TessellationScheduler::Detail::Fine) {
+                                publishBodyLod(result.bodyId, result.generation, std::move(result.lod));
+                                return;
+                            }
+                            publishBodyMesh(result.bodyId, result.generation,
+                                            result.detail == render::TessellationScheduler::Detail::Full,
+                                            std::move(result.mesh));
+                        },
+                        Qt::QueuedConnection);
+                });
+        }
+        // The worker names elements from a copy of this body's entries only. Submitting
+        // supersedes a fine level still being built for the old shape.
+        pendingFineMeshes_.erase(bodyId);
+        pendingMeshes_[bodyId] = tessellationScheduler_->submit(bodyId, shape, elementMap_.bodyEntries(bodyId));
+    } else {
+        render::SceneMeshStore::Mesh mesh = tessellationCache_->buildMesh(bodyId, shape, elementMap_);
+        sceneMeshStore_->setBodyMesh(bodyId, std::move(mesh));
+    }
+    bodyUpdateTimers_.tessellationUs += microsSince(start);
     if (emitSignal) {
         emit bodyUpdated(QString::fromStdString(bodyId));
     }
 }
 
+void Document::publishBodyMesh(const std::string& bodyId, std::uint64_t generation, bool full,
+                               render::SceneMeshStore::Mesh&& mesh) {
+    auto it = pendingMeshes_.find(bodyId);
+    if (it == pendingMeshes_.end() || it->second != generation || bodies_.find(bodyId) == bodies_.end()) {
+        return;  // Superseded, cancelled or removed since it was queued
+    }
+    if (full) {
+        pendingMeshes_.erase(it);
+    }
+    sceneMeshStore_->setBodyMesh(bodyId, std::move(mesh));
+    emit bodyUpdated(QString::fromStdString(bodyId));
+}
+
+void Document::publishBodyLod(const std::string& bodyId, std::uint64_t generation,
+                              render::SceneMeshStore::Lod&& lod) {
+    auto it = pendingFineMeshes_.find(bodyId);
+    if (it == pendingFineMeshes_.end() || it->second != generation) {
+        return;  // The body changed or went away since it was queued
+    }
+    pendingFineMeshes_.erase(it);
+    if (sceneMeshStore_->setBodyLod(bodyId, render::SceneMeshStore::Detail::Fine, std::move(lod))) {
+        emit bodyMeshDetailChanged(QString::fromStdString(bodyId));
+    }
+}
+
+void Document::cancelBodyMesh(const std::string& bodyId) {
+    const bool pending = pendingMeshes_.erase(bodyId) > 0;
+    if ((pendingFineMeshes_.erase(bodyId) > 0 || pending) && tessellationScheduler_) {
+        tessellationScheduler_->cancel(bodyId);
+    }
+}
+
+void Document::requestFineMesh(const std::string& bodyId) {
+    if (!backgroundTessellation_ || !tessellationScheduler_ || !sceneMeshStore_ ||
+        pendingMeshes_.count(bodyId) > 0 || pendingFineMeshes_.count(bodyId) > 0) {
+        return;
+    }
+    auto body = bodies_.find(bodyId);
+    const auto* mesh = sceneMeshStore_->findMesh(bodyId);
+    if (body == bodies_.end() || !mesh || !mesh->fine.empty()) {
+        return;
+    }
+    const std::uint64_t generation =
+        tessellationScheduler_->requestFine(bodyId, body->second.shape, elementMap_.bodyEntries(bodyId));
+    if (generation != 0) {
+        pendingFineMeshes_[bodyId] = generation;
+    }
+}
+
+void Document::setBackgroundTessellation(bool enabled) {
+    if (enabled == backgroundTessellation_) {
+        return;
+    }
+    backgroundTessellation_ = enabled;
+    if (enabled) {
+        // The worker keeps its own cache from here on.
+        tessellationCache_->clearCache();
+        return;
+    }
+
+    tessellationScheduler_.reset();
+    pendingFineMeshes_.clear();
+    const auto pending = std::move(pendingMeshes_);
+    pendingMeshes_.clear();
+    for (const auto& [id, generation] : pending) {
+        (void)generation;
+        auto it = bodies_.find(id);
+        if (it != bodies_.end()) {
+            updateBodyMesh(id, it->second.shape);
+        }
+    }
+}
+
+void Document::setBackgroundTessellationDefault(bool enabled) {
+    backgroundTessellationByDefault.store(enabled);
+}
+
+bool Document::backgroundTessellationDefault() {
+    return backgroundTessellationByDefault.load();
+}
+
+void Document::waitForTessellation() {
+    if (tessellationScheduler_) {
+        tessellationScheduler_->waitForIdle();
+    }
+}
+
+void Document::rebindBodyElements(const std::string& bodyId, const TopoDS_Shape& shape,
+                                  const std::string& opId) {
+    saveBodyLayerEntry(bodyId);
+    const auto start = std::chrono::steady_clock::now();
+    elementMap_.rebindBody(bodyId, shape, opId);
+    bodyUpdateTimers_.elementMapUs += microsSince(start);
+}
+
+bool Document::beginBodyLayer() {
+    if (bodyLayer_) {
+        return false;
+    }
+    bodyLayer_.emplace();
+    bodyLayerModified_ = modified_;
+    return true;
+}
+
+std::vector<std::string> Document::bodyLayerChanges() const {
+    std::vector<std::string> ids;
+    if (!bodyLayer_) {
+        return ids;
+    }
+    ids.reserve(bodyLayer_->size());
+    for (const auto& [id, saved] : *bodyLayer_) {
+        (void)saved;
+        ids.push_back(id);
+    }
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+void Document::commitBodyLayer() {
+    bodyLayer_.reset();
+}
+
+void Document::discardBodyLayer() {
+    if (!bodyLayer_) {
+        return;
+    }
+    // Closed first so the restores below are not recorded into it.
+    auto layer = std::move(*bodyLayer_);
+    bodyLayer_.reset();
+
+    for (auto& [id, saved] : layer) {
+        const bool exists = bodies_.find(id) != bodies_.end();
+        const QString qid = QString::fromStdString(id);
+
+        if (saved.name) {
+            bodyNames_[id] = *saved.name;
+        } else {
+            bodyNames_.erase(id);
+        }
+        if (saved.cachedVisibility) {
+            bodyVisibilityCache_[id] = *saved.cachedVisibility;
+        } else {
+            bodyVisibilityCache_.erase(id);
+        }
+        if (saved.base) {
+            baseBodyIds_.insert(id);
+        } else {
+            baseBodyIds_.erase(id);
+        }
+        elementMap_.restoreBodyEntries(id, saved.elements);
+
+        cancelBodyMesh(id);
+        if (!saved.body) {
+            bodies_.erase(id);
+            if (sceneMeshStore_) {
+                sceneMeshStore_->removeBody(id);
+            }
+            if (exists) {
+                emit bodyRemoved(qid);
+            }
+            continue;
+        }
+
+        bodies_[id] = *saved.body;
+        if (sceneMeshStore_) {
+            if (saved.mesh) {
+                sceneMeshStore_->setBodyMesh(id, std::move(*saved.mesh));
+            } else if (backgroundTessellation_) {
+                // Saved while its mesh was still being built
+                updateBodyMesh(id, saved.body->shape, false);
+            } else {
+                sceneMeshStore_->removeBody(id);
+            }
+        }
+        if (exists) {
+            emit bodyUpdated(qid);
+        } else {
+            emit bodyAdded(qid);
+        }
+    }
+    setModified(bodyLayerModified_);
+}
+
+void Document::saveBodyLayerEntry(const std::string& id) {
+    if (!bodyLayer_ || bodyLayer_->find(id) != bodyLayer_->end()) {
+        return;
+    }
+
+    BodyLayerEntry saved;
+    auto bodyIt = bodies_.find(id);
+    if (bodyIt != bodies_.end()) {
+        saved.body = bodyIt->second;
+        // A mesh still being built would be stale once restored; discard rebuilds it instead.
+        if (sceneMeshStore_ && pendingMeshes_.find(id) == pendingMeshes_.end()) {
+            if (const auto* mesh = sceneMeshStore_->findMesh(id)) {
+                saved.mesh = *mesh;
+            }
+        }
+    }
+    auto nameIt = bodyNames_.find(id);
+    if (nameIt != bodyNames_.end()) {
+        saved.name = nameIt->second;
+    }
+    auto visibilityIt = bodyVisibilityCache_.find(id);
+    if (visibilityIt != bodyVisibilityCache_.end()) {
+        saved.cachedVisibility = visibilityIt->second;
+    }
+    saved.elements = elementMap_.bodyEntries(id);
+    saved.base = baseBodyIds_.find(id) != baseBodyIds_.end();
+    bodyLayer_->emplace(id, std::move(saved));
+}
+
 void Document::rebuildElementMap() {
     elementMap_.clear();
     for (const auto& [id, body] : bodies_) {
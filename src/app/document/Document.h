@@ -8,6 +8,7 @@
 
 #include <QObject>
 #include <QString>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -24,6 +25,19 @@
 #include "../../render/scene/SceneMeshStore.h"
 #include "../../render/tessellation/TessellationCache.h"
 
+namespace onecad::render {
+class TessellationScheduler;
+}
+
+namespace onecad::app::history {
+class AsyncRegenerator;
+struct ModelSnapshot;
+class OperationCheckpointCache;
+class PrefixSnapshotCache;
+class RegenProfile;
+class RegenerationCache;
+}
+
 namespace onecad::app {
 
 /**
@@ -102,6 +116,9 @@ public:
     bool addBodyWithId(const std::string& id, const TopoDS_Shape& shape, const std::string& name = {});
     bool updateBodyShape(const std::string& id, const TopoDS_Shape& shape,
                          bool emitSignal = true, const std::string& opId = {});
+    bool restoreBodyShape(const std::string& id, const TopoDS_Shape& shape,
+                          const std::vector<kernel::elementmap::Entry>& elements,
+                          bool emitSignal = true);
     const TopoDS_Shape* getBodyShape(const std::string& id) const;
     std::optional<core::sketch::SketchPlane> getSketchPlaneForFace(const std::string& bodyId,
                                                                     const std::string& faceId) const;
@@ -163,6 +180,125 @@ public:
     const render::SceneMeshStore& meshStore() const { return *sceneMeshStore_; }
     kernel::elementmap::ElementMap& elementMap() { return elementMap_; }
     const kernel::elementmap::ElementMap& elementMap() const { return elementMap_; }
+    history::RegenerationCache& regenerationCache() { return *regenerationCache_; }
+    const history::RegenerationCache& regenerationCache() const { return *regenerationCache_; }
+    history::OperationCheckpointCache& checkpointCache() { return *checkpointCache_; }
+    const history::OperationCheckpointCache& checkpointCache() const { return *checkpointCache_; }
+    history::PrefixSnapshotCache& prefixSnapshots() { return *prefixSnapshots_; }
+    const history::PrefixSnapshotCache& prefixSnapshots() const { return *prefixSnapshots_; }
+    history::RegenProfile& regenProfile() { return *regenProfile_; }
+    const history::RegenProfile& regenProfile() const { return *regenProfile_; }
+
+    /**
+     * @brief Running totals of time spent updating bodies; the profiler diffs them per op.
+     */
+    struct BodyUpdateTimers {
+        std::int64_t elementMapUs = 0;
+        std::int64_t tessellationUs = 0;
+    };
+    const BodyUpdateTimers& bodyUpdateTimers() const { return bodyUpdateTimers_; }
+
+    /**
+     * @brief Rebind a body's ElementMap entries to @p shape, attributing new ones to @p opId.
+     */
+    void rebindBodyElements(const std::string& bodyId, const TopoDS_Shape& shape,
+                            const std::string& opId = {});
+
+    // Copy-on-write body layer
+    /**
+     * @brief Start recording body changes so they can be rolled back cheaply.
+     *
+     * Nothing is copied up front: the first change to a body inside the layer
+     * saves that body's shape, name, ElementMap entries and mesh. Commit and
+     * discard cost O(changed bodies). Layers do not nest.
+     * @return false if a layer is already open
+     */
+    bool beginBodyLayer();
+    bool hasBodyLayer() const { return bodyLayer_.has_value(); }
+
+    /**
+     * @brief Bodies added, changed or removed since beginBodyLayer().
+     */
+    std::vector<std::string> bodyLayerChanges() const;
+
+    /**
+     * @brief Keep the layer's changes and drop the saved bodies.
+     */
+    void commitBodyLayer();
+
+    /**
+     * @brief Put every body changed inside the layer back as it was, then close it.
+     */
+    void discardBodyLayer();
+
+    // Asynchronous regeneration
+    /**
+     * @brief Copy of the history, bodies and ElementMap for a kernel-thread run.
+     *
+     * Sketches are deep-copied and shapes shared; meshes and the checkpoint
+     * and prefix snapshot caches are not copied. The clone never meshes the
+     * bodies it rebuilds.
+     */
+    std::unique_ptr<Document> cloneForRegeneration() const;
+
+    /**
+     * @brief Capture bodies, ElementMap and op outcomes as a snapshot.
+     */
+    std::unique_ptr<history::ModelSnapshot> makeModelSnapshot() const;
+
+    /**
+     * @brief Swap in a regenerated model as a whole, then emit change signals.
+     *
+     * Changed bodies are meshed the way any other body change is, in the
+     * background when background tessellation is on.
+     */
+    void applyModelSnapshot(const history::ModelSnapshot& snapshot);
+    std::uint64_t publishedModelVersion() const { return publishedModelVersion_; }
+
+    /**
+     * @brief Regenerator that history commands queue on instead of replaying inline.
+     */
+    void setAsyncRegenerator(history::AsyncRegenerator* regenerator) { asyncRegenerator_ = regenerator; }
+    history::AsyncRegenerator* asyncRegenerator() const { return asyncRegenerator_; }
+
+    // Background tessellation
+    /**
+     * @brief Tessellate changed bodies on a worker thread instead of inline.
+     *
+     * A changed body gets a coarse mesh first, then its full-detail mesh, and
+     * bodyUpdated() is emitted as each lands. Until then the body keeps its
+     * previous mesh, or has none if it is new. A body changed again before its
+     * mesh lands cancels the stale build. The full mesh keeps the coarse one
+     * as its coarse level of detail. Regeneration clones never use it.
+     */
+    void setBackgroundTessellation(bool enabled);
+    bool backgroundTessellation() const { return backgroundTessellation_; }
+
+    /**
+     * @brief Whether new documents start with background tessellation on.
+     */
+    static void setBackgroundTessellationDefault(bool enabled);
+    static bool backgroundTessellationDefault();
+
+    /**
+     * @brief Bodies whose full-detail mesh has not landed yet.
+     */
+    bool hasPendingMeshes() const { return !pendingMeshes_.empty(); }
+
+    /**
+     * @brief Block until every queued tessellation has finished; its meshes land on the next event loop pass.
+     */
+    void waitForTessellation();
+
+    /**
+     * @brief Build a finer level of detail for a body the view has zoomed in on.
+     *
+     * Background tessellation only: the level is built on the tessellation
+     * thread and bodyMeshDetailChanged() is emitted when it lands. Does nothing
+     * while the body's full mesh is pending or once it has a fine level; a
+     * change to the body drops the level.
+     */
+    void requestFineMesh(const std::string& bodyId);
 
 signals:
     void sketchAdded(const QString& id);
@@ -172,6 +308,7 @@ signals:
     void bodyRemoved(const QString& id);
     void bodyRenamed(const QString& id, const QString& newName);
     void bodyUpdated(const QString& id);
+    void bodyMeshDetailChanged(const QString& id);
     void bodyVisibilityChanged(const QString& id, bool visible);
     void sketchVisibilityChanged(const QString& id, bool visible);
     void isolationChanged();
@@ -184,6 +321,7 @@ signals:
     void operationFailed(const QString& opId, const QString& reason);
     void operationSucceeded(const QString& opId);
     void appliedOpCountChanged(qulonglong appliedOpCount);
+    void modelSnapshotPublished(qulonglong version);
 
 private:
     struct BodyEntry {
@@ -191,8 +329,24 @@ private:
         bool visible = true;
     };
 
+    // State of a body before its first change inside the body layer.
+    struct BodyLayerEntry {
+        std::optional<BodyEntry> body;  // Empty: created inside the layer
+        std::optional<std::string> name;
+        std::optional<bool> cachedVisibility;
+        std::vector<kernel::elementmap::Entry> elements;
+        std::optional<render::SceneMeshStore::Mesh> mesh;
+        bool base = false;
+    };
+
+    void saveBodyLayerEntry(const std::string& id);
+    bool insertBodyEntry(const std::string& id, const TopoDS_Shape& shape, const std::string& name);
     void registerBodyElements(const std::string& bodyId, const TopoDS_Shape& shape);
     void updateBodyMesh(const std::string& bodyId, const TopoDS_Shape& shape, bool emitSignal = true);
+    void publishBodyMesh(const std::string& bodyId, std::uint64_t generation, bool full,
+                         render::SceneMeshStore::Mesh&& mesh);
+    void publishBodyLod(const std::string& bodyId, std::uint64_t generation, render::SceneMeshStore::Lod&& lod);
+    void cancelBodyMesh(const std::string& bodyId);
     void rebuildElementMap();
 
     std::unordered_map<std::string, std::unique_ptr<core::sketch::Sketch>> sketches_;
@@ -202,6 +356,8 @@ private:
     std::unordered_map<std::string, std::string> bodyNames_;  // id -> display name
     std::unordered_map<std::string, bool> bodyVisibilityCache_;
     std::unordered_set<std::string> baseBodyIds_;
+    std::optional<std::unordered_map<std::string, BodyLayerEntry>> bodyLayer_;  // id -> pre-image
+    bool bodyLayerModified_ = false;  // modified_ when the layer began
 
     // Isolation state (not persisted)
     std::string isolatedItemId_;
@@ -215,6 +371,18 @@ private:
     kernel::elementmap::ElementMap elementMap_;
     std::unique_ptr<render::SceneMeshStore> sceneMeshStore_;
     std::unique_ptr<render::TessellationCache> tessellationCache_;
+    std::unique_ptr<render::TessellationScheduler> tessellationScheduler_;  // Created on first use
+    std::unordered_map<std::string, std::uint64_t> pendingMeshes_;  // bodyId -> generation awaited
+    std::unordered_map<std::string, std::uint64_t> pendingFineMeshes_;
+    bool backgroundTessellation_ = false;
+    bool meshBodies_ = true;  // Off in regeneration clones
+    std::unique_ptr<history::RegenerationCache> regenerationCache_;
+    std::unique_ptr<history::OperationCheckpointCache> checkpointCache_;
+    std::unique_ptr<history::PrefixSnapshotCache> prefixSnapshots_;
+    std::unique_ptr<history::RegenProfile> regenProfile_;
+    BodyUpdateTimers bodyUpdateTimers_;
+    history::AsyncRegenerator* asyncRegenerator_ = nullptr;  // Not owned
+    std::uint64_t publishedModelVersion_ = 0;
     bool modified_ = false;
     unsigned int nextSketchNumber_ = 1;
     unsigned int nextBodyNumber_ = 1;
@@ -0,0 +1,149 @@
+/**
+ * @file AsyncRegenerator.cpp
+ * @brief Implementation of AsyncRegenerator.
+ */
+#include "AsyncRegenerator.h"
+
+#include "RegenProgress.h"
+#include "../document/Document.h"
+
+#include <QLoggingCategory>
+#include <QMetaObject>
+#include <QtGlobal>
+
+#include <algorithm>
+#include <utility>
+
+namespace onecad::app::history {
+
+Q_LOGGING_CATEGORY(logAsyncRegen, "onecad.app.history.asyncregen")
+
+AsyncRegenerator::AsyncRegenerator(Document* document, QObject* parent)
+    : QObject(parent), document_(document), scheduler_(std::make_unique<KernelScheduler>()) {
+    if (document_) {
+        document_->setAsyncRegenerator(this);
+        // A cleared document must not receive a model built from its old history.
+        connect(document_, &Document::documentCleared, this, &AsyncRegenerator::discardPending);
+    }
+}
+
+AsyncRegenerator::~AsyncRegenerator() {
+    if (document_ && document_->asyncRegenerator() == this) {
+        document_->setAsyncRegenerator(nullptr);
+    }
+    if (activeJob_ != 0) {
+        scheduler_->cancel(activeJob_);
+    }
+    // Joins the writer thread; posted snapshots die with this object.
+    scheduler_->shutdown();
+}
+
+bool AsyncRegenerator::isEnabled() {
+    return qEnvironmentVariableIntValue("ONECAD_SYNC_REGEN") != 1;
+}
+
+std::uint64_t AsyncRegenerator::requestRegeneration(const std::vector<std::string>& dirtyOpIds) {
+    if (!document_) {
+        return 0;
+    }
+
+    if (dirtyOpIds.empty()) {
+        pendingFull_ = true;
+    }
+    pendingDirty_.insert(dirtyOpIds.begin(), dirtyOpIds.end());
+    if (activeJob_ != 0) {
+        scheduler_->cancel(activeJob_);  // Superseded; this request covers its edits too
+    }
+
+    const std::uint64_t version = ++requestedVersion_;
+    std::shared_ptr<Document> copy = document_->cloneForRegeneration();
+    const std::vector<std::string> bodiesBefore = document_->getBodyIds();
+
+    RegenRequest request;
+    request.document = copy.get();
+    request.appliedOpCount = document_->appliedOpCount();
+    if (!pendingFull_) {
+        request.dirtyOpIds.assign(pendingDirty_.begin(), pendingDirty_.end());
+        std::sort(request.dirtyOpIds.begin(), request.dirtyOpIds.end());
+    }
+    // Reported from whichever thread advances the run; relayed to the UI thread.
+    request.progress = [this, version](int current, int total, const std::string&) {
+        const int permille = total > 0 ? static_cast<int>(static_cast<long long>(current) *
+                                                          RegenProgressIndicator::kScale / total)
+                                       : 0;
+        QMetaObject::invokeMethod(
+            this,
+            [this, version, permille]() {
+                if (version == requestedVersion_) {
+                    emit regenerationProgress(static_cast<quint64>(version), permille);
+                }
+            },
+            Qt::QueuedConnection);
+    };
+
+    activeJob_ = scheduler_->submitRegen(
+        request, [this, copy, version, bodiesBefore](const RegenJobResult& output) {
+            if (output.cancelled) {
+                return;
+            }
+            std::shared_ptr<ModelSnapshot> snapshot = copy->makeModelSnapshot();
+            snapshot->version = version;
+            snapshot->result = output.result;
+            for (const auto& bodyId : bodiesBefore) {
+                if (snapshot->bodies.find(bodyId) == snapshot->bodies.end()) {
+                    snapshot->removedBodyIds.push_back(bodyId);
+                }
+            }
+            // The writer thread is joined before this object dies, and Qt drops
+            // posted calls to a deleted receiver.
+            QMetaObject::invokeMethod(
+                this,
+                [this, snapshot = std::shared_ptr<const ModelSnapshot>(std::move(snapshot))]() mutable {
+                    publish(std::move(snapshot));
+                },
+                Qt::QueuedConnection);
+        });
+
+    qCDebug(logAsyncRegen) << "requestRegeneration:queued"
+                           << "version=" << version
+                           << "job=" << activeJob_
+                           << "dirty=" << request.dirtyOpIds.size()
+                           << "full=" << pendingFull_;
+    emit regenerationStarted(static_cast<quint64>(version));
+    return version;
+}
+
+void AsyncRegenerator::publish(std::shared_ptr<const ModelSnapshot> snapshot) {
+    if (!document_ || snapshot->version != requestedVersion_) {
+        qCDebug(logAsyncRegen) << "publish:drop-stale"
+                               << "version=" << snapshot->version
+                               << "latest=" << requestedVersion_;
+        return;
+    }
+
+    document_->applyModelSnapshot(*snapshot);
+    activeJob_ = 0;
+    pendingDirty_.clear();
+    pendingFull_ = false;
+    publishedVersion_ = snapshot->version;
+    latest_ = std::move(snapshot);
+
+    qCDebug(logAsyncRegen) << "publish:applied"
+                           << "version=" << publishedVersion_
+                           << "bodies=" << latest_->bodies.size()
+                           << "status=" << static_cast<int>(latest_->result.status);
+    emit snapshotPublished(static_cast<quint64>(publishedVersion_));
+}
+
+void AsyncRegenerator::discardPending() {
+    if (activeJob_ != 0) {
+        scheduler_->cancel(activeJob_);
+        activeJob_ = 0;
+    }
+    pendingDirty_.clear();
+    pendingFull_ = false;
+    // Bump the version so a snapshot already posted is recognized as stale.
+    publishedVersion_ = ++requestedVersion_;
+}
+
+} // namespace onecad::app::history
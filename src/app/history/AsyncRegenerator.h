@@ -0,0 +1,84 @@
+/**
+ * @file AsyncRegenerator.h
+ * @brief Off-UI-thread regeneration publishing versioned model snapshots.
+ *
+ * History commands commit their edit and queue a regeneration here instead
+ * of replaying inline. Each request copies the document, replays it on the
+ * KernelScheduler writer thread and posts the result back as a
+ * ModelSnapshot. Until it arrives the document keeps showing the last
+ * valid model. A newer request cancels the one in flight; only the latest
+ * snapshot is ever applied.
+ */
+#ifndef ONECAD_APP_HISTORY_ASYNCREGENERATOR_H
+#define ONECAD_APP_HISTORY_ASYNCREGENERATOR_H
+
+#include "KernelScheduler.h"
+#include "ModelSnapshot.h"
+
+#include <QObject>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace onecad::app {
+class Document;
+}
+
+namespace onecad::app::history {
+
+class AsyncRegenerator : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Attach to @p document; commands on it regenerate asynchronously from now on.
+     *
+     * Must be destroyed before @p document, which it detaches from.
+     */
+    explicit AsyncRegenerator(Document* document, QObject* parent = nullptr);
+    ~AsyncRegenerator() override;
+
+    /**
+     * @brief Whether the app regenerates asynchronously; ONECAD_SYNC_REGEN=1 opts out.
+     */
+    static bool isEnabled();
+
+    /**
+     * @brief Queue a regeneration of the applied history.
+     *
+     * @p dirtyOpIds accumulate until a snapshot is published and are replayed
+     * incrementally; an empty list requests a full replay.
+     * @return Version the resulting snapshot will carry.
+     */
+    std::uint64_t requestRegeneration(const std::vector<std::string>& dirtyOpIds = {});
+
+    bool isRegenerating() const { return publishedVersion_ != requestedVersion_; }
+    std::uint64_t requestedVersion() const { return requestedVersion_; }
+    std::uint64_t publishedVersion() const { return publishedVersion_; }
+    std::shared_ptr<const ModelSnapshot> latestSnapshot() const { return latest_; }
+
+signals:
+    void regenerationStarted(quint64 version);
+    void regenerationProgress(quint64 version, int permille);  // 0..RegenProgressIndicator::kScale
+    void snapshotPublished(quint64 version);
+
+private:
+    void publish(std::shared_ptr<const ModelSnapshot> snapshot);
+    void discardPending();
+
+    Document* document_;
+    std::unique_ptr<KernelScheduler> scheduler_;
+    JobId activeJob_ = 0;
+    std::uint64_t requestedVersion_ = 0;
+    std::uint64_t publishedVersion_ = 0;
+    std::unordered_set<std::string> pendingDirty_;  // Dirty ops not yet in a published snapshot
+    bool pendingFull_ = false;
+    std::shared_ptr<const ModelSnapshot> latest_;
+};
+
+} // namespace onecad::app::history
+
+#endif // ONECAD_APP_HISTORY_ASYNCREGENERATOR_H
@@ -8,7 +8,6 @@
 #include <QString>
 
 #include <algorithm>
-#include <queue>
 
 namespace onecad::app::history {
 
@@ -16,33 +15,32 @@ Q_LOGGING_CATEGORY(logDependencyGraph, "onecad.app.history.dependency")
 
 void DependencyGraph::clear() {
     nodes_.clear();
+    indexById_.clear();
+    bodyIndexById_.clear();
+    nodeInputBodies_.clear();
+    nodeOutputBodies_.clear();
+    nodeElementBodies_.clear();
+    bodyProducers_.clear();
     forwardEdges_.clear();
     backwardEdges_.clear();
-    creationOrder_.clear();
-    bodyProducers_.clear();
 }
 
 void DependencyGraph::rebuildFromOperations(const std::vector<OperationRecord>& ops) {
     qCDebug(logDependencyGraph) << "rebuildFromOperations:start" << "operationCount=" << ops.size();
     clear();
+    nodes_.reserve(ops.size());
+    indexById_.reserve(ops.size());
+    nodeInputBodies_.reserve(ops.size());
+    nodeOutputBodies_.reserve(ops.size());
+    nodeElementBodies_.reserve(ops.size());
     for (const auto& op : ops) {
-        FeatureNode node;
-        node.opId = op.opId;
-        node.type = op.type;
-
-        extractDependencies(op, node);
-        for (const auto& bodyId : op.resultBodyIds) {
-            node.outputBodyIds.insert(bodyId);
-        }
-
-        nodes_[op.opId] = std::move(node);
-        creationOrder_.push_back(op.opId);
+        appendNode(op);
     }
     rebuildEdges();
     qCDebug(logDependencyGraph) << "rebuildFromOperations:done"
                                 << "nodeCount=" << nodes_.size()
-                                << "forwardEdgeCount=" << forwardEdges_.size()
-                                << "backwardEdgeCount=" << backwardEdges_.size();
+                                << "edgeCount=" << backwardEdges_.targets.size()
+                                << "bodyCount=" << bodyIndexById_.size();
 }
 
 void DependencyGraph::addOperation(const OperationRecord& op) {
@@ -50,136 +48,113 @@ void DependencyGraph::addOperation(const OperationRecord& op) {
                                 << "opId=" << QString::fromStdString(op.opId)
                                 << "type=" << static_cast<int>(op.type)
                                 << "outputs=" << op.resultBodyIds.size();
-    FeatureNode node;
-    node.opId = op.opId;
-    node.type = op.type;
-
-    // Extract dependencies from operation
-    extractDependencies(op, node);
-
-    // Store output bodies
-    for (const auto& bodyId : op.resultBodyIds) {
-        node.outputBodyIds.insert(bodyId);
+    if (findIndex(op.opId) != kNoNode) {
+        // Re-adding replaces the node; it moves to the end of the history.
+        removeOperation(op.opId);
     }
 
-    // Add node
-    nodes_[op.opId] = std::move(node);
-    creationOrder_.push_back(op.opId);
-
-    // Rebuild edges
-    rebuildEdges();
+    // A new last node only gains upstream edges; earlier rows are unchanged.
+    appendNode(op);
+    linkNode(static_cast<NodeIndex>(nodes_.size() - 1));
+    rebuildForwardEdges();
 }
 
 void DependencyGraph::removeOperation(const std::string& opId) {
-    auto it = nodes_.find(opId);
-    if (it == nodes_.end()) {
+    const NodeIndex index = findIndex(opId);
+    if (index == kNoNode) {
         return;
     }
 
-    // Remove from body producers
-    for (const auto& bodyId : it->second.outputBodyIds) {
-        bodyProducers_.erase(bodyId);
+    nodes_.erase(nodes_.begin() + index);
+    nodeInputBodies_.erase(nodeInputBodies_.begin() + index);
+    nodeOutputBodies_.erase(nodeOutputBodies_.begin() + index);
+    nodeElementBodies_.erase(nodeElementBodies_.begin() + index);
+    indexById_.erase(opId);
+    for (NodeIndex i = index; i < nodes_.size(); ++i) {
+        indexById_[nodes_[i].opId] = i;
     }
 
-    // Remove node
-    nodes_.erase(it);
-
-    // Remove from creation order
-    creationOrder_.erase(
-        std::remove(creationOrder_.begin(), creationOrder_.end(), opId),
-        creationOrder_.end());
+    // Later ops may now read an earlier producer of the same body.
+    rebuildEdges();
+}
 
-    // Rebuild edges
+void DependencyGraph::setElementProducers(
+    const std::unordered_map<std::string, std::vector<std::string>>& producersByOp) {
+    std::size_t refined = 0;
+    for (const auto& [opId, producers] : producersByOp) {
+        const NodeIndex index = findIndex(opId);
+        if (index == kNoNode || nodeElementBodies_[index].empty()) {
+            continue;
+        }
+        FeatureNode& node = nodes_[index];
+        node.elementProducerIds = std::unordered_set<std::string>(producers.begin(), producers.end());
+        node.elementProducersKnown = true;
+        ++refined;
+    }
+    if (refined == 0) {
+        return;
+    }
     rebuildEdges();
+    qCDebug(logDependencyGraph) << "setElementProducers"
+                                << "refinedNodes=" << refined
+                                << "edgeCount=" << backwardEdges_.targets.size();
 }
 
 const FeatureNode* DependencyGraph::getNode(const std::string& opId) const {
-    auto it = nodes_.find(opId);
-    return (it != nodes_.end()) ? &it->second : nullptr;
+    const NodeIndex index = findIndex(opId);
+    return index != kNoNode ? &nodes_[index] : nullptr;
 }
 
 FeatureNode* DependencyGraph::getNode(const std::string& opId) {
-    auto it = nodes_.find(opId);
-    return (it != nodes_.end()) ? &it->second : nullptr;
+    const NodeIndex index = findIndex(opId);
+    return index != kNoNode ? &nodes_[index] : nullptr;
 }
 
 std::vector<std::string> DependencyGraph::topologicalSort() const {
-    // Kahn's algorithm for topological sort
-    std::unordered_map<std::string, int> inDegree;
-    std::unordered_map<std::string, std::size_t> creationIndex;
-    creationIndex.reserve(creationOrder_.size());
-    for (std::size_t i = 0; i < creationOrder_.size(); ++i) {
-        creationIndex[creationOrder_[i]] = i;
-    }
+    return getAllOpIds();
+}
 
-    // Initialize in-degrees
-    for (const auto& [opId, _] : nodes_) {
-        inDegree[opId] = 0;
+std::vector<std::string> DependencyGraph::getDownstream(const std::string& opId) const {
+    const NodeIndex index = findIndex(opId);
+    if (index == kNoNode) {
+        return {};
     }
+    return toOpIds(collectReachable(index, forwardEdges_));
+}
 
-    // Count in-degrees from backward edges
-    for (const auto& [opId, upstreams] : backwardEdges_) {
-        inDegree[opId] = static_cast<int>(upstreams.size());
+std::vector<std::string> DependencyGraph::getUpstream(const std::string& opId) const {
+    const NodeIndex index = findIndex(opId);
+    if (index == kNoNode) {
+        return {};
     }
+    return toOpIds(collectReachable(index, backwardEdges_));
+}
 
-    // Queue nodes with zero in-degree in creation order
-    auto cmp = [&](const std::string& a, const std::string& b) {
-        auto ia = creationIndex.find(a);
-        auto ib = creationIndex.find(b);
-        const std::size_t indexA = (ia != creationIndex.end()) ? ia->second : creationOrder_.size();
-        const std::size_t indexB = (ib != creationIndex.end()) ? ib->second : creationOrder_.size();
-        return indexA > indexB;
-    };
-    std::priority_queue<std::string, std::vector<std::string>, decltype(cmp)> queue(cmp);
-    for (const auto& [opId, degree] : inDegree) {
-        if (degree == 0) {
-            queue.push(opId);
-        }
+bool DependencyGraph::hasFailedUpstream(const std::string& opId) const {
+    const NodeIndex index = findIndex(opId);
+    if (index == kNoNode) {
+        return false;
     }
-
-    std::vector<std::string> result;
-    result.reserve(nodes_.size());
-
-    while (!queue.empty()) {
-        std::string current = queue.top();
-        queue.pop();
-        result.push_back(current);
-
-        // Decrement in-degree of downstream nodes
-        auto fwdIt = forwardEdges_.find(current);
-        if (fwdIt != forwardEdges_.end()) {
-            for (const auto& downstream : fwdIt->second) {
-                if (--inDegree[downstream] == 0) {
-                    queue.push(downstream);
-                }
-            }
+    for (NodeIndex upstream : collectReachable(index, backwardEdges_)) {
+        if (nodes_[upstream].failed) {
+            return true;
         }
     }
-
-    // If result size != nodes size, there's a cycle
-    if (result.size() != nodes_.size()) {
-        return {};  // Empty indicates cycle
-    }
-
-    return result;
-}
-
-std::vector<std::string> DependencyGraph::getDownstream(const std::string& opId) const {
-    std::vector<std::string> result;
-    std::unordered_set<std::string> visited;
-    collectDownstream(opId, visited, result);
-    return result;
+    return false;
 }
 
-std::vector<std::string> DependencyGraph::getUpstream(const std::string& opId) const {
-    std::vector<std::string> result;
-    std::unordered_set<std::string> visited;
-    collectUpstream(opId, visited, result);
-    return result;
+std::vector<std::string> DependencyGraph::getAllOpIds() const {
+    std::vector<std::string> ids;
+    ids.reserve(nodes_.size());
+    for (const auto& node : nodes_) {
+        ids.push_back(node.opId);
+    }
+    return ids;
 }
 
 bool DependencyGraph::hasCycle() const {
-    return topologicalSort().empty() && !nodes_.empty();
+    // Edges only point from earlier to later ops (see topologicalSort()).
+    return false;
 }
 
 void DependencyGraph::setSuppressed(const std::string& opId, bool suppressed) {
@@ -202,8 +177,8 @@ void DependencyGraph::suppressDownstream(const std::string& opId) {
 
 std::unordered_map<std::string, bool> DependencyGraph::getSuppressionState() const {
     std::unordered_map<std::string, bool> state;
-    for (const auto& [opId, node] : nodes_) {
-        state[opId] = node.suppressed;
+    for (const auto& node : nodes_) {
+        state[node.opId] = node.suppressed;
     }
     return state;
 }
@@ -234,22 +209,27 @@ std::string DependencyGraph::getFailureReason(const std::string& opId) const {
 
 std::vector<std::string> DependencyGraph::getFailedOps() const {
     std::vector<std::string> result;
-    for (const auto& [opId, node] : nodes_) {
+    for (const auto& node : nodes_) {
         if (node.failed) {
-            result.push_back(opId);
+            result.push_back(node.opId);
         }
     }
     return result;
 }
 
 void DependencyGraph::clearFailures() {
-    for (auto& [opId, node] : nodes_) {
+    for (auto& node : nodes_) {
         node.failed = false;
         node.failureReason.clear();
     }
 }
 
 void DependencyGraph::extractDependencies(const OperationRecord& op, FeatureNode& node) {
+    // Bodies reached through a face or edge reference, and bodies read whole
+    std::unordered_set<std::string> elementBodies;
+    std::unordered_set<std::string> wholeBodies;
+    std::string faceBodyId;
+
     // Extract from input variant
     if (std::holds_alternative<SketchRegionRef>(op.input)) {
         const auto& ref = std::get<SketchRegionRef>(op.input);
@@ -258,9 +238,12 @@ void DependencyGraph::extractDependencies(const OperationRecord& op, FeatureNode
         const auto& ref = std::get<FaceRef>(op.input);
         node.inputBodyIds.insert(ref.bodyId);
         node.inputFaceIds.insert(ref.faceId);
+        elementBodies.insert(ref.bodyId);
+        faceBodyId = ref.bodyId;
     } else if (std::holds_alternative<BodyRef>(op.input)) {
         const auto& ref = std::get<BodyRef>(op.input);
         node.inputBodyIds.insert(ref.bodyId);
+        wholeBodies.insert(ref.bodyId);
     }
 
     // Extract from params variant
@@ -273,6 +256,10 @@ void DependencyGraph::extractDependencies(const OperationRecord& op, FeatureNode
                                         << "targetBodyId=" << QString::fromStdString(p.targetBodyId)
                                         << "mode=" << static_cast<int>(p.booleanMode);
         }
+        if (p.booleanMode != BooleanMode::NewBody) {
+            // An empty target resolves to the face input's body
+            wholeBodies.insert(p.targetBodyId.empty() ? faceBodyId : p.targetBodyId);
+        }
     } else if (std::holds_alternative<RevolveParams>(op.params)) {
         const auto& p = std::get<RevolveParams>(op.params);
         if (p.booleanMode != BooleanMode::NewBody && !p.targetBodyId.empty()) {
@@ -282,6 +269,9 @@ void DependencyGraph::extractDependencies(const OperationRecord& op, FeatureNode
                                         << "targetBodyId=" << QString::fromStdString(p.targetBodyId)
                                         << "mode=" << static_cast<int>(p.booleanMode);
         }
+        if (p.booleanMode != BooleanMode::NewBody) {
+            wholeBodies.insert(p.targetBodyId.empty() ? faceBodyId : p.targetBodyId);
+        }
         if (std::holds_alternative<SketchLineRef>(p.axis)) {
             const auto& axis = std::get<SketchLineRef>(p.axis);
             node.inputSketchIds.insert(axis.sketchId);
@@ -289,6 +279,7 @@ void DependencyGraph::extractDependencies(const OperationRecord& op, FeatureNode
             const auto& axis = std::get<EdgeRef>(p.axis);
             node.inputBodyIds.insert(axis.bodyId);
             node.inputEdgeIds.insert(axis.edgeId);
+            elementBodies.insert(axis.bodyId);
         }
     } else if (std::holds_alternative<FilletChamferParams>(op.params)) {
         const auto& p = std::get<FilletChamferParams>(op.params);
@@ -305,65 +296,177 @@ void DependencyGraph::extractDependencies(const OperationRecord& op, FeatureNode
         node.inputBodyIds.insert(p.targetBodyId);
         node.inputBodyIds.insert(p.toolBodyId);
     }
+
+    for (const auto& bodyId : elementBodies) {
+        if (!bodyId.empty() && wholeBodies.count(bodyId) == 0) {
+            node.elementBodyIds.insert(bodyId);
+        }
+    }
 }
 
-void DependencyGraph::rebuildEdges() {
-    forwardEdges_.clear();
-    backwardEdges_.clear();
-    bodyProducers_.clear();
+void DependencyGraph::appendNode(const OperationRecord& op) {
+    FeatureNode node;
+    node.opId = op.opId;
+    node.type = op.type;
+    extractDependencies(op, node);
+    for (const auto& bodyId : op.resultBodyIds) {
+        node.outputBodyIds.insert(bodyId);
+        node.elementBodyIds.erase(bodyId);  // Written bodies are read whole
+    }
 
-    // Walk creation order so dependencies target the most recent producer.
-    for (const auto& opId : creationOrder_) {
-        auto nodeIt = nodes_.find(opId);
-        if (nodeIt == nodes_.end()) {
-            continue;
+    std::vector<std::uint32_t> inputs;
+    inputs.reserve(node.inputBodyIds.size());
+    for (const auto& bodyId : node.inputBodyIds) {
+        inputs.push_back(internBody(bodyId));
+    }
+    std::vector<std::uint32_t> outputs;
+    outputs.reserve(node.outputBodyIds.size());
+    for (const auto& bodyId : node.outputBodyIds) {
+        outputs.push_back(internBody(bodyId));
+    }
+    std::vector<std::uint32_t> elementInputs;
+    elementInputs.reserve(node.elementBodyIds.size());
+    for (const auto& bodyId : node.elementBodyIds) {
+        elementInputs.push_back(internBody(bodyId));
+    }
+
+    indexById_[node.opId] = static_cast<NodeIndex>(nodes_.size());
+    nodes_.push_back(std::move(node));
+    nodeInputBodies_.push_back(std::move(inputs));
+    nodeOutputBodies_.push_back(std::move(outputs));
+    nodeElementBodies_.push_back(std::move(elementInputs));
+}
+
+std::uint32_t DependencyGraph::internBody(const std::string& bodyId) {
+    auto [it, inserted] = bodyIndexById_.try_emplace(bodyId, static_cast<std::uint32_t>(bodyIndexById_.size()));
+    if (inserted) {
+        bodyProducers_.push_back(kNoNode);
+    }
+    return it->second;
+}
+
+DependencyGraph::NodeIndex DependencyGraph::findIndex(const std::string& opId) const {
+    auto it = indexById_.find(opId);
+    return it != indexById_.end() ? it->second : kNoNode;
+}
+
+void DependencyGraph::linkNode(NodeIndex index) {
+    // Rows are appended in node order, so row `index` is the last one.
+    const std::size_t rowStart = backwardEdges_.targets.size();
+    auto addEdge = [&](NodeIndex producer) {
+        if (producer == kNoNode || producer == index) {
+            return;
+        }
+        auto rowBegin = backwardEdges_.targets.begin() + static_cast<std::ptrdiff_t>(rowStart);
+        if (std::find(rowBegin, backwardEdges_.targets.end(), producer) == backwardEdges_.targets.end()) {
+            backwardEdges_.targets.push_back(producer);
         }
-        const FeatureNode& node = nodeIt->second;
+    };
 
-        for (const auto& inputBodyId : node.inputBodyIds) {
-            auto it = bodyProducers_.find(inputBodyId);
-            if (it != bodyProducers_.end() && it->second != opId) {
-                forwardEdges_[it->second].insert(opId);
-                backwardEdges_[opId].insert(it->second);
+    // Element-level inputs link to the producers of the referenced elements.
+    const FeatureNode& node = nodes_[index];
+    const std::vector<std::uint32_t>& elementBodies = nodeElementBodies_[index];
+    bool elementLinked = node.elementProducersKnown;
+    if (elementLinked) {
+        for (const auto& producerId : node.elementProducerIds) {
+            if (producerId.empty()) {
+                continue;
+            }
+            const NodeIndex producer = findIndex(producerId);
+            if (producer == kNoNode || producer >= index) {
+                elementLinked = false;
+                break;
             }
         }
+    }
+    if (elementLinked) {
+        for (const auto& producerId : node.elementProducerIds) {
+            if (!producerId.empty()) {
+                addEdge(findIndex(producerId));
+            }
+        }
+    }
 
-        for (const auto& bodyId : node.outputBodyIds) {
-            bodyProducers_[bodyId] = opId;
+    for (std::uint32_t body : nodeInputBodies_[index]) {
+        if (elementLinked &&
+            std::find(elementBodies.begin(), elementBodies.end(), body) != elementBodies.end()) {
+            continue;
         }
+        addEdge(bodyProducers_[body]);
+    }
+    std::sort(backwardEdges_.targets.begin() + static_cast<std::ptrdiff_t>(rowStart),
+              backwardEdges_.targets.end());
+    backwardEdges_.offsets.push_back(static_cast<std::uint32_t>(backwardEdges_.targets.size()));
+
+    for (std::uint32_t body : nodeOutputBodies_[index]) {
+        bodyProducers_[body] = index;
     }
 }
 
-void DependencyGraph::collectDownstream(const std::string& opId,
-                                        std::unordered_set<std::string>& visited,
-                                        std::vector<std::string>& result) const {
-    auto it = forwardEdges_.find(opId);
-    if (it == forwardEdges_.end()) {
-        return;
+void DependencyGraph::rebuildEdges() {
+    // Walk creation order so dependencies target the most recent producer.
+    backwardEdges_.clear();
+    backwardEdges_.offsets.reserve(nodes_.size() + 1);
+    std::fill(bodyProducers_.begin(), bodyProducers_.end(), kNoNode);
+    for (NodeIndex i = 0; i < nodes_.size(); ++i) {
+        linkNode(i);
+    }
+    rebuildForwardEdges();
+}
+
+void DependencyGraph::rebuildForwardEdges() {
+    const std::size_t nodeCount = nodes_.size();
+    forwardEdges_.offsets.assign(nodeCount + 1, 0);
+    forwardEdges_.targets.resize(backwardEdges_.targets.size());
+
+    for (NodeIndex upstream : backwardEdges_.targets) {
+        ++forwardEdges_.offsets[upstream + 1];
+    }
+    for (std::size_t i = 0; i < nodeCount; ++i) {
+        forwardEdges_.offsets[i + 1] += forwardEdges_.offsets[i];
     }
 
-    for (const auto& downstream : it->second) {
-        if (visited.insert(downstream).second) {
-            result.push_back(downstream);
-            collectDownstream(downstream, visited, result);
+    // Visiting consumers in index order keeps every row sorted.
+    std::vector<std::uint32_t> cursor(forwardEdges_.offsets.begin(), forwardEdges_.offsets.end() - 1);
+    for (NodeIndex consumer = 0; consumer < nodeCount; ++consumer) {
+        for (std::uint32_t e = backwardEdges_.offsets[consumer]; e < backwardEdges_.offsets[consumer + 1]; ++e) {
+            forwardEdges_.targets[cursor[backwardEdges_.targets[e]]++] = consumer;
         }
     }
 }
 
-void DependencyGraph::collectUpstream(const std::string& opId,
-                                      std::unordered_set<std::string>& visited,
-                                      std::vector<std::string>& result) const {
-    auto it = backwardEdges_.find(opId);
-    if (it == backwardEdges_.end()) {
-        return;
+std::vector<DependencyGraph::NodeIndex> DependencyGraph::collectReachable(NodeIndex start,
+                                                                          const Csr& edges) const {
+    std::vector<NodeIndex> result;
+    std::vector<char> visited(nodes_.size(), 0);
+    std::vector<NodeIndex> stack;
+    visited[start] = 1;
+    stack.push_back(start);
+    while (!stack.empty()) {
+        const NodeIndex current = stack.back();
+        stack.pop_back();
+        if (current != start) {
+            result.push_back(current);
+        }
+        // Push in reverse so neighbours are visited in index order.
+        for (std::uint32_t e = edges.offsets[current + 1]; e > edges.offsets[current]; --e) {
+            const NodeIndex next = edges.targets[e - 1];
+            if (!visited[next]) {
+                visited[next] = 1;
+                stack.push_back(next);
+            }
+        }
     }
+    return result;
+}
 
-    for (const auto& upstream : it->second) {
-        if (visited.insert(upstream).second) {
-            result.push_back(upstream);
-            collectUpstream(upstream, visited, result);
-        }
+std::vector<std::string> DependencyGraph::toOpIds(const std::vector<NodeIndex>& indices) const {
+    std::vector<std::string> ids;
+    ids.reserve(indices.size());
+    for (NodeIndex index : indices) {
+        ids.push_back(nodes_[index].opId);
     }
+    return ids;
 }
 
 } // namespace onecad::app::history
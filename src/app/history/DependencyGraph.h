@@ -4,12 +4,21 @@
  *
  * Tracks relationships between operations (which ops depend on which bodies/sketches)
  * and provides topological sort for regeneration order.
+ *
+ * Ops and body IDs are interned to dense indices; edges live in compressed
+ * sparse rows so traversals walk flat integer arrays instead of hashing
+ * op ID strings.
+ *
+ * An op that reads a body only through faces or edges can be linked to the
+ * ops that generated or last modified those elements instead of to the
+ * body's latest producer (setElementProducers()).
  */
 #ifndef ONECAD_APP_HISTORY_DEPENDENCYGRAPH_H
 #define ONECAD_APP_HISTORY_DEPENDENCYGRAPH_H
 
 #include "../document/OperationRecord.h"
 
+#include <cstdint>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -30,6 +39,13 @@ struct FeatureNode {
     std::unordered_set<std::string> inputEdgeIds;   // ElementMap IDs
     std::unordered_set<std::string> inputFaceIds;   // ElementMap IDs
 
+    // Bodies read only through inputEdgeIds/inputFaceIds, never as a whole.
+    // Once the ops that generated or last modified those elements are known,
+    // the op depends on them instead of on the body's latest producer.
+    std::unordered_set<std::string> elementBodyIds;
+    std::unordered_set<std::string> elementProducerIds;  // Empty ID: element predates the history
+    bool elementProducersKnown = false;
+
     // Output (what this op produces/modifies)
     std::unordered_set<std::string> outputBodyIds;
 
@@ -68,6 +84,15 @@ public:
      */
     void removeOperation(const std::string& opId);
 
+    /**
+     * @brief Refine edges to element level: opId -> ops that generated or last
+     * modified the faces and edges it references (ElementMap entry opIds).
+     *
+     * Only affects ops with elementBodyIds. Producers that are unknown to the
+     * graph or do not precede the op fall back to the body's latest producer.
+     */
+    void setElementProducers(const std::unordered_map<std::string, std::vector<std::string>>& producersByOp);
+
     // ─────────────────────────────────────────────────────────────────────────
     // Queries
     // ─────────────────────────────────────────────────────────────────────────
@@ -83,7 +108,9 @@ public:
      * @brief Get topologically sorted list of operation IDs.
      *
      * Operations are ordered such that all dependencies come before dependents.
-     * Uses Kahn's algorithm. Returns empty if graph has a cycle.
+     * An op only ever depends on the latest earlier producer of a body it
+     * reads, so creation order already is that order and the graph cannot
+     * contain a cycle.
      */
     std::vector<std::string> topologicalSort() const;
 
@@ -97,10 +124,17 @@ public:
      */
     std::vector<std::string> getUpstream(const std::string& opId) const;
 
+    /**
+     * @brief Check whether any operation upstream of @p opId is marked failed.
+     *
+     * Same answer as scanning getUpstream(), but stops at the first failure.
+     */
+    bool hasFailedUpstream(const std::string& opId) const;
+
     /**
      * @brief Get all operation IDs in creation order.
      */
-    std::vector<std::string> getAllOpIds() const { return creationOrder_; }
+    std::vector<std::string> getAllOpIds() const;
 
     /**
      * @brief Check if graph contains a cycle (invalid state).
@@ -176,42 +210,72 @@ public:
     void clearFailures();
 
 private:
+    using NodeIndex = std::uint32_t;
+    static constexpr NodeIndex kNoNode = UINT32_MAX;
+
+    /**
+     * @brief Adjacency in compressed sparse rows: the neighbours of node i are
+     * targets[offsets[i] .. offsets[i + 1]).
+     */
+    struct Csr {
+        std::vector<std::uint32_t> offsets{0};
+        std::vector<NodeIndex> targets;
+
+        void clear() {
+            offsets.assign(1, 0);
+            targets.clear();
+        }
+    };
+
     /**
      * @brief Extract dependencies from an operation record.
      */
     void extractDependencies(const OperationRecord& op, FeatureNode& node);
 
     /**
-     * @brief Rebuild edge maps from node dependencies.
+     * @brief Append a node for @p op and intern its body IDs; edges are not touched.
      */
-    void rebuildEdges();
+    void appendNode(const OperationRecord& op);
+
+    std::uint32_t internBody(const std::string& bodyId);
+    NodeIndex findIndex(const std::string& opId) const;
 
     /**
-     * @brief DFS helper for collecting downstream operations.
+     * @brief Link node @p index to the current producers of its inputs (or
+     * of its referenced elements, when known), then make it the producer of
+     * its outputs. Nodes must be linked in order.
      */
-    void collectDownstream(const std::string& opId,
-                           std::unordered_set<std::string>& visited,
-                           std::vector<std::string>& result) const;
+    void linkNode(NodeIndex index);
 
     /**
-     * @brief DFS helper for collecting upstream operations.
+     * @brief Relink every node and lay out both CSR arrays. Integer-only, O(V+E).
      */
-    void collectUpstream(const std::string& opId,
-                         std::unordered_set<std::string>& visited,
-                         std::vector<std::string>& result) const;
-
-    // Node storage
-    std::unordered_map<std::string, FeatureNode> nodes_;
-
-    // Edge maps (opId -> set of connected opIds)
-    std::unordered_map<std::string, std::unordered_set<std::string>> forwardEdges_;  // opId -> downstream
-    std::unordered_map<std::string, std::unordered_set<std::string>> backwardEdges_; // opId -> upstream
+    void rebuildEdges();
 
-    // Creation order (for deterministic iteration)
-    std::vector<std::string> creationOrder_;
+    /**
+     * @brief Derive downstream rows by transposing the upstream rows.
+     */
+    void rebuildForwardEdges();
 
-    // Map: bodyId -> opId that produces it
-    std::unordered_map<std::string, std::string> bodyProducers_;
+    /**
+     * @brief Iterative DFS from @p start over @p edges, in visit (pre)order.
+     */
+    std::vector<NodeIndex> collectReachable(NodeIndex start, const Csr& edges) const;
+    std::vector<std::string> toOpIds(const std::vector<NodeIndex>& indices) const;
+
+    // Nodes in creation order; a node's index is its position
+    std::vector<FeatureNode> nodes_;
+    std::unordered_map<std::string, NodeIndex> indexById_;
+
+    // Interned body IDs each node reads and writes
+    std::unordered_map<std::string, std::uint32_t> bodyIndexById_;
+    std::vector<std::vector<std::uint32_t>> nodeInputBodies_;
+    std::vector<std::vector<std::uint32_t>> nodeOutputBodies_;
+    std::vector<std::vector<std::uint32_t>> nodeElementBodies_;  // Subset of the inputs
+    std::vector<NodeIndex> bodyProducers_;  // bodyIndex -> latest producing node
+
+    Csr forwardEdges_;   // node -> downstream nodes
+    Csr backwardEdges_;  // node -> upstream nodes
 };
 
 } // namespace onecad::app::history
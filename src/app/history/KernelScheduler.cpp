@@ -6,13 +6,12 @@
 
 #include "../document/Document.h"
 
+#include <algorithm>
 #include <utility>
 
 namespace onecad::app::history {
 
-KernelScheduler::KernelScheduler()
-    : worker_(&KernelScheduler::workerLoop, this) {
-}
+KernelScheduler::KernelScheduler() = default;
 
 KernelScheduler::~KernelScheduler() {
     shutdown();
@@ -24,6 +23,10 @@ JobId KernelScheduler::submitRegen(const RegenRequest& request, CompletionCallba
         return 0;
     }
 
+    if (!worker_.joinable()) {
+        worker_ = std::thread(&KernelScheduler::workerLoop, this);
+    }
+
     Job job;
     job.id = nextId_++;
     job.request = request;
@@ -35,7 +38,19 @@ JobId KernelScheduler::submitRegen(const RegenRequest& request, CompletionCallba
 
 void KernelScheduler::cancel(JobId id) {
     std::lock_guard<std::mutex> lock(mutex_);
-    cancelled_.insert(id);
+    // Only the worker forgets cancelled ids, so a job it is done with must not be recorded.
+    if (id != 0 && id == runningId_) {
+        cancelled_.insert(id);
+        if (runningToken_) {
+            runningToken_->cancel();
+        }
+        return;
+    }
+    const bool queued = std::any_of(queue_.begin(), queue_.end(),
+                                    [id](const Job& job) { return job.id == id; });
+    if (queued) {
+        cancelled_.insert(id);
+    }
 }
 
 void KernelScheduler::shutdown() {
@@ -47,9 +62,65 @@ void KernelScheduler::shutdown() {
         stopping_ = true;
     }
     cv_.notify_all();
+    previewCv_.notify_all();
     if (worker_.joinable()) {
         worker_.join();
     }
+    if (previewWorker_.joinable()) {
+        previewWorker_.join();
+    }
+}
+
+JobId KernelScheduler::submitPreview(PreviewRequest request, PreviewCallback callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_ || !request.build) {
+        return 0;
+    }
+    if (!previewWorker_.joinable()) {
+        previewWorker_ = std::thread(&KernelScheduler::previewLoop, this);
+    }
+
+    const std::string& toolKey = request.toolKey;
+    const auto staleEnd = std::remove_if(previewQueue_.begin(), previewQueue_.end(),
+                                         [&toolKey](const PreviewJob& queued) {
+                                             return queued.request.toolKey == toolKey;
+                                         });
+    supersededPreviews_ += static_cast<std::size_t>(std::distance(staleEnd, previewQueue_.end()));
+    previewQueue_.erase(staleEnd, previewQueue_.end());
+
+    PreviewJob job;
+    job.id = nextId_++;
+    job.request = std::move(request);
+    job.callback = std::move(callback);
+    latestPreview_[job.request.toolKey] = job.id;
+    previewQueue_.push_back(std::move(job));
+    previewCv_.notify_one();
+    return previewQueue_.back().id;
+}
+
+void KernelScheduler::cancelPreviews(const std::string& toolKey) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto staleEnd = std::remove_if(previewQueue_.begin(), previewQueue_.end(),
+                                         [&toolKey](const PreviewJob& queued) {
+                                             return queued.request.toolKey == toolKey;
+                                         });
+    previewQueue_.erase(staleEnd, previewQueue_.end());
+    latestPreview_[toolKey] = 0;
+}
+
+std::size_t KernelScheduler::pendingCancellationCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cancelled_.size();
+}
+
+std::size_t KernelScheduler::supersededPreviewCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return supersededPreviews_;
+}
+
+bool KernelScheduler::isLatestPreviewLocked(const PreviewJob& job) const {
+    auto it = latestPreview_.find(job.request.toolKey);
+    return it != latestPreview_.end() && it->second == job.id;
 }
 
 bool KernelScheduler::isCancelledLocked(JobId id) const {
@@ -59,6 +130,7 @@ bool KernelScheduler::isCancelledLocked(JobId id) const {
 void KernelScheduler::workerLoop() {
     while (true) {
         Job job;
+        auto token = std::make_shared<CancellationToken>();
         {
             std::unique_lock<std::mutex> lock(mutex_);
             cv_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
@@ -71,6 +143,8 @@ void KernelScheduler::workerLoop() {
                 cancelled_.erase(job.id);
                 continue;
             }
+            runningId_ = job.id;
+            runningToken_ = token;
         }
 
         RegenJobResult output;
@@ -80,7 +154,14 @@ void KernelScheduler::workerLoop() {
             output.result.status = RegenStatus::CriticalFailure;
         } else {
             RegenerationEngine engine(job.request.document);
-            if (job.request.useAppliedCount) {
+            engine.setCancellationToken(token);
+            if (job.request.progress) {
+                engine.setProgressCallback(job.request.progress);
+            }
+            if (!job.request.dirtyOpIds.empty()) {
+                output.result = engine.regenerateIncremental(job.request.appliedOpCount,
+                                                             job.request.dirtyOpIds);
+            } else if (job.request.useAppliedCount) {
                 output.result = engine.regenerateToAppliedCount(job.request.appliedOpCount);
             } else {
                 output.result = engine.regenerateAll();
@@ -89,10 +170,15 @@ void KernelScheduler::workerLoop() {
 
         {
             std::lock_guard<std::mutex> lock(mutex_);
+            runningId_ = 0;
+            runningToken_.reset();
             if (isCancelledLocked(job.id)) {
                 cancelled_.erase(job.id);
                 output.cancelled = true;
             }
+            if (output.result.status == RegenStatus::Cancelled) {
+                output.cancelled = true;
+            }
         }
 
         if (job.callback) {
@@ -101,4 +187,40 @@ void KernelScheduler::workerLoop() {
     }
 }
 
+void KernelScheduler::previewLoop() {
+    while (true) {
+        PreviewJob job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            previewCv_.wait(lock, [this]() { return stopping_ || !previewQueue_.empty(); });
+            if (stopping_) {
+                return;  // Previews are disposable; do not drain on shutdown
+            }
+            job = std::move(previewQueue_.front());
+            previewQueue_.pop_front();
+        }
+
+        auto snapshot = std::make_shared<PreviewSnapshot>();
+        snapshot->id = job.id;
+        snapshot->toolKey = job.request.toolKey;
+        try {
+            snapshot->shape = job.request.build();
+        } catch (...) {
+            snapshot->shape.Nullify();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!isLatestPreviewLocked(job)) {
+                ++supersededPreviews_;
+                continue;
+            }
+        }
+
+        if (job.callback) {
+            job.callback(std::move(snapshot));
+        }
+    }
+}
+
 } // namespace onecad::app::history
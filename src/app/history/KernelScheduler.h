@@ -1,19 +1,32 @@
 /**
  * @file KernelScheduler.h
  * @brief Single-writer scheduler for kernel regeneration tasks.
+ *
+ * Regeneration jobs run FIFO on the writer thread; cancelling the running
+ * job stops it inside its current OCCT algorithm. Interactive tool
+ * previews use a separate lane with its own thread, so a drag never waits
+ * behind a regeneration, and are coalesced latest-wins per tool key.
+ * Each thread starts with the first job of its lane, so a preview-only
+ * or regeneration-only user runs one thread.
  */
 #ifndef ONECAD_APP_HISTORY_KERNELSCHEDULER_H
 #define ONECAD_APP_HISTORY_KERNELSCHEDULER_H
 
 #include "RegenerationEngine.h"
 
+#include <TopoDS_Shape.hxx>
+
 #include <cstdint>
 #include <condition_variable>
 #include <deque>
 #include <functional>
+#include <memory>
 #include <mutex>
+#include <string>
 #include <thread>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 namespace onecad::app {
 class Document;
@@ -27,6 +40,8 @@ struct RegenRequest {
     Document* document = nullptr;
     std::size_t appliedOpCount = 0;
     bool useAppliedCount = true;
+    RegenerationEngine::ProgressCallback progress;  // Serialized, but from any build thread
+    std::vector<std::string> dirtyOpIds;            // Non-empty: regenerateIncremental()
 };
 
 struct RegenJobResult {
@@ -35,17 +50,70 @@ struct RegenJobResult {
     bool cancelled = false;
 };
 
+/**
+ * @brief Interactive preview build for one tool.
+ *
+ * The builder runs on the preview thread. It must not touch the Document;
+ * capture the input shapes and parameters by value instead.
+ */
+struct PreviewRequest {
+    std::string toolKey;                 // Newer requests with the same key supersede older ones
+    std::function<TopoDS_Shape()> build;
+};
+
+/**
+ * @brief Immutable result of a preview build.
+ */
+struct PreviewSnapshot {
+    JobId id = 0;
+    std::string toolKey;
+    TopoDS_Shape shape;  // Null when the build failed
+};
+
 class KernelScheduler {
 public:
     using CompletionCallback = std::function<void(const RegenJobResult&)>;
+    using PreviewCallback = std::function<void(std::shared_ptr<const PreviewSnapshot>)>;
 
     KernelScheduler();
     ~KernelScheduler();
 
     JobId submitRegen(const RegenRequest& request, CompletionCallback callback = {});
+
+    /**
+     * @brief Cancel a queued or running job.
+     *
+     * A running job aborts cooperatively and leaves its document unchanged;
+     * its callback still runs with RegenJobResult::cancelled set. Ids of
+     * finished or unknown jobs are ignored.
+     */
     void cancel(JobId id);
+
+    /**
+     * @brief Number of cancelled jobs the writer thread has yet to drop.
+     */
+    std::size_t pendingCancellationCount() const;
     void shutdown();
 
+    /**
+     * @brief Queue a preview build on the preview lane.
+     *
+     * Queued previews with the same tool key are dropped, and a running one
+     * is discarded when it finishes. The callback runs on the preview thread
+     * and only for a result that is still the latest for its key.
+     */
+    JobId submitPreview(PreviewRequest request, PreviewCallback callback = {});
+
+    /**
+     * @brief Drop queued previews of a tool and discard its running one.
+     */
+    void cancelPreviews(const std::string& toolKey);
+
+    /**
+     * @brief Number of preview requests dropped or discarded as superseded.
+     */
+    std::size_t supersededPreviewCount() const;
+
 private:
     struct Job {
         JobId id = 0;
@@ -53,16 +121,33 @@ private:
         CompletionCallback callback;
     };
 
+    struct PreviewJob {
+        JobId id = 0;
+        PreviewRequest request;
+        PreviewCallback callback;
+    };
+
     void workerLoop();
+    void previewLoop();
     bool isCancelledLocked(JobId id) const;
+    bool isLatestPreviewLocked(const PreviewJob& job) const;
 
     mutable std::mutex mutex_;
     std::condition_variable cv_;
     std::deque<Job> queue_;
     std::unordered_set<JobId> cancelled_;
+    JobId runningId_ = 0;
+    std::shared_ptr<CancellationToken> runningToken_;
     std::thread worker_;
     bool stopping_ = false;
     JobId nextId_ = 1;
+
+    // Preview lane
+    std::condition_variable previewCv_;
+    std::deque<PreviewJob> previewQueue_;
+    std::unordered_map<std::string, JobId> latestPreview_;  // toolKey -> newest submitted job (0 = cancelled)
+    std::size_t supersededPreviews_ = 0;
+    std::thread previewWorker_;
 };
 
 } // namespace onecad::app::history
@@ -0,0 +1,46 @@
+/**
+ * @file ModelSnapshot.h
+ * @brief Versioned, read-only result of an asynchronous regeneration.
+ *
+ * AsyncRegenerator replays history on a private copy of the document on
+ * the kernel thread and hands the outcome to the UI thread as one
+ * immutable snapshot. Document::applyModelSnapshot() swaps it in as a
+ * whole, so the viewport and pickers never see a half-regenerated model.
+ */
+#ifndef ONECAD_APP_HISTORY_MODELSNAPSHOT_H
+#define ONECAD_APP_HISTORY_MODELSNAPSHOT_H
+
+#include "RegenProfile.h"
+#include "RegenerationCache.h"
+#include "RegenerationEngine.h"
+#include "../../kernel/elementmap/ElementMap.h"
+
+#include <TopoDS_Shape.hxx>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace onecad::app::history {
+
+struct ModelSnapshot {
+    std::uint64_t version = 0;
+    std::size_t appliedOpCount = 0;
+    RegenResult result;
+
+    std::unordered_map<std::string, TopoDS_Shape> bodies;  // Every body after the run
+    std::unordered_map<std::string, std::string> bodyNames;
+    std::vector<std::string> removedBodyIds;               // Bodies the run dropped
+    unsigned int nextBodyNumber = 1;
+    kernel::elementmap::ElementMap elementMap;
+
+    std::unordered_map<std::string, std::string> operationFailures;
+    RegenerationCache regenerationCache;
+    std::vector<OpProfile> opProfiles;  // Costs measured by the run, in execution order
+};
+
+} // namespace onecad::app::history
+
+#endif // ONECAD_APP_HISTORY_MODELSNAPSHOT_H
@@ -0,0 +1,133 @@
+/**
+ * @file OperationCheckpointCache.cpp
+ * @brief Implementation of OperationCheckpointCache.
+ */
+#include "OperationCheckpointCache.h"
+
+#include <TopExp.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+
+#include <iterator>
+
+namespace onecad::app::history {
+
+namespace {
+// Rough per-element footprint of B-Rep topology plus geometry and triangulation.
+constexpr std::size_t kBytesPerFace = 4096;
+constexpr std::size_t kBytesPerEdge = 1024;
+constexpr std::size_t kBytesPerVertex = 128;
+constexpr std::size_t kSlotOverheadBytes = 256;
+} // namespace
+
+OperationCheckpointCache::OperationCheckpointCache(std::size_t budgetBytes)
+    : budgetBytes_(budgetBytes) {
+}
+
+void OperationCheckpointCache::setMemoryBudget(std::size_t bytes) {
+    budgetBytes_ = bytes;
+    evictToBudget();
+}
+
+const OperationCheckpoint* OperationCheckpointCache::find(const OperationCheckpointKey& key) {
+    auto it = index_.find(key.hash);
+    if (it == index_.end()) {
+        ++stats_.misses;
+        return nullptr;
+    }
+
+    const Slot& slot = *it->second;
+    bool inputsMatch = slot.key.inputShapes.size() == key.inputShapes.size();
+    for (std::size_t i = 0; inputsMatch && i < key.inputShapes.size(); ++i) {
+        inputsMatch = slot.key.inputShapes[i].IsEqual(key.inputShapes[i]);
+    }
+    if (!inputsMatch) {
+        ++stats_.misses;
+        return nullptr;
+    }
+
+    lru_.splice(lru_.begin(), lru_, it->second);
+    ++stats_.hits;
+    return &lru_.front().checkpoint;
+}
+
+void OperationCheckpointCache::insert(OperationCheckpointKey key, OperationCheckpoint checkpoint) {
+    if (!isEnabled() || checkpoint.shape.IsNull()) {
+        return;
+    }
+
+    auto existing = index_.find(key.hash);
+    if (existing != index_.end()) {
+        erase(existing->second);
+    }
+
+    Slot slot;
+    slot.bytes = estimateBytes(checkpoint);
+    if (slot.bytes > budgetBytes_) {
+        return;
+    }
+    slot.key = std::move(key);
+    slot.checkpoint = std::move(checkpoint);
+
+    const std::uint64_t hash = slot.key.hash;
+    stats_.bytesUsed += slot.bytes;
+    lru_.push_front(std::move(slot));
+    index_[hash] = lru_.begin();
+    ++stats_.insertions;
+    stats_.entryCount = lru_.size();
+    evictToBudget();
+}
+
+void OperationCheckpointCache::clear() {
+    lru_.clear();
+    index_.clear();
+    stats_.entryCount = 0;
+    stats_.bytesUsed = 0;
+}
+
+void OperationCheckpointCache::resetStats() {
+    stats_.hits = 0;
+    stats_.misses = 0;
+    stats_.insertions = 0;
+    stats_.evictions = 0;
+}
+
+std::size_t OperationCheckpointCache::estimateBytes(const OperationCheckpoint& checkpoint) {
+    std::size_t bytes = kSlotOverheadBytes;
+    if (!checkpoint.shape.IsNull()) {
+        TopTools_IndexedMapOfShape faces;
+        TopTools_IndexedMapOfShape edges;
+        TopTools_IndexedMapOfShape vertices;
+        TopExp::MapShapes(checkpoint.shape, TopAbs_FACE, faces);
+        TopExp::MapShapes(checkpoint.shape, TopAbs_EDGE, edges);
+        TopExp::MapShapes(checkpoint.shape, TopAbs_VERTEX, vertices);
+        bytes += static_cast<std::size_t>(faces.Extent()) * kBytesPerFace;
+        bytes += static_cast<std::size_t>(edges.Extent()) * kBytesPerEdge;
+        bytes += static_cast<std::size_t>(vertices.Extent()) * kBytesPerVertex;
+    }
+    for (const auto& [bodyId, entries] : checkpoint.bodyElements) {
+        bytes += bodyId.size();
+        for (const auto& entry : entries) {
+            bytes += sizeof(kernel::elementmap::Entry) + entry.id.value.size() + entry.opId.size();
+            for (const auto& source : entry.sources) {
+                bytes += sizeof(kernel::elementmap::ElementId) + source.value.size();
+            }
+        }
+    }
+    return bytes;
+}
+
+void OperationCheckpointCache::erase(std::list<Slot>::iterator it) {
+    stats_.bytesUsed -= it->bytes;
+    index_.erase(it->key.hash);
+    lru_.erase(it);
+    stats_.entryCount = lru_.size();
+}
+
+void OperationCheckpointCache::evictToBudget() {
+    while (!lru_.empty() && stats_.bytesUsed > budgetBytes_) {
+        erase(std::prev(lru_.end()));
+        ++stats_.evictions;
+    }
+}
+
+} // namespace onecad::app::history
@@ -0,0 +1,118 @@
+/**
+ * @file OperationCheckpointCache.h
+ * @brief Memoized operation results keyed by operation inputs.
+ *
+ * Undo/redo and rollback scrubbing replay the same history prefixes over
+ * and over. RegenerationEngine hashes everything an operation reads (its
+ * params, resolved input shapes, sketch content and the pre-op ElementMap
+ * state of its output bodies) and, when the same inputs come back, reuses
+ * the produced shape and ElementMap entries instead of re-running OCCT.
+ */
+#ifndef ONECAD_APP_HISTORY_OPERATIONCHECKPOINTCACHE_H
+#define ONECAD_APP_HISTORY_OPERATIONCHECKPOINTCACHE_H
+
+#include "../../kernel/elementmap/ElementMap.h"
+
+#include <TopoDS_Shape.hxx>
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace onecad::app::history {
+
+/**
+ * @brief Lookup key of an operation checkpoint.
+ *
+ * The hash covers every input; the input shapes are kept as well and
+ * compared on lookup, so a hash collision or a recycled TShape address
+ * never yields a foreign result.
+ */
+struct OperationCheckpointKey {
+    std::uint64_t hash = 0;
+    std::vector<TopoDS_Shape> inputShapes;
+};
+
+/**
+ * @brief Cached result of one operation execution.
+ */
+struct OperationCheckpoint {
+    TopoDS_Shape shape;                                                    // Produced shape
+    std::unordered_map<std::string,
+                       std::vector<kernel::elementmap::Entry>> bodyElements;  // Post-op entries per output body
+};
+
+struct CheckpointCacheStats {
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+    std::size_t insertions = 0;
+    std::size_t evictions = 0;
+    std::size_t entryCount = 0;
+    std::size_t bytesUsed = 0;
+};
+
+/**
+ * @brief LRU cache of operation checkpoints bounded by an estimated memory budget.
+ *
+ * Owned by Document. Shapes are TopoDS handles shared with the document,
+ * so the budget accounts for the geometry a checkpoint keeps alive after
+ * the document has moved on, estimated from its topology.
+ */
+class OperationCheckpointCache {
+public:
+    static constexpr std::size_t kDefaultBudgetBytes = 256u * 1024u * 1024u;
+
+    explicit OperationCheckpointCache(std::size_t budgetBytes = kDefaultBudgetBytes);
+
+    /**
+     * @brief Set the memory budget; evicts least recently used entries to fit.
+     *
+     * A budget of 0 disables the cache.
+     */
+    void setMemoryBudget(std::size_t bytes);
+    std::size_t memoryBudget() const { return budgetBytes_; }
+    bool isEnabled() const { return budgetBytes_ > 0; }
+
+    /**
+     * @brief Find a checkpoint and mark it most recently used.
+     * @return nullptr on miss. The pointer is valid until the next insert/clear.
+     */
+    const OperationCheckpoint* find(const OperationCheckpointKey& key);
+
+    /**
+     * @brief Store a checkpoint, replacing any entry with the same hash.
+     */
+    void insert(OperationCheckpointKey key, OperationCheckpoint checkpoint);
+
+    void clear();
+
+    const CheckpointCacheStats& stats() const { return stats_; }
+    void resetStats();
+
+    /**
+     * @brief Approximate memory kept alive by a checkpoint.
+     */
+    static std::size_t estimateBytes(const OperationCheckpoint& checkpoint);
+
+private:
+    struct Slot {
+        OperationCheckpointKey key;
+        OperationCheckpoint checkpoint;
+        std::size_t bytes = 0;
+    };
+
+    void erase(std::list<Slot>::iterator it);
+    void evictToBudget();
+
+    std::size_t budgetBytes_;
+    std::list<Slot> lru_;  // Front is most recently used
+    std::unordered_map<std::uint64_t, std::list<Slot>::iterator> index_;
+    CheckpointCacheStats stats_;
+};
+
+} // namespace onecad::app::history
+
+#endif // ONECAD_APP_HISTORY_OPERATIONCHECKPOINTCACHE_H
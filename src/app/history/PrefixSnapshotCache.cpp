@@ -0,0 +1,63 @@
+/**
+ * @file PrefixSnapshotCache.cpp
+ * @brief Implementation of PrefixSnapshotCache.
+ */
+#include "PrefixSnapshotCache.h"
+
+#include <algorithm>
+
+namespace onecad::app::history {
+
+void PrefixSnapshotCache::setInterval(std::size_t interval) {
+    if (interval == interval_) {
+        return;
+    }
+    interval_ = interval;
+    clear();
+}
+
+void PrefixSnapshotCache::store(PrefixSnapshot snapshot) {
+    if (snapshot.opCount == 0) {
+        return;  // Replaying nothing needs no snapshot
+    }
+
+    const std::size_t opCount = snapshot.opCount;
+    snapshots_[opCount] = std::move(snapshot);
+    if (isGridPosition(opCount)) {
+        return;
+    }
+
+    auto existing = std::find(positionOrder_.begin(), positionOrder_.end(), opCount);
+    if (existing != positionOrder_.end()) {
+        positionOrder_.erase(existing);
+    }
+    positionOrder_.push_back(opCount);
+    while (positionOrder_.size() > kMaxPositionSnapshots) {
+        snapshots_.erase(positionOrder_.front());
+        positionOrder_.pop_front();
+    }
+}
+
+const PrefixSnapshot* PrefixSnapshotCache::findLatest(
+    const std::vector<std::uint64_t>& prefixSignatures) const {
+    if (prefixSignatures.empty()) {
+        return nullptr;
+    }
+
+    // Positions past the requested prefix are kept for redo but skipped here.
+    auto it = snapshots_.upper_bound(prefixSignatures.size() - 1);
+    while (it != snapshots_.begin()) {
+        --it;
+        if (it->second.signature == prefixSignatures[it->first]) {
+            return &it->second;
+        }
+    }
+    return nullptr;
+}
+
+void PrefixSnapshotCache::clear() {
+    snapshots_.clear();
+    positionOrder_.clear();
+}
+
+} // namespace onecad::app::history
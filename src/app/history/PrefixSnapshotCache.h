@@ -0,0 +1,89 @@
+/**
+ * @file PrefixSnapshotCache.h
+ * @brief Body-map snapshots at selected history positions for fast rollback.
+ *
+ * Moving the rollback marker calls regenerateToAppliedCount(k), which used
+ * to replay the whole prefix [0, k). RegenerationEngine records the body
+ * shapes, their ElementMap entries and the per-op outcomes after every N
+ * replayed ops and at the end of each run. A later run restores the
+ * nearest snapshot whose prefix is unchanged and replays only the gap.
+ */
+#ifndef ONECAD_APP_HISTORY_PREFIXSNAPSHOTCACHE_H
+#define ONECAD_APP_HISTORY_PREFIXSNAPSHOTCACHE_H
+
+#include "RegenerationCache.h"
+#include "../../kernel/elementmap/ElementMap.h"
+
+#include <TopoDS_Shape.hxx>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace onecad::app::history {
+
+/**
+ * @brief Replay state after the first opCount ops of the creation order.
+ */
+struct PrefixSnapshot {
+    std::size_t opCount = 0;
+    std::uint64_t signature = 0;  // Hash of base bodies and the replayed op prefix
+    std::vector<std::pair<std::string, CachedOpState>> operations;  // In replay order
+    std::unordered_map<std::string, TopoDS_Shape> bodies;
+    std::unordered_map<std::string, std::vector<kernel::elementmap::Entry>> bodyElements;
+};
+
+/**
+ * @brief Snapshots kept every interval() ops plus a few recent end positions.
+ *
+ * Owned by Document. Snapshots are immutable once stored; shapes are
+ * TopoDS handles shared with the document.
+ */
+class PrefixSnapshotCache {
+public:
+    static constexpr std::size_t kDefaultInterval = 8;
+    static constexpr std::size_t kMaxPositionSnapshots = 4;
+
+    PrefixSnapshotCache() = default;
+
+    /**
+     * @brief Distance between grid snapshots; 0 keeps only end positions.
+     *
+     * Changing the interval drops existing snapshots.
+     */
+    void setInterval(std::size_t interval);
+    std::size_t interval() const { return interval_; }
+    bool isGridPosition(std::size_t opCount) const {
+        return interval_ > 0 && opCount > 0 && opCount % interval_ == 0;
+    }
+
+    /**
+     * @brief Store a snapshot, replacing any snapshot at the same position.
+     *
+     * Off-grid snapshots are capped at kMaxPositionSnapshots, oldest first out.
+     */
+    void store(PrefixSnapshot snapshot);
+
+    /**
+     * @brief Latest snapshot whose signature matches the current prefix.
+     * @param prefixSignatures prefixSignatures[j] is the signature of the first j ops.
+     */
+    const PrefixSnapshot* findLatest(const std::vector<std::uint64_t>& prefixSignatures) const;
+
+    void clear();
+    std::size_t size() const { return snapshots_.size(); }
+
+private:
+    std::size_t interval_ = kDefaultInterval;
+    std::map<std::size_t, PrefixSnapshot> snapshots_;
+    std::deque<std::size_t> positionOrder_;  // Off-grid positions, oldest first
+};
+
+} // namespace onecad::app::history
+
+#endif // ONECAD_APP_HISTORY_PREFIXSNAPSHOTCACHE_H
@@ -0,0 +1,185 @@
+/**
+ * @file RegenProfile.cpp
+ * @brief Implementation of RegenProfile.
+ */
+#include "RegenProfile.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QString>
+#include <QtGlobal>
+
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+
+#if defined(__APPLE__)
+#include <mach/mach.h>
+#elif defined(__linux__)
+#include <unistd.h>
+#endif
+
+namespace onecad::app::history {
+
+namespace {
+constexpr int kTracePid = 1;
+constexpr int kApplyThread = 0;
+
+QJsonObject makeEvent(const OpProfile& op, const char* category, std::int64_t startUs,
+                      std::int64_t durationUs, int thread) {
+    QJsonObject event;
+    event["name"] = QString::fromStdString(op.name);
+    event["cat"] = category;
+    event["ph"] = "X";
+    event["ts"] = static_cast<double>(startUs);
+    event["dur"] = static_cast<double>(durationUs);
+    event["pid"] = kTracePid;
+    event["tid"] = thread;
+    return event;
+}
+
+QJsonObject makeThreadName(int thread, const QString& name) {
+    QJsonObject event;
+    event["name"] = "thread_name";
+    event["ph"] = "M";
+    event["pid"] = kTracePid;
+    event["tid"] = thread;
+    event["args"] = QJsonObject{{"name", name}};
+    return event;
+}
+} // namespace
+
+RegenProfile::RegenProfile()
+    : runStart_(std::chrono::steady_clock::now()) {
+    if (qEnvironmentVariableIsSet("ONECAD_REGEN_PROFILE")) {
+        enabled_ = qEnvironmentVariableIntValue("ONECAD_REGEN_PROFILE") != 0;
+    }
+}
+
+void RegenProfile::beginRun() {
+    ++runCount_;
+    runStart_ = std::chrono::steady_clock::now();
+    lastRunOrder_.clear();
+}
+
+std::int64_t RegenProfile::elapsedUs() const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - runStart_)
+        .count();
+}
+
+void RegenProfile::record(OpProfile profile) {
+    const std::string opId = profile.opId;
+    lastRunOrder_.push_back(opId);
+    latest_[opId] = std::move(profile);
+}
+
+void RegenProfile::adoptRun(const std::vector<OpProfile>& run) {
+    beginRun();
+    for (const auto& profile : run) {
+        record(profile);
+    }
+}
+
+const OpProfile* RegenProfile::find(const std::string& opId) const {
+    auto it = latest_.find(opId);
+    return it != latest_.end() ? &it->second : nullptr;
+}
+
+std::vector<OpProfile> RegenProfile::lastRun() const {
+    std::vector<OpProfile> run;
+    run.reserve(lastRunOrder_.size());
+    for (const auto& opId : lastRunOrder_) {
+        run.push_back(latest_.at(opId));
+    }
+    return run;
+}
+
+void RegenProfile::clear() {
+    latest_.clear();
+    lastRunOrder_.clear();
+}
+
+std::string RegenProfile::toChromeTrace() const {
+    QJsonArray events;
+    events.append(makeThreadName(kApplyThread, "regeneration"));
+
+    int maxThread = 0;
+    for (const auto& op : lastRun()) {
+        maxThread = std::max(maxThread, op.buildThread);
+        if (!op.checkpointHit) {
+            QJsonObject build = makeEvent(op, "build", op.buildStartUs, op.buildWallUs, op.buildThread);
+            build["args"] = QJsonObject{
+                {"opId", QString::fromStdString(op.opId)},
+                {"cpuUs", static_cast<double>(op.buildCpuUs)},
+                {"residentDeltaBytes", static_cast<double>(op.residentDeltaBytes)}};
+            events.append(build);
+        }
+
+        QJsonObject apply = makeEvent(op, "apply", op.applyStartUs, op.applyWallUs, kApplyThread);
+        apply["args"] = QJsonObject{
+            {"opId", QString::fromStdString(op.opId)},
+            {"elementMapUs", static_cast<double>(op.elementMapUs)},
+            {"tessellationUs", static_cast<double>(op.tessellationUs)},
+            {"faces", op.faceCount},
+            {"edges", op.edgeCount},
+            {"checkpointHit", op.checkpointHit}};
+        events.append(apply);
+    }
+    for (int thread = 1; thread <= maxThread; ++thread) {
+        events.append(makeThreadName(thread, QString("build worker %1").arg(thread)));
+    }
+
+    QJsonObject root;
+    root["traceEvents"] = events;
+    root["displayTimeUnit"] = "ms";
+    return QJsonDocument(root).toJson(QJsonDocument::Compact).toStdString();
+}
+
+bool RegenProfile::writeChromeTrace(const std::string& path, std::string& errorOut) const {
+    QFile file(QString::fromStdString(path));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        errorOut = "Failed to open trace file: " + file.errorString().toStdString();
+        return false;
+    }
+    const std::string json = toChromeTrace();
+    if (file.write(json.data(), static_cast<qint64>(json.size())) != static_cast<qint64>(json.size())) {
+        errorOut = "Failed to write trace file: " + file.errorString().toStdString();
+        return false;
+    }
+    return true;
+}
+
+std::int64_t RegenProfile::threadCpuMicros() {
+    timespec ts{};
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+        return 0;
+    }
+    return static_cast<std::int64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+std::int64_t RegenProfile::residentBytes() {
+#if defined(__APPLE__)
+    mach_task_basic_info info{};
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO,
+                  reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS) {
+        return 0;
+    }
+    return static_cast<std::int64_t>(info.resident_size);
+#elif defined(__linux__)
+    std::ifstream statm("/proc/self/statm");
+    long pages = 0;
+    long resident = 0;
+    if (!(statm >> pages >> resident)) {
+        return 0;
+    }
+    return static_cast<std::int64_t>(resident) * sysconf(_SC_PAGESIZE);
+#else
+    return 0;
+#endif
+}
+
+} // namespace onecad::app::history
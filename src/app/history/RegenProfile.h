@@ -0,0 +1,100 @@
+/**
+ * @file RegenProfile.h
+ * @brief Per-operation cost of regeneration, exportable as a Chrome trace.
+ *
+ * RegenerationEngine records one OpProfile per executed operation: kernel
+ * build time (wall and thread CPU), the document update that follows it
+ * (ElementMap rebind and tessellation of the touched bodies), resident
+ * memory growth and the size of the produced shape. The history panel
+ * shows the totals; writeChromeTrace() dumps the last run for
+ * chrome://tracing or Perfetto.
+ */
+#ifndef ONECAD_APP_HISTORY_REGENPROFILE_H
+#define ONECAD_APP_HISTORY_REGENPROFILE_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace onecad::app::history {
+
+struct OpProfile {
+    std::string opId;
+    std::string name;                  // Operation type, e.g. "Extrude"
+    std::int64_t buildStartUs = 0;     // Relative to the start of the run
+    std::int64_t buildWallUs = 0;
+    std::int64_t buildCpuUs = 0;       // CPU time of the building thread
+    std::int64_t applyStartUs = 0;
+    std::int64_t applyWallUs = 0;      // Document update, including the two below
+    std::int64_t elementMapUs = 0;
+    std::int64_t tessellationUs = 0;
+    std::int64_t residentDeltaBytes = 0;  // Process RSS growth across the build
+    int faceCount = 0;
+    int edgeCount = 0;
+    int buildThread = 0;               // 0 = regeneration thread, 1.. = parallel workers
+    bool checkpointHit = false;
+
+    std::int64_t totalUs() const { return buildWallUs + applyWallUs; }
+};
+
+/**
+ * @brief Latest measured cost of every operation plus the order of the last run.
+ *
+ * Incremental runs only replay dirty operations; the others keep the cost
+ * of their last execution. Not thread-safe: written by the thread driving
+ * the run, read by the thread owning the document.
+ */
+class RegenProfile {
+public:
+    RegenProfile();
+
+    /**
+     * @brief On by default; ONECAD_REGEN_PROFILE=0 turns it off.
+     */
+    void setEnabled(bool enabled) { enabled_ = enabled; }
+    bool isEnabled() const { return enabled_; }
+
+    /**
+     * @brief Start a run: restart the clock and forget the previous run's order.
+     */
+    void beginRun();
+
+    /**
+     * @brief Microseconds since beginRun(). Safe to call from build workers.
+     */
+    std::int64_t elapsedUs() const;
+
+    void record(OpProfile profile);
+
+    /**
+     * @brief Replace the last run with one measured elsewhere (an async snapshot).
+     */
+    void adoptRun(const std::vector<OpProfile>& run);
+
+    const OpProfile* find(const std::string& opId) const;
+    std::vector<OpProfile> lastRun() const;
+    std::uint64_t runCount() const { return runCount_; }
+    void clear();
+
+    /**
+     * @brief Chrome trace-event JSON of the last run.
+     */
+    std::string toChromeTrace() const;
+    bool writeChromeTrace(const std::string& path, std::string& errorOut) const;
+
+    static std::int64_t threadCpuMicros();
+    static std::int64_t residentBytes();
+
+private:
+    bool enabled_ = true;
+    std::uint64_t runCount_ = 0;
+    std::chrono::steady_clock::time_point runStart_;
+    std::unordered_map<std::string, OpProfile> latest_;  // opId -> last measurement
+    std::vector<std::string> lastRunOrder_;
+};
+
+} // namespace onecad::app::history
+
+#endif // ONECAD_APP_HISTORY_REGENPROFILE_H
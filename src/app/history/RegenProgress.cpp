@@ -0,0 +1,47 @@
+/**
+ * @file RegenProgress.cpp
+ * @brief Implementation of RegenProgressIndicator.
+ */
+#include "RegenProgress.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace onecad::app::history {
+
+RegenProgressIndicator::RegenProgressIndicator(std::shared_ptr<const CancellationToken> token,
+                                               ReportFn report)
+    : token_(std::move(token)), report_(std::move(report)) {
+}
+
+void RegenProgressIndicator::setCurrentOp(const std::string& opId) {
+    std::lock_guard<std::mutex> lock(opMutex_);
+    currentOp_ = opId;
+}
+
+Standard_Boolean RegenProgressIndicator::UserBreak() {
+    return token_ && token_->isCancelled();
+}
+
+void RegenProgressIndicator::Show(const Message_ProgressScope& scope, const Standard_Boolean isForce) {
+    (void)scope;
+    if (!report_) {
+        return;
+    }
+
+    const int permille = std::clamp(static_cast<int>(std::lround(GetPosition() * kScale)), 0, kScale);
+    if (permille == lastPermille_ && !isForce) {
+        return;
+    }
+    lastPermille_ = permille;
+
+    std::string opId;
+    {
+        std::lock_guard<std::mutex> lock(opMutex_);
+        opId = currentOp_;
+    }
+    report_(permille, opId);
+}
+
+} // namespace onecad::app::history
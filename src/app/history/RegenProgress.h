@@ -0,0 +1,71 @@
+/**
+ * @file RegenProgress.h
+ * @brief Cooperative cancellation and OCCT progress reporting for regeneration.
+ *
+ * RegenerationEngine hands a Message_ProgressRange from a
+ * RegenProgressIndicator to every OCCT algorithm it runs. The indicator
+ * answers UserBreak() from a CancellationToken, so a cancelled job stops
+ * inside long booleans and fillets, not only between operations.
+ */
+#ifndef ONECAD_APP_HISTORY_REGENPROGRESS_H
+#define ONECAD_APP_HISTORY_REGENPROGRESS_H
+
+#include <Message_ProgressIndicator.hxx>
+#include <Message_ProgressScope.hxx>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace onecad::app::history {
+
+/**
+ * @brief Thread-safe cancel flag shared between a job's owner and its engine.
+ */
+class CancellationToken {
+public:
+    void cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+    bool isCancelled() const { return cancelled_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<bool> cancelled_{false};
+};
+
+/**
+ * @brief Progress indicator driving RegenerationEngine's ProgressCallback.
+ *
+ * Reports overall progress in per-mille steps, each time it advances.
+ * Show() is serialized by Message_ProgressIndicator, but it runs on
+ * whichever thread advanced the progress (including parallel build workers).
+ */
+class RegenProgressIndicator : public Message_ProgressIndicator {
+public:
+    static constexpr int kScale = 1000;
+
+    using ReportFn = std::function<void(int permille, const std::string& opId)>;
+
+    RegenProgressIndicator(std::shared_ptr<const CancellationToken> token, ReportFn report);
+
+    /**
+     * @brief Operation reported alongside the next progress updates.
+     */
+    void setCurrentOp(const std::string& opId);
+
+    Standard_Boolean UserBreak() override;
+    void Show(const Message_ProgressScope& scope, const Standard_Boolean isForce) override;
+
+    DEFINE_STANDARD_RTTI_INLINE(RegenProgressIndicator, Message_ProgressIndicator)
+
+private:
+    std::shared_ptr<const CancellationToken> token_;
+    ReportFn report_;
+    std::mutex opMutex_;
+    std::string currentOp_;
+    int lastPermille_ = -1;  // Guarded by the base class mutex around Show()
+};
+
+} // namespace onecad::app::history
+
+#endif // ONECAD_APP_HISTORY_REGENPROGRESS_H
@@ -0,0 +1,30 @@
+/**
+ * @file RegenerationCache.cpp
+ * @brief Implementation of RegenerationCache.
+ */
+#include "RegenerationCache.h"
+
+namespace onecad::app::history {
+
+void RegenerationCache::clear() {
+    primed_ = false;
+    appliedOrder_.clear();
+    operations_.clear();
+    baseShapes_.clear();
+    finalBodies_.clear();
+}
+
+const CachedOpState* RegenerationCache::findOperation(const std::string& opId) const {
+    auto it = operations_.find(opId);
+    return (it != operations_.end()) ? &it->second : nullptr;
+}
+
+void RegenerationCache::setOperationState(const std::string& opId, CachedOpState state) {
+    operations_[opId] = std::move(state);
+}
+
+void RegenerationCache::eraseOperation(const std::string& opId) {
+    operations_.erase(opId);
+}
+
+} // namespace onecad::app::history
@@ -0,0 +1,115 @@
+/**
+ * @file RegenerationCache.h
+ * @brief Per-document replay state reused by incremental regeneration.
+ *
+ * Records, for every applied operation of the last regeneration run, its
+ * outcome and the body shapes it produced. RegenerationEngine uses this to
+ * rewind only the bodies touched by a history edit and re-run only the
+ * affected operations instead of replaying the whole history.
+ */
+#ifndef ONECAD_APP_HISTORY_REGENERATIONCACHE_H
+#define ONECAD_APP_HISTORY_REGENERATIONCACHE_H
+
+#include <TopoDS_Shape.hxx>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace onecad::app::history {
+
+/**
+ * @brief Outcome of an operation in the last regeneration run.
+ */
+enum class CachedOpOutcome {
+    Succeeded,
+    Failed,          // Executor reported an error
+    UpstreamFailed,  // Skipped because an upstream op failed
+    Suppressed,      // Skipped because the op is suppressed
+    Missing          // Skipped because the record was not found
+};
+
+/**
+ * @brief A face or edge an operation referenced, as resolved before it last ran.
+ */
+struct CachedElementInput {
+    std::string elementId;
+    std::string producerOpId;  // Op that generated or last modified it; empty for base geometry
+    TopoDS_Shape shape;        // Null if the reference did not resolve
+};
+
+/**
+ * @brief Cached replay state of a single operation.
+ */
+struct CachedOpState {
+    CachedOpOutcome outcome = CachedOpOutcome::Missing;
+    std::string errorMessage;
+    std::vector<std::string> outputBodyIds;                       // Bodies the op writes
+    std::unordered_map<std::string, TopoDS_Shape> outputShapes;   // Post-op shapes (Succeeded only)
+    std::uint64_t sketchFingerprint = 0;                          // Hash of input sketch content
+    std::vector<CachedElementInput> elementInputs;                // Referenced faces/edges (executed ops)
+};
+
+/**
+ * @brief Replay state of the last regeneration run of a document.
+ *
+ * Owned by Document so it outlives the short-lived RegenerationEngine
+ * instances created by commands. Shapes are stored as TopoDS handles, so
+ * keeping them costs references, not geometry copies.
+ */
+class RegenerationCache {
+public:
+    RegenerationCache() = default;
+
+    /**
+     * @brief Drop all cached state (next regeneration will be a full replay).
+     */
+    void clear();
+
+    /**
+     * @brief True once a full run has been recorded.
+     */
+    bool isPrimed() const { return primed_; }
+    void setPrimed(bool primed) { primed_ = primed; }
+
+    /**
+     * @brief Applied operation IDs of the last run, in creation order.
+     */
+    const std::vector<std::string>& appliedOrder() const { return appliedOrder_; }
+    void setAppliedOrder(std::vector<std::string> order) { appliedOrder_ = std::move(order); }
+
+    const CachedOpState* findOperation(const std::string& opId) const;
+    void setOperationState(const std::string& opId, CachedOpState state);
+    void eraseOperation(const std::string& opId);
+
+    /**
+     * @brief Base body shapes as seen at the start of the last full run.
+     */
+    const std::unordered_map<std::string, TopoDS_Shape>& baseShapes() const { return baseShapes_; }
+    void setBaseShapes(std::unordered_map<std::string, TopoDS_Shape> shapes) {
+        baseShapes_ = std::move(shapes);
+    }
+
+    /**
+     * @brief Document body shapes at the end of the last run.
+     *
+     * Used to detect edits made outside of regeneration (which invalidate
+     * the cached replay state).
+     */
+    const std::unordered_map<std::string, TopoDS_Shape>& finalBodies() const { return finalBodies_; }
+    void setFinalBodies(std::unordered_map<std::string, TopoDS_Shape> bodies) {
+        finalBodies_ = std::move(bodies);
+    }
+
+private:
+    bool primed_ = false;
+    std::vector<std::string> appliedOrder_;
+    std::unordered_map<std::string, CachedOpState> operations_;
+    std::unordered_map<std::string, TopoDS_Shape> baseShapes_;
+    std::unordered_map<std::string, TopoDS_Shape> finalBodies_;
+};
+
+} // namespace onecad::app::history
+
+#endif // ONECAD_APP_HISTORY_REGENERATIONCACHE_H
@@ -3,6 +3,10 @@
  * @brief Implementation of RegenerationEngine.
  */
 #include "RegenerationEngine.h"
+#include "OperationCheckpointCache.h"
+#include "PrefixSnapshotCache.h"
+#include "RegenProgress.h"
+#include "RegenerationCache.h"
 
 #include "../document/Document.h"
 #include "../../core/loop/RegionUtils.h"
@@ -28,6 +32,7 @@
 #include <BRepAdaptor_Surface.hxx>
 #include <BRepGProp.hxx>
 #include <GProp_GProps.hxx>
+#include <Message_ProgressScope.hxx>
 #include <TopExp.hxx>
 #include <TopExp_Explorer.hxx>
 #include <TopoDS.hxx>
@@ -35,7 +40,11 @@
 #include <TopTools_IndexedMapOfShape.hxx>
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <cstring>
+#include <mutex>
+#include <thread>
 #include <unordered_set>
 
 namespace onecad::app::history {
@@ -47,11 +56,298 @@ constexpr double kDraftAngleEpsilon = 1e-4;
 constexpr double kSideFaceDotThreshold = 0.9;
 constexpr double kMinValue = 1e-3;
 constexpr double kMinAngleDeg = 1e-3;
+constexpr const char* kCancelledMessage = "Regeneration cancelled";
+constexpr std::uint64_t kFnvOffset = 1469598103934665603ULL;
+constexpr std::uint64_t kFnvPrime = 1099511628211ULL;
+
+const char* operationTypeName(OperationType type) {
+    switch (type) {
+    case OperationType::Extrude: return "Extrude";
+    case OperationType::Revolve: return "Revolve";
+    case OperationType::Fillet: return "Fillet";
+    case OperationType::Chamfer: return "Chamfer";
+    case OperationType::Shell: return "Shell";
+    case OperationType::Boolean: return "Boolean";
+    }
+    return "Operation";
+}
+
+std::uint64_t fnv1a(std::uint64_t hash, const std::string& text) {
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= kFnvPrime;
+    }
+    return hash;
+}
+
+std::uint64_t hashValue(std::uint64_t hash, std::uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        hash ^= (value >> (i * 8)) & 0xffu;
+        hash *= kFnvPrime;
+    }
+    return hash;
+}
+
+std::uint64_t hashDouble(std::uint64_t hash, double value) {
+    std::uint64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return hashValue(hash, bits);
+}
+
+std::uint64_t hashString(std::uint64_t hash, const std::string& text) {
+    // Length prefix keeps adjacent fields from running into each other.
+    return fnv1a(hashValue(hash, text.size()), text);
+}
+
+// TShape identity and orientation; locations are checked by IsEqual on lookup.
+std::uint64_t hashShape(std::uint64_t hash, const TopoDS_Shape& shape) {
+    if (shape.IsNull()) {
+        return hashValue(hash, 0);
+    }
+    hash = hashValue(hash, reinterpret_cast<std::uintptr_t>(shape.TShape().get()));
+    return hashValue(hash, static_cast<std::uint64_t>(shape.Orientation()));
+}
+
+std::uint64_t hashOperationDefinition(const OperationRecord& op) {
+    std::uint64_t hash = hashString(kFnvOffset, op.opId);
+    hash = hashValue(hash, static_cast<std::uint64_t>(op.type));
+
+    hash = hashValue(hash, op.input.index());
+    if (std::holds_alternative<SketchRegionRef>(op.input)) {
+        const auto& ref = std::get<SketchRegionRef>(op.input);
+        hash = hashString(hash, ref.sketchId);
+        hash = hashString(hash, ref.regionId);
+    } else if (std::holds_alternative<FaceRef>(op.input)) {
+        const auto& ref = std::get<FaceRef>(op.input);
+        hash = hashString(hash, ref.bodyId);
+        hash = hashString(hash, ref.faceId);
+    } else if (std::holds_alternative<BodyRef>(op.input)) {
+        hash = hashString(hash, std::get<BodyRef>(op.input).bodyId);
+    }
+
+    hash = hashValue(hash, op.params.index());
+    if (std::holds_alternative<ExtrudeParams>(op.params)) {
+        const auto& params = std::get<ExtrudeParams>(op.params);
+        hash = hashDouble(hash, params.distance);
+        hash = hashDouble(hash, params.draftAngleDeg);
+        hash = hashValue(hash, static_cast<std::uint64_t>(params.booleanMode));
+        hash = hashString(hash, params.targetBodyId);
+    } else if (std::holds_alternative<RevolveParams>(op.params)) {
+        const auto& params = std::get<RevolveParams>(op.params);
+        hash = hashDouble(hash, params.angleDeg);
+        hash = hashValue(hash, params.axis.index());
+        if (std::holds_alternative<SketchLineRef>(params.axis)) {
+            const auto& ref = std::get<SketchLineRef>(params.axis);
+            hash = hashString(hash, ref.sketchId);
+            hash = hashString(hash, ref.lineId);
+        } else if (std::holds_alternative<EdgeRef>(params.axis)) {
+            const auto& ref = std::get<EdgeRef>(params.axis);
+            hash = hashString(hash, ref.bodyId);
+            hash = hashString(hash, ref.edgeId);
+        }
+        hash = hashValue(hash, static_cast<std::uint64_t>(params.booleanMode));
+        hash = hashString(hash, params.targetBodyId);
+    } else if (std::holds_alternative<FilletChamferParams>(op.params)) {
+        const auto& params = std::get<FilletChamferParams>(op.params);
+        hash = hashValue(hash, static_cast<std::uint64_t>(params.mode));
+        hash = hashDouble(hash, params.radius);
+        hash = hashValue(hash, params.edgeIds.size());
+        for (const auto& edgeId : params.edgeIds) {
+            hash = hashString(hash, edgeId);
+        }
+        hash = hashValue(hash, params.chainTangentEdges ? 1 : 0);
+    } else if (std::holds_alternative<ShellParams>(op.params)) {
+        const auto& params = std::get<ShellParams>(op.params);
+        hash = hashDouble(hash, params.thickness);
+        hash = hashValue(hash, params.openFaceIds.size());
+        for (const auto& faceId : params.openFaceIds) {
+            hash = hashString(hash, faceId);
+        }
+    } else if (std::holds_alternative<BooleanParams>(op.params)) {
+        const auto& params = std::get<BooleanParams>(op.params);
+        hash = hashValue(hash, static_cast<std::uint64_t>(params.operation));
+        hash = hashString(hash, params.targetBodyId);
+        hash = hashString(hash, params.toolBodyId);
+    }
+
+    hash = hashValue(hash, op.resultBodyIds.size());
+    for (const auto& bodyId : op.resultBodyIds) {
+        hash = hashString(hash, bodyId);
+    }
+    return hash;
+}
+
+std::uint64_t hashElementEntry(std::uint64_t hash, const kernel::elementmap::Entry& entry) {
+    hash = hashString(hash, entry.id.value);
+    hash = hashValue(hash, static_cast<std::uint64_t>(entry.kind));
+    hash = hashString(hash, entry.opId);
+    hash = hashValue(hash, entry.sources.size());
+    for (const auto& source : entry.sources) {
+        hash = hashString(hash, source.value);
+    }
+    const auto& d = entry.descriptor;
+    hash = hashValue(hash, static_cast<std::uint64_t>(d.shapeType));
+    hash = hashDouble(hash, d.center.X());
+    hash = hashDouble(hash, d.center.Y());
+    hash = hashDouble(hash, d.center.Z());
+    hash = hashDouble(hash, d.size);
+    hash = hashDouble(hash, d.magnitude);
+    hash = hashValue(hash, static_cast<std::uint64_t>(d.surfaceType));
+    hash = hashValue(hash, static_cast<std::uint64_t>(d.curveType));
+    hash = hashDouble(hash, d.normal.X());
+    hash = hashDouble(hash, d.normal.Y());
+    hash = hashDouble(hash, d.normal.Z());
+    hash = hashDouble(hash, d.tangent.X());
+    hash = hashDouble(hash, d.tangent.Y());
+    hash = hashDouble(hash, d.tangent.Z());
+    hash = hashValue(hash, (d.hasNormal ? 1u : 0u) | (d.hasTangent ? 2u : 0u));
+    return hashValue(hash, d.adjacencyHash);
+}
+
+struct BodySignature {
+    int faces = 0;
+    int edges = 0;
+    int vertices = 0;
+    double volume = 0.0;
+};
+
+std::unordered_map<std::string, BodySignature> captureBodySignatures(const Document& doc) {
+    std::unordered_map<std::string, BodySignature> signatures;
+    for (const auto& bodyId : doc.getBodyIds()) {
+        const TopoDS_Shape* shape = doc.getBodyShape(bodyId);
+        if (!shape || shape->IsNull()) {
+            continue;
+        }
+        BodySignature signature;
+        TopTools_IndexedMapOfShape faces;
+        TopTools_IndexedMapOfShape edges;
+        TopTools_IndexedMapOfShape vertices;
+        TopExp::MapShapes(*shape, TopAbs_FACE, faces);
+        TopExp::MapShapes(*shape, TopAbs_EDGE, edges);
+        TopExp::MapShapes(*shape, TopAbs_VERTEX, vertices);
+        signature.faces = faces.Extent();
+        signature.edges = edges.Extent();
+        signature.vertices = vertices.Extent();
+        GProp_GProps props;
+        BRepGProp::VolumeProperties(*shape, props);
+        signature.volume = props.Mass();
+        signatures[bodyId] = signature;
+    }
+    return signatures;
+}
+
+bool bodySignaturesMatch(const std::unordered_map<std::string, BodySignature>& lhs,
+                         const std::unordered_map<std::string, BodySignature>& rhs,
+                         std::string& mismatchOut) {
+    if (lhs.size() != rhs.size()) {
+        mismatchOut = "body count " + std::to_string(lhs.size()) + " vs " + std::to_string(rhs.size());
+        return false;
+    }
+    for (const auto& [bodyId, a] : lhs) {
+        auto it = rhs.find(bodyId);
+        if (it == rhs.end()) {
+            mismatchOut = "body missing from full replay: " + bodyId;
+            return false;
+        }
+        const BodySignature& b = it->second;
+        const double volumeTol = 1e-6 * std::max(1.0, std::abs(b.volume));
+        if (a.faces != b.faces || a.edges != b.edges || a.vertices != b.vertices ||
+            std::abs(a.volume - b.volume) > volumeTol) {
+            mismatchOut = "body geometry differs: " + bodyId;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool regenResultsMatch(const RegenResult& lhs, const RegenResult& rhs, std::string& mismatchOut) {
+    if (lhs.status != rhs.status) {
+        mismatchOut = "status differs";
+        return false;
+    }
+    if (lhs.succeededOps != rhs.succeededOps) {
+        mismatchOut = "succeeded ops differ";
+        return false;
+    }
+    if (lhs.skippedOps != rhs.skippedOps) {
+        mismatchOut = "skipped ops differ";
+        return false;
+    }
+    if (lhs.failedOps.size() != rhs.failedOps.size()) {
+        mismatchOut = "failed op count differs";
+        return false;
+    }
+    for (std::size_t i = 0; i < lhs.failedOps.size(); ++i) {
+        const auto& a = lhs.failedOps[i];
+        const auto& b = rhs.failedOps[i];
+        auto downstreamA = a.affectedDownstream;
+        auto downstreamB = b.affectedDownstream;
+        std::sort(downstreamA.begin(), downstreamA.end());
+        std::sort(downstreamB.begin(), downstreamB.end());
+        if (a.opId != b.opId || a.type != b.type || a.errorMessage != b.errorMessage ||
+            downstreamA != downstreamB) {
+            mismatchOut = "failed op differs: " + a.opId;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Whether two element lists name the same shapes under the same ids and ops.
+bool sameElements(const std::vector<kernel::elementmap::Entry>& lhs,
+                  const std::vector<kernel::elementmap::Entry>& rhs) {
+    if (lhs.size() != rhs.size()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < lhs.size(); ++i) {
+        if (lhs[i].id.value != rhs[i].id.value || lhs[i].opId != rhs[i].opId ||
+            !lhs[i].shape.IsEqual(rhs[i].shape)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Bodies whose elements an op references through face/edge ids.
+std::vector<std::string> referencedBodyIds(const OperationRecord& op) {
+    std::vector<std::string> bodyIds;
+    auto addElementBody = [&](const std::string& elementId) {
+        bodyIds.push_back(elementId.substr(0, elementId.find('/')));
+    };
+    if (std::holds_alternative<FaceRef>(op.input)) {
+        bodyIds.push_back(std::get<FaceRef>(op.input).bodyId);
+    }
+    if (std::holds_alternative<RevolveParams>(op.params)) {
+        const auto& axis = std::get<RevolveParams>(op.params).axis;
+        if (std::holds_alternative<EdgeRef>(axis)) {
+            bodyIds.push_back(std::get<EdgeRef>(axis).bodyId);
+        }
+    } else if (std::holds_alternative<FilletChamferParams>(op.params)) {
+        for (const auto& edgeId : std::get<FilletChamferParams>(op.params).edgeIds) {
+            addElementBody(edgeId);
+        }
+    } else if (std::holds_alternative<ShellParams>(op.params)) {
+        for (const auto& faceId : std::get<ShellParams>(op.params).openFaceIds) {
+            addElementBody(faceId);
+        }
+    }
+    return bodyIds;
+}
 } // namespace
 
 RegenerationEngine::RegenerationEngine(Document* doc)
     : doc_(doc), graph_() {
-    qCDebug(logRegen) << "RegenerationEngine:ctor" << "hasDocument=" << (doc_ != nullptr);
+    const int envThreads = qEnvironmentVariableIntValue("ONECAD_REGEN_THREADS");
+    if (envThreads > 0) {
+        maxParallelOps_ = static_cast<std::size_t>(envThreads);
+    } else {
+        maxParallelOps_ = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (qEnvironmentVariableIsSet("ONECAD_REGEN_ELEMENT_DEPS")) {
+        elementLevelInvalidation_ = qEnvironmentVariableIntValue("ONECAD_REGEN_ELEMENT_DEPS") != 0;
+    }
+    qCDebug(logRegen) << "RegenerationEngine:ctor" << "hasDocument=" << (doc_ != nullptr)
+                      << "maxParallelOps=" << maxParallelOps_;
     if (doc_) {
         graph_.rebuildFromOperations(doc_->operations());
         for (const auto& op : doc_->operations()) {
@@ -60,171 +356,1244 @@ RegenerationEngine::RegenerationEngine(Document* doc)
             }
         }
     }
-}
+}
+
+RegenResult RegenerationEngine::regenerateAll() {
+    if (!doc_) {
+        RegenResult result;
+        result.status = RegenStatus::CriticalFailure;
+        return result;
+    }
+    return regenerateToAppliedCount(doc_->operations().size());
+}
+
+RegenResult RegenerationEngine::regenerateToAppliedCount(std::size_t appliedCount) {
+    RegenResult result;
+    qCInfo(logRegen) << "regenerateAll:start";
+    lastRunIncremental_ = false;
+    lastReplayedOpCount_ = 0;
+    lastRestoredOpCount_ = 0;
+    lastAvoidedOpCount_ = 0;
+
+    if (!doc_) {
+        qCCritical(logRegen) << "regenerateAll:no-document";
+        result.status = RegenStatus::CriticalFailure;
+        return result;
+    }
+
+    // A cancellable run must be able to put everything back.
+    std::optional<RunRestorePoint> restorePoint;
+    if (cancelToken_) {
+        restorePoint = captureRestorePoint();
+    }
+
+    const auto& operations = doc_->operations();
+    const std::size_t boundedAppliedCount = std::min(appliedCount, operations.size());
+    std::vector<OperationRecord> appliedOps;
+    appliedOps.reserve(boundedAppliedCount);
+    for (std::size_t i = 0; i < boundedAppliedCount; ++i) {
+        appliedOps.push_back(operations[i]);
+    }
+
+    // Rebuild dependency graph from current operations
+    graph_.rebuildFromOperations(appliedOps);
+    for (const auto& op : appliedOps) {
+        if (doc_->isOperationSuppressed(op.opId)) {
+            graph_.setSuppressed(op.opId, true);
+        }
+    }
+    graph_.clearFailures();
+    doc_->clearOperationFailures();
+
+    auto& cache = doc_->regenerationCache();
+    cache.clear();
+
+    // Get topological sort order
+    std::vector<std::string> order = graph_.topologicalSort();
+    if (order.empty() && graph_.size() > 0) {
+        // Cycle detected
+        qCCritical(logRegen) << "regenerateAll:dependency-cycle-detected"
+                             << "graphSize=" << graph_.size();
+        result.status = RegenStatus::CriticalFailure;
+        return result;
+    }
+
+    // Base bodies are replay inputs; remember them for incremental rewinds.
+    std::unordered_map<std::string, TopoDS_Shape> baseShapes;
+    for (const auto& bodyId : doc_->baseBodyIds()) {
+        const TopoDS_Shape* shape = doc_->getBodyShape(bodyId);
+        baseShapes[bodyId] = shape ? *shape : TopoDS_Shape();
+    }
+    cache.setBaseShapes(std::move(baseShapes));
+
+    // Resume from the nearest snapshot of an unchanged prefix, if any.
+    sketchHashes_.clear();
+    auto& snapshots = doc_->prefixSnapshots();
+    const std::vector<std::uint64_t> signatures = prefixSignatures(order);
+    std::size_t startIndex = 0;
+    if (const PrefixSnapshot* snapshot = snapshots.findLatest(signatures)) {
+        restorePrefixSnapshot(*snapshot);
+        startIndex = snapshot->opCount;
+        qCDebug(logRegen) << "regenerateAll:restored-prefix-snapshot"
+                          << "opCount=" << startIndex
+                          << "remaining=" << (order.size() - startIndex);
+    }
+
+    // Execute operations segment by segment; snapshot grid positions are
+    // scheduling barriers so the state at each of them is materialized.
+    beginProfiling();
+    beginProgress(order.size() - startIndex);
+    const std::size_t interval = snapshots.interval();
+    std::size_t segmentStart = startIndex;
+    while (segmentStart < order.size()) {
+        std::size_t segmentEnd = order.size();
+        if (interval > 0) {
+            segmentEnd = std::min(order.size(), (segmentStart / interval + 1) * interval);
+        }
+        const std::vector<std::string> segment(order.begin() + static_cast<std::ptrdiff_t>(segmentStart),
+                                               order.begin() + static_cast<std::ptrdiff_t>(segmentEnd));
+        if (!runScheduledOperations(segment)) {
+            return cancelRun(*restorePoint);
+        }
+        if (segmentEnd < order.size() && snapshots.isGridPosition(segmentEnd)) {
+            capturePrefixSnapshot(order, segmentEnd, signatures[segmentEnd]);
+        }
+        segmentStart = segmentEnd;
+    }
+    endProgress();
+    if (startIndex < order.size()) {
+        capturePrefixSnapshot(order, order.size(), signatures[order.size()]);
+    }
+
+    // Report outcomes in replay order, whichever way each op was scheduled.
+    for (const auto& opId : order) {
+        appendCachedOutcome(opId, result);
+    }
+
+    lastRestoredOpCount_ = startIndex;
+    lastReplayedOpCount_ = order.size() - startIndex;
+    finishRun(appliedOps, result);
+
+    qCInfo(logRegen) << "regenerateAll:done"
+                     << "status=" << static_cast<int>(result.status)
+                     << "succeeded=" << result.succeededOps.size()
+                     << "failed=" << result.failedOps.size()
+                     << "skipped=" << result.skippedOps.size()
+                     << "restored=" << lastRestoredOpCount_;
+
+    return result;
+}
+
+RegenResult RegenerationEngine::regenerateIncremental(std::size_t appliedCount,
+                                                      const std::vector<std::string>& dirtyOpIds) {
+    return regenerateIncrementalPass(appliedCount, dirtyOpIds, elementLevelInvalidation_, std::nullopt);
+}
+
+RegenResult RegenerationEngine::regenerateIncrementalPass(std::size_t appliedCount,
+                                                          const std::vector<std::string>& dirtyOpIds,
+                                                          bool elementLevel,
+                                                          std::optional<RunRestorePoint> restorePoint) {
+    lastVerification_ = IncrementalVerification{};
+
+    if (!doc_) {
+        RegenResult result;
+        result.status = RegenStatus::CriticalFailure;
+        return result;
+    }
+
+    const auto& operations = doc_->operations();
+    const std::size_t boundedAppliedCount = std::min(appliedCount, operations.size());
+    std::vector<OperationRecord> appliedOps(operations.begin(),
+                                            operations.begin() + static_cast<std::ptrdiff_t>(boundedAppliedCount));
+
+    std::unordered_set<std::string> dirty(dirtyOpIds.begin(), dirtyOpIds.end());
+    std::string fallbackReason;
+    if (!canRegenerateIncrementally(appliedOps, dirty, fallbackReason)) {
+        qCInfo(logRegen) << "regenerateIncremental:fallback-full-replay"
+                         << "reason=" << QString::fromStdString(fallbackReason);
+        return regenerateToAppliedCount(appliedCount);
+    }
+
+    qCInfo(logRegen) << "regenerateIncremental:start"
+                     << "applied=" << appliedOps.size()
+                     << "dirty=" << dirty.size()
+                     << "elementLevel=" << elementLevel;
+
+    if (cancelToken_ && !restorePoint) {
+        restorePoint = captureRestorePoint();
+    }
+
+    graph_.rebuildFromOperations(appliedOps);
+    for (const auto& op : appliedOps) {
+        if (doc_->isOperationSuppressed(op.opId)) {
+            graph_.setSuppressed(op.opId, true);
+        }
+    }
+    graph_.clearFailures();
+
+    auto& cache = doc_->regenerationCache();
+    std::vector<std::string> order = graph_.topologicalSort();
+    if (order.empty() && graph_.size() > 0) {
+        qCCritical(logRegen) << "regenerateIncremental:dependency-cycle-detected"
+                             << "graphSize=" << graph_.size();
+        cache.clear();
+        RegenResult result;
+        result.status = RegenStatus::CriticalFailure;
+        return result;
+    }
+
+    // Sketch edits are not reported by history commands; pick them up here.
+    sketchHashes_.clear();
+    for (const auto& op : appliedOps) {
+        const CachedOpState* state = cache.findOperation(op.opId);
+        if (state && state->sketchFingerprint != sketchFingerprint(op.opId)) {
+            dirty.insert(op.opId);
+        }
+    }
+
+    std::unordered_map<std::string, std::size_t> position;
+    position.reserve(appliedOps.size());
+    for (std::size_t i = 0; i < appliedOps.size(); ++i) {
+        position[appliedOps[i].opId] = i;
+    }
+
+    // Ops that left the applied prefix still wrote bodies in the last run;
+    // those bodies replay from the first surviving op created after them.
+    std::vector<std::pair<std::string, std::size_t>> removedBodies;
+    const auto& previousOrder = cache.appliedOrder();
+    for (std::size_t i = 0; i < previousOrder.size(); ++i) {
+        const std::string& previousId = previousOrder[i];
+        if (dirty.count(previousId) == 0 || position.count(previousId) > 0) {
+            continue;
+        }
+        const CachedOpState* state = cache.findOperation(previousId);
+        if (!state) {
+            continue;
+        }
+        std::size_t fromPos = appliedOps.size();
+        for (std::size_t j = i + 1; j < previousOrder.size(); ++j) {
+            auto posIt = position.find(previousOrder[j]);
+            if (posIt != position.end()) {
+                fromPos = posIt->second;
+                break;
+            }
+        }
+        for (const auto& bodyId : state->outputBodyIds) {
+            removedBodies.emplace_back(bodyId, fromPos);
+        }
+    }
+
+    std::vector<std::vector<std::string>> touched(appliedOps.size());
+    for (std::size_t i = 0; i < appliedOps.size(); ++i) {
+        touched[i] = touchedBodyIds(appliedOps[i]);
+    }
+    // Bodies an op only reads through faces/edges whose producers are known
+    std::vector<std::vector<std::string>> elementOnly(appliedOps.size());
+
+    struct AffectedSet {
+        std::unordered_set<std::string> ops;
+        std::unordered_map<std::string, std::size_t> bodyReplayFrom;  // bodyId -> first replayed position
+    };
+
+    // Close over graph downstream and over later ops touching a replayed body.
+    // At element level a replay of a body does not pull in later ops that
+    // only reach it through faces/edges; those are probed during the run.
+    auto closeOver = [&](bool elementLevel) {
+        AffectedSet set;
+        std::vector<std::string> pending;
+        auto markBody = [&](const std::string& bodyId, std::size_t fromPos) {
+            auto [it, inserted] = set.bodyReplayFrom.emplace(bodyId, fromPos);
+            if (!inserted && fromPos < it->second) {
+                it->second = fromPos;
+            }
+        };
+        auto markOp = [&](const std::string& opId) {
+            if (position.count(opId) > 0 && set.ops.insert(opId).second) {
+                pending.push_back(opId);
+            }
+        };
+
+        for (const auto& [bodyId, fromPos] : removedBodies) {
+            markBody(bodyId, fromPos);
+        }
+        for (const auto& opId : dirty) {
+            markOp(opId);
+        }
+
+        bool changed = true;
+        while (changed) {
+            while (!pending.empty()) {
+                const std::string opId = pending.back();
+                pending.pop_back();
+                for (const auto& downstreamId : graph_.getDownstream(opId)) {
+                    markOp(downstreamId);
+                }
+                const std::size_t pos = position[opId];
+                for (const auto& bodyId : touched[pos]) {
+                    markBody(bodyId, pos);
+                }
+            }
+
+            changed = false;
+            for (std::size_t i = 0; i < appliedOps.size(); ++i) {
+                if (set.ops.count(appliedOps[i].opId) > 0) {
+                    continue;
+                }
+                for (const auto& bodyId : touched[i]) {
+                    if (elementLevel && std::find(elementOnly[i].begin(), elementOnly[i].end(), bodyId) !=
+                                            elementOnly[i].end()) {
+                        continue;
+                    }
+                    auto it = set.bodyReplayFrom.find(bodyId);
+                    if (it != set.bodyReplayFrom.end() && i >= it->second) {
+                        markOp(appliedOps[i].opId);
+                        changed = true;
+                        break;
+                    }
+                }
+            }
+        }
+        return set;
+    };
+
+    AffectedSet closure = closeOver(false);
+    const std::size_t bodyLevelCount = closure.ops.size();
+
+    // Refine with the element producers recorded by the last run.
+    std::unordered_set<std::string> probes;
+    if (elementLevel) {
+        std::unordered_map<std::string, std::vector<std::string>> producers;
+        for (const auto& op : appliedOps) {
+            const CachedOpState* state = cache.findOperation(op.opId);
+            if (!state || state->elementInputs.empty()) {
+                continue;
+            }
+            auto& opProducers = producers[op.opId];
+            for (const auto& input : state->elementInputs) {
+                opProducers.push_back(input.producerOpId);
+            }
+        }
+        graph_.setElementProducers(producers);
+
+        bool refined = false;
+        for (std::size_t i = 0; i < appliedOps.size(); ++i) {
+            const FeatureNode* node = graph_.getNode(appliedOps[i].opId);
+            if (node && node->elementProducersKnown) {
+                elementOnly[i].assign(node->elementBodyIds.begin(), node->elementBodyIds.end());
+                refined = true;
+            }
+        }
+        if (refined) {
+            AffectedSet elementClosure = closeOver(true);
+            for (std::size_t i = 0; i < appliedOps.size(); ++i) {
+                const std::string& opId = appliedOps[i].opId;
+                if (!elementOnly[i].empty() && closure.ops.count(opId) > 0 &&
+                    elementClosure.ops.count(opId) == 0) {
+                    probes.insert(opId);
+                }
+            }
+            closure = std::move(elementClosure);
+        }
+    }
+    const std::unordered_set<std::string>& affected = closure.ops;
+    auto& bodyReplayFrom = closure.bodyReplayFrom;
+
+    // Rewind replayed bodies to the state left by their last unaffected producer.
+    std::vector<std::string> rewindBodies;
+    rewindBodies.reserve(bodyReplayFrom.size());
+    for (const auto& [bodyId, fromPos] : bodyReplayFrom) {
+        (void)fromPos;
+        rewindBodies.push_back(bodyId);
+    }
+    std::sort(rewindBodies.begin(), rewindBodies.end());
+
+    std::size_t rewound = 0;
+    for (const auto& bodyId : rewindBodies) {
+        const std::size_t fromPos = std::min(bodyReplayFrom[bodyId], appliedOps.size());
+        const TopoDS_Shape* restored = nullptr;
+        std::string producerOpId;
+        for (std::size_t i = fromPos; i-- > 0;) {
+            const CachedOpState* state = cache.findOperation(appliedOps[i].opId);
+            if (!state || state->outcome != CachedOpOutcome::Succeeded) {
+                continue;
+            }
+            auto shapeIt = state->outputShapes.find(bodyId);
+            if (shapeIt != state->outputShapes.end()) {
+                restored = &shapeIt->second;
+                producerOpId = appliedOps[i].opId;
+                break;
+            }
+        }
+        if (!restored) {
+            auto baseIt = cache.baseShapes().find(bodyId);
+            if (baseIt != cache.baseShapes().end() && !baseIt->second.IsNull()) {
+                restored = &baseIt->second;
+            }
+        }
+        if (!restored) {
+            // A full replay also starts from the current body in this case.
+            continue;
+        }
+        const TopoDS_Shape* currentShape = doc_->getBodyShape(bodyId);
+        if (currentShape && currentShape->IsEqual(*restored)) {
+            continue;
+        }
+        applyBodyResult(bodyId, *restored, producerOpId);
+        ++rewound;
+    }
+
+    // Failure state of unaffected ops carries over from the last run.
+    for (const auto& op : appliedOps) {
+        if (affected.count(op.opId) > 0) {
+            doc_->clearOperationFailed(op.opId);
+        } else if (doc_->isOperationFailed(op.opId)) {
+            graph_.setFailed(op.opId, true, doc_->operationFailureReason(op.opId));
+        }
+    }
+    std::vector<std::string> staleFailures;
+    for (const auto& [opId, reason] : doc_->operationFailures()) {
+        (void)reason;
+        if (position.count(opId) == 0) {
+            staleFailures.push_back(opId);
+        }
+    }
+    for (const auto& opId : staleFailures) {
+        doc_->clearOperationFailed(opId);
+    }
+
+    std::vector<std::string> affectedOrder;
+    affectedOrder.reserve(affected.size() + probes.size());
+    for (const auto& opId : order) {
+        if (affected.count(opId) > 0 || probes.count(opId) > 0) {
+            affectedOrder.push_back(opId);
+        }
+    }
+    const std::size_t probeCount = probes.size();
+    elementProbeOps_ = std::move(probes);
+    staleElementProbes_.clear();
+    beginProfiling();
+    beginProgress(affectedOrder.size());
+    const bool completed = runScheduledOperations(affectedOrder);
+    elementProbeOps_.clear();
+    if (!completed) {
+        return cancelRun(*restorePoint);
+    }
+    endProgress();
+
+    RegenResult result;
+    for (const auto& opId : order) {
+        appendCachedOutcome(opId, result);
+    }
+
+    if (!staleElementProbes_.empty()) {
+        // A replayed op changed faces or edges a skipped op reads after all.
+        // Redo the edit at body level; the ops replayed above hit their checkpoints.
+        finishRun(appliedOps, result);
+        std::vector<std::string> redo(dirty.begin(), dirty.end());
+        redo.insert(redo.end(), staleElementProbes_.begin(), staleElementProbes_.end());
+        qCInfo(logRegen) << "regenerateIncremental:element-inputs-changed"
+                         << "ops=" << staleElementProbes_.size();
+        staleElementProbes_.clear();
+        return regenerateIncrementalPass(appliedCount, redo, false, std::move(restorePoint));
+    }
+
+    // The end state doubles as a rollback snapshot (e.g. to undo a rollback).
+    if (!order.empty()) {
+        const std::vector<std::uint64_t> signatures = prefixSignatures(order);
+        capturePrefixSnapshot(order, order.size(), signatures.back());
+    }
+
+    finishRun(appliedOps, result);
+
+    qCInfo(logRegen) << "regenerateIncremental:done"
+                     << "status=" << static_cast<int>(result.status)
+                     << "replayed=" << affected.size()
+                     << "reused=" << (order.size() - affected.size())
+                     << "avoided=" << (bodyLevelCount - affected.size())
+                     << "probed=" << probeCount
+                     << "rewoundBodies=" << rewound;
+
+    if (verifyIncremental_) {
+        verifyAgainstFullReplay(appliedCount, result);
+    }
+
+    lastRunIncremental_ = true;
+    lastReplayedOpCount_ = affected.size();
+    lastRestoredOpCount_ = 0;
+    lastAvoidedOpCount_ = bodyLevelCount - affected.size();
+    return result;
+}
+
+const OperationRecord* RegenerationEngine::beginScheduledOperation(const std::string& opId,
+                                                                  CachedOpState& state) {
+    auto& cache = doc_->regenerationCache();
+
+    // Skipped on element-level evidence: its cached result stands if the
+    // faces and edges it reads still resolve to the shapes it last read.
+    if (elementProbeOps_.count(opId) > 0) {
+        if (elementInputsUnchanged(opId)) {
+            qCDebug(logRegen) << "regenerateIncremental:probe-unchanged"
+                              << QString::fromStdString(opId);
+        } else {
+            qCDebug(logRegen) << "regenerateIncremental:probe-changed"
+                              << QString::fromStdString(opId);
+            staleElementProbes_.push_back(opId);
+        }
+        return nullptr;
+    }
+
+    state.sketchFingerprint = sketchFingerprint(opId);
+
+    // Skip suppressed operations
+    if (graph_.isSuppressed(opId)) {
+        qCDebug(logRegen) << "regenerateAll:skip-suppressed"
+                          << QString::fromStdString(opId);
+        doc_->clearOperationFailed(opId);
+        if (const OperationRecord* opRecord = doc_->findOperation(opId)) {
+            state.outputBodyIds = opRecord->resultBodyIds;
+        }
+        state.outcome = CachedOpOutcome::Suppressed;
+        cache.setOperationState(opId, std::move(state));
+        return nullptr;
+    }
+
+    // Find the operation record
+    const OperationRecord* opRecord = doc_->findOperation(opId);
+
+    if (!opRecord) {
+        qCWarning(logRegen) << "regenerateAll:missing-operation-record"
+                            << QString::fromStdString(opId);
+        state.outcome = CachedOpOutcome::Missing;
+        cache.setOperationState(opId, std::move(state));
+        return nullptr;
+    }
+    state.outputBodyIds = opRecord->resultBodyIds;
+
+    // Check if any upstream dependency failed
+    if (graph_.hasFailedUpstream(opId)) {
+        qCWarning(logRegen) << "regenerateAll:skip-upstream-failed"
+                            << QString::fromStdString(opId);
+        graph_.setFailed(opId, true, "Upstream operation failed");
+        doc_->setOperationFailed(opId, "Upstream operation failed");
+        state.outcome = CachedOpOutcome::UpstreamFailed;
+        state.errorMessage = "Upstream operation failed";
+        cache.setOperationState(opId, std::move(state));
+        return nullptr;
+    }
+
+    state.elementInputs = captureElementInputs(opId);
+    return opRecord;
+}
+
+void RegenerationEngine::finishScheduledOperation(const OperationRecord& op, bool success,
+                                                  const std::string& errorMsg, CachedOpState state) {
+    const std::string& opId = op.opId;
+    if (success) {
+        qCDebug(logRegen) << "regenerateAll:operation-succeeded"
+                          << QString::fromStdString(opId);
+        doc_->clearOperationFailed(opId);
+        state.outcome = CachedOpOutcome::Succeeded;
+        for (const auto& bodyId : op.resultBodyIds) {
+            if (const TopoDS_Shape* shape = doc_->getBodyShape(bodyId)) {
+                state.outputShapes[bodyId] = *shape;
+            }
+        }
+    } else {
+        qCWarning(logRegen) << "regenerateAll:operation-failed"
+                            << "opId=" << QString::fromStdString(opId)
+                            << "error=" << QString::fromStdString(errorMsg);
+        graph_.setFailed(opId, true, errorMsg);
+        doc_->setOperationFailed(opId, errorMsg);
+        state.outcome = CachedOpOutcome::Failed;
+        state.errorMessage = errorMsg;
+    }
+    doc_->regenerationCache().setOperationState(opId, std::move(state));
+}
+
+bool RegenerationEngine::runScheduledOperation(const std::string& opId) {
+    if (isCancelled()) {
+        return false;
+    }
+    const Message_ProgressRange range = nextOpRange(opId);
+    CachedOpState state;
+    const OperationRecord* opRecord = beginScheduledOperation(opId, state);
+    if (!opRecord) {
+        return true;
+    }
+
+    std::string errorMsg;
+    const bool success = executeOperation(*opRecord, range, errorMsg);
+    if (isCancelled()) {
+        return false;  // The run is rolled back; do not record a partial result
+    }
+    finishScheduledOperation(*opRecord, success, errorMsg, std::move(state));
+    return true;
+}
+
+bool RegenerationEngine::runScheduledOperations(const std::vector<std::string>& opIds) {
+    if (maxParallelOps_ <= 1 || opIds.size() < 2) {
+        for (const auto& opId : opIds) {
+            if (!runScheduledOperation(opId)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    for (const auto& level : planParallelLevels(opIds)) {
+        if (isCancelled()) {
+            return false;
+        }
+
+        // Checks, checkpoint lookups and all document access stay on this thread.
+        std::vector<PreparedOperation> prepared;
+        std::vector<CachedOpState> states;
+        prepared.reserve(level.size());
+        states.reserve(level.size());
+        for (const auto& opId : level) {
+            Message_ProgressRange range = nextOpRange(opId);
+            CachedOpState state;
+            const OperationRecord* opRecord = beginScheduledOperation(opId, state);
+            if (!opRecord) {
+                continue;
+            }
+            prepared.push_back(prepareOperation(*opRecord));
+            prepared.back().range = std::move(range);
+            states.push_back(std::move(state));
+        }
+
+        std::vector<std::size_t> pending;
+        for (std::size_t i = 0; i < prepared.size(); ++i) {
+            if (!prepared[i].checkpoint) {
+                pending.push_back(i);
+            }
+        }
+        buildConcurrently(prepared, pending);
+        if (isCancelled()) {
+            return false;
+        }
+
+        // Apply in replay order so ElementMap updates match a serial run.
+        for (std::size_t i = 0; i < prepared.size(); ++i) {
+            std::string errorMsg;
+            const bool success = applyPreparedOperation(prepared[i], errorMsg);
+            finishScheduledOperation(*prepared[i].op, success, errorMsg, std::move(states[i]));
+        }
+    }
+    return true;
+}
+
+std::vector<std::vector<std::string>> RegenerationEngine::planParallelLevels(
+    const std::vector<std::string>& opIds) const {
+    // An op runs one level after the latest earlier op sharing a body with it.
+    // Graph edges are body producer/consumer links, so this also orders every
+    // dependency, and each body sees its ops in the original order.
+    std::vector<std::vector<std::string>> levels;
+    std::unordered_map<std::string, std::size_t> bodyLevel;
+    for (const auto& opId : opIds) {
+        std::vector<std::string> bodies;
+        if (const OperationRecord* op = doc_->findOperation(opId)) {
+            bodies = touchedBodyIds(*op);
+            for (auto& bodyId : referencedBodyIds(*op)) {
+                bodies.push_back(std::move(bodyId));
+            }
+        }
+
+        std::size_t level = 0;
+        for (const auto& bodyId : bodies) {
+            auto it = bodyLevel.find(bodyId);
+            if (it != bodyLevel.end()) {
+                level = std::max(level, it->second + 1);
+            }
+        }
+        for (const auto& bodyId : bodies) {
+            bodyLevel[bodyId] = level;
+        }
+        if (levels.size() <= level) {
+            levels.resize(level + 1);
+        }
+        levels[level].push_back(opId);
+    }
+    return levels;
+}
+
+void RegenerationEngine::buildConcurrently(std::vector<PreparedOperation>& prepared,
+                                           const std::vector<std::size_t>& pending) {
+    auto build = [&](PreparedOperation& item, int thread) {
+        try {
+            buildPrepared(item, item.range, thread);
+        } catch (...) {
+            item.shape.Nullify();
+            item.error = "Operation failed with an unexpected exception";
+        }
+    };
+
+    const std::size_t workerCount = std::min(maxParallelOps_, pending.size());
+    if (workerCount <= 1) {
+        for (std::size_t index : pending) {
+            build(prepared[index], 0);
+        }
+        return;
+    }
+
+    qCDebug(logRegen) << "buildConcurrently:start"
+                      << "ops=" << pending.size()
+                      << "workers=" << workerCount;
+    std::atomic<std::size_t> next{0};
+    auto worker = [&](int thread) {
+        for (std::size_t k = next.fetch_add(1); k < pending.size(); k = next.fetch_add(1)) {
+            build(prepared[pending[k]], thread);
+        }
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(workerCount - 1);
+    for (std::size_t t = 1; t < workerCount; ++t) {
+        threads.emplace_back(worker, static_cast<int>(t));
+    }
+    worker(0);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+bool RegenerationEngine::isCancelled() const {
+    return cancelToken_ && cancelToken_->isCancelled();
+}
+
+void RegenerationEngine::beginProfiling() {
+    profiling_ = doc_->regenProfile().isEnabled();
+    if (profiling_) {
+        doc_->regenProfile().beginRun();
+    }
+}
+
+void RegenerationEngine::beginProgress(std::size_t opCount) {
+    endProgress();
+    if (!cancelToken_ && !progressCallback_) {
+        return;  // Nobody listens; OCCT runs without a progress indicator
+    }
+
+    progress_ = new RegenProgressIndicator(
+        cancelToken_,
+        [callback = progressCallback_](int permille, const std::string& opId) {
+            if (callback) {
+                callback(permille, RegenProgressIndicator::kScale, opId);
+            }
+        });
+    progressScope_ = std::make_unique<Message_ProgressScope>(
+        progress_->Start(), "Regenerate", static_cast<Standard_Real>(std::max<std::size_t>(opCount, 1)));
+}
+
+void RegenerationEngine::endProgress() {
+    progressScope_.reset();
+    progress_.Nullify();
+}
+
+Message_ProgressRange RegenerationEngine::nextOpRange(const std::string& opId) {
+    if (!progressScope_) {
+        return Message_ProgressRange();
+    }
+    progress_->setCurrentOp(opId);
+    return progressScope_->Next();
+}
+
+RegenerationEngine::RunRestorePoint RegenerationEngine::captureRestorePoint() const {
+    RunRestorePoint point;
+    for (const auto& bodyId : doc_->getBodyIds()) {
+        const TopoDS_Shape* shape = doc_->getBodyShape(bodyId);
+        point.bodies[bodyId] = shape ? *shape : TopoDS_Shape();
+        point.bodyElements[bodyId] = doc_->elementMap().bodyEntries(bodyId);
+    }
+    point.failures = doc_->operationFailures();
+    point.cache = doc_->regenerationCache();
+    point.modified = doc_->isModified();
+    return point;
+}
+
+RegenResult RegenerationEngine::cancelRun(const RunRestorePoint& point) {
+    endProgress();
+
+    for (const auto& bodyId : doc_->getBodyIds()) {
+        if (point.bodies.count(bodyId) == 0) {
+            doc_->removeBody(bodyId);
+        }
+    }
+    std::vector<std::string> bodyIds;
+    bodyIds.reserve(point.bodies.size());
+    for (const auto& [bodyId, shape] : point.bodies) {
+        (void)shape;
+        bodyIds.push_back(bodyId);
+    }
+    std::sort(bodyIds.begin(), bodyIds.end());
+    std::size_t restoredBodies = 0;
+    for (const auto& bodyId : bodyIds) {
+        const TopoDS_Shape& shape = point.bodies.at(bodyId);
+        const auto& elements = point.bodyElements.at(bodyId);
+        const TopoDS_Shape* current = doc_->getBodyShape(bodyId);
+        if (current && current->IsEqual(shape) &&
+            sameElements(doc_->elementMap().bodyEntries(bodyId), elements)) {
+            continue;
+        }
+        doc_->restoreBodyShape(bodyId, shape, elements);
+        ++restoredBodies;
+    }
+
+    doc_->clearOperationFailures();
+    graph_.clearFailures();
+    for (const auto& [opId, reason] : point.failures) {
+        doc_->setOperationFailed(opId, reason);
+        graph_.setFailed(opId, true, reason);
+    }
+    doc_->regenerationCache() = point.cache;
+    doc_->setModified(point.modified);
+
+    qCInfo(logRegen) << "regenerate:cancelled" << "restoredBodies=" << restoredBodies;
+    lastReplayedOpCount_ = 0;
+    lastRestoredOpCount_ = 0;
+    lastAvoidedOpCount_ = 0;
+
+    RegenResult result;
+    result.status = RegenStatus::Cancelled;
+    return result;
+}
+
+void RegenerationEngine::appendCachedOutcome(const std::string& opId, RegenResult& result) const {
+    const CachedOpState* state = doc_->regenerationCache().findOperation(opId);
+    if (!state) {
+        result.skippedOps.push_back(opId);
+        return;
+    }
+
+    switch (state->outcome) {
+    case CachedOpOutcome::Succeeded:
+        result.succeededOps.push_back(opId);
+        break;
+    case CachedOpOutcome::Failed: {
+        FailedOp failedOp;
+        failedOp.opId = opId;
+        if (const OperationRecord* opRecord = doc_->findOperation(opId)) {
+            failedOp.type = opRecord->type;
+        }
+        failedOp.errorMessage = state->errorMessage;
+        failedOp.affectedDownstream = graph_.getDownstream(opId);
+        result.failedOps.push_back(std::move(failedOp));
+        break;
+    }
+    case CachedOpOutcome::UpstreamFailed:
+    case CachedOpOutcome::Suppressed:
+    case CachedOpOutcome::Missing:
+        result.skippedOps.push_back(opId);
+        break;
+    }
+}
+
+void RegenerationEngine::finishRun(const std::vector<OperationRecord>& appliedOps, RegenResult& result) {
+    auto& cache = doc_->regenerationCache();
+
+    // Determine overall status
+    if (result.failedOps.empty()) {
+        result.status = RegenStatus::Success;
+    } else if (!result.succeededOps.empty()) {
+        result.status = RegenStatus::PartialFailure;
+    } else {
+        result.status = RegenStatus::CriticalFailure;
+    }
+
+    std::unordered_set<std::string> expectedBodies;
+    expectedBodies.reserve(appliedOps.size());
+    std::unordered_set<std::string> updatedBodies;
+    for (const auto& bodyId : doc_->baseBodyIds()) {
+        expectedBodies.insert(bodyId);
+        updatedBodies.insert(bodyId);
+    }
+    std::vector<std::string> appliedOrder;
+    appliedOrder.reserve(appliedOps.size());
+    std::unordered_set<std::string> appliedIds;
+    for (const auto& op : appliedOps) {
+        appliedOrder.push_back(op.opId);
+        appliedIds.insert(op.opId);
+        for (const auto& bodyId : op.resultBodyIds) {
+            expectedBodies.insert(bodyId);
+        }
+        const CachedOpState* state = cache.findOperation(op.opId);
+        if (state && state->outcome == CachedOpOutcome::Succeeded) {
+            for (const auto& bodyId : op.resultBodyIds) {
+                updatedBodies.insert(bodyId);
+            }
+        }
+    }
 
-RegenResult RegenerationEngine::regenerateAll() {
-    if (!doc_) {
-        RegenResult result;
-        result.status = RegenStatus::CriticalFailure;
-        return result;
+    // Remove bodies not produced during this regeneration.
+    for (const auto& bodyId : doc_->getBodyIds()) {
+        if (expectedBodies.find(bodyId) == expectedBodies.end()) {
+            doc_->removeBody(bodyId);
+            continue;
+        }
+        if (updatedBodies.find(bodyId) == updatedBodies.end()) {
+            doc_->removeBodyPreserveElementMap(bodyId);
+        }
     }
-    return regenerateToAppliedCount(doc_->operations().size());
-}
-
-RegenResult RegenerationEngine::regenerateToAppliedCount(std::size_t appliedCount) {
-    RegenResult result;
-    qCInfo(logRegen) << "regenerateAll:start";
 
-    if (!doc_) {
-        qCCritical(logRegen) << "regenerateAll:no-document";
-        result.status = RegenStatus::CriticalFailure;
-        return result;
+    // Forget ops that are no longer applied and remember the final body states.
+    for (const auto& previousId : cache.appliedOrder()) {
+        if (appliedIds.count(previousId) == 0) {
+            cache.eraseOperation(previousId);
+        }
+    }
+    cache.setAppliedOrder(std::move(appliedOrder));
+    std::unordered_map<std::string, TopoDS_Shape> finalBodies;
+    for (const auto& bodyId : doc_->getBodyIds()) {
+        if (const TopoDS_Shape* shape = doc_->getBodyShape(bodyId)) {
+            finalBodies[bodyId] = *shape;
+        }
     }
+    cache.setFinalBodies(std::move(finalBodies));
+    cache.setPrimed(true);
+}
 
-    const auto& operations = doc_->operations();
-    const std::size_t boundedAppliedCount = std::min(appliedCount, operations.size());
-    std::vector<OperationRecord> appliedOps;
-    appliedOps.reserve(boundedAppliedCount);
-    for (std::size_t i = 0; i < boundedAppliedCount; ++i) {
-        appliedOps.push_back(operations[i]);
+bool RegenerationEngine::canRegenerateIncrementally(const std::vector<OperationRecord>& appliedOps,
+                                                    const std::unordered_set<std::string>& dirty,
+                                                    std::string& reasonOut) const {
+    const auto& cache = doc_->regenerationCache();
+    if (!cache.isPrimed()) {
+        reasonOut = "cache-not-primed";
+        return false;
+    }
+    if (dirty.empty()) {
+        reasonOut = "no-dirty-ops";
+        return false;
     }
 
-    // Rebuild dependency graph from current operations
-    graph_.rebuildFromOperations(appliedOps);
+    // Apart from the dirty ops, the applied history must be unchanged.
+    std::vector<std::string> previous;
+    previous.reserve(cache.appliedOrder().size());
+    for (const auto& opId : cache.appliedOrder()) {
+        if (dirty.count(opId) == 0) {
+            previous.push_back(opId);
+        }
+    }
+    std::vector<std::string> current;
+    current.reserve(appliedOps.size());
     for (const auto& op : appliedOps) {
-        if (doc_->isOperationSuppressed(op.opId)) {
-            graph_.setSuppressed(op.opId, true);
+        if (dirty.count(op.opId) == 0) {
+            current.push_back(op.opId);
+        }
+    }
+    if (previous != current) {
+        reasonOut = "history-changed";
+        return false;
+    }
+    for (const auto& opId : current) {
+        const CachedOpState* state = cache.findOperation(opId);
+        if (!state) {
+            reasonOut = "missing-op-state";
+            return false;
+        }
+        const bool wasSuppressed = state->outcome == CachedOpOutcome::Suppressed;
+        if (wasSuppressed != doc_->isOperationSuppressed(opId)) {
+            reasonOut = "suppression-changed";
+            return false;
         }
     }
-    graph_.clearFailures();
-    doc_->clearOperationFailures();
 
-    // Get topological sort order
-    std::vector<std::string> order = graph_.topologicalSort();
-    if (order.empty() && graph_.size() > 0) {
-        // Cycle detected
-        qCCritical(logRegen) << "regenerateAll:dependency-cycle-detected"
-                             << "graphSize=" << graph_.size();
-        result.status = RegenStatus::CriticalFailure;
-        return result;
+    const auto& baseShapes = cache.baseShapes();
+    if (baseShapes.size() != doc_->baseBodyIds().size()) {
+        reasonOut = "base-bodies-changed";
+        return false;
+    }
+    for (const auto& bodyId : doc_->baseBodyIds()) {
+        if (baseShapes.find(bodyId) == baseShapes.end()) {
+            reasonOut = "base-bodies-changed";
+            return false;
+        }
     }
 
-    std::unordered_set<std::string> expectedBodies;
-    expectedBodies.reserve(appliedOps.size());
-    for (const auto& op : appliedOps) {
-        for (const auto& bodyId : op.resultBodyIds) {
-            expectedBodies.insert(bodyId);
+    // Bodies edited outside of regeneration invalidate the cached states.
+    const auto& finalBodies = cache.finalBodies();
+    const auto bodyIds = doc_->getBodyIds();
+    if (bodyIds.size() != finalBodies.size()) {
+        reasonOut = "bodies-changed";
+        return false;
+    }
+    for (const auto& bodyId : bodyIds) {
+        auto it = finalBodies.find(bodyId);
+        const TopoDS_Shape* shape = doc_->getBodyShape(bodyId);
+        if (it == finalBodies.end() || !shape || !shape->IsEqual(it->second)) {
+            reasonOut = "bodies-changed";
+            return false;
         }
     }
-    for (const auto& bodyId : doc_->baseBodyIds()) {
-        expectedBodies.insert(bodyId);
+    return true;
+}
+
+std::vector<std::string> RegenerationEngine::touchedBodyIds(const OperationRecord& op) const {
+    std::unordered_set<std::string> bodies;
+    for (const auto& bodyId : inputBodyIds(op)) {
+        bodies.insert(bodyId);
     }
+    if (const FeatureNode* node = graph_.getNode(op.opId)) {
+        bodies.insert(node->outputBodyIds.begin(), node->outputBodyIds.end());
+    }
+    bodies.insert(op.resultBodyIds.begin(), op.resultBodyIds.end());
+    bodies.erase(std::string{});
 
-    // Execute operations in order
-    const int total = static_cast<int>(order.size());
-    int current = 0;
-    std::unordered_set<std::string> updatedBodies;
-    for (const auto& bodyId : doc_->baseBodyIds()) {
-        updatedBodies.insert(bodyId);
+    std::vector<std::string> sorted(bodies.begin(), bodies.end());
+    std::sort(sorted.begin(), sorted.end());
+    return sorted;
+}
+
+std::vector<CachedElementInput> RegenerationEngine::captureElementInputs(const std::string& opId) const {
+    std::vector<CachedElementInput> inputs;
+    const FeatureNode* node = graph_.getNode(opId);
+    if (!node || node->elementBodyIds.empty()) {
+        return inputs;
+    }
+
+    std::vector<std::string> elementIds(node->inputFaceIds.begin(), node->inputFaceIds.end());
+    elementIds.insert(elementIds.end(), node->inputEdgeIds.begin(), node->inputEdgeIds.end());
+    std::sort(elementIds.begin(), elementIds.end());
+    inputs.reserve(elementIds.size());
+    for (const auto& elementId : elementIds) {
+        CachedElementInput input;
+        input.elementId = elementId;
+        if (const auto* entry = doc_->elementMap().find(kernel::elementmap::ElementId{elementId})) {
+            input.producerOpId = entry->opId;
+            input.shape = entry->shape;
+        }
+        inputs.push_back(std::move(input));
     }
+    return inputs;
+}
 
-    for (const auto& opId : order) {
-        ++current;
-        if (progressCallback_) {
-            progressCallback_(current, total, opId);
+bool RegenerationEngine::elementInputsUnchanged(const std::string& opId) const {
+    const CachedOpState* state = doc_->regenerationCache().findOperation(opId);
+    if (!state || state->elementInputs.empty()) {
+        return false;
+    }
+    for (const auto& input : state->elementInputs) {
+        const auto* entry = doc_->elementMap().find(kernel::elementmap::ElementId{input.elementId});
+        const TopoDS_Shape current = entry ? entry->shape : TopoDS_Shape();
+        if (!current.IsEqual(input.shape)) {
+            return false;
         }
+    }
+    return true;
+}
 
-        // Skip suppressed operations
-        if (graph_.isSuppressed(opId)) {
-            qCDebug(logRegen) << "regenerateAll:skip-suppressed"
-                              << QString::fromStdString(opId);
-            result.skippedOps.push_back(opId);
-            doc_->clearOperationFailed(opId);
-            continue;
+std::vector<std::string> RegenerationEngine::inputBodyIds(const OperationRecord& op) const {
+    std::unordered_set<std::string> bodies;
+    if (const FeatureNode* node = graph_.getNode(op.opId)) {
+        bodies.insert(node->inputBodyIds.begin(), node->inputBodyIds.end());
+    }
+
+    if (std::holds_alternative<ExtrudeParams>(op.params)) {
+        const auto& params = std::get<ExtrudeParams>(op.params);
+        if (params.booleanMode != BooleanMode::NewBody) {
+            bodies.insert(resolveBooleanTargetBodyId(op, params.targetBodyId));
         }
+    } else if (std::holds_alternative<RevolveParams>(op.params)) {
+        const auto& params = std::get<RevolveParams>(op.params);
+        if (params.booleanMode != BooleanMode::NewBody) {
+            bodies.insert(resolveBooleanTargetBodyId(op, params.targetBodyId));
+        }
+    }
+    bodies.erase(std::string{});
 
-        // Find the operation record
-        const OperationRecord* opRecord = doc_->findOperation(opId);
+    std::vector<std::string> sorted(bodies.begin(), bodies.end());
+    std::sort(sorted.begin(), sorted.end());
+    return sorted;
+}
 
-        if (!opRecord) {
-            qCWarning(logRegen) << "regenerateAll:missing-operation-record"
-                                << QString::fromStdString(opId);
-            result.skippedOps.push_back(opId);
-            continue;
+std::uint64_t RegenerationEngine::sketchFingerprint(const std::string& opId) {
+    const FeatureNode* node = graph_.getNode(opId);
+    if (!node || node->inputSketchIds.empty()) {
+        return 0;
+    }
+
+    std::vector<std::string> sketchIds(node->inputSketchIds.begin(), node->inputSketchIds.end());
+    std::sort(sketchIds.begin(), sketchIds.end());
+
+    std::uint64_t hash = kFnvOffset;
+    for (const auto& sketchId : sketchIds) {
+        auto it = sketchHashes_.find(sketchId);
+        if (it == sketchHashes_.end()) {
+            const core::sketch::Sketch* sketch = doc_->getSketch(sketchId);
+            const std::uint64_t sketchHash = sketch ? fnv1a(kFnvOffset, sketch->toJson()) : 0;
+            it = sketchHashes_.emplace(sketchId, sketchHash).first;
         }
+        hash = fnv1a(hash, sketchId);
+        hash = fnv1a(hash, std::to_string(it->second));
+    }
+    return hash;
+}
 
-        // Check if any upstream dependency failed
-        bool upstreamFailed = false;
-        for (const auto& upstreamId : graph_.getUpstream(opId)) {
-            if (graph_.isFailed(upstreamId)) {
-                upstreamFailed = true;
-                break;
-            }
+OperationCheckpointKey RegenerationEngine::makeCheckpointKey(const OperationRecord& op) {
+    OperationCheckpointKey key;
+    std::uint64_t hash = hashOperationDefinition(op);
+    hash = hashValue(hash, sketchFingerprint(op.opId));
+
+    auto addInputShape = [&](const TopoDS_Shape& shape) {
+        hash = hashShape(hash, shape);
+        key.inputShapes.push_back(shape);
+    };
+
+    // Bodies the op reads, including resolved boolean targets. Bodies it only
+    // writes do not influence the produced shape.
+    for (const auto& bodyId : inputBodyIds(op)) {
+        hash = hashString(hash, bodyId);
+        const TopoDS_Shape* shape = doc_->getBodyShape(bodyId);
+        addInputShape(shape ? *shape : TopoDS_Shape());
+    }
+
+    // Referenced faces and edges as currently resolved by the ElementMap.
+    auto addElement = [&](const std::optional<TopoDS_Shape>& shape) {
+        addInputShape(shape ? *shape : TopoDS_Shape());
+    };
+    if (std::holds_alternative<FaceRef>(op.input)) {
+        addElement(resolveFace(std::get<FaceRef>(op.input).faceId));
+    }
+    if (std::holds_alternative<RevolveParams>(op.params)) {
+        const auto& axis = std::get<RevolveParams>(op.params).axis;
+        if (std::holds_alternative<EdgeRef>(axis)) {
+            addElement(resolveEdge(std::get<EdgeRef>(axis).edgeId));
+        }
+    } else if (std::holds_alternative<FilletChamferParams>(op.params)) {
+        for (const auto& edgeId : std::get<FilletChamferParams>(op.params).edgeIds) {
+            addElement(resolveEdge(edgeId));
         }
+    } else if (std::holds_alternative<ShellParams>(op.params)) {
+        for (const auto& faceId : std::get<ShellParams>(op.params).openFaceIds) {
+            addElement(resolveFace(faceId));
+        }
+    }
 
-        if (upstreamFailed) {
-            qCWarning(logRegen) << "regenerateAll:skip-upstream-failed"
-                                << QString::fromStdString(opId);
-            graph_.setFailed(opId, true, "Upstream operation failed");
-            doc_->setOperationFailed(opId, "Upstream operation failed");
-            result.skippedOps.push_back(opId);
-            continue;
+    // Rebinding output bodies starts from their current entries, so those are inputs too.
+    for (const auto& bodyId : op.resultBodyIds) {
+        const auto entries = doc_->elementMap().bodyEntries(bodyId);
+        hash = hashValue(hash, entries.size());
+        for (const auto& entry : entries) {
+            hash = hashElementEntry(hash, entry);
         }
+    }
 
-        // Execute the operation
-        std::string errorMsg;
-        bool success = executeOperation(*opRecord, errorMsg);
+    key.hash = hash;
+    return key;
+}
 
-        if (success) {
-            qCDebug(logRegen) << "regenerateAll:operation-succeeded"
-                              << QString::fromStdString(opId);
-            result.succeededOps.push_back(opId);
-            doc_->clearOperationFailed(opId);
-            for (const auto& bodyId : opRecord->resultBodyIds) {
-                updatedBodies.insert(bodyId);
-            }
+std::vector<std::uint64_t> RegenerationEngine::prefixSignatures(const std::vector<std::string>& order) {
+    std::vector<std::uint64_t> signatures;
+    signatures.reserve(order.size() + 1);
+
+    // Base bodies are replay inputs of every prefix.
+    std::vector<std::string> baseIds(doc_->baseBodyIds().begin(), doc_->baseBodyIds().end());
+    std::sort(baseIds.begin(), baseIds.end());
+    std::uint64_t hash = kFnvOffset;
+    for (const auto& bodyId : baseIds) {
+        hash = hashString(hash, bodyId);
+        const TopoDS_Shape* shape = doc_->getBodyShape(bodyId);
+        hash = hashShape(hash, shape ? *shape : TopoDS_Shape());
+    }
+    signatures.push_back(hash);
+
+    for (const auto& opId : order) {
+        if (const OperationRecord* op = doc_->findOperation(opId)) {
+            hash = hashValue(hash, hashOperationDefinition(*op));
         } else {
-            qCWarning(logRegen) << "regenerateAll:operation-failed"
-                                << "opId=" << QString::fromStdString(opId)
-                                << "error=" << QString::fromStdString(errorMsg);
-            graph_.setFailed(opId, true, errorMsg);
-            doc_->setOperationFailed(opId, errorMsg);
-            FailedOp failedOp;
-            failedOp.opId = opId;
-            failedOp.type = opRecord->type;
-            failedOp.errorMessage = errorMsg;
-            failedOp.affectedDownstream = graph_.getDownstream(opId);
-            result.failedOps.push_back(std::move(failedOp));
+            hash = hashString(hash, opId);
         }
+        hash = hashValue(hash, graph_.isSuppressed(opId) ? 1 : 0);
+        hash = hashValue(hash, sketchFingerprint(opId));
+        signatures.push_back(hash);
     }
+    return signatures;
+}
 
-    // Determine overall status
-    if (result.failedOps.empty()) {
-        result.status = RegenStatus::Success;
-    } else if (!result.succeededOps.empty()) {
-        result.status = RegenStatus::PartialFailure;
-    } else {
-        result.status = RegenStatus::CriticalFailure;
+void RegenerationEngine::capturePrefixSnapshot(const std::vector<std::string>& order,
+                                               std::size_t opCount, std::uint64_t signature) {
+    const auto& cache = doc_->regenerationCache();
+    PrefixSnapshot snapshot;
+    snapshot.opCount = opCount;
+    snapshot.signature = signature;
+    snapshot.operations.reserve(opCount);
+
+    std::unordered_set<std::string> bodyIds(doc_->baseBodyIds().begin(), doc_->baseBodyIds().end());
+    for (std::size_t i = 0; i < opCount && i < order.size(); ++i) {
+        const CachedOpState* state = cache.findOperation(order[i]);
+        if (!state) {
+            continue;
+        }
+        snapshot.operations.emplace_back(order[i], *state);
+        if (state->outcome == CachedOpOutcome::Succeeded) {
+            bodyIds.insert(state->outputBodyIds.begin(), state->outputBodyIds.end());
+        }
     }
 
-    // Remove bodies not produced during this regeneration.
-    for (const auto& bodyId : doc_->getBodyIds()) {
-        if (expectedBodies.find(bodyId) == expectedBodies.end()) {
-            doc_->removeBody(bodyId);
+    for (const auto& bodyId : bodyIds) {
+        const TopoDS_Shape* shape = doc_->getBodyShape(bodyId);
+        if (!shape || shape->IsNull()) {
             continue;
         }
-        if (updatedBodies.find(bodyId) == updatedBodies.end()) {
-            doc_->removeBodyPreserveElementMap(bodyId);
+        snapshot.bodies[bodyId] = *shape;
+        snapshot.bodyElements[bodyId] = doc_->elementMap().bodyEntries(bodyId);
+    }
+
+    doc_->prefixSnapshots().store(std::move(snapshot));
+}
+
+void RegenerationEngine::restorePrefixSnapshot(const PrefixSnapshot& snapshot) {
+    auto& cache = doc_->regenerationCache();
+    for (const auto& [opId, state] : snapshot.operations) {
+        cache.setOperationState(opId, state);
+        if (state.outcome == CachedOpOutcome::Failed ||
+            state.outcome == CachedOpOutcome::UpstreamFailed) {
+            graph_.setFailed(opId, true, state.errorMessage);
+            doc_->setOperationFailed(opId, state.errorMessage);
         }
     }
 
-    qCInfo(logRegen) << "regenerateAll:done"
-                     << "status=" << static_cast<int>(result.status)
-                     << "succeeded=" << result.succeededOps.size()
-                     << "failed=" << result.failedOps.size()
-                     << "skipped=" << result.skippedOps.size();
+    std::vector<std::string> bodyIds;
+    bodyIds.reserve(snapshot.bodies.size());
+    for (const auto& [bodyId, shape] : snapshot.bodies) {
+        (void)shape;
+        bodyIds.push_back(bodyId);
+    }
+    std::sort(bodyIds.begin(), bodyIds.end());
 
-    return result;
+    for (const auto& bodyId : bodyIds) {
+        const TopoDS_Shape& shape = snapshot.bodies.at(bodyId);
+        auto elementsIt = snapshot.bodyElements.find(bodyId);
+        static const std::vector<kernel::elementmap::Entry> kNoElements;
+        const auto& elements = elementsIt != snapshot.bodyElements.end() ? elementsIt->second : kNoElements;
+
+        // Bodies the gap does not touch are usually already in the snapshot state.
+        const TopoDS_Shape* current = doc_->getBodyShape(bodyId);
+        if (current && current->IsEqual(shape) &&
+            sameElements(doc_->elementMap().bodyEntries(bodyId), elements)) {
+            continue;
+        }
+        doc_->restoreBodyShape(bodyId, shape, elements);
+    }
+}
+
+void RegenerationEngine::verifyAgainstFullReplay(std::size_t appliedCount,
+                                                 const RegenResult& incremental) {
+    lastVerification_ = IncrementalVerification{};
+    lastVerification_.performed = true;
+
+    const auto incrementalBodies = captureBodySignatures(*doc_);
+    const RegenResult full = regenerateToAppliedCount(appliedCount);
+    const auto fullBodies = captureBodySignatures(*doc_);
+
+    std::string mismatch;
+    if (!regenResultsMatch(incremental, full, mismatch) ||
+        !bodySignaturesMatch(incrementalBodies, fullBodies, mismatch)) {
+        lastVerification_.matches = false;
+        lastVerification_.mismatch = mismatch;
+        qCWarning(logRegen) << "regenerateIncremental:verification-mismatch"
+                            << "detail=" << QString::fromStdString(mismatch);
+        return;
+    }
+    qCDebug(logRegen) << "regenerateIncremental:verification-match";
 }
 
 RegenResult RegenerationEngine::regenerateFrom(const std::string& opId) {
@@ -235,7 +1604,13 @@ RegenResult RegenerationEngine::regenerateFrom(const std::string& opId) {
         return result;
     }
 
+    std::optional<RunRestorePoint> restorePoint;
+    if (cancelToken_) {
+        restorePoint = captureRestorePoint();
+    }
+
     // Ensure graph is up to date
+    sketchHashes_.clear();
     graph_.rebuildFromOperations(doc_->operations());
     for (const auto& op : doc_->operations()) {
         if (doc_->isOperationSuppressed(op.opId)) {
@@ -263,20 +1638,18 @@ RegenResult RegenerationEngine::regenerateFrom(const std::string& opId) {
 
     // Execute only affected ops in topological order
     std::unordered_set<std::string> affectedSet(opsToRegen.begin(), opsToRegen.end());
-    const int total = static_cast<int>(opsToRegen.size());
-    int current = 0;
     std::unordered_set<std::string> updatedBodies;
+    beginProfiling();
+    beginProgress(opsToRegen.size());
 
     for (const auto& currentOpId : fullOrder) {
         if (affectedSet.find(currentOpId) == affectedSet.end()) {
             continue;
         }
 
-        ++current;
-        if (progressCallback_) {
-            progressCallback_(current, total, currentOpId);
+        if (isCancelled()) {
+            return cancelRun(*restorePoint);
         }
-
         if (graph_.isSuppressed(currentOpId)) {
             result.skippedOps.push_back(currentOpId);
             doc_->clearOperationFailed(currentOpId);
@@ -290,15 +1663,7 @@ RegenResult RegenerationEngine::regenerateFrom(const std::string& opId) {
             continue;
         }
 
-        bool upstreamFailed = false;
-        for (const auto& upId : graph_.getUpstream(currentOpId)) {
-            if (graph_.isFailed(upId)) {
-                upstreamFailed = true;
-                break;
-            }
-        }
-
-        if (upstreamFailed) {
+        if (graph_.hasFailedUpstream(currentOpId)) {
             graph_.setFailed(currentOpId, true, "Upstream operation failed");
             doc_->setOperationFailed(currentOpId, "Upstream operation failed");
             result.skippedOps.push_back(currentOpId);
@@ -306,7 +1671,10 @@ RegenResult RegenerationEngine::regenerateFrom(const std::string& opId) {
         }
 
         std::string errorMsg;
-        bool success = executeOperation(*opRecord, errorMsg);
+        bool success = executeOperation(*opRecord, nextOpRange(currentOpId), errorMsg);
+        if (isCancelled()) {
+            return cancelRun(*restorePoint);
+        }
 
         if (success) {
             result.succeededOps.push_back(currentOpId);
@@ -325,6 +1693,7 @@ RegenResult RegenerationEngine::regenerateFrom(const std::string& opId) {
             result.failedOps.push_back(std::move(failedOp));
         }
     }
+    endProgress();
 
     if (result.failedOps.empty()) {
         result.status = RegenStatus::Success;
@@ -344,8 +1713,17 @@ RegenResult RegenerationEngine::previewFrom(const std::string& opId, const Opera
         return result;
     }
 
-    // Backup current state
-    backupCurrentState();
+    // A second preview replaces the first rather than stacking on top of it.
+    discardPreview();
+
+    // Bodies are saved lazily, on their first change during the preview.
+    if (!doc_->beginBodyLayer()) {
+        qCWarning(logRegen) << "previewFrom:body-layer-busy"
+                            << "opId=" << QString::fromStdString(opId);
+        RegenResult result;
+        result.status = RegenStatus::CriticalFailure;
+        return result;
+    }
     previewActive_ = true;
     previewOpId_ = opId;
 
@@ -364,8 +1742,9 @@ void RegenerationEngine::commitPreview() {
         return;
     }
 
-    // Clear backup (keep current state)
-    backupShapes_.clear();
+    if (doc_) {
+        doc_->commitBodyLayer();
+    }
     previewActive_ = false;
     previewOpId_.clear();
 }
@@ -380,12 +1759,11 @@ void RegenerationEngine::discardPreview() {
         op->params = previewOriginalParams_;
     }
 
-    // Restore body shapes
-    restoreBackupState();
+    // Put back only the bodies the preview touched
+    doc_->discardBodyLayer();
 
     previewActive_ = false;
     previewOpId_.clear();
-    backupShapes_.clear();
 }
 
 std::optional<TopoDS_Shape> RegenerationEngine::resolveEdge(const std::string& edgeId) const {
@@ -427,37 +1805,141 @@ std::optional<TopoDS_Shape> RegenerationEngine::resolveBody(const std::string& b
     return *shape;
 }
 
-bool RegenerationEngine::executeOperation(const OperationRecord& op, std::string& errorOut) {
+bool RegenerationEngine::executeOperation(const OperationRecord& op, const Message_ProgressRange& range,
+                                          std::string& errorOut) {
+    PreparedOperation prepared = prepareOperation(op);
+    if (!prepared.checkpoint) {
+        buildPrepared(prepared, range, 0);
+    }
+    return applyPreparedOperation(prepared, errorOut);
+}
+
+RegenerationEngine::PreparedOperation RegenerationEngine::prepareOperation(const OperationRecord& op) {
     qCDebug(logRegen) << "executeOperation:start"
                       << "opId=" << QString::fromStdString(op.opId)
                       << "type=" << static_cast<int>(op.type)
                       << "outputs=" << op.resultBodyIds.size();
-    TopoDS_Shape result;
+
+    PreparedOperation prepared;
+    prepared.op = &op;
+
+    // Same inputs as an earlier execution: reuse its shape and element bindings.
+    auto& checkpoints = doc_->checkpointCache();
+    if (checkpoints.isEnabled()) {
+        prepared.checkpointKey = makeCheckpointKey(op);
+        if (const OperationCheckpoint* checkpoint = checkpoints.find(prepared.checkpointKey)) {
+            prepared.checkpoint = *checkpoint;
+        }
+    }
+    return prepared;
+}
+
+TopoDS_Shape RegenerationEngine::buildOperationShape(const OperationRecord& op,
+                                                     const Message_ProgressRange& range,
+                                                     std::string& errorOut) {
+    if (isCancelled()) {
+        errorOut = kCancelledMessage;
+        return {};
+    }
 
     switch (op.type) {
     case OperationType::Extrude:
-        result = buildExtrude(op, errorOut);
-        break;
+        return buildExtrude(op, range, errorOut);
     case OperationType::Revolve:
-        result = buildRevolve(op, errorOut);
-        break;
+        return buildRevolve(op, range, errorOut);
     case OperationType::Fillet:
-        result = buildFillet(op, errorOut);
-        break;
+        return buildFillet(op, range, errorOut);
     case OperationType::Chamfer:
-        result = buildChamfer(op, errorOut);
-        break;
+        return buildChamfer(op, range, errorOut);
     case OperationType::Shell:
-        result = buildShell(op, errorOut);
-        break;
+        return buildShell(op, range, errorOut);
     case OperationType::Boolean:
-        result = buildBoolean(op, errorOut);
-        break;
+        return buildBoolean(op, range, errorOut);
     default:
         errorOut = "Unknown operation type";
-        return false;
+        return {};
+    }
+}
+
+void RegenerationEngine::buildPrepared(PreparedOperation& prepared, const Message_ProgressRange& range,
+                                       int thread) {
+    if (!profiling_) {
+        prepared.shape = buildOperationShape(*prepared.op, range, prepared.error);
+        return;
+    }
+
+    // Resident growth is process-wide, so concurrent builds share each other's.
+    OpProfile& profile = prepared.profile;
+    profile.buildThread = thread;
+    profile.buildStartUs = doc_->regenProfile().elapsedUs();
+    const std::int64_t cpuBefore = RegenProfile::threadCpuMicros();
+    const std::int64_t residentBefore = RegenProfile::residentBytes();
+    prepared.shape = buildOperationShape(*prepared.op, range, prepared.error);
+    profile.buildWallUs = doc_->regenProfile().elapsedUs() - profile.buildStartUs;
+    profile.buildCpuUs = RegenProfile::threadCpuMicros() - cpuBefore;
+    profile.residentDeltaBytes = RegenProfile::residentBytes() - residentBefore;
+}
+
+bool RegenerationEngine::applyPreparedOperation(PreparedOperation& prepared, std::string& errorOut) {
+    if (!profiling_) {
+        return applyPreparedResult(prepared, errorOut);
+    }
+
+    RegenProfile& regenProfile = doc_->regenProfile();
+    const Document::BodyUpdateTimers timersBefore = doc_->bodyUpdateTimers();
+    const std::int64_t applyStart = regenProfile.elapsedUs();
+    const bool success = applyPreparedResult(prepared, errorOut);
+
+    OpProfile profile = std::move(prepared.profile);
+    profile.opId = prepared.op->opId;
+    profile.name = operationTypeName(prepared.op->type);
+    profile.checkpointHit = prepared.checkpoint.has_value();
+    if (profile.checkpointHit) {
+        profile.buildStartUs = applyStart;
+    }
+    profile.applyStartUs = applyStart;
+    profile.applyWallUs = regenProfile.elapsedUs() - applyStart;
+    const Document::BodyUpdateTimers& timersAfter = doc_->bodyUpdateTimers();
+    profile.elementMapUs = timersAfter.elementMapUs - timersBefore.elementMapUs;
+    profile.tessellationUs = timersAfter.tessellationUs - timersBefore.tessellationUs;
+    if (success) {
+        const TopoDS_Shape& shape = profile.checkpointHit ? prepared.checkpoint->shape : prepared.shape;
+        TopTools_IndexedMapOfShape faces;
+        TopTools_IndexedMapOfShape edges;
+        TopExp::MapShapes(shape, TopAbs_FACE, faces);
+        TopExp::MapShapes(shape, TopAbs_EDGE, edges);
+        profile.faceCount = faces.Extent();
+        profile.edgeCount = edges.Extent();
+    }
+    regenProfile.record(std::move(profile));
+    return success;
+}
+
+bool RegenerationEngine::applyPreparedResult(PreparedOperation& prepared, std::string& errorOut) {
+    const OperationRecord& op = *prepared.op;
+
+    if (prepared.checkpoint) {
+        static const std::vector<kernel::elementmap::Entry> kNoElements;
+        const OperationCheckpoint& checkpoint = *prepared.checkpoint;
+        for (const auto& bodyId : op.resultBodyIds) {
+            auto elementsIt = checkpoint.bodyElements.find(bodyId);
+            const auto& elements = elementsIt != checkpoint.bodyElements.end()
+                                       ? elementsIt->second
+                                       : kNoElements;
+            doc_->restoreBodyShape(bodyId, checkpoint.shape, elements);
+        }
+        qCDebug(logRegen) << "executeOperation:checkpoint-hit"
+                          << "opId=" << QString::fromStdString(op.opId);
+        return true;
     }
 
+    errorOut = prepared.error;
+    const TopoDS_Shape& result = prepared.shape;
+    if (isCancelled()) {
+        // An interrupted OCCT algorithm may have left a partial shape behind.
+        errorOut = kCancelledMessage;
+        return false;
+    }
     if (result.IsNull()) {
         if (errorOut.empty()) {
             errorOut = "Operation produced null shape";
@@ -473,12 +1955,23 @@ bool RegenerationEngine::executeOperation(const OperationRecord& op, std::string
         applyBodyResult(bodyId, result, op.opId);
     }
 
+    auto& checkpoints = doc_->checkpointCache();
+    if (checkpoints.isEnabled()) {
+        OperationCheckpoint checkpoint;
+        checkpoint.shape = result;
+        for (const auto& bodyId : op.resultBodyIds) {
+            checkpoint.bodyElements[bodyId] = doc_->elementMap().bodyEntries(bodyId);
+        }
+        checkpoints.insert(std::move(prepared.checkpointKey), std::move(checkpoint));
+    }
+
     qCDebug(logRegen) << "executeOperation:done"
                       << "opId=" << QString::fromStdString(op.opId);
     return true;
 }
 
-TopoDS_Shape RegenerationEngine::buildExtrude(const OperationRecord& op, std::string& errorOut) {
+TopoDS_Shape RegenerationEngine::buildExtrude(const OperationRecord& op, const Message_ProgressRange& range,
+                                              std::string& errorOut) {
     if (!std::holds_alternative<ExtrudeParams>(op.params)) {
         errorOut = "Invalid params for extrude";
         return {};
@@ -516,6 +2009,7 @@ TopoDS_Shape RegenerationEngine::buildExtrude(const OperationRecord& op, std::st
                     direction.Y() * params.distance,
                     direction.Z() * params.distance);
 
+    Message_ProgressScope scope(range, "Extrude", 2);
     BRepPrimAPI_MakePrism prism(baseFace, prismVec, true);
     TopoDS_Shape result = prism.Shape();
 
@@ -552,7 +2046,7 @@ TopoDS_Shape RegenerationEngine::buildExtrude(const OperationRecord& op, std::st
             }
         }
 
-        draft.Build();
+        draft.Build(scope.Next());
         if (draft.IsDone()) {
             result = draft.Shape();
         }
@@ -580,17 +2074,17 @@ TopoDS_Shape RegenerationEngine::buildExtrude(const OperationRecord& op, std::st
         }
 
         if (params.booleanMode == BooleanMode::Add) {
-            BRepAlgoAPI_Fuse fuse(*targetOpt, result);
+            BRepAlgoAPI_Fuse fuse(*targetOpt, result, scope.Next());
             if (fuse.IsDone()) {
                 result = fuse.Shape();
             }
         } else if (params.booleanMode == BooleanMode::Cut) {
-            BRepAlgoAPI_Cut cut(*targetOpt, result);
+            BRepAlgoAPI_Cut cut(*targetOpt, result, scope.Next());
             if (cut.IsDone()) {
                 result = cut.Shape();
             }
         } else if (params.booleanMode == BooleanMode::Intersect) {
-            BRepAlgoAPI_Common common(*targetOpt, result);
+            BRepAlgoAPI_Common common(*targetOpt, result, scope.Next());
             if (common.IsDone()) {
                 result = common.Shape();
             }
@@ -600,7 +2094,8 @@ TopoDS_Shape RegenerationEngine::buildExtrude(const OperationRecord& op, std::st
     return result;
 }
 
-TopoDS_Shape RegenerationEngine::buildRevolve(const OperationRecord& op, std::string& errorOut) {
+TopoDS_Shape RegenerationEngine::buildRevolve(const OperationRecord& op, const Message_ProgressRange& range,
+                                              std::string& errorOut) {
     if (!std::holds_alternative<RevolveParams>(op.params)) {
         errorOut = "Invalid params for revolve";
         return {};
@@ -625,6 +2120,7 @@ TopoDS_Shape RegenerationEngine::buildRevolve(const OperationRecord& op, std::st
 
     if (std::holds_alternative<SketchLineRef>(params.axis)) {
         const auto& lineRef = std::get<SketchLineRef>(params.axis);
+        std::lock_guard<std::mutex> sketchLock(sketchMutex_);
         core::sketch::Sketch* sketch = doc_->getSketch(lineRef.sketchId);
         if (!sketch) {
             errorOut = "Sketch not found: " + lineRef.sketchId;
@@ -719,17 +2215,17 @@ TopoDS_Shape RegenerationEngine::buildRevolve(const OperationRecord& op, std::st
         }
 
         if (params.booleanMode == BooleanMode::Add) {
-            BRepAlgoAPI_Fuse fuse(*targetOpt, result);
+            BRepAlgoAPI_Fuse fuse(*targetOpt, result, range);
             if (fuse.IsDone()) {
                 result = fuse.Shape();
             }
         } else if (params.booleanMode == BooleanMode::Cut) {
-            BRepAlgoAPI_Cut cut(*targetOpt, result);
+            BRepAlgoAPI_Cut cut(*targetOpt, result, range);
             if (cut.IsDone()) {
                 result = cut.Shape();
             }
         } else if (params.booleanMode == BooleanMode::Intersect) {
-            BRepAlgoAPI_Common common(*targetOpt, result);
+            BRepAlgoAPI_Common common(*targetOpt, result, range);
             if (common.IsDone()) {
                 result = common.Shape();
             }
@@ -739,7 +2235,8 @@ TopoDS_Shape RegenerationEngine::buildRevolve(const OperationRecord& op, std::st
     return result;
 }
 
-TopoDS_Shape RegenerationEngine::buildFillet(const OperationRecord& op, std::string& errorOut) {
+TopoDS_Shape RegenerationEngine::buildFillet(const OperationRecord& op, const Message_ProgressRange& range,
+                                             std::string& errorOut) {
     if (!std::holds_alternative<FilletChamferParams>(op.params)) {
         errorOut = "Invalid params for fillet";
         return {};
@@ -792,7 +2289,7 @@ TopoDS_Shape RegenerationEngine::buildFillet(const OperationRecord& op, std::str
             return {};
         }
 
-        fillet.Build();
+        fillet.Build(range);
         if (fillet.IsDone()) {
             return fillet.Shape();
         }
@@ -805,7 +2302,8 @@ TopoDS_Shape RegenerationEngine::buildFillet(const OperationRecord& op, std::str
     return {};
 }
 
-TopoDS_Shape RegenerationEngine::buildChamfer(const OperationRecord& op, std::string& errorOut) {
+TopoDS_Shape RegenerationEngine::buildChamfer(const OperationRecord& op, const Message_ProgressRange& range,
+                                              std::string& errorOut) {
     if (!std::holds_alternative<FilletChamferParams>(op.params)) {
         errorOut = "Invalid params for chamfer";
         return {};
@@ -872,7 +2370,7 @@ TopoDS_Shape RegenerationEngine::buildChamfer(const OperationRecord& op, std::st
             return {};
         }
 
-        chamfer.Build();
+        chamfer.Build(range);
         if (chamfer.IsDone()) {
             return chamfer.Shape();
         }
@@ -885,7 +2383,8 @@ TopoDS_Shape RegenerationEngine::buildChamfer(const OperationRecord& op, std::st
     return {};
 }
 
-TopoDS_Shape RegenerationEngine::buildShell(const OperationRecord& op, std::string& errorOut) {
+TopoDS_Shape RegenerationEngine::buildShell(const OperationRecord& op, const Message_ProgressRange& range,
+                                            std::string& errorOut) {
     if (!std::holds_alternative<ShellParams>(op.params)) {
         errorOut = "Invalid params for shell";
         return {};
@@ -933,7 +2432,7 @@ TopoDS_Shape RegenerationEngine::buildShell(const OperationRecord& op, std::stri
         BRepOffsetAPI_MakeThickSolid thickSolid;
         thickSolid.MakeThickSolidByJoin(targetShape, facesToRemove, -params.thickness,
                                          1e-3, BRepOffset_Skin, false, false,
-                                         GeomAbs_Arc, false);
+                                         GeomAbs_Arc, false, range);
 
         if (thickSolid.IsDone()) {
             return thickSolid.Shape();
@@ -947,7 +2446,8 @@ TopoDS_Shape RegenerationEngine::buildShell(const OperationRecord& op, std::stri
     return {};
 }
 
-TopoDS_Shape RegenerationEngine::buildBoolean(const OperationRecord& op, std::string& errorOut) {
+TopoDS_Shape RegenerationEngine::buildBoolean(const OperationRecord& op, const Message_ProgressRange& range,
+                                              std::string& errorOut) {
     if (!std::holds_alternative<BooleanParams>(op.params)) {
         errorOut = "Invalid params for boolean";
         return {};
@@ -970,21 +2470,21 @@ TopoDS_Shape RegenerationEngine::buildBoolean(const OperationRecord& op, std::st
     try {
         switch (params.operation) {
         case BooleanParams::Op::Union: {
-            BRepAlgoAPI_Fuse fuse(*targetOpt, *toolOpt);
+            BRepAlgoAPI_Fuse fuse(*targetOpt, *toolOpt, range);
             if (fuse.IsDone()) {
                 return fuse.Shape();
             }
             break;
         }
         case BooleanParams::Op::Cut: {
-            BRepAlgoAPI_Cut cut(*targetOpt, *toolOpt);
+            BRepAlgoAPI_Cut cut(*targetOpt, *toolOpt, range);
             if (cut.IsDone()) {
                 return cut.Shape();
             }
             break;
         }
         case BooleanParams::Op::Intersect: {
-            BRepAlgoAPI_Common common(*targetOpt, *toolOpt);
+            BRepAlgoAPI_Common common(*targetOpt, *toolOpt, range);
             if (common.IsDone()) {
                 return common.Shape();
             }
@@ -1083,6 +2583,8 @@ std::optional<TopoDS_Face> RegenerationEngine::buildFaceFromSketchRegion(const s
         return std::nullopt;
     }
 
+    // Sketches are shared between operations built on different threads.
+    std::lock_guard<std::mutex> sketchLock(sketchMutex_);
     core::sketch::Sketch* sketch = doc_->getSketch(sketchId);
     if (!sketch) {
         errorOut = "Sketch not found: " + sketchId;
@@ -1105,36 +2607,6 @@ std::optional<TopoDS_Face> RegenerationEngine::buildFaceFromSketchRegion(const s
     return faceResult.face;
 }
 
-void RegenerationEngine::backupCurrentState() {
-    if (!doc_) {
-        return;
-    }
-
-    backupShapes_.clear();
-    for (const auto& bodyId : doc_->getBodyIds()) {
-        const TopoDS_Shape* shape = doc_->getBodyShape(bodyId);
-        if (shape && !shape->IsNull()) {
-            backupShapes_[bodyId] = *shape;
-        }
-    }
-}
-
-void RegenerationEngine::restoreBackupState() {
-    if (!doc_) {
-        return;
-    }
-
-    // Remove current bodies
-    for (const auto& bodyId : doc_->getBodyIds()) {
-        doc_->removeBody(bodyId);
-    }
-
-    // Restore backed up bodies
-    for (const auto& [bodyId, shape] : backupShapes_) {
-        doc_->addBodyWithId(bodyId, shape);
-    }
-}
-
 void RegenerationEngine::applyBodyResult(const std::string& bodyId, const TopoDS_Shape& shape,
                                           const std::string& opId) {
     if (!doc_) {
@@ -1145,7 +2617,7 @@ void RegenerationEngine::applyBodyResult(const std::string& bodyId, const TopoDS
         doc_->updateBodyShape(bodyId, shape, true, opId);
     } else {
         doc_->addBodyWithId(bodyId, shape);
-        doc_->elementMap().rebindBody(bodyId, shape, opId);
+        doc_->rebindBodyElements(bodyId, shape, opId);
     }
 }
 
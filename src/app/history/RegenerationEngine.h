@@ -9,15 +9,25 @@
 #define ONECAD_APP_HISTORY_REGENERATIONENGINE_H
 
 #include "DependencyGraph.h"
+#include "OperationCheckpointCache.h"
+#include "RegenProfile.h"
+#include "RegenProgress.h"
+#include "RegenerationCache.h"
 #include "../document/OperationRecord.h"
 
 #include <TopoDS_Shape.hxx>
 #include <TopoDS_Face.hxx>
+#include <Message_ProgressRange.hxx>
+#include <Message_ProgressScope.hxx>
 
+#include <cstdint>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace onecad::app {
@@ -26,6 +36,8 @@ class Document;
 
 namespace onecad::app::history {
 
+struct PrefixSnapshot;
+
 // ─────────────────────────────────────────────────────────────────────────────
 // Result Types
 // ─────────────────────────────────────────────────────────────────────────────
@@ -33,7 +45,8 @@ namespace onecad::app::history {
 enum class RegenStatus {
     Success,         // All operations succeeded
     PartialFailure,  // Some ops failed, others succeeded
-    CriticalFailure  // Unrecoverable error
+    CriticalFailure, // Unrecoverable error
+    Cancelled        // Aborted via CancellationToken; document left as before the run
 };
 
 struct FailedOp {
@@ -50,6 +63,15 @@ struct RegenResult {
     std::vector<std::string> skippedOps;  // Suppressed or downstream of failed
 };
 
+/**
+ * @brief Outcome of checking an incremental run against a full replay.
+ */
+struct IncrementalVerification {
+    bool performed = false;
+    bool matches = true;
+    std::string mismatch;
+};
+
 // ─────────────────────────────────────────────────────────────────────────────
 // Regeneration Engine
 // ─────────────────────────────────────────────────────────────────────────────
@@ -80,6 +102,75 @@ public:
      */
     RegenResult regenerateToAppliedCount(std::size_t appliedCount);
 
+    /**
+     * @brief Regenerate [0, appliedCount) re-running only ops affected by an edit.
+     *
+     * @p dirtyOpIds are the ops a history command touched (added, removed,
+     * re-parameterized or (un)suppressed). They are closed over their
+     * DependencyGraph downstream and over later ops touching the same bodies;
+     * those bodies are rewound to the states cached by the previous run and
+     * only the affected ops are executed. Unaffected ops report their cached
+     * outcome, so the RegenResult matches what a full replay would publish.
+     *
+     * With element-level invalidation, an op that reads a replayed body only
+     * through faces or edges is not replayed when no affected op generated
+     * or modified them. It is probed when the run reaches it instead: if a
+     * reference no longer resolves to the shape it last read, the edit is
+     * redone at body level.
+     *
+     * Falls back to regenerateToAppliedCount() when the document's
+     * RegenerationCache does not describe the current history.
+     */
+    RegenResult regenerateIncremental(std::size_t appliedCount,
+                                      const std::vector<std::string>& dirtyOpIds);
+
+    /**
+     * @brief Test mode: follow every incremental run with a full replay and compare.
+     */
+    void setVerifyIncremental(bool enabled) { verifyIncremental_ = enabled; }
+    const IncrementalVerification& lastVerification() const { return lastVerification_; }
+
+    /**
+     * @brief Whether the last run took the incremental path.
+     */
+    bool lastRunWasIncremental() const { return lastRunIncremental_; }
+
+    /**
+     * @brief Number of operations executed (not served from cache) by the last run.
+     */
+    std::size_t lastReplayedOpCount() const { return lastReplayedOpCount_; }
+
+    /**
+     * @brief Number of leading operations the last run restored from a prefix snapshot.
+     */
+    std::size_t lastRestoredOpCount() const { return lastRestoredOpCount_; }
+
+    /**
+     * @brief Number of operations the last incremental run did not replay
+     * although a body-level invalidation would have.
+     */
+    std::size_t lastAvoidedOpCount() const { return lastAvoidedOpCount_; }
+
+    /**
+     * @brief Invalidate by ElementMap references instead of whole bodies where possible.
+     *
+     * On by default; ONECAD_REGEN_ELEMENT_DEPS=0 turns it off.
+     */
+    void setElementLevelInvalidation(bool enabled) { elementLevelInvalidation_ = enabled; }
+    bool elementLevelInvalidation() const { return elementLevelInvalidation_; }
+
+    /**
+     * @brief Maximum number of operations built concurrently.
+     *
+     * Ops touching disjoint bodies (independent DependencyGraph branches) are
+     * grouped into levels; OCCT builds within a level run on worker threads
+     * while document and ElementMap updates are applied on the calling thread
+     * in creation order, so results match a serial replay. Defaults to the
+     * hardware concurrency, or ONECAD_REGEN_THREADS when set; 1 disables it.
+     */
+    void setMaxParallelOps(std::size_t count) { maxParallelOps_ = count > 0 ? count : 1; }
+    std::size_t maxParallelOps() const { return maxParallelOps_; }
+
     /**
      * @brief Regenerate from a specific operation onwards.
      *
@@ -90,7 +181,8 @@ public:
     /**
      * @brief Preview regeneration with modified parameters.
      *
-     * Temporarily modifies an operation's params and regenerates.
+     * Temporarily modifies an operation's params and regenerates inside a
+     * document body layer, so only the bodies the preview touches are saved.
      * Use commitPreview() to keep changes, or discardPreview() to revert.
      */
     RegenResult previewFrom(const std::string& opId, const OperationParams& newParams);
@@ -112,10 +204,27 @@ public:
 
     /**
      * @brief Set progress callback for long operations.
+     *
+     * Reports the run's completion as current of total (total is
+     * RegenProgressIndicator::kScale), including progress inside long OCCT
+     * algorithms, with the op being built. Parallel builds report from
+     * worker threads; calls are serialized.
      */
     using ProgressCallback = std::function<void(int current, int total, const std::string& opId)>;
     void setProgressCallback(ProgressCallback cb) { progressCallback_ = std::move(cb); }
 
+    /**
+     * @brief Make subsequent runs cancellable.
+     *
+     * The token is checked between operations and polled by OCCT algorithms
+     * through their progress range. A cancelled run restores the bodies,
+     * ElementMap entries, failure flags and RegenerationCache it started
+     * from and returns RegenStatus::Cancelled.
+     */
+    void setCancellationToken(std::shared_ptr<const CancellationToken> token) {
+        cancelToken_ = std::move(token);
+    }
+
     /**
      * @brief Access dependency graph (for queries and suppression).
      */
@@ -146,41 +255,88 @@ private:
     // Operation Executors
     // ─────────────────────────────────────────────────────────────────────────
 
+    /**
+     * @brief An operation between checkpoint lookup and applying its result.
+     */
+    struct PreparedOperation {
+        const OperationRecord* op = nullptr;
+        OperationCheckpointKey checkpointKey;
+        std::optional<OperationCheckpoint> checkpoint;  // Set on checkpoint hit
+        TopoDS_Shape shape;                             // Built result on miss
+        std::string error;
+        Message_ProgressRange range;                    // Share of the run's progress
+        OpProfile profile;                              // Filled while profiling
+    };
+
     /**
      * @brief Execute a single operation.
      * @return true on success, false on failure (error in errorOut).
      */
-    bool executeOperation(const OperationRecord& op, std::string& errorOut);
+    bool executeOperation(const OperationRecord& op, const Message_ProgressRange& range,
+                          std::string& errorOut);
+
+    /**
+     * @brief Look up the op's checkpoint. Touches the document; calling thread only.
+     */
+    PreparedOperation prepareOperation(const OperationRecord& op);
+
+    /**
+     * @brief Build the op's shape. Reads the document only; safe on worker threads
+     * while no other thread modifies it.
+     */
+    TopoDS_Shape buildOperationShape(const OperationRecord& op, const Message_ProgressRange& range,
+                                     std::string& errorOut);
+
+    /**
+     * @brief Build a prepared op, timing it when profiling. @p thread labels the trace lane.
+     */
+    void buildPrepared(PreparedOperation& prepared, const Message_ProgressRange& range, int thread);
+
+    /**
+     * @brief Apply a prepared op and record its profile when profiling.
+     */
+    bool applyPreparedOperation(PreparedOperation& prepared, std::string& errorOut);
+
+    /**
+     * @brief Apply a checkpoint hit or built shape to the document and cache it.
+     */
+    bool applyPreparedResult(PreparedOperation& prepared, std::string& errorOut);
 
     /**
      * @brief Build extrude geometry.
      */
-    TopoDS_Shape buildExtrude(const OperationRecord& op, std::string& errorOut);
+    TopoDS_Shape buildExtrude(const OperationRecord& op, const Message_ProgressRange& range,
+                              std::string& errorOut);
 
     /**
      * @brief Build revolve geometry.
      */
-    TopoDS_Shape buildRevolve(const OperationRecord& op, std::string& errorOut);
+    TopoDS_Shape buildRevolve(const OperationRecord& op, const Message_ProgressRange& range,
+                              std::string& errorOut);
 
     /**
      * @brief Build fillet geometry.
      */
-    TopoDS_Shape buildFillet(const OperationRecord& op, std::string& errorOut);
+    TopoDS_Shape buildFillet(const OperationRecord& op, const Message_ProgressRange& range,
+                             std::string& errorOut);
 
     /**
      * @brief Build chamfer geometry.
      */
-    TopoDS_Shape buildChamfer(const OperationRecord& op, std::string& errorOut);
+    TopoDS_Shape buildChamfer(const OperationRecord& op, const Message_ProgressRange& range,
+                              std::string& errorOut);
 
     /**
      * @brief Build shell geometry.
      */
-    TopoDS_Shape buildShell(const OperationRecord& op, std::string& errorOut);
+    TopoDS_Shape buildShell(const OperationRecord& op, const Message_ProgressRange& range,
+                            std::string& errorOut);
 
     /**
      * @brief Build boolean geometry.
      */
-    TopoDS_Shape buildBoolean(const OperationRecord& op, std::string& errorOut);
+    TopoDS_Shape buildBoolean(const OperationRecord& op, const Message_ProgressRange& range,
+                              std::string& errorOut);
 
     // ─────────────────────────────────────────────────────────────────────────
     // Input Resolution
@@ -211,22 +367,164 @@ private:
                                            const std::string& explicitTargetBodyId) const;
 
     // ─────────────────────────────────────────────────────────────────────────
-    // State Management
+    // Replay Bookkeeping
     // ─────────────────────────────────────────────────────────────────────────
 
     /**
-     * @brief Clear bodies produced by specified operations.
+     * @brief Run one scheduled op: suppression/upstream checks, execution,
+     * failure tracking and RegenerationCache recording.
+     * @return false when the run was cancelled.
      */
+    bool runScheduledOperation(const std::string& opId);
 
     /**
-     * @brief Backup current body shapes for preview restore.
+     * @brief Run ops in creation order, building independent ones concurrently.
+     * @return false when the run was cancelled.
      */
-    void backupCurrentState();
+    bool runScheduledOperations(const std::vector<std::string>& opIds);
 
     /**
-     * @brief Restore body shapes from backup.
+     * @brief Group ops into levels whose members touch pairwise disjoint bodies.
      */
-    void restoreBackupState();
+    std::vector<std::vector<std::string>> planParallelLevels(
+        const std::vector<std::string>& opIds) const;
+
+    /**
+     * @brief Build the shapes of prepared[pending[k]] on up to maxParallelOps() threads.
+     */
+    void buildConcurrently(std::vector<PreparedOperation>& prepared,
+                           const std::vector<std::size_t>& pending);
+
+    /**
+     * @brief Suppression/upstream checks of a scheduled op.
+     * @return The record to execute, or nullptr when the op was settled here.
+     */
+    const OperationRecord* beginScheduledOperation(const std::string& opId, CachedOpState& state);
+
+    /**
+     * @brief Record an executed op's outcome in the graph, document and cache.
+     */
+    void finishScheduledOperation(const OperationRecord& op, bool success,
+                                  const std::string& errorMsg, CachedOpState state);
+
+    /**
+     * @brief Append the outcome cached by the previous run for an unaffected op.
+     */
+    void appendCachedOutcome(const std::string& opId, RegenResult& result) const;
+
+    /**
+     * @brief Compute status, drop stale bodies and store the run in the cache.
+     */
+    void finishRun(const std::vector<OperationRecord>& appliedOps, RegenResult& result);
+
+    /**
+     * @brief Check that the cached replay state still describes the document.
+     */
+    bool canRegenerateIncrementally(const std::vector<OperationRecord>& appliedOps,
+                                    const std::unordered_set<std::string>& dirty,
+                                    std::string& reasonOut) const;
+
+    /**
+     * @brief Bodies an op reads or writes (including resolved boolean targets).
+     */
+    std::vector<std::string> touchedBodyIds(const OperationRecord& op) const;
+
+    /**
+     * @brief Bodies an op reads (graph inputs plus resolved boolean targets).
+     */
+    std::vector<std::string> inputBodyIds(const OperationRecord& op) const;
+
+    /**
+     * @brief Faces and edges an op reads through a body it does not write,
+     * with the op that generated or last modified each one.
+     */
+    std::vector<CachedElementInput> captureElementInputs(const std::string& opId) const;
+
+    /**
+     * @brief Whether the references captured by the op's last run still resolve to the same shapes.
+     */
+    bool elementInputsUnchanged(const std::string& opId) const;
+
+    /**
+     * @brief Hash of the content of the sketches an op reads (memoized per run).
+     */
+    std::uint64_t sketchFingerprint(const std::string& opId);
+
+    /**
+     * @brief Checkpoint key over everything an op reads: params, input and
+     * referenced shapes, sketch content and the pre-op element state of its
+     * output bodies.
+     */
+    OperationCheckpointKey makeCheckpointKey(const OperationRecord& op);
+
+    /**
+     * @brief Signatures of every prefix of @p order; element j covers the first j ops.
+     */
+    std::vector<std::uint64_t> prefixSignatures(const std::vector<std::string>& order);
+
+    /**
+     * @brief Record the replay state after the first @p opCount ops of @p order.
+     */
+    void capturePrefixSnapshot(const std::vector<std::string>& order, std::size_t opCount,
+                               std::uint64_t signature);
+
+    /**
+     * @brief Restore bodies, elements and op outcomes from a prefix snapshot.
+     */
+    void restorePrefixSnapshot(const PrefixSnapshot& snapshot);
+
+    /**
+     * @brief Start reporting a run of @p opCount ops; no-op without token or callback.
+     */
+    void beginProgress(std::size_t opCount);
+    void endProgress();
+
+    /**
+     * @brief Progress range of the next op of the run (empty when not reporting).
+     */
+    Message_ProgressRange nextOpRange(const std::string& opId);
+
+    bool isCancelled() const;
+
+    /**
+     * @brief Start the document's profile for a new run if profiling is enabled.
+     */
+    void beginProfiling();
+
+    /**
+     * @brief Document state a cancelled run rolls back to.
+     */
+    struct RunRestorePoint {
+        std::unordered_map<std::string, TopoDS_Shape> bodies;
+        std::unordered_map<std::string, std::vector<kernel::elementmap::Entry>> bodyElements;
+        std::unordered_map<std::string, std::string> failures;
+        RegenerationCache cache;
+        bool modified = false;
+    };
+
+    RunRestorePoint captureRestorePoint() const;
+
+    /**
+     * @brief Roll the document back to @p point and report the run as cancelled.
+     */
+    RegenResult cancelRun(const RunRestorePoint& point);
+
+    /**
+     * @brief One incremental run; @p restorePoint carries over from a pass it redoes.
+     */
+    RegenResult regenerateIncrementalPass(std::size_t appliedCount,
+                                          const std::vector<std::string>& dirtyOpIds,
+                                          bool elementLevel,
+                                          std::optional<RunRestorePoint> restorePoint);
+
+    /**
+     * @brief Re-run the full replay and compare with an incremental result.
+     */
+    void verifyAgainstFullReplay(std::size_t appliedCount, const RegenResult& incremental);
+
+    // ─────────────────────────────────────────────────────────────────────────
+    // State Management
+    // ─────────────────────────────────────────────────────────────────────────
 
     /**
      * @brief Add or update a body in the document.
@@ -238,9 +536,34 @@ private:
     DependencyGraph graph_;
     ProgressCallback progressCallback_;
 
+    // Incremental regeneration
+    bool verifyIncremental_ = false;
+    IncrementalVerification lastVerification_;
+    bool lastRunIncremental_ = false;
+    std::size_t lastReplayedOpCount_ = 0;
+    std::size_t lastRestoredOpCount_ = 0;
+    std::size_t lastAvoidedOpCount_ = 0;
+    std::unordered_map<std::string, std::uint64_t> sketchHashes_;  // sketchId -> content hash, per run
+
+    // Element-level invalidation
+    bool elementLevelInvalidation_ = true;
+    std::unordered_set<std::string> elementProbeOps_;  // Ops of the current run skipped on element evidence
+    std::vector<std::string> staleElementProbes_;      // Probes whose referenced elements changed
+
+    // Parallel branch execution
+    std::size_t maxParallelOps_ = 1;
+    std::mutex sketchMutex_;  // Serializes sketch reads of concurrent builds
+
+    // Cancellation and progress
+    std::shared_ptr<const CancellationToken> cancelToken_;
+    Handle(RegenProgressIndicator) progress_;
+    std::unique_ptr<Message_ProgressScope> progressScope_;  // Per-op ranges of the current run
+
+    // Profiling
+    bool profiling_ = false;  // Latched per run from the document's RegenProfile
+
     // Preview state
     bool previewActive_ = false;
-    std::unordered_map<std::string, TopoDS_Shape> backupShapes_;
     std::string previewOpId_;
     OperationParams previewOriginalParams_;
 };
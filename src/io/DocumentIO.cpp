@@ -322,7 +322,7 @@ QJsonObject DocumentIO::createDocumentJson(const app::Document* document) {
     json["history"] = history;
     
     QJsonObject topology;
-    topology["elementMapPath"] = "topology/elementmap.json";
+    topology["elementMapPath"] = "topology/elementmap.bin";
     json["topology"] = topology;
     
     return json;
@@ -12,6 +12,7 @@
 #include <QJsonArray>
 #include <cmath>
 #include <optional>
+#include <string>
 #include <gp_Vec.hxx>
 
 namespace onecad::io {
@@ -20,6 +21,9 @@ using namespace kernel::elementmap;
 
 namespace {
 
+const QString kBinaryPath = QStringLiteral("topology/elementmap.bin");
+const QString kJsonPath = QStringLiteral("topology/elementmap.json");
+
 QString kindToString(ElementKind kind) {
     switch (kind) {
         case ElementKind::Body: return "Body";
@@ -217,14 +221,25 @@ std::optional<ElementDescriptor> deserializeDescriptor(const QJsonObject& json,
 
 bool ElementMapIO::saveElementMap(Package* package,
                                    const ElementMap& elementMap) {
-    QJsonObject json = serializeElementMap(elementMap);
-    return package->writeFile("topology/elementmap.json", JSONUtils::toCanonicalJson(json));
+    const std::string image = elementMap.toBinary();
+    return package->writeFile(kBinaryPath, QByteArray(image.data(), static_cast<qsizetype>(image.size())));
 }
 
 bool ElementMapIO::loadElementMap(Package* package,
                                    ElementMap& elementMap,
                                    QString& errorMessage) {
-    QByteArray data = package->readFile("topology/elementmap.json");
+    if (package->fileExists(kBinaryPath)) {
+        // Read in place; fromBinary() only copies when the buffer is misaligned
+        const QByteArray image = package->readFile(kBinaryPath);
+        if (!elementMap.fromBinary(image.constData(), static_cast<std::size_t>(image.size()))) {
+            errorMessage = "Invalid or unsupported elementmap.bin";
+            return false;
+        }
+        return true;
+    }
+
+    // v1 documents
+    QByteArray data = package->readFile(kJsonPath);
     if (data.isEmpty()) {
         // Not an error - new document may not have ElementMap
         return true;
@@ -17,21 +17,23 @@ namespace onecad::io {
 class Package;
 
 /**
- * @brief Serialization for topology/elementmap.json
+ * @brief Serialization for topology/elementmap.bin
  * 
  * Per FILE_FORMAT.md §12:
- * Versioned descriptor schema with stable hashing metadata.
+ * Documents are saved as the binary v2 image (ElementMap::toBinary()).
+ * The v1 topology/elementmap.json schema is still read when no binary
+ * image is present, and remains available through serializeElementMap().
  */
 class ElementMapIO {
 public:
     /**
-     * @brief Save ElementMap to package
+     * @brief Save ElementMap to package as topology/elementmap.bin
      */
     static bool saveElementMap(Package* package,
                                 const kernel::elementmap::ElementMap& elementMap);
     
     /**
-     * @brief Load ElementMap from package
+     * @brief Load ElementMap from package, preferring elementmap.bin over elementmap.json
      */
     static bool loadElementMap(Package* package,
                                 kernel::elementmap::ElementMap& elementMap,
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace onecad::kernel::elementmap {
+
+// 32-bit stand-in for an element ID string. Meshes, pickers and caches store handles and
+// resolve them to strings only where an ID leaves for the UI, selection or persistence.
+// Handles are process-wide and stay valid for the life of the process; 0 is invalid.
+struct ElementHandle {
+    std::uint32_t value{0};
+
+    bool valid() const { return value != 0; }
+    bool operator==(const ElementHandle& other) const { return value == other.value; }
+    bool operator!=(const ElementHandle& other) const { return value != other.value; }
+    bool operator<(const ElementHandle& other) const { return value < other.value; }
+};
+
+struct ElementHandleHash {
+    std::size_t operator()(const ElementHandle& handle) const noexcept {
+        return std::hash<std::uint32_t>{}(handle.value);
+    }
+};
+
+// Interning table behind ElementHandle. Strings are never released, so the table grows with
+// the number of distinct IDs ever seen (IDs of a model are bounded by its history).
+// Thread-safe: tessellation interns from worker threads while the UI resolves.
+class ElementHandleTable {
+public:
+    static ElementHandleTable& global() {
+        static ElementHandleTable table;
+        return table;
+    }
+
+    // Handle of the ID, allocating one on first sight. An empty ID maps to the invalid handle.
+    ElementHandle intern(std::string_view id) {
+        if (id.empty()) {
+            return {};
+        }
+        {
+            std::shared_lock lock(mutex_);
+            auto it = index_.find(id);
+            if (it != index_.end()) {
+                return ElementHandle{it->second};
+            }
+        }
+        std::unique_lock lock(mutex_);
+        auto it = index_.find(id);
+        if (it != index_.end()) {
+            return ElementHandle{it->second};
+        }
+        // deque::push_back keeps existing elements in place, so index_ keys stay valid.
+        const std::string& stored = strings_.emplace_back(id);
+        const auto value = static_cast<std::uint32_t>(strings_.size());
+        index_.emplace(std::string_view(stored), value);
+        return ElementHandle{value};
+    }
+
+    // Handle of an already interned ID; invalid if the ID was never interned.
+    ElementHandle find(std::string_view id) const {
+        if (id.empty()) {
+            return {};
+        }
+        std::shared_lock lock(mutex_);
+        auto it = index_.find(id);
+        return it != index_.end() ? ElementHandle{it->second} : ElementHandle{};
+    }
+
+    // The interned string; empty for the invalid handle. The reference stays valid.
+    const std::string& resolve(ElementHandle handle) const {
+        static const std::string empty;
+        if (!handle.valid()) {
+            return empty;
+        }
+        std::shared_lock lock(mutex_);
+        if (handle.value > strings_.size()) {
+            return empty;
+        }
+        return strings_[handle.value - 1];
+    }
+
+    std::size_t size() const {
+        std::shared_lock lock(mutex_);
+        return strings_.size();
+    }
+
+private:
+    ElementHandleTable() = default;
+
+    mutable std::shared_mutex mutex_;
+    std::deque<std::string> strings_;                               // handle.value - 1 -> ID
+    std::unordered_map<std::string_view, std::uint32_t> index_;     // Views into strings_
+};
+
+inline ElementHandle internElementId(std::string_view id) {
+    return ElementHandleTable::global().intern(id);
+}
+
+inline ElementHandle findElementHandle(std::string_view id) {
+    return ElementHandleTable::global().find(id);
+}
+
+inline const std::string& elementIdString(ElementHandle handle) {
+    return ElementHandleTable::global().resolve(handle);
+}
+
+} // namespace onecad::kernel::elementmap
@@ -1,14 +1,24 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cmath>
 #include <cstdint>
+#include <cstring>
+#include <exception>
 #include <iomanip>
 #include <iosfwd>
+#include <iterator>
 #include <limits>
+#include <mutex>
+#include <optional>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -28,6 +38,7 @@
 #include <TopAbs_Orientation.hxx>
 #include <TopoDS.hxx>
 #include <TopoDS_Shape.hxx>
+#include <TopoDS_TShape.hxx>
 #include <TopoDS_Edge.hxx>
 #include <TopoDS_Face.hxx>
 #include <TopoDS_Vertex.hxx>
@@ -38,6 +49,9 @@
 #include <gp_Pnt.hxx>
 #include <gp_Vec.hxx>
 
+#include "ElementHandle.h"
+#include "ElementMapFormat.h"
+
 namespace onecad::kernel::elementmap {
 
 enum class ElementKind {
@@ -78,6 +92,19 @@ struct Entry {
     std::vector<ElementId> sources;
 };
 
+// Hit counters of the descriptor cache; see ElementMap::descriptorCacheStats().
+struct DescriptorCacheStats {
+    std::uint64_t hits{0};
+    std::uint64_t misses{0};
+    std::uint64_t released{0};  // Entries dropped because nothing else held their shape
+    std::size_t size{0};
+
+    double hitRate() const {
+        const std::uint64_t lookups = hits + misses;
+        return lookups == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(lookups);
+    }
+};
+
 class ElementMap {
 public:
     void registerElement(const ElementId& id, ElementKind kind, const TopoDS_Shape& shape,
@@ -91,26 +118,58 @@ public:
     bool contains(const ElementId& id) const;
     std::vector<ElementId> ids() const;
     std::vector<ElementId> findIdsByShape(const TopoDS_Shape& shape) const;
+    // Interned handle of the first ID bound to the shape; invalid if none is.
+    ElementHandle findHandleByShape(const TopoDS_Shape& shape) const;
     void clear();
     void clearShape(const ElementId& id);
+    // Per-body operations go through a body -> entries index and cost O(entries of that body).
     void removeElementsForBody(const std::string& bodyId);
+    // Snapshot of the entries owned by a body (its own entry and "bodyId/..." children), sorted by id.
+    std::vector<Entry> bodyEntries(const std::string& bodyId) const;
+    // Replaces the entries owned by a body with a snapshot taken by bodyEntries().
+    void restoreBodyEntries(const std::string& bodyId, const std::vector<Entry>& entries);
+    // Rematches the body's entries to a new shape by descriptor. Entries whose shape changed,
+    // and new elements, take opId; entries matched to the same shape keep their own.
     void rebindBody(const std::string& bodyId, const TopoDS_Shape& shape,
                     const std::string& opId = {});
+    // rebindBody() searches a spatial index once a kind has at least this many candidates and
+    // scans linearly below it. Both assign the same IDs; 0 always indexes, SIZE_MAX never does.
+    void setIndexedRebindThreshold(std::size_t minCandidates) { indexedRebindThreshold_ = minCandidates; }
+    static constexpr std::size_t kIndexedRebindThreshold = 64;
+
+    // Descriptors are cached per TShape and Location, so sub-shapes a boolean passes through
+    // unchanged are not measured again. Entries whose shape nothing else holds are released.
+    void setDescriptorCacheEnabled(bool enabled);
+    DescriptorCacheStats descriptorCacheStats() const;
+    void resetDescriptorCacheStats();
 
     // Updates tracked shapes using the history from a boolean operation. Returns IDs that were deleted.
+    // Descriptors and scores of the new shapes are computed on up to updateThreads workers once
+    // at least kParallelUpdateMinEntries entries are tracked; IDs do not depend on the count.
     std::vector<ElementId> update(BRepAlgoAPI_BooleanOperation& algo, const std::string& opId);
+    void setUpdateThreads(std::size_t threads) { updateThreads_ = std::max<std::size_t>(1, threads); }
+    static constexpr std::size_t kParallelUpdateMinEntries = 256;
 
+    // v1 text; read() and fromString() also accept a v2 binary image.
     bool write(std::ostream& os) const;
     bool read(std::istream& is);
     std::string toString() const;
     bool fromString(const std::string& data);
 
+    // v2 binary image, see ElementMapFormat.h. fromBinary() reads the records in place,
+    // copying only if data is not 8-byte aligned.
+    std::string toBinary() const;
+    bool fromBinary(const void* data, std::size_t size);
+    bool readView(const format::ElementMapView& view);
+
 private:
     enum class ChildReason {
         Split,
         Generated
     };
 
+    class CandidateIndex;
+
     struct DescriptorKey {
         int shapeType{0};
         int surfaceType{0};
@@ -132,6 +191,9 @@ private:
     };
 
     ElementDescriptor computeDescriptor(const TopoDS_Shape& shape) const;
+    ElementDescriptor measureDescriptor(const TopoDS_Shape& shape) const;
+    void storeDescriptor(const TopoDS_Shape& shape, const ElementDescriptor& descriptor) const;
+    void releaseUnusedDescriptors() const;
     double score(const ElementDescriptor& target, const ElementDescriptor& candidate) const;
     TopoDS_Shape pickBestShape(const TopTools_ListOfShape& list, const ElementDescriptor& target) const;
     ElementKind inferKind(const TopoDS_Shape& shape, ElementKind fallback) const;
@@ -149,8 +211,93 @@ private:
     std::string kindToString(ElementKind kind) const;
     ElementKind kindFromString(const std::string& value) const;
 
+    static constexpr std::size_t kElementKindCount = static_cast<std::size_t>(ElementKind::Unknown) + 1;
+
+    // Owning body of an entry ID: everything before the first '/'.
+    static std::string_view bodyIdOf(std::string_view id) { return id.substr(0, id.find('/')); }
+
+    // Body ID -> its entries, split by kind. Entry pointers stay valid because entries_ is
+    // node-based; a copied map cannot reuse them and rebuilds the index on first use.
+    struct BodyIndex {
+        using KindSets = std::array<std::unordered_set<const Entry*>, kElementKindCount>;
+
+        std::unordered_map<std::string, KindSets> bodies;
+        bool valid{true};
+
+        BodyIndex() = default;
+        BodyIndex(const BodyIndex&) : valid(false) {}
+        BodyIndex(BodyIndex&&) = default;
+        BodyIndex& operator=(const BodyIndex&) {
+            bodies.clear();
+            valid = false;
+            return *this;
+        }
+        BodyIndex& operator=(BodyIndex&&) = default;
+    };
+
+    void indexEntry(const Entry& entry) const;
+    void unindexEntry(const Entry& entry) const;
+    const BodyIndex::KindSets* findBodyIndex(const std::string& bodyId) const;
+
     std::unordered_map<std::string, Entry> entries_;
+    mutable BodyIndex bodyIndex_;
     NCollection_DataMap<TopoDS_Shape, std::vector<std::string>, TopTools_ShapeMapHasher> shapeToIds_;
+    std::size_t indexedRebindThreshold_{kIndexedRebindThreshold};
+
+    static constexpr std::size_t kDescriptorCacheMinRelease = 4096;
+    bool descriptorCacheEnabled_{true};
+    mutable NCollection_DataMap<TopoDS_Shape, ElementDescriptor, TopTools_ShapeMapHasher> descriptorCache_;
+    mutable std::size_t descriptorCacheReleaseAt_{kDescriptorCacheMinRelease};
+    mutable DescriptorCacheStats descriptorCacheStats_;
+    std::size_t updateThreads_{std::max(1u, std::thread::hardware_concurrency())};
+};
+
+// Exact lowest-score lookup over rebindBody() candidates. Candidates arrive sorted by
+// DescriptorKey, so each (shape, surface, curve) type is a contiguous bucket; every bucket
+// gets a k-d tree over descriptor center, size and magnitude. A node's bound never exceeds
+// score() of anything below it, so branch and bound returns the same candidate as a linear
+// scan: the lowest score, ties going to the lowest index.
+class ElementMap::CandidateIndex {
+public:
+    CandidateIndex(const ElementMap& map, std::vector<const ElementDescriptor*> descriptors);
+
+    // Unassigned candidate scoring lowest against target, or -1 if none is left.
+    int findBest(const ElementDescriptor& target) const;
+    void markAssigned(std::size_t index);
+
+private:
+    static constexpr std::size_t kLeafSize = 8;
+    static constexpr int kDims = 5;  // center x, y, z, size, magnitude
+
+    struct Node {
+        double lo[kDims];
+        double hi[kDims];
+        std::size_t begin{0};
+        std::size_t end{0};
+        std::size_t alive{0};
+        int left{-1};
+        int right{-1};
+        int parent{-1};
+    };
+
+    struct Bucket {
+        const ElementDescriptor* sample{nullptr};
+        int root{-1};
+    };
+
+    static double coord(const ElementDescriptor& descriptor, int dim);
+    int build(std::size_t begin, std::size_t end, int parent);
+    double bound(const Node& node, const ElementDescriptor& target) const;
+    void search(int nodeIndex, const ElementDescriptor& target, double penalty,
+                double& bestScore, int& bestIndex) const;
+
+    const ElementMap& map_;
+    std::vector<const ElementDescriptor*> descriptors_;
+    std::vector<std::size_t> order_;  // Candidate indices, grouped by node
+    std::vector<int> leafOf_;         // Candidate index -> leaf node
+    std::vector<bool> assigned_;
+    std::vector<Node> nodes_;
+    std::vector<Bucket> buckets_;
 };
 
 // --- Inline implementation -------------------------------------------------
@@ -224,9 +371,40 @@ inline std::vector<ElementId> ElementMap::findIdsByShape(const TopoDS_Shape& sha
     return out;
 }
 
+inline ElementHandle ElementMap::findHandleByShape(const TopoDS_Shape& shape) const {
+    TopoDS_Shape normalized = normalizeShape(shape);
+    if (normalized.IsNull() || !shapeToIds_.IsBound(normalized)) {
+        return {};
+    }
+    const std::vector<std::string>& ids = shapeToIds_.Find(normalized);
+    return ids.empty() ? ElementHandle{} : internElementId(ids.front());
+}
+
 inline void ElementMap::clear() {
     entries_.clear();
+    bodyIndex_.bodies.clear();
+    bodyIndex_.valid = true;
     shapeToIds_.Clear();
+    descriptorCache_.Clear();
+    descriptorCacheReleaseAt_ = kDescriptorCacheMinRelease;
+}
+
+inline void ElementMap::setDescriptorCacheEnabled(bool enabled) {
+    descriptorCacheEnabled_ = enabled;
+    if (!enabled) {
+        descriptorCache_.Clear();
+        descriptorCacheReleaseAt_ = kDescriptorCacheMinRelease;
+    }
+}
+
+inline DescriptorCacheStats ElementMap::descriptorCacheStats() const {
+    DescriptorCacheStats stats = descriptorCacheStats_;
+    stats.size = static_cast<std::size_t>(descriptorCache_.Extent());
+    return stats;
+}
+
+inline void ElementMap::resetDescriptorCacheStats() {
+    descriptorCacheStats_ = DescriptorCacheStats{};
 }
 
 inline void ElementMap::clearShape(const ElementId& id) {
@@ -240,22 +418,86 @@ inline void ElementMap::clearShape(const ElementId& id) {
     it->second.shape.Nullify();
 }
 
+inline void ElementMap::indexEntry(const Entry& entry) const {
+    if (!bodyIndex_.valid) {
+        return;
+    }
+    bodyIndex_.bodies[std::string(bodyIdOf(entry.id.value))][static_cast<std::size_t>(entry.kind)].insert(&entry);
+}
+
+inline void ElementMap::unindexEntry(const Entry& entry) const {
+    if (!bodyIndex_.valid) {
+        return;
+    }
+    auto it = bodyIndex_.bodies.find(std::string(bodyIdOf(entry.id.value)));
+    if (it == bodyIndex_.bodies.end()) {
+        return;
+    }
+    it->second[static_cast<std::size_t>(entry.kind)].erase(&entry);
+    if (std::all_of(it->second.begin(), it->second.end(), [](const auto& set) { return set.empty(); })) {
+        bodyIndex_.bodies.erase(it);
+    }
+}
+
+inline const ElementMap::BodyIndex::KindSets* ElementMap::findBodyIndex(const std::string& bodyId) const {
+    if (!bodyIndex_.valid) {
+        bodyIndex_.bodies.clear();
+        bodyIndex_.valid = true;
+        for (const auto& [key, entry] : entries_) {
+            indexEntry(entry);
+        }
+    }
+    auto it = bodyIndex_.bodies.find(bodyId);
+    return it != bodyIndex_.bodies.end() ? &it->second : nullptr;
+}
+
 inline void ElementMap::removeElementsForBody(const std::string& bodyId) {
     if (bodyId.empty()) {
         return;
     }
-    const std::string prefix = bodyId + "/";
-    for (auto it = entries_.begin(); it != entries_.end();) {
-        const std::string& id = it->first;
-        if (id == bodyId || id.rfind(prefix, 0) == 0) {
-            if (!it->second.shape.IsNull()) {
-                unbindShape(it->second.shape, it->second.id);
+    const BodyIndex::KindSets* sets = findBodyIndex(bodyId);
+    if (!sets) {
+        return;
+    }
+    std::vector<std::string> ids;
+    for (const auto& set : *sets) {
+        for (const Entry* entry : set) {
+            ids.push_back(entry->id.value);
+            if (!entry->shape.IsNull()) {
+                unbindShape(entry->shape, entry->id);
+            }
+        }
+    }
+    bodyIndex_.bodies.erase(bodyId);
+    for (const auto& id : ids) {
+        entries_.erase(id);
+    }
+}
+
+inline std::vector<Entry> ElementMap::bodyEntries(const std::string& bodyId) const {
+    std::vector<Entry> out;
+    if (bodyId.empty()) {
+        return out;
+    }
+    if (const BodyIndex::KindSets* sets = findBodyIndex(bodyId)) {
+        for (const auto& set : *sets) {
+            for (const Entry* entry : set) {
+                out.push_back(*entry);
             }
-            it = entries_.erase(it);
-        } else {
-            ++it;
         }
     }
+    std::sort(out.begin(), out.end(),
+              [](const Entry& a, const Entry& b) {
+                  return a.id.value < b.id.value;
+              });
+    return out;
+}
+
+inline void ElementMap::restoreBodyEntries(const std::string& bodyId, const std::vector<Entry>& entries) {
+    removeElementsForBody(bodyId);
+    for (const auto& entry : entries) {
+        upsertEntry(entry.id, entry.kind, entry.shape, entry.descriptor, entry.opId, entry.sources);
+    }
 }
 
 inline void ElementMap::rebindBody(const std::string& bodyId, const TopoDS_Shape& shape,
@@ -279,15 +521,10 @@ inline void ElementMap::rebindBody(const std::string& bodyId, const TopoDS_Shape
     };
 
     auto collectEntries = [&](ElementKind kind) {
-        std::vector<Entry*> entries;
-        const std::string prefix = bodyId + "/";
-        for (auto& [key, entry] : entries_) {
-            if (entry.kind != kind) {
-                continue;
-            }
-            if (entry.id.value == bodyId || entry.id.value.rfind(prefix, 0) == 0) {
-                entries.push_back(&entry);
-            }
+        std::vector<const Entry*> entries;
+        if (const BodyIndex::KindSets* sets = findBodyIndex(bodyId)) {
+            const auto& set = (*sets)[static_cast<std::size_t>(kind)];
+            entries.assign(set.begin(), set.end());
         }
         std::sort(entries.begin(), entries.end(),
                   [](const Entry* a, const Entry* b) {
@@ -322,23 +559,44 @@ inline void ElementMap::rebindBody(const std::string& bodyId, const TopoDS_Shape
         auto entries = collectEntries(kind);
         auto candidates = collectCandidates(shapeKind);
 
-        for (auto* entry : entries) {
+        // Greedy in entry-ID order; the index only speeds up each entry's lookup.
+        std::optional<CandidateIndex> index;
+        if (!entries.empty() && candidates.size() >= indexedRebindThreshold_) {
+            std::vector<const ElementDescriptor*> descriptors;
+            descriptors.reserve(candidates.size());
+            for (const auto& candidate : candidates) {
+                descriptors.push_back(&candidate.descriptor);
+            }
+            index.emplace(*this, std::move(descriptors));
+        }
+
+        for (const Entry* entry : entries) {
             double bestScore = std::numeric_limits<double>::max();
             int bestIndex = -1;
-            for (std::size_t i = 0; i < candidates.size(); ++i) {
-                if (candidates[i].assigned) {
-                    continue;
-                }
-                double currentScore = score(entry->descriptor, candidates[i].descriptor);
-                if (currentScore < bestScore) {
-                    bestScore = currentScore;
-                    bestIndex = static_cast<int>(i);
+            if (index) {
+                bestIndex = index->findBest(entry->descriptor);
+            } else {
+                for (std::size_t i = 0; i < candidates.size(); ++i) {
+                    if (candidates[i].assigned) {
+                        continue;
+                    }
+                    double currentScore = score(entry->descriptor, candidates[i].descriptor);
+                    if (currentScore < bestScore) {
+                        bestScore = currentScore;
+                        bestIndex = static_cast<int>(i);
+                    }
                 }
             }
 
             if (bestIndex >= 0) {
-                attachShape(entry->id, candidates[bestIndex].shape, opId);
+                // Elements the op left untouched keep the op that last generated or modified them.
+                const bool unchanged = !entry->shape.IsNull() &&
+                                       entry->shape.IsSame(candidates[bestIndex].shape);
+                attachShape(entry->id, candidates[bestIndex].shape, unchanged ? std::string{} : opId);
                 candidates[bestIndex].assigned = true;
+                if (index) {
+                    index->markAssigned(static_cast<std::size_t>(bestIndex));
+                }
             } else {
                 clearShape(entry->id);
             }
@@ -360,6 +618,174 @@ inline void ElementMap::rebindBody(const std::string& bodyId, const TopoDS_Shape
     matchKind(ElementKind::Vertex, TopAbs_VERTEX);
 }
 
+inline ElementMap::CandidateIndex::CandidateIndex(const ElementMap& map,
+                                                  std::vector<const ElementDescriptor*> descriptors)
+    : map_(map),
+      descriptors_(std::move(descriptors)),
+      order_(descriptors_.size()),
+      leafOf_(descriptors_.size(), -1),
+      assigned_(descriptors_.size(), false) {
+    for (std::size_t i = 0; i < order_.size(); ++i) {
+        order_[i] = i;
+    }
+    nodes_.reserve(2 * (descriptors_.size() / kLeafSize + 1));
+
+    std::size_t begin = 0;
+    while (begin < descriptors_.size()) {
+        const ElementDescriptor& first = *descriptors_[begin];
+        std::size_t end = begin + 1;
+        while (end < descriptors_.size() &&
+               descriptors_[end]->shapeType == first.shapeType &&
+               descriptors_[end]->surfaceType == first.surfaceType &&
+               descriptors_[end]->curveType == first.curveType) {
+            ++end;
+        }
+        buckets_.push_back(Bucket{&first, build(begin, end, -1)});
+        begin = end;
+    }
+}
+
+inline double ElementMap::CandidateIndex::coord(const ElementDescriptor& descriptor, int dim) {
+    switch (dim) {
+    case 0: return descriptor.center.X();
+    case 1: return descriptor.center.Y();
+    case 2: return descriptor.center.Z();
+    case 3: return descriptor.size;
+    default: return descriptor.magnitude;
+    }
+}
+
+inline int ElementMap::CandidateIndex::build(std::size_t begin, std::size_t end, int parent) {
+    const int nodeIndex = static_cast<int>(nodes_.size());
+    nodes_.emplace_back();
+    {
+        Node& node = nodes_.back();
+        node.begin = begin;
+        node.end = end;
+        node.alive = end - begin;
+        node.parent = parent;
+        for (int dim = 0; dim < kDims; ++dim) {
+            node.lo[dim] = std::numeric_limits<double>::max();
+            node.hi[dim] = std::numeric_limits<double>::lowest();
+        }
+        for (std::size_t i = begin; i < end; ++i) {
+            for (int dim = 0; dim < kDims; ++dim) {
+                const double value = coord(*descriptors_[order_[i]], dim);
+                node.lo[dim] = std::min(node.lo[dim], value);
+                node.hi[dim] = std::max(node.hi[dim], value);
+            }
+        }
+    }
+
+    if (end - begin <= kLeafSize) {
+        for (std::size_t i = begin; i < end; ++i) {
+            leafOf_[order_[i]] = nodeIndex;
+        }
+        return nodeIndex;
+    }
+
+    // Split on the widest center axis; size and magnitude only tighten the bounds.
+    int axis = 0;
+    for (int dim = 1; dim < 3; ++dim) {
+        const Node& node = nodes_[static_cast<std::size_t>(nodeIndex)];
+        if (node.hi[dim] - node.lo[dim] > node.hi[axis] - node.lo[axis]) {
+            axis = dim;
+        }
+    }
+    const std::size_t mid = begin + (end - begin) / 2;
+    std::nth_element(order_.begin() + static_cast<std::ptrdiff_t>(begin),
+                     order_.begin() + static_cast<std::ptrdiff_t>(mid),
+                     order_.begin() + static_cast<std::ptrdiff_t>(end),
+                     [&](std::size_t a, std::size_t b) {
+                         const double ca = coord(*descriptors_[a], axis);
+                         const double cb = coord(*descriptors_[b], axis);
+                         return ca != cb ? ca < cb : a < b;
+                     });
+    const int left = build(begin, mid, nodeIndex);
+    const int right = build(mid, end, nodeIndex);
+    nodes_[static_cast<std::size_t>(nodeIndex)].left = left;
+    nodes_[static_cast<std::size_t>(nodeIndex)].right = right;
+    return nodeIndex;
+}
+
+inline double ElementMap::CandidateIndex::bound(const Node& node, const ElementDescriptor& target) const {
+    double gap[kDims];
+    for (int dim = 0; dim < kDims; ++dim) {
+        const double value = coord(target, dim);
+        gap[dim] = std::max({node.lo[dim] - value, 0.0, value - node.hi[dim]});
+    }
+    // Mirrors the distance terms of score(); its remaining terms are never negative.
+    const double centerDistance = std::sqrt(gap[0] * gap[0] + gap[1] * gap[1] + gap[2] * gap[2]);
+    return centerDistance + 0.1 * gap[3] + 0.01 * gap[4];
+}
+
+inline void ElementMap::CandidateIndex::search(int nodeIndex, const ElementDescriptor& target,
+                                               double penalty, double& bestScore, int& bestIndex) const {
+    // Slack absorbs rounding differences between bound() and score(); it only costs pruning.
+    constexpr double kSlack = 1e-9;
+    const Node& node = nodes_[static_cast<std::size_t>(nodeIndex)];
+    if (node.alive == 0 || bound(node, target) + penalty > bestScore + kSlack * (1.0 + std::abs(bestScore))) {
+        return;
+    }
+
+    if (node.left < 0) {
+        for (std::size_t i = node.begin; i < node.end; ++i) {
+            const std::size_t candidate = order_[i];
+            if (assigned_[candidate]) {
+                continue;
+            }
+            const double currentScore = map_.score(target, *descriptors_[candidate]);
+            const int currentIndex = static_cast<int>(candidate);
+            if (currentScore < bestScore || (currentScore == bestScore && currentIndex < bestIndex)) {
+                bestScore = currentScore;
+                bestIndex = currentIndex;
+            }
+        }
+        return;
+    }
+
+    int first = node.left;
+    int second = node.right;
+    if (bound(nodes_[static_cast<std::size_t>(second)], target) <
+        bound(nodes_[static_cast<std::size_t>(first)], target)) {
+        std::swap(first, second);
+    }
+    search(first, target, penalty, bestScore, bestIndex);
+    search(second, target, penalty, bestScore, bestIndex);
+}
+
+inline int ElementMap::CandidateIndex::findBest(const ElementDescriptor& target) const {
+    // Type mismatches add a fixed amount to score(); visit the cheapest buckets first.
+    std::vector<std::pair<double, int>> visits;
+    visits.reserve(buckets_.size());
+    for (std::size_t i = 0; i < buckets_.size(); ++i) {
+        const ElementDescriptor& sample = *buckets_[i].sample;
+        double penalty = 0.0;
+        if (target.shapeType != sample.shapeType) penalty += 1000.0;
+        if (target.surfaceType != sample.surfaceType) penalty += 10.0;
+        if (target.curveType != sample.curveType) penalty += 5.0;
+        visits.emplace_back(penalty, buckets_[i].root);
+    }
+    std::sort(visits.begin(), visits.end());
+
+    double bestScore = std::numeric_limits<double>::max();
+    int bestIndex = -1;
+    for (const auto& [penalty, root] : visits) {
+        search(root, target, penalty, bestScore, bestIndex);
+    }
+    return bestIndex;
+}
+
+inline void ElementMap::CandidateIndex::markAssigned(std::size_t index) {
+    if (index >= assigned_.size() || assigned_[index]) {
+        return;
+    }
+    assigned_[index] = true;
+    for (int node = leafOf_[index]; node >= 0; node = nodes_[static_cast<std::size_t>(node)].parent) {
+        --nodes_[static_cast<std::size_t>(node)].alive;
+    }
+}
+
 inline bool ElementMap::DescriptorKey::operator<(const DescriptorKey& other) const {
     if (shapeType != other.shapeType) return shapeType < other.shapeType;
     if (surfaceType != other.surfaceType) return surfaceType < other.surfaceType;
@@ -379,13 +805,69 @@ inline bool ElementMap::DescriptorKey::operator<(const DescriptorKey& other) con
 }
 
 inline ElementDescriptor ElementMap::computeDescriptor(const TopoDS_Shape& shape) const {
+    if (shape.IsNull() || !descriptorCacheEnabled_) {
+        return measureDescriptor(shape);
+    }
+    if (const ElementDescriptor* cached = descriptorCache_.Seek(shape)) {
+        ++descriptorCacheStats_.hits;
+        return *cached;
+    }
+    ++descriptorCacheStats_.misses;
+
+    ElementDescriptor descriptor = measureDescriptor(shape);
+    storeDescriptor(shape, descriptor);
+    return descriptor;
+}
+
+inline void ElementMap::storeDescriptor(const TopoDS_Shape& shape, const ElementDescriptor& descriptor) const {
+    if (static_cast<std::size_t>(descriptorCache_.Extent()) >= descriptorCacheReleaseAt_) {
+        releaseUnusedDescriptors();
+    }
+    descriptorCache_.Bind(shape, descriptor);
+}
+
+inline void ElementMap::releaseUnusedDescriptors() const {
+    // A key whose TShape only the cache references belongs to a released shape. Parents hold
+    // their sub-shapes, so solids go before faces, faces before edges, and so on down.
+    using CacheIterator = NCollection_DataMap<TopoDS_Shape, ElementDescriptor, TopTools_ShapeMapHasher>::Iterator;
+    for (int type = TopAbs_COMPOUND; type <= TopAbs_VERTEX; ++type) {
+        // Keys differing only in Location share a TShape; each holds one reference.
+        std::unordered_map<const TopoDS_TShape*, int> cacheRefs;
+        for (CacheIterator it(descriptorCache_); it.More(); it.Next()) {
+            if (it.Key().ShapeType() == static_cast<TopAbs_ShapeEnum>(type)) {
+                ++cacheRefs[it.Key().TShape().get()];
+            }
+        }
+        std::unordered_set<const TopoDS_TShape*> unused;
+        for (const auto& [tshape, refs] : cacheRefs) {
+            if (tshape->GetRefCount() == refs) {
+                unused.insert(tshape);
+            }
+        }
+        std::vector<TopoDS_Shape> released;
+        for (CacheIterator it(descriptorCache_); it.More(); it.Next()) {
+            if (unused.count(it.Key().TShape().get()) > 0) {
+                released.push_back(it.Key());
+            }
+        }
+        for (const auto& key : released) {
+            descriptorCache_.UnBind(key);
+        }
+        descriptorCacheStats_.released += released.size();
+    }
+    descriptorCacheReleaseAt_ = std::max(kDescriptorCacheMinRelease,
+                                         2 * static_cast<std::size_t>(descriptorCache_.Extent()));
+}
+
+inline ElementDescriptor ElementMap::measureDescriptor(const TopoDS_Shape& shape) const {
     ElementDescriptor desc;
     if (shape.IsNull()) return desc;
 
     desc.shapeType = shape.ShapeType();
 
     Bnd_Box box;
-    BRepBndLib::Add(shape, box);
+    // Geometry only, so the descriptor does not depend on whether or how finely the shape is meshed.
+    BRepBndLib::Add(shape, box, Standard_False);
     if (!box.IsVoid()) {
         Standard_Real xmin, ymin, zmin, xmax, ymax, zmax;
         box.Get(xmin, ymin, zmin, xmax, ymax, zmax);
@@ -650,12 +1132,17 @@ inline void ElementMap::upsertEntry(const ElementId& id, ElementKind kind, const
                                     const ElementDescriptor& descriptor, const std::string& opId,
                                     std::vector<ElementId> sources) {
     auto it = entries_.find(id.value);
-    if (it != entries_.end() && !it->second.shape.IsNull()) {
-        unbindShape(it->second.shape, id);
+    if (it != entries_.end()) {
+        if (!it->second.shape.IsNull()) {
+            unbindShape(it->second.shape, id);
+        }
+        unindexEntry(it->second);
     }
 
     Entry entry{ id, kind, shape, descriptor, opId, std::move(sources) };
-    entries_[id.value] = entry;
+    Entry& stored = entries_[id.value];
+    stored = std::move(entry);
+    indexEntry(stored);
     bindShape(shape, id);
 }
 
@@ -729,6 +1216,126 @@ inline std::vector<ElementId> ElementMap::update(BRepAlgoAPI_BooleanOperation& a
         std::vector<ElementId> sources;
     };
 
+    struct Candidate {
+        TopoDS_Shape shape;
+        ElementDescriptor descriptor;
+        DescriptorKey key;
+        double score{0.0};
+        bool cached{false};
+    };
+
+    // What the boolean did to one tracked entry. History lists are copied serially, since
+    // BRepAlgoAPI_BuilderAlgo may answer from a shared scratch list; candidates are measured,
+    // scored and sorted in parallel; everything order-dependent happens in the commit loop.
+    struct EntryPlan {
+        Entry* entry{nullptr};
+        bool deleted{false};
+        TopTools_ListOfShape modifiedShapes;
+        TopTools_ListOfShape generatedShapes;
+        std::vector<Candidate> modified;   // Sorted by key
+        std::optional<Candidate> best;     // Lowest-scoring modified shape
+        std::vector<Candidate> generated;  // Sorted by key
+    };
+
+    std::vector<EntryPlan> plans;
+    plans.reserve(entries_.size());
+    for (auto& [key, entry] : entries_) {
+        if (entry.shape.IsNull()) {
+            continue;
+        }
+        EntryPlan plan;
+        plan.entry = &entry;
+        plan.deleted = algo.IsDeleted(entry.shape);
+        if (!plan.deleted) {
+            plan.modifiedShapes = algo.Modified(entry.shape);
+            plan.generatedShapes = algo.Generated(entry.shape);
+        }
+        plans.push_back(std::move(plan));
+    }
+
+    // Read-only: the descriptor cache is only looked up here and filled during the commit.
+    auto measure = [this](const TopoDS_Shape& shape) {
+        Candidate candidate;
+        candidate.shape = shape;
+        const ElementDescriptor* cached =
+            descriptorCacheEnabled_ && !shape.IsNull() ? descriptorCache_.Seek(shape) : nullptr;
+        candidate.cached = cached != nullptr;
+        candidate.descriptor = cached ? *cached : measureDescriptor(shape);
+        candidate.key = makeKey(candidate.descriptor);
+        return candidate;
+    };
+    auto planEntry = [&](EntryPlan& plan) {
+        if (plan.modifiedShapes.Extent() == 1) {
+            if (!plan.modifiedShapes.First().IsNull()) {
+                plan.best = measure(plan.modifiedShapes.First());
+            }
+        } else if (!plan.modifiedShapes.IsEmpty()) {
+            plan.modified.reserve(static_cast<std::size_t>(plan.modifiedShapes.Extent()));
+            for (TopTools_ListIteratorOfListOfShape it(plan.modifiedShapes); it.More(); it.Next()) {
+                Candidate candidate = measure(it.Value());
+                candidate.score = score(plan.entry->descriptor, candidate.descriptor);
+                plan.modified.push_back(std::move(candidate));
+            }
+            plan.best = *std::min_element(plan.modified.begin(), plan.modified.end(),
+                                          [](const Candidate& a, const Candidate& b) {
+                                              if (a.score != b.score) {
+                                                  return a.score < b.score;
+                                              }
+                                              return a.key < b.key;
+                                          });
+            std::sort(plan.modified.begin(), plan.modified.end(),
+                      [](const Candidate& a, const Candidate& b) {
+                          return a.key < b.key;
+                      });
+        }
+
+        plan.generated.reserve(static_cast<std::size_t>(plan.generatedShapes.Extent()));
+        for (TopTools_ListIteratorOfListOfShape it(plan.generatedShapes); it.More(); it.Next()) {
+            plan.generated.push_back(measure(it.Value()));
+        }
+        std::sort(plan.generated.begin(), plan.generated.end(),
+                  [](const Candidate& a, const Candidate& b) {
+                      return a.key < b.key;
+                  });
+    };
+
+    const std::size_t workerCount =
+        plans.size() >= kParallelUpdateMinEntries ? std::min(updateThreads_, plans.size()) : 1;
+    if (workerCount <= 1) {
+        for (auto& plan : plans) {
+            planEntry(plan);
+        }
+    } else {
+        std::atomic<std::size_t> next{0};
+        std::mutex errorMutex;
+        std::exception_ptr error;
+        auto worker = [&]() {
+            try {
+                for (std::size_t k = next.fetch_add(1); k < plans.size(); k = next.fetch_add(1)) {
+                    planEntry(plans[k]);
+                }
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                next.store(plans.size());
+            }
+        };
+        std::vector<std::thread> threads;
+        threads.reserve(workerCount - 1);
+        for (std::size_t t = 1; t < workerCount; ++t) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
     std::vector<PendingEntry> pending;
     std::unordered_map<std::string, std::size_t> pendingById;
     NCollection_DataMap<TopoDS_Shape, std::vector<std::string>, TopTools_ShapeMapHasher> pendingShapeToIds;
@@ -784,122 +1391,50 @@ inline std::vector<ElementId> ElementMap::update(BRepAlgoAPI_BooleanOperation& a
         }
     };
 
-    for (auto& [key, entry] : entries_) {
-        const TopoDS_Shape oldShape = entry.shape;
-        if (oldShape.IsNull()) {
-            continue;
+    auto recordMeasured = [&](const Candidate& candidate) {
+        if (!descriptorCacheEnabled_ || candidate.shape.IsNull()) {
+            return;
+        }
+        if (candidate.cached) {
+            ++descriptorCacheStats_.hits;
+        } else {
+            ++descriptorCacheStats_.misses;
+            storeDescriptor(candidate.shape, candidate.descriptor);
         }
+    };
 
-        if (algo.IsDeleted(oldShape)) {
+    // Commit in the order entries_ was walked, exactly as a serial pass would.
+    for (auto& plan : plans) {
+        Entry& entry = *plan.entry;
+        const TopoDS_Shape oldShape = entry.shape;
+
+        if (plan.deleted) {
             deleted.push_back(entry.id);
-            toErase.emplace_back(key, oldShape);
+            toErase.emplace_back(entry.id.value, oldShape);
             continue;
         }
 
-        const TopTools_ListOfShape& modified = algo.Modified(oldShape);
-        if (!modified.IsEmpty()) {
-            if (modified.Extent() == 1) {
-                const TopoDS_Shape best = modified.First();
-                if (!best.IsNull()) {
-                    unbindShape(oldShape, entry.id);
-                    entry.shape = best;
-                    entry.descriptor = computeDescriptor(best);
-                    entry.opId = opId;
-                    bindShape(entry.shape, entry.id);
-                }
-            } else {
-                struct Candidate {
-                    TopoDS_Shape shape;
-                    ElementDescriptor descriptor;
-                    DescriptorKey key;
-                    double score{0.0};
-                };
-
-                std::vector<Candidate> candidates;
-                candidates.reserve(modified.Extent());
-                for (TopTools_ListIteratorOfListOfShape it(modified); it.More(); it.Next()) {
-                    const TopoDS_Shape& candidateShape = it.Value();
-                    ElementDescriptor descriptor = computeDescriptor(candidateShape);
-                    candidates.push_back(Candidate{
-                        candidateShape,
-                        descriptor,
-                        makeKey(descriptor),
-                        score(entry.descriptor, descriptor)
-                    });
-                }
-
-                auto bestIt = std::min_element(candidates.begin(), candidates.end(),
-                                               [](const Candidate& a, const Candidate& b) {
-                                                   if (a.score != b.score) {
-                                                       return a.score < b.score;
-                                                   }
-                                                   return a.key < b.key;
-                                               });
-
-                if (bestIt != candidates.end()) {
-                    unbindShape(oldShape, entry.id);
-                    entry.shape = bestIt->shape;
-                    entry.descriptor = bestIt->descriptor;
-                    entry.opId = opId;
-                    bindShape(entry.shape, entry.id);
-
-                    std::sort(candidates.begin(), candidates.end(),
-                              [](const Candidate& a, const Candidate& b) {
-                                  return a.key < b.key;
-                              });
-
-                    for (std::size_t index = 0; index < candidates.size(); ++index) {
-                        const Candidate& candidate = candidates[index];
-                        if (candidate.shape.IsSame(entry.shape)) {
-                            continue;
-                        }
-
-                        const auto existingIds = collectIdsByShape(candidate.shape);
-                        if (!existingIds.empty()) {
-                            for (const auto& existingId : existingIds) {
-                                addSourceToId(existingId, entry.id);
-                            }
-                            continue;
-                        }
-
-                        ElementId childId = makeChildId(entry.id, entry.kind, candidate.descriptor, opId,
-                                                        ChildReason::Split, index);
-                        registerPending(PendingEntry{
-                            childId,
-                            entry.kind,
-                            candidate.shape,
-                            candidate.descriptor,
-                            opId,
-                            {entry.id}
-                        });
-                    }
+        if (plan.modified.empty() && plan.best) {
+            recordMeasured(*plan.best);
+            unbindShape(oldShape, entry.id);
+            entry.shape = plan.best->shape;
+            entry.descriptor = plan.best->descriptor;
+            entry.opId = opId;
+            bindShape(entry.shape, entry.id);
+        } else if (plan.best) {
+            unbindShape(oldShape, entry.id);
+            entry.shape = plan.best->shape;
+            entry.descriptor = plan.best->descriptor;
+            entry.opId = opId;
+            bindShape(entry.shape, entry.id);
+
+            for (std::size_t index = 0; index < plan.modified.size(); ++index) {
+                const Candidate& candidate = plan.modified[index];
+                recordMeasured(candidate);
+                if (candidate.shape.IsSame(entry.shape)) {
+                    continue;
                 }
-            }
-        }
-
-        const TopTools_ListOfShape& generated = algo.Generated(oldShape);
-        if (!generated.IsEmpty()) {
-            struct GeneratedCandidate {
-                TopoDS_Shape shape;
-                ElementDescriptor descriptor;
-                DescriptorKey key;
-            };
-
-            std::vector<GeneratedCandidate> candidates;
-            candidates.reserve(generated.Extent());
-            for (TopTools_ListIteratorOfListOfShape git(generated); git.More(); git.Next()) {
-                const TopoDS_Shape& child = git.Value();
-                ElementDescriptor descriptor = computeDescriptor(child);
-                candidates.push_back(GeneratedCandidate{child, descriptor, makeKey(descriptor)});
-            }
 
-            std::sort(candidates.begin(), candidates.end(),
-                      [](const GeneratedCandidate& a, const GeneratedCandidate& b) {
-                          return a.key < b.key;
-                      });
-
-            for (std::size_t index = 0; index < candidates.size(); ++index) {
-                const GeneratedCandidate& candidate = candidates[index];
                 const auto existingIds = collectIdsByShape(candidate.shape);
                 if (!existingIds.empty()) {
                     for (const auto& existingId : existingIds) {
@@ -908,12 +1443,11 @@ inline std::vector<ElementId> ElementMap::update(BRepAlgoAPI_BooleanOperation& a
                     continue;
                 }
 
-                ElementKind childKind = inferKind(candidate.shape, entry.kind);
-                ElementId childId = makeChildId(entry.id, childKind, candidate.descriptor, opId,
-                                                ChildReason::Generated, index);
+                ElementId childId = makeChildId(entry.id, entry.kind, candidate.descriptor, opId,
+                                                ChildReason::Split, index);
                 registerPending(PendingEntry{
                     childId,
-                    childKind,
+                    entry.kind,
                     candidate.shape,
                     candidate.descriptor,
                     opId,
@@ -921,15 +1455,40 @@ inline std::vector<ElementId> ElementMap::update(BRepAlgoAPI_BooleanOperation& a
                 });
             }
         }
+
+        for (std::size_t index = 0; index < plan.generated.size(); ++index) {
+            const Candidate& candidate = plan.generated[index];
+            recordMeasured(candidate);
+            const auto existingIds = collectIdsByShape(candidate.shape);
+            if (!existingIds.empty()) {
+                for (const auto& existingId : existingIds) {
+                    addSourceToId(existingId, entry.id);
+                }
+                continue;
+            }
+
+            ElementKind childKind = inferKind(candidate.shape, entry.kind);
+            ElementId childId = makeChildId(entry.id, childKind, candidate.descriptor, opId,
+                                            ChildReason::Generated, index);
+            registerPending(PendingEntry{
+                childId,
+                childKind,
+                candidate.shape,
+                candidate.descriptor,
+                opId,
+                {entry.id}
+            });
+        }
     }
 
     for (auto const& [idKey, shape] : toErase) {
         if (auto it = entries_.find(idKey); it != entries_.end()) {
             unbindShape(shape, it->second.id);
+            unindexEntry(it->second);
+            entries_.erase(it);
         } else {
             unbindShape(shape);
         }
-        entries_.erase(idKey);
     }
 
     for (auto& entry : pending) {
@@ -980,6 +1539,12 @@ inline bool ElementMap::write(std::ostream& os) const {
 inline bool ElementMap::read(std::istream& is) {
     clear();
 
+    // A v1 header starts with 'E', a v2 image with its magic.
+    if (is.peek() == format::kMagic[0]) {
+        const std::string data{std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>()};
+        return fromBinary(data.data(), data.size());
+    }
+
     std::string header;
     std::getline(is, header);
     if (header != "ElementMap v1") {
@@ -1092,6 +1657,187 @@ inline bool ElementMap::read(std::istream& is) {
     return true;
 }
 
+inline std::string ElementMap::toBinary() const {
+    using namespace format;
+
+    struct Row {
+        std::string_view owner;
+        const Entry* entry;
+    };
+    std::vector<Row> rows;
+    rows.reserve(entries_.size());
+    for (const auto& [key, entry] : entries_) {
+        const std::string_view id(entry.id.value);
+        rows.push_back(Row{id.substr(0, id.find('/')), &entry});
+    }
+    std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) {
+        if (a.owner != b.owner) {
+            return a.owner < b.owner;
+        }
+        return a.entry->id.value < b.entry->id.value;
+    });
+
+    std::vector<std::string_view> strings;
+    std::unordered_map<std::string_view, std::uint32_t> stringIndex;
+    auto intern = [&](std::string_view value) {
+        auto [it, inserted] = stringIndex.emplace(value, static_cast<std::uint32_t>(strings.size()));
+        if (inserted) {
+            strings.push_back(value);
+        }
+        return it->second;
+    };
+
+    std::vector<EntryRecord> records;
+    std::vector<std::uint32_t> sources;
+    std::vector<BodySection> bodies;
+    records.reserve(rows.size());
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        const Entry& entry = *rows[i].entry;
+        if (bodies.empty() || strings[bodies.back().bodyId] != rows[i].owner) {
+            bodies.push_back(BodySection{intern(rows[i].owner), 0, i, 0});
+        }
+        ++bodies.back().entryCount;
+
+        EntryRecord record{};
+        record.id = intern(entry.id.value);
+        record.opId = intern(entry.opId);
+        record.sourceBegin = static_cast<std::uint32_t>(sources.size());
+        record.sourceCount = static_cast<std::uint32_t>(entry.sources.size());
+        for (const auto& source : entry.sources) {
+            sources.push_back(intern(source.value));
+        }
+        const ElementDescriptor& d = entry.descriptor;
+        record.kind = static_cast<std::uint8_t>(entry.kind);
+        record.shapeType = static_cast<std::uint8_t>(d.shapeType);
+        record.surfaceType = static_cast<std::uint8_t>(d.surfaceType);
+        record.curveType = static_cast<std::uint8_t>(d.curveType);
+        record.hasNormal = d.hasNormal ? 1 : 0;
+        record.hasTangent = d.hasTangent ? 1 : 0;
+        record.center[0] = d.center.X();
+        record.center[1] = d.center.Y();
+        record.center[2] = d.center.Z();
+        record.size = d.size;
+        record.magnitude = d.magnitude;
+        record.normal[0] = d.normal.X();
+        record.normal[1] = d.normal.Y();
+        record.normal[2] = d.normal.Z();
+        record.tangent[0] = d.tangent.X();
+        record.tangent[1] = d.tangent.Y();
+        record.tangent[2] = d.tangent.Z();
+        record.adjacencyHash = d.adjacencyHash;
+        records.push_back(record);
+    }
+
+    std::vector<std::uint64_t> stringOffsets;
+    stringOffsets.reserve(strings.size() + 1);
+    std::uint64_t blobSize = 0;
+    for (const auto& value : strings) {
+        stringOffsets.push_back(blobSize);
+        blobSize += value.size();
+    }
+    stringOffsets.push_back(blobSize);
+
+    Header header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.headerSize = sizeof(Header);
+    header.stringCount = strings.size();
+    header.stringOffsetsOffset = align8(sizeof(Header));
+    header.stringBlobOffset = header.stringOffsetsOffset + stringOffsets.size() * sizeof(std::uint64_t);
+    header.entryCount = records.size();
+    header.entriesOffset = align8(header.stringBlobOffset + blobSize);
+    header.sourceCount = sources.size();
+    header.sourcesOffset = header.entriesOffset + records.size() * sizeof(EntryRecord);
+    header.bodyCount = bodies.size();
+    header.bodiesOffset = align8(header.sourcesOffset + sources.size() * sizeof(std::uint32_t));
+    header.fileSize = header.bodiesOffset + bodies.size() * sizeof(BodySection);
+
+    std::string image(header.fileSize, '\0');
+    auto put = [&image](std::uint64_t offset, const void* data, std::size_t size) {
+        if (size > 0) {
+            std::memcpy(image.data() + offset, data, size);
+        }
+    };
+    put(0, &header, sizeof(Header));
+    put(header.stringOffsetsOffset, stringOffsets.data(), stringOffsets.size() * sizeof(std::uint64_t));
+    for (std::size_t i = 0; i < strings.size(); ++i) {
+        put(header.stringBlobOffset + stringOffsets[i], strings[i].data(), strings[i].size());
+    }
+    put(header.entriesOffset, records.data(), records.size() * sizeof(EntryRecord));
+    put(header.sourcesOffset, sources.data(), sources.size() * sizeof(std::uint32_t));
+    put(header.bodiesOffset, bodies.data(), bodies.size() * sizeof(BodySection));
+    return image;
+}
+
+inline bool ElementMap::fromBinary(const void* data, std::size_t size) {
+    format::ElementMapView view;
+    if (reinterpret_cast<std::uintptr_t>(data) % alignof(std::uint64_t) == 0) {
+        return view.open(data, size) && readView(view);
+    }
+    std::vector<std::uint64_t> aligned((size + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t));
+    if (size > 0) {
+        std::memcpy(aligned.data(), data, size);
+    }
+    return view.open(aligned.data(), size) && readView(view);
+}
+
+inline bool ElementMap::readView(const format::ElementMapView& view) {
+    clear();
+    if (!view.isOpen()) {
+        return false;
+    }
+
+    const auto validDir = [](const double* v) {
+        return std::isfinite(v[0]) && std::isfinite(v[1]) && std::isfinite(v[2]) &&
+               v[0] * v[0] + v[1] * v[1] + v[2] * v[2] > 1e-24;
+    };
+
+    entries_.reserve(view.entryCount());
+    for (std::size_t i = 0; i < view.entryCount(); ++i) {
+        const format::EntryRecord& record = view.entry(i);
+        const std::string_view id = view.string(record.id);
+        const std::uint32_t* sourceBegin = nullptr;
+        const std::uint32_t* sourceEnd = nullptr;
+        if (id.empty() || record.kind > static_cast<std::uint8_t>(ElementKind::Unknown) ||
+            record.shapeType > static_cast<std::uint8_t>(TopAbs_SHAPE) ||
+            record.surfaceType > static_cast<std::uint8_t>(GeomAbs_OtherSurface) ||
+            record.curveType > static_cast<std::uint8_t>(GeomAbs_OtherCurve) ||
+            (record.hasNormal && !validDir(record.normal)) ||
+            (record.hasTangent && !validDir(record.tangent)) ||
+            !view.sources(record, sourceBegin, sourceEnd)) {
+            clear();
+            return false;
+        }
+
+        std::vector<ElementId> sources;
+        sources.reserve(record.sourceCount);
+        for (const std::uint32_t* source = sourceBegin; source != sourceEnd; ++source) {
+            sources.push_back(ElementId{std::string(view.string(*source))});
+        }
+
+        ElementDescriptor descriptor;
+        descriptor.shapeType = static_cast<TopAbs_ShapeEnum>(record.shapeType);
+        descriptor.surfaceType = static_cast<GeomAbs_SurfaceType>(record.surfaceType);
+        descriptor.curveType = static_cast<GeomAbs_CurveType>(record.curveType);
+        descriptor.center = gp_Pnt(record.center[0], record.center[1], record.center[2]);
+        descriptor.size = record.size;
+        descriptor.magnitude = record.magnitude;
+        descriptor.hasNormal = record.hasNormal != 0;
+        if (descriptor.hasNormal) {
+            descriptor.normal = gp_Dir(record.normal[0], record.normal[1], record.normal[2]);
+        }
+        descriptor.hasTangent = record.hasTangent != 0;
+        if (descriptor.hasTangent) {
+            descriptor.tangent = gp_Dir(record.tangent[0], record.tangent[1], record.tangent[2]);
+        }
+        descriptor.adjacencyHash = record.adjacencyHash;
+
+        registerEntry(ElementId{std::string(id)}, static_cast<ElementKind>(record.kind), descriptor,
+                      std::string(view.string(record.opId)), std::move(sources));
+    }
+    return true;
+}
+
 inline std::string ElementMap::toString() const {
     std::ostringstream oss;
     write(oss);
@@ -1099,6 +1845,9 @@ inline std::string ElementMap::toString() const {
 }
 
 inline bool ElementMap::fromString(const std::string& data) {
+    if (format::hasMagic(data.data(), data.size())) {
+        return fromBinary(data.data(), data.size());
+    }
     std::istringstream iss(data);
     return read(iss);
 }
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+// ElementMap v2: a binary image meant to be used in place (read from a memory-mapped
+// or fully read file) without a parse step. Little-endian, every section 8-byte aligned:
+//
+//   Header
+//   uint64 stringOffsets[stringCount + 1]   byte offsets into the string blob
+//   char   stringBlob[]                     interned IDs, opIds and body IDs, not terminated
+//   EntryRecord entries[entryCount]         grouped by owning body, by ID within a body
+//   uint32 sources[sourceCount]             string indices, referenced by EntryRecord
+//   BodySection bodies[bodyCount]           sorted by body ID
+//
+// The owning body of an entry is its ID up to the first '/', as in ElementMap::bodyEntries().
+
+namespace onecad::kernel::elementmap::format {
+
+static_assert(std::endian::native == std::endian::little,
+              "ElementMap v2 images are little-endian and read in place");
+
+inline constexpr char kMagic[8] = {'O', 'C', 'E', 'M', 'A', 'P', '\0', '\0'};
+inline constexpr std::uint32_t kVersion = 2;
+
+struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t headerSize;
+    std::uint64_t fileSize;
+    std::uint64_t stringCount;
+    std::uint64_t stringOffsetsOffset;
+    std::uint64_t stringBlobOffset;
+    std::uint64_t entryCount;
+    std::uint64_t entriesOffset;
+    std::uint64_t sourceCount;
+    std::uint64_t sourcesOffset;
+    std::uint64_t bodyCount;
+    std::uint64_t bodiesOffset;
+};
+
+struct EntryRecord {
+    std::uint32_t id;            // String index
+    std::uint32_t opId;          // String index
+    std::uint32_t sourceBegin;   // Index into sources
+    std::uint32_t sourceCount;
+    std::uint8_t kind;           // ElementKind
+    std::uint8_t shapeType;      // TopAbs_ShapeEnum
+    std::uint8_t surfaceType;    // GeomAbs_SurfaceType
+    std::uint8_t curveType;      // GeomAbs_CurveType
+    std::uint8_t hasNormal;
+    std::uint8_t hasTangent;
+    std::uint8_t reserved[2];
+    double center[3];
+    double size;
+    double magnitude;
+    double normal[3];
+    double tangent[3];
+    std::uint64_t adjacencyHash;
+};
+
+struct BodySection {
+    std::uint32_t bodyId;        // String index
+    std::uint32_t reserved;
+    std::uint64_t entryBegin;
+    std::uint64_t entryCount;
+};
+
+static_assert(sizeof(Header) == 96);
+static_assert(sizeof(EntryRecord) == 120);
+static_assert(sizeof(BodySection) == 24);
+
+inline constexpr std::size_t align8(std::size_t value) {
+    return (value + 7) & ~static_cast<std::size_t>(7);
+}
+
+inline bool hasMagic(const void* data, std::size_t size) {
+    return size >= sizeof(kMagic) && std::memcmp(data, kMagic, sizeof(kMagic)) == 0;
+}
+
+// Read-only view of a v2 image. open() checks the header and section bounds once;
+// records are then read straight from the buffer, which must outlive the view and be
+// 8-byte aligned.
+class ElementMapView {
+public:
+    bool open(const void* data, std::size_t size) {
+        base_ = static_cast<const char*>(data);
+        size_ = size;
+        header_ = nullptr;
+        if (!base_ || reinterpret_cast<std::uintptr_t>(base_) % alignof(std::uint64_t) != 0 ||
+            size < sizeof(Header) || !hasMagic(base_, size)) {
+            return false;
+        }
+        const auto* header = reinterpret_cast<const Header*>(base_);
+        if (header->version != kVersion || header->headerSize != sizeof(Header) || header->fileSize != size) {
+            return false;
+        }
+        if (!fits(header->stringOffsetsOffset, header->stringCount + 1, sizeof(std::uint64_t)) ||
+            !fits(header->entriesOffset, header->entryCount, sizeof(EntryRecord)) ||
+            !fits(header->sourcesOffset, header->sourceCount, sizeof(std::uint32_t)) ||
+            !fits(header->bodiesOffset, header->bodyCount, sizeof(BodySection)) ||
+            header->stringCount > UINT32_MAX || header->stringBlobOffset > size) {
+            return false;
+        }
+        const auto* offsets = reinterpret_cast<const std::uint64_t*>(base_ + header->stringOffsetsOffset);
+        if (offsets[header->stringCount] > size - header->stringBlobOffset) {
+            return false;
+        }
+        header_ = header;
+        return true;
+    }
+
+    bool isOpen() const { return header_ != nullptr; }
+    std::size_t entryCount() const { return header_ ? header_->entryCount : 0; }
+    std::size_t bodyCount() const { return header_ ? header_->bodyCount : 0; }
+
+    const EntryRecord& entry(std::size_t index) const {
+        return reinterpret_cast<const EntryRecord*>(base_ + header_->entriesOffset)[index];
+    }
+
+    const BodySection& body(std::size_t index) const {
+        return reinterpret_cast<const BodySection*>(base_ + header_->bodiesOffset)[index];
+    }
+
+    // Empty for an out-of-range or malformed index.
+    std::string_view string(std::uint32_t index) const {
+        if (!header_ || index >= header_->stringCount) {
+            return {};
+        }
+        const auto* offsets = reinterpret_cast<const std::uint64_t*>(base_ + header_->stringOffsetsOffset);
+        const std::uint64_t begin = offsets[index];
+        const std::uint64_t end = offsets[index + 1];
+        if (begin > end || end > offsets[header_->stringCount]) {
+            return {};
+        }
+        return std::string_view(base_ + header_->stringBlobOffset + begin, end - begin);
+    }
+
+    // Sources of an entry, as string indices; false if the record points outside the table.
+    bool sources(const EntryRecord& record, const std::uint32_t*& begin, const std::uint32_t*& end) const {
+        if (static_cast<std::uint64_t>(record.sourceBegin) + record.sourceCount > header_->sourceCount) {
+            return false;
+        }
+        begin = reinterpret_cast<const std::uint32_t*>(base_ + header_->sourcesOffset) + record.sourceBegin;
+        end = begin + record.sourceCount;
+        return true;
+    }
+
+    // Section of the body's entries, found by binary search; nullptr if it has none.
+    const BodySection* findBody(std::string_view bodyId) const {
+        std::size_t lo = 0;
+        std::size_t hi = bodyCount();
+        while (lo < hi) {
+            const std::size_t mid = lo + (hi - lo) / 2;
+            const std::string_view value = string(body(mid).bodyId);
+            if (value < bodyId) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        if (lo < bodyCount() && string(body(lo).bodyId) == bodyId) {
+            const BodySection& section = body(lo);
+            if (section.entryBegin <= entryCount() && section.entryCount <= entryCount() - section.entryBegin) {
+                return &section;
+            }
+        }
+        return nullptr;
+    }
+
+private:
+    bool fits(std::uint64_t offset, std::uint64_t count, std::size_t width) const {
+        return offset % 8 == 0 && offset <= size_ && count <= (size_ - offset) / width;
+    }
+
+    const char* base_{nullptr};
+    std::size_t size_{0};
+    const Header* header_{nullptr};
+};
+
+} // namespace onecad::kernel::elementmap::format
@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <array>
 #include <cmath>
+#include <iterator>
 #include <limits>
 #include <unordered_map>
 #include <unordered_set>
@@ -16,6 +17,10 @@ namespace {
 constexpr float kPolygonOffsetFactor = 1.0f;
 constexpr float kPolygonOffsetUnits = 1.0f;
 
+constexpr std::size_t kCoarse = static_cast<std::size_t>(SceneMeshStore::Detail::Coarse);
+constexpr std::size_t kStandard = static_cast<std::size_t>(SceneMeshStore::Detail::Standard);
+constexpr std::size_t kFine = static_cast<std::size_t>(SceneMeshStore::Detail::Fine);
+
 QVector3D normalizeOrFallback(const QVector3D& v, const QVector3D& fallback) {
     if (v.lengthSquared() < 1e-6f) {
         return fallback;
@@ -298,11 +303,13 @@ void BodyRenderer::cleanup() {
 
     m_mainBuffers.triangles.vao.destroy();
     m_mainBuffers.triangles.vbo.destroy();
+    m_mainBuffers.triangles.ibo.destroy();
     m_mainBuffers.edges.vao.destroy();
     m_mainBuffers.edges.vbo.destroy();
 
     m_previewBuffers.triangles.vao.destroy();
     m_previewBuffers.triangles.vbo.destroy();
+    m_previewBuffers.triangles.ibo.destroy();
     m_previewBuffers.edges.vao.destroy();
     m_previewBuffers.edges.vbo.destroy();
 
@@ -312,27 +319,44 @@ void BodyRenderer::cleanup() {
 }
 
 void BodyRenderer::setMeshes(const std::vector<SceneMeshStore::Mesh>& meshes) {
-    buildBuffers(meshes, &m_mainCpu);
+    std::vector<const SceneMeshStore::Mesh*> pointers;
+    pointers.reserve(meshes.size());
+    for (const auto& mesh : meshes) {
+        pointers.push_back(&mesh);
+    }
+    buildBuffers(pointers, &m_mainCpu);
     m_mainDirty = true;
 }
 
 void BodyRenderer::setMeshes(const SceneMeshStore& store) {
-    buildBuffers(store, &m_mainCpu);
+    std::vector<const SceneMeshStore::Mesh*> pointers;
+    pointers.reserve(store.size());
+    store.forEachMesh([&](const SceneMeshStore::Mesh& mesh) {
+        pointers.push_back(&mesh);
+    });
+    buildBuffers(pointers, &m_mainCpu);
     m_mainDirty = true;
 }
 
 void BodyRenderer::setPreviewMeshes(const std::vector<SceneMeshStore::Mesh>& meshes) {
-    buildBuffers(meshes, &m_previewCpu);
+    std::vector<const SceneMeshStore::Mesh*> pointers;
+    pointers.reserve(meshes.size());
+    for (const auto& mesh : meshes) {
+        pointers.push_back(&mesh);
+    }
+    buildBuffers(pointers, &m_previewCpu);
     m_previewDirty = true;
 }
 
 void BodyRenderer::clearPreview() {
-    m_previewCpu.triangles.clear();
-    m_previewCpu.edges.clear();
-    m_previewCpu.bounds.valid = false;
+    m_previewCpu.clear();
     m_previewDirty = true;
 }
 
+std::vector<std::string> BodyRenderer::takeFineDetailRequests() {
+    return std::exchange(m_fineRequests, {});
+}
+
 void BodyRenderer::render(const QMatrix4x4& viewProjection,
                           const QMatrix4x4& view,
                           const RenderStyle& style) {
@@ -350,37 +374,39 @@ void BodyRenderer::render(const QMatrix4x4& viewProjection,
     }
 
     const QMatrix3x3 viewNormal = view.normalMatrix();
-    renderBatch(m_mainBuffers, viewProjection, view, viewNormal, m_mainCpu.bounds, style, -1.0f);
+    selectLevels(m_mainCpu, viewProjection, style, &m_mainRanges, &m_fineRequests);
+    renderBatch(m_mainBuffers, viewProjection, view, viewNormal, m_mainCpu.bounds, m_mainRanges, style, -1.0f);
     if (m_previewBuffers.triangles.vertexCount > 0 || m_previewBuffers.edges.vertexCount > 0) {
-        renderBatch(m_previewBuffers, viewProjection, view, viewNormal, m_previewCpu.bounds, style, style.previewAlpha);
+        selectLevels(m_previewCpu, viewProjection, style, &m_previewRanges, nullptr);
+        renderBatch(m_previewBuffers, viewProjection, view, viewNormal, m_previewCpu.bounds, m_previewRanges,
+                    style, style.previewAlpha);
     }
 }
 
-void BodyRenderer::buildBuffers(const std::vector<SceneMeshStore::Mesh>& meshes,
+void BodyRenderer::buildBuffers(const std::vector<const SceneMeshStore::Mesh*>& meshes,
                                 CpuBuffers* outBuffers) const {
     if (!outBuffers) {
         return;
     }
-    outBuffers->triangles.clear();
-    outBuffers->edges.clear();
-    outBuffers->bounds.valid = false;
+    outBuffers->clear();
 
-    for (const auto& mesh : meshes) {
-        appendMeshBuffers(mesh, outBuffers);
+    for (const auto* mesh : meshes) {
+        appendMeshBuffers(*mesh, outBuffers);
     }
-}
-
-void BodyRenderer::buildBuffers(const SceneMeshStore& store, CpuBuffers* outBuffers) const {
-    if (!outBuffers) {
-        return;
+    // The other levels follow level by level, so neighbouring bodies drawn at the same level
+    // have adjacent index ranges.
+    for (const auto detail : {SceneMeshStore::Detail::Coarse, SceneMeshStore::Detail::Fine}) {
+        for (std::size_t i = 0; i < meshes.size(); ++i) {
+            const auto& lod = detail == SceneMeshStore::Detail::Coarse ? meshes[i]->coarse : meshes[i]->fine;
+            if (lod.empty()) {
+                continue;
+            }
+            BodyDraw& body = outBuffers->bodies[i];
+            body.levels[static_cast<std::size_t>(detail)] =
+                appendTriangles(lod.positions, lod.normals, lod.indices, meshes[i]->modelMatrix, outBuffers);
+            body.deflections[static_cast<std::size_t>(detail)] = lod.linearDeflection;
+        }
     }
-    outBuffers->triangles.clear();
-    outBuffers->edges.clear();
-    outBuffers->bounds.valid = false;
-
-    store.forEachMesh([&](const SceneMeshStore::Mesh& mesh) {
-        appendMeshBuffers(mesh, outBuffers);
-    });
 }
 
 void BodyRenderer::appendMeshBuffers(const SceneMeshStore::Mesh& mesh, CpuBuffers* outBuffers) const {
@@ -388,106 +414,44 @@ void BodyRenderer::appendMeshBuffers(const SceneMeshStore::Mesh& mesh, CpuBuffer
         return;
     }
 
-    // Check if we have precomputed smooth normals
-    const bool hasPrecomputedNormals = !mesh.normals.empty() &&
-                                       mesh.normals.size() == mesh.vertices.size();
-
-    // Transform vertices
-    std::vector<QVector3D> transformedVertices;
-    transformedVertices.reserve(mesh.vertices.size());
-    QVector3D boundsMin = outBuffers->bounds.min;
-    QVector3D boundsMax = outBuffers->bounds.max;
-    bool boundsValid = outBuffers->bounds.valid;
-    for (const auto& v : mesh.vertices) {
-        QVector4D transformed = mesh.modelMatrix * QVector4D(v, 1.0f);
-        QVector3D position(transformed.x(), transformed.y(), transformed.z());
-        transformedVertices.push_back(position);
-        if (!boundsValid) {
-            boundsMin = position;
-            boundsMax = position;
-            boundsValid = true;
-        } else {
-            boundsMin.setX(std::min(boundsMin.x(), position.x()));
-            boundsMin.setY(std::min(boundsMin.y(), position.y()));
-            boundsMin.setZ(std::min(boundsMin.z(), position.z()));
-            boundsMax.setX(std::max(boundsMax.x(), position.x()));
-            boundsMax.setY(std::max(boundsMax.y(), position.y()));
-            boundsMax.setZ(std::max(boundsMax.z(), position.z()));
-        }
-    }
-    outBuffers->bounds.min = boundsMin;
-    outBuffers->bounds.max = boundsMax;
-    outBuffers->bounds.valid = boundsValid;
-
-    // Transform normals (rotation only, no translation)
-    std::vector<QVector3D> transformedNormals;
-    if (hasPrecomputedNormals) {
-        QMatrix3x3 normalMatrix = mesh.modelMatrix.normalMatrix();
-        transformedNormals.reserve(mesh.normals.size());
-        for (const auto& n : mesh.normals) {
-            QVector3D tn(
-                normalMatrix(0, 0) * n.x() + normalMatrix(0, 1) * n.y() + normalMatrix(0, 2) * n.z(),
-                normalMatrix(1, 0) * n.x() + normalMatrix(1, 1) * n.y() + normalMatrix(1, 2) * n.z(),
-                normalMatrix(2, 0) * n.x() + normalMatrix(2, 1) * n.y() + normalMatrix(2, 2) * n.z()
-            );
-            transformedNormals.push_back(tn.normalized());
-        }
-    }
-
-    for (const auto& tri : mesh.triangles) {
-        if (tri.i0 >= transformedVertices.size() ||
-            tri.i1 >= transformedVertices.size() ||
-            tri.i2 >= transformedVertices.size()) {
-            continue;
-        }
-        const QVector3D& v0 = transformedVertices[tri.i0];
-        const QVector3D& v1 = transformedVertices[tri.i1];
-        const QVector3D& v2 = transformedVertices[tri.i2];
+    BodyDraw body;
+    body.bodyId = mesh.bodyId;
+    body.deflections[kStandard] = mesh.linearDeflection;
+    const std::size_t firstPosition = outBuffers->positions.size();
+    body.levels[kStandard] = appendTriangles(mesh.positions, mesh.normals, mesh.indices, mesh.modelMatrix, outBuffers);
 
-        // Use precomputed normals if available, otherwise compute flat normal
-        QVector3D n0, n1, n2;
-        if (hasPrecomputedNormals) {
-            n0 = transformedNormals[tri.i0];
-            n1 = transformedNormals[tri.i1];
-            n2 = transformedNormals[tri.i2];
+    for (std::size_t i = firstPosition; i < outBuffers->positions.size(); i += 3) {
+        const QVector3D position(outBuffers->positions[i], outBuffers->positions[i + 1], outBuffers->positions[i + 2]);
+        if (!body.bounds.valid) {
+            body.bounds.min = position;
+            body.bounds.max = position;
+            body.bounds.valid = true;
         } else {
-            // Fallback: compute flat normal
-            QVector3D flatNormal = QVector3D::crossProduct(v1 - v0, v2 - v0);
-            if (flatNormal.lengthSquared() < 1e-8f) {
-                flatNormal = QVector3D(0.0f, 0.0f, 1.0f);
-            } else {
-                flatNormal.normalize();
-            }
-            n0 = n1 = n2 = flatNormal;
+            body.bounds.min.setX(std::min(body.bounds.min.x(), position.x()));
+            body.bounds.min.setY(std::min(body.bounds.min.y(), position.y()));
+            body.bounds.min.setZ(std::min(body.bounds.min.z(), position.z()));
+            body.bounds.max.setX(std::max(body.bounds.max.x(), position.x()));
+            body.bounds.max.setY(std::max(body.bounds.max.y(), position.y()));
+            body.bounds.max.setZ(std::max(body.bounds.max.z(), position.z()));
         }
-
-        // Emit vertices with per-vertex normals
-        outBuffers->triangles.push_back(v0.x());
-        outBuffers->triangles.push_back(v0.y());
-        outBuffers->triangles.push_back(v0.z());
-        outBuffers->triangles.push_back(n0.x());
-        outBuffers->triangles.push_back(n0.y());
-        outBuffers->triangles.push_back(n0.z());
-
-        outBuffers->triangles.push_back(v1.x());
-        outBuffers->triangles.push_back(v1.y());
-        outBuffers->triangles.push_back(v1.z());
-        outBuffers->triangles.push_back(n1.x());
-        outBuffers->triangles.push_back(n1.y());
-        outBuffers->triangles.push_back(n1.z());
-
-        outBuffers->triangles.push_back(v2.x());
-        outBuffers->triangles.push_back(v2.y());
-        outBuffers->triangles.push_back(v2.z());
-        outBuffers->triangles.push_back(n2.x());
-        outBuffers->triangles.push_back(n2.y());
-        outBuffers->triangles.push_back(n2.z());
     }
+    Bounds& bounds = outBuffers->bounds;
+    if (body.bounds.valid && !bounds.valid) {
+        bounds = body.bounds;
+    } else if (body.bounds.valid) {
+        bounds.min = QVector3D(std::min(bounds.min.x(), body.bounds.min.x()),
+                               std::min(bounds.min.y(), body.bounds.min.y()),
+                               std::min(bounds.min.z(), body.bounds.min.z()));
+        bounds.max = QVector3D(std::max(bounds.max.x(), body.bounds.max.x()),
+                               std::max(bounds.max.y(), body.bounds.max.y()),
+                               std::max(bounds.max.z(), body.bounds.max.z()));
+    }
+    outBuffers->bodies.push_back(std::move(body));
 
     // Only render edges from OCCT topology - no tessellation edge fallback
     // This ensures cylinders show only their actual edges (top/bottom circles)
     // and planar faces show only their boundary edges (no internal triangulation)
-    std::unordered_set<std::string> seenEdges;
+    std::unordered_set<SceneMeshStore::ElementHandle, SceneMeshStore::ElementHandleHash> seenEdges;
     for (const auto& [faceId, topo] : mesh.topologyByFace) {
         (void)faceId;
         for (const auto& edge : topo.edges) {
@@ -512,6 +476,177 @@ void BodyRenderer::appendMeshBuffers(const SceneMeshStore::Mesh& mesh, CpuBuffer
     }
 }
 
+BodyRenderer::IndexRange BodyRenderer::appendTriangles(const std::vector<float>& positions,
+                                                       const std::vector<float>& normals,
+                                                       const std::vector<std::uint32_t>& indices,
+                                                       const QMatrix4x4& modelMatrix,
+                                                       CpuBuffers* outBuffers) const {
+    const std::size_t vertexCount = positions.size() / 3;
+    const auto baseVertex = static_cast<std::uint32_t>(outBuffers->positions.size() / 3);
+    const auto firstIndex = static_cast<std::uint32_t>(outBuffers->indices.size());
+    const bool hasPrecomputedNormals = normals.size() == positions.size();
+    auto position = [&positions](std::size_t vertex) {
+        return QVector3D(positions[3 * vertex], positions[3 * vertex + 1], positions[3 * vertex + 2]);
+    };
+
+    // Tessellated meshes are already in world space, so positions and normals are copied as is.
+    if (modelMatrix.isIdentity()) {
+        outBuffers->positions.insert(outBuffers->positions.end(), positions.begin(), positions.end());
+        if (hasPrecomputedNormals) {
+            outBuffers->normals.insert(outBuffers->normals.end(), normals.begin(), normals.end());
+        }
+    } else {
+        const QMatrix3x3 normalMatrix = modelMatrix.normalMatrix();
+        outBuffers->positions.reserve(outBuffers->positions.size() + positions.size());
+        for (std::size_t i = 0; i < vertexCount; ++i) {
+            const QVector4D p = modelMatrix * QVector4D(position(i), 1.0f);
+            outBuffers->positions.insert(outBuffers->positions.end(), {p.x(), p.y(), p.z()});
+            if (!hasPrecomputedNormals) {
+                continue;
+            }
+            // Rotation only, no translation
+            const QVector3D n(normals[3 * i], normals[3 * i + 1], normals[3 * i + 2]);
+            const QVector3D tn = QVector3D(
+                normalMatrix(0, 0) * n.x() + normalMatrix(0, 1) * n.y() + normalMatrix(0, 2) * n.z(),
+                normalMatrix(1, 0) * n.x() + normalMatrix(1, 1) * n.y() + normalMatrix(1, 2) * n.z(),
+                normalMatrix(2, 0) * n.x() + normalMatrix(2, 1) * n.y() + normalMatrix(2, 2) * n.z()
+            ).normalized();
+            outBuffers->normals.insert(outBuffers->normals.end(), {tn.x(), tn.y(), tn.z()});
+        }
+    }
+
+    // Drop triangles that point outside the mesh; indices move past the meshes already appended.
+    outBuffers->indices.reserve(outBuffers->indices.size() + indices.size());
+    for (std::size_t i = 0; i + 2 < indices.size(); i += 3) {
+        if (indices[i] >= vertexCount || indices[i + 1] >= vertexCount ||
+            indices[i + 2] >= vertexCount) {
+            continue;
+        }
+        outBuffers->indices.insert(outBuffers->indices.end(), {baseVertex + indices[i],
+                                                               baseVertex + indices[i + 1],
+                                                               baseVertex + indices[i + 2]});
+    }
+
+    if (!hasPrecomputedNormals) {
+        // Fallback: area-weighted vertex normals from the triangles
+        std::vector<QVector3D> accumulated(vertexCount);
+        const float* transformed = outBuffers->positions.data() + 3 * static_cast<std::size_t>(baseVertex);
+        auto corner = [transformed](std::uint32_t vertex) {
+            return QVector3D(transformed[3 * vertex], transformed[3 * vertex + 1], transformed[3 * vertex + 2]);
+        };
+        for (std::size_t i = 0; i + 2 < indices.size(); i += 3) {
+            const std::uint32_t a = indices[i];
+            const std::uint32_t b = indices[i + 1];
+            const std::uint32_t c = indices[i + 2];
+            if (a >= vertexCount || b >= vertexCount || c >= vertexCount) {
+                continue;
+            }
+            const QVector3D cross = QVector3D::crossProduct(corner(b) - corner(a), corner(c) - corner(a));
+            accumulated[a] += cross;
+            accumulated[b] += cross;
+            accumulated[c] += cross;
+        }
+        outBuffers->normals.reserve(outBuffers->normals.size() + 3 * vertexCount);
+        for (QVector3D n : accumulated) {
+            n = n.lengthSquared() < 1e-8f ? QVector3D(0.0f, 0.0f, 1.0f) : n.normalized();
+            outBuffers->normals.insert(outBuffers->normals.end(), {n.x(), n.y(), n.z()});
+        }
+    }
+    return {firstIndex, static_cast<std::uint32_t>(outBuffers->indices.size()) - firstIndex};
+}
+
+void BodyRenderer::selectLevels(CpuBuffers& cpu,
+                                const QMatrix4x4& viewProjection,
+                                const RenderStyle& style,
+                                std::vector<IndexRange>* outRanges,
+                                std::vector<std::string>* fineRequests) const {
+    outRanges->clear();
+    const bool useLevels = style.viewportWidth > 0 && style.viewportHeight > 0;
+    for (auto& body : cpu.bodies) {
+        std::size_t level = kStandard;
+        if (useLevels && body.bounds.valid) {
+            // Clip-space corners: the box is culled if they all lie outside one frustum plane.
+            const QVector3D& lo = body.bounds.min;
+            const QVector3D& hi = body.bounds.max;
+            int outside[6] = {0, 0, 0, 0, 0, 0};
+            bool behind = false;
+            float minX = std::numeric_limits<float>::max();
+            float minY = std::numeric_limits<float>::max();
+            float maxX = -std::numeric_limits<float>::max();
+            float maxY = -std::numeric_limits<float>::max();
+            for (int corner = 0; corner < 8; ++corner) {
+                const QVector4D clip = viewProjection * QVector4D((corner & 1) ? hi.x() : lo.x(),
+                                                                  (corner & 2) ? hi.y() : lo.y(),
+                                                                  (corner & 4) ? hi.z() : lo.z(), 1.0f);
+                outside[0] += clip.x() < -clip.w();
+                outside[1] += clip.x() > clip.w();
+                outside[2] += clip.y() < -clip.w();
+                outside[3] += clip.y() > clip.w();
+                outside[4] += clip.z() < -clip.w();
+                outside[5] += clip.z() > clip.w();
+                if (clip.w() <= 1e-6f) {
+                    behind = true;
+                    continue;
+                }
+                minX = std::min(minX, clip.x() / clip.w());
+                maxX = std::max(maxX, clip.x() / clip.w());
+                minY = std::min(minY, clip.y() / clip.w());
+                maxY = std::max(maxY, clip.y() / clip.w());
+            }
+            if (std::any_of(std::begin(outside), std::end(outside), [](int count) { return count == 8; })) {
+                continue;
+            }
+
+            // Screen pixels per world unit, from the projected box over its diagonal. A box
+            // reaching behind the camera is as close as it gets.
+            const float diagonal = (hi - lo).length();
+            float pixelsPerUnit = std::numeric_limits<float>::infinity();
+            if (!behind && diagonal > 1e-6f) {
+                const float extent = std::max((maxX - minX) * 0.5f * static_cast<float>(style.viewportWidth),
+                                              (maxY - minY) * 0.5f * static_cast<float>(style.viewportHeight));
+                pixelsPerUnit = extent / diagonal;
+            }
+            auto fits = [&](std::size_t candidate) {
+                return body.levels[candidate].count > 0 && body.deflections[candidate] > 0.0 &&
+                       static_cast<float>(body.deflections[candidate]) * pixelsPerUnit <= style.maxDeflectionPixels;
+            };
+            if (body.deflections[kStandard] > 0.0) {
+                if (fits(kCoarse)) {
+                    level = kCoarse;
+                } else if (!fits(kStandard)) {
+                    if (body.levels[kFine].count > 0) {
+                        level = kFine;
+                    } else if (fineRequests && !body.fineRequested) {
+                        body.fineRequested = true;
+                        fineRequests->push_back(body.bodyId);
+                    }
+                }
+            }
+        }
+
+        if (body.levels[level].count > 0) {
+            outRanges->push_back(body.levels[level]);
+        }
+    }
+
+    // Bodies picked at the same level are adjacent in the index buffer once sorted.
+    std::sort(outRanges->begin(), outRanges->end(),
+              [](const IndexRange& a, const IndexRange& b) { return a.first < b.first; });
+    std::size_t merged = 0;
+    for (std::size_t i = 1; i < outRanges->size(); ++i) {
+        IndexRange& last = (*outRanges)[merged];
+        const IndexRange& next = (*outRanges)[i];
+        if (last.first + last.count == next.first) {
+            last.count += next.count;
+        } else {
+            (*outRanges)[++merged] = next;
+        }
+    }
+    if (!outRanges->empty()) {
+        outRanges->resize(merged + 1);
+    }
+}
+
 void BodyRenderer::ensureBuffers(RenderBuffers* buffers, QOpenGLBuffer::UsagePattern usage) {
     if (!buffers) {
         return;
@@ -524,6 +659,10 @@ void BodyRenderer::ensureBuffers(RenderBuffers* buffers, QOpenGLBuffer::UsagePat
         buffers->triangles.vbo.create();
         buffers->triangles.vbo.setUsagePattern(usage);
     }
+    if (!buffers->triangles.ibo.isCreated()) {
+        buffers->triangles.ibo.create();
+        buffers->triangles.ibo.setUsagePattern(usage);
+    }
     if (!buffers->edges.vao.isCreated()) {
         buffers->edges.vao.create();
     }
@@ -537,26 +676,35 @@ void BodyRenderer::uploadBuffers(const CpuBuffers& cpu, RenderBuffers* buffers)
     if (!buffers) {
         return;
     }
-    if (!buffers->triangles.vbo.isCreated() || !buffers->edges.vbo.isCreated() ||
+    if (!buffers->triangles.vbo.isCreated() || !buffers->triangles.ibo.isCreated() ||
+        !buffers->edges.vbo.isCreated() ||
         !buffers->triangles.vao.isCreated() || !buffers->edges.vao.isCreated()) {
         return;
     }
 
     buffers->triangles.vertexCount = 0;
-    if (!cpu.triangles.empty()) {
-        buffers->triangles.vertexCount = static_cast<int>(cpu.triangles.size() / 6);
+    if (!cpu.indices.empty() && cpu.normals.size() == cpu.positions.size()) {
+        const int positionBytes = static_cast<int>(cpu.positions.size() * sizeof(float));
+        const int normalBytes = static_cast<int>(cpu.normals.size() * sizeof(float));
+        buffers->triangles.vertexCount = static_cast<int>(cpu.indices.size());
         buffers->triangles.vao.bind();
         buffers->triangles.vbo.bind();
-        buffers->triangles.vbo.allocate(cpu.triangles.data(),
-                                        static_cast<int>(cpu.triangles.size() * sizeof(float)));
+        buffers->triangles.vbo.allocate(positionBytes + normalBytes);
+        buffers->triangles.vbo.write(0, cpu.positions.data(), positionBytes);
+        buffers->triangles.vbo.write(positionBytes, cpu.normals.data(), normalBytes);
         glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float),
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float),
                               reinterpret_cast<void*>(0));
         glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float),
-                              reinterpret_cast<void*>(3 * sizeof(float)));
-        buffers->triangles.vbo.release();
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float),
+                              reinterpret_cast<void*>(static_cast<std::uintptr_t>(positionBytes)));
+        buffers->triangles.ibo.bind();
+        buffers->triangles.ibo.allocate(cpu.indices.data(),
+                                        static_cast<int>(cpu.indices.size() * sizeof(std::uint32_t)));
+        // The VAO records the index buffer binding, so it goes first.
         buffers->triangles.vao.release();
+        buffers->triangles.vbo.release();
+        buffers->triangles.ibo.release();
     }
 
     buffers->edges.vertexCount = 0;
@@ -579,6 +727,7 @@ void BodyRenderer::renderBatch(RenderBuffers& buffers,
                                const QMatrix4x4& view,
                                const QMatrix3x3& viewNormal,
                                const Bounds& bounds,
+                               const std::vector<IndexRange>& ranges,
                                const RenderStyle& style,
                                float alphaOverride) {
     const float colorScale = style.ghosted ? style.ghostFactor : 1.0f;
@@ -611,7 +760,7 @@ void BodyRenderer::renderBatch(RenderBuffers& buffers,
     }
 
     // Skip triangle pass in wireframe-only mode
-    if (buffers.triangles.vertexCount > 0 && !style.wireframeOnly) {
+    if (buffers.triangles.vertexCount > 0 && !ranges.empty() && !style.wireframeOnly) {
         glEnable(GL_DEPTH_TEST);
         glDepthFunc(GL_LESS);
         glDisable(GL_CULL_FACE);
@@ -664,7 +813,10 @@ void BodyRenderer::renderBatch(RenderBuffers& buffers,
         m_triangleShader->setUniformValue("uIsOrtho", style.isOrtho);
 
         buffers.triangles.vao.bind();
-        glDrawArrays(GL_TRIANGLES, 0, buffers.triangles.vertexCount);
+        for (const IndexRange& range : ranges) {
+            glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(range.count), GL_UNSIGNED_INT,
+                           reinterpret_cast<void*>(static_cast<std::uintptr_t>(range.first) * sizeof(std::uint32_t)));
+        }
         buffers.triangles.vao.release();
 
         m_triangleShader->release();
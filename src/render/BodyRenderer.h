@@ -8,13 +8,20 @@
 #include <QOpenGLShaderProgram>
 #include <QOpenGLVertexArrayObject>
 #include <QVector3D>
+#include <array>
+#include <cstdint>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "scene/SceneMeshStore.h"
 
 namespace onecad::render {
 
+// Each body is drawn at one of its levels of detail (SceneMeshStore::Detail), picked every
+// frame from its projected size: the coarsest level whose linear deflection stays under
+// RenderStyle::maxDeflectionPixels on screen. Bodies wholly outside the view are skipped.
+// Levels are laid out level by level, so bodies drawn at the same level share draw calls.
 class BodyRenderer : protected QOpenGLFunctions {
 public:
     struct RenderStyle {
@@ -55,6 +62,10 @@ public:
         float nearPlane = 0.1f;
         float farPlane = 100000.0f;
         bool isOrtho = false;
+        // Level of detail; without a viewport size every body is drawn at standard detail.
+        int viewportWidth = 0;   // Pixels
+        int viewportHeight = 0;
+        float maxDeflectionPixels = 1.5f;
     };
 
     BodyRenderer();
@@ -77,6 +88,10 @@ public:
                 const QMatrix4x4& view,
                 const RenderStyle& style);
 
+    // Bodies the last frames wanted in more detail than their meshes have; each is reported
+    // once per setMeshes().
+    std::vector<std::string> takeFineDetailRequests();
+
 private:
     struct Bounds {
         QVector3D min;
@@ -84,16 +99,44 @@ private:
         bool valid = false;
     };
 
+    // indices[first, first + count)
+    struct IndexRange {
+        std::uint32_t first = 0;
+        std::uint32_t count = 0;
+    };
+
+    struct BodyDraw {
+        std::string bodyId;
+        Bounds bounds;
+        std::array<IndexRange, 3> levels;   // By SceneMeshStore::Detail; empty if not built
+        std::array<double, 3> deflections{};
+        bool fineRequested = false;
+    };
+
+    // Triangles keep the SceneMeshStore layout: positions, then normals, indexed.
     struct CpuBuffers {
-        std::vector<float> triangles;
+        std::vector<float> positions;
+        std::vector<float> normals;
+        std::vector<std::uint32_t> indices;
         std::vector<float> edges;
         Bounds bounds;
+        std::vector<BodyDraw> bodies;
+
+        void clear() {
+            positions.clear();
+            normals.clear();
+            indices.clear();
+            edges.clear();
+            bounds.valid = false;
+            bodies.clear();
+        }
     };
 
     struct DrawBuffers {
         QOpenGLVertexArrayObject vao;
         QOpenGLBuffer vbo{QOpenGLBuffer::VertexBuffer};
-        int vertexCount = 0;
+        QOpenGLBuffer ibo{QOpenGLBuffer::IndexBuffer};  // Triangles only
+        int vertexCount = 0;                             // Index count for triangles
     };
 
     struct RenderBuffers {
@@ -101,9 +144,20 @@ private:
         DrawBuffers edges;
     };
 
-    void buildBuffers(const std::vector<SceneMeshStore::Mesh>& meshes, CpuBuffers* outBuffers) const;
-    void buildBuffers(const SceneMeshStore& store, CpuBuffers* outBuffers) const;
+    void buildBuffers(const std::vector<const SceneMeshStore::Mesh*>& meshes, CpuBuffers* outBuffers) const;
     void appendMeshBuffers(const SceneMeshStore::Mesh& mesh, CpuBuffers* outBuffers) const;
+    IndexRange appendTriangles(const std::vector<float>& positions,
+                               const std::vector<float>& normals,
+                               const std::vector<std::uint32_t>& indices,
+                               const QMatrix4x4& modelMatrix,
+                               CpuBuffers* outBuffers) const;
+    // Index ranges to draw this frame, merged where adjacent; adds the bodies that want a
+    // finer level than they have to @p fineRequests when given.
+    void selectLevels(CpuBuffers& cpu,
+                      const QMatrix4x4& viewProjection,
+                      const RenderStyle& style,
+                      std::vector<IndexRange>* outRanges,
+                      std::vector<std::string>* fineRequests) const;
     void ensureBuffers(RenderBuffers* buffers, QOpenGLBuffer::UsagePattern usage);
     void uploadBuffers(const CpuBuffers& cpu, RenderBuffers* buffers);
     void renderBatch(RenderBuffers& buffers,
@@ -111,6 +165,7 @@ private:
                      const QMatrix4x4& view,
                      const QMatrix3x3& viewNormal,
                      const Bounds& bounds,
+                     const std::vector<IndexRange>& ranges,
                      const RenderStyle& style,
                      float alphaOverride);
 
@@ -120,6 +175,9 @@ private:
     RenderBuffers m_previewBuffers;
     CpuBuffers m_mainCpu;
     CpuBuffers m_previewCpu;
+    std::vector<IndexRange> m_mainRanges;
+    std::vector<IndexRange> m_previewRanges;
+    std::vector<std::string> m_fineRequests;
     bool m_mainDirty = false;
     bool m_previewDirty = false;
     bool m_initialized = false;
@@ -7,6 +7,15 @@ void SceneMeshStore::setBodyMesh(const std::string& bodyId, Mesh mesh) {
     meshes_[bodyId] = std::move(mesh);
 }
 
+bool SceneMeshStore::setBodyLod(const std::string& bodyId, Detail detail, Lod lod) {
+    auto it = meshes_.find(bodyId);
+    if (it == meshes_.end() || detail == Detail::Standard) {
+        return false;
+    }
+    (detail == Detail::Coarse ? it->second.coarse : it->second.fine) = std::move(lod);
+    return true;
+}
+
 bool SceneMeshStore::removeBody(const std::string& bodyId) {
     return meshes_.erase(bodyId) > 0;
 }
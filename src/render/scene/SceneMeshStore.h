@@ -1,6 +1,8 @@
 #ifndef ONECAD_RENDER_SCENE_SCENEMESHSTORE_H
 #define ONECAD_RENDER_SCENE_SCENEMESHSTORE_H
 
+#include "../../kernel/elementmap/ElementHandle.h"
+
 #include <QMatrix4x4>
 #include <QVector3D>
 #include <cstddef>
@@ -14,40 +16,76 @@ namespace onecad::render {
 class SceneMeshStore {
 public:
     // Not thread-safe; access from the UI/renderer thread or add external synchronization.
-    struct Triangle {
-        std::uint32_t i0 = 0;
-        std::uint32_t i1 = 0;
-        std::uint32_t i2 = 0;
-        std::string faceId;
+    // Element IDs are interned handles (kernel::elementmap::elementIdString() resolves them).
+    using ElementHandle = kernel::elementmap::ElementHandle;
+    using ElementHandleHash = kernel::elementmap::ElementHandleHash;
+
+    // The triangles of one face: indices[firstIndex, firstIndex + indexCount).
+    struct FaceRange {
+        ElementHandle faceId;
+        std::uint32_t firstIndex = 0;
+        std::uint32_t indexCount = 0;  // Three per triangle
     };
 
     struct EdgePolyline {
-        std::string edgeId;
+        ElementHandle edgeId;
         std::vector<QVector3D> points;
     };
 
     struct VertexSample {
-        std::string vertexId;
+        ElementHandle vertexId;
         QVector3D position;
     };
 
     struct FaceTopology {
-        std::string faceId;
+        ElementHandle faceId;
         std::vector<EdgePolyline> edges;
         std::vector<VertexSample> vertices;
     };
 
+    // Levels of detail the renderer picks from; Standard is the mesh's own arrays.
+    enum class Detail { Coarse, Standard, Fine };
+
+    // Another triangulation of the same body, for drawing only: faces, topology and picking
+    // always use the Standard arrays. Empty until built.
+    struct Lod {
+        double linearDeflection = 0.0;
+        std::vector<float> positions;
+        std::vector<float> normals;
+        std::vector<std::uint32_t> indices;
+
+        [[nodiscard]] bool empty() const { return indices.empty(); }
+        [[nodiscard]] std::size_t triangleCount() const { return indices.size() / 3; }
+    };
+
+    // Structure-of-arrays layout: the position, normal and index arrays are what the GPU
+    // takes, so uploading a mesh is a copy. Triangles carry no face ID; faces are index ranges.
     struct Mesh {
         std::string bodyId;
         QMatrix4x4 modelMatrix;
-        std::vector<QVector3D> vertices;
-        std::vector<QVector3D> normals;  // Per-vertex smoothed normals (same size as vertices)
-        std::vector<Triangle> triangles;
-        std::unordered_map<std::string, FaceTopology> topologyByFace;
-        std::unordered_map<std::string, std::string> faceGroupByFaceId;
+        std::vector<float> positions;        // x, y, z per vertex
+        std::vector<float> normals;          // Per-vertex smoothed normals (same size as positions)
+        std::vector<std::uint32_t> indices;  // Three per triangle
+        std::vector<FaceRange> faces;        // In index order, covering indices
+        std::unordered_map<ElementHandle, FaceTopology, ElementHandleHash> topologyByFace;
+        std::unordered_map<ElementHandle, ElementHandle, ElementHandleHash> faceGroupByFaceId;
+        double linearDeflection = 0.0;       // Of the arrays above; 0 if unknown
+        Lod coarse;
+        Lod fine;                            // Built on demand, when the body is zoomed in on
+
+        [[nodiscard]] std::size_t vertexCount() const { return positions.size() / 3; }
+        [[nodiscard]] std::size_t triangleCount() const { return indices.size() / 3; }
+        [[nodiscard]] QVector3D position(std::uint32_t vertex) const {
+            return QVector3D(positions[3 * vertex], positions[3 * vertex + 1], positions[3 * vertex + 2]);
+        }
+        [[nodiscard]] QVector3D normal(std::uint32_t vertex) const {
+            return QVector3D(normals[3 * vertex], normals[3 * vertex + 1], normals[3 * vertex + 2]);
+        }
     };
 
     void setBodyMesh(const std::string& bodyId, Mesh mesh);
+    // Replaces the body's coarse or fine level; false if the body has no mesh.
+    bool setBodyLod(const std::string& bodyId, Detail detail, Lod lod);
     bool removeBody(const std::string& bodyId);
     void clear();
 
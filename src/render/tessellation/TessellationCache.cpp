@@ -1,6 +1,9 @@
 #include "TessellationCache.h"
 
+#include <BRepBuilderAPI_Copy.hxx>
 #include <BRepMesh_IncrementalMesh.hxx>
+#include <IMeshTools_Parameters.hxx>
+#include <BRep_Builder.hxx>
 #include <BRep_Tool.hxx>
 #include <BRepAdaptor_Surface.hxx>
 #include <BRepLProp_SLProps.hxx>
@@ -19,6 +22,7 @@
 #include <TopExp.hxx>
 #include <TopLoc_Location.hxx>
 #include <TopAbs_Orientation.hxx>
+#include <TopoDS_Compound.hxx>
 #include <TopoDS_Edge.hxx>
 #include <TopoDS_Wire.hxx>
 #include <TopoDS_Vertex.hxx>
@@ -26,9 +30,17 @@
 #include <TopTools_IndexedDataMapOfShapeListOfShape.hxx>
 #include <TopTools_ListIteratorOfListOfShape.hxx>
 
+#include <Eigen/Core>
+
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <exception>
 #include <functional>
 #include <limits>
+#include <mutex>
+#include <numeric>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -111,14 +123,63 @@ bool isVisibleEdge(const TopoDS_Edge& edge, const TopTools_ListOfShape& faces) {
     return false;
 }
 
+// Below this many items a pass runs on the calling thread.
+constexpr std::size_t kParallelMinItems = 64;
+
+// Calls func(k) for every k in [0, count), on up to @p threads threads. Items are handed out
+// one at a time, and the first exception is rethrown once every thread has stopped.
+template <typename Func>
+void parallelFor(std::size_t count, std::size_t threads, Func&& func) {
+    const std::size_t workerCount = count >= kParallelMinItems ? std::min(threads, count) : 1;
+    if (workerCount <= 1) {
+        for (std::size_t k = 0; k < count; ++k) {
+            func(k);
+        }
+        return;
+    }
+    std::atomic<std::size_t> next{0};
+    std::mutex errorMutex;
+    std::exception_ptr error;
+    auto worker = [&]() {
+        try {
+            for (std::size_t k = next.fetch_add(1); k < count; k = next.fetch_add(1)) {
+                func(k);
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+            next.store(count);
+        }
+    };
+    std::vector<std::thread> pool;
+    pool.reserve(workerCount - 1);
+    for (std::size_t t = 1; t < workerCount; ++t) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+using onecad::kernel::elementmap::ElementHandle;
+using onecad::kernel::elementmap::ElementHandleHash;
+using onecad::kernel::elementmap::elementIdString;
+using onecad::kernel::elementmap::internElementId;
+
 struct FaceDisjointSet {
-    std::unordered_map<std::string, std::string> parent;
+    std::unordered_map<ElementHandle, ElementHandle, ElementHandleHash> parent;
 
-    void add(const std::string& id) {
+    void add(ElementHandle id) {
         parent.emplace(id, id);
     }
 
-    std::string find(const std::string& id) {
+    ElementHandle find(ElementHandle id) {
         auto it = parent.find(id);
         if (it == parent.end()) {
             return id;
@@ -130,13 +191,14 @@ struct FaceDisjointSet {
         return it->second;
     }
 
-    void unite(const std::string& a, const std::string& b) {
-        std::string rootA = find(a);
-        std::string rootB = find(b);
+    void unite(ElementHandle a, ElementHandle b) {
+        ElementHandle rootA = find(a);
+        ElementHandle rootB = find(b);
         if (rootA == rootB) {
             return;
         }
-        if (rootA < rootB) {
+        // Lead with the smallest ID string so the leader does not depend on interning order.
+        if (elementIdString(rootA) < elementIdString(rootB)) {
             parent[rootB] = rootA;
         } else {
             parent[rootA] = rootB;
@@ -144,34 +206,60 @@ struct FaceDisjointSet {
     }
 };
 
-// Hash for position-based vertex grouping (quantized to avoid float noise).
-struct QuantizedPosition {
-    int64_t x;
-    int64_t y;
-    int64_t z;
+// Positions are welded on a 1e-4 grid, so float noise between faces does not split vertices.
+inline std::int64_t quantize(float f) {
+    return static_cast<std::int64_t>(std::llround(static_cast<double>(f) * 10000.0));
+}
 
-    bool operator==(const QuantizedPosition& other) const {
-        return x == other.x && y == other.y && z == other.z;
-    }
-};
+constexpr int kNormalBatch = 256;
+
+// Unit facet normal (+Z when degenerate) and area of every triangle. Corners are gathered
+// into fixed-size Eigen arrays a batch at a time, so the cross products, square roots and
+// degenerate-triangle selects run as SIMD packets.
+void computeTriangleNormals(const std::vector<float>& positions,
+                            const std::vector<std::uint32_t>& indices,
+                            std::vector<float>& normals,
+                            std::vector<float>& areas) {
+    using Batch = Eigen::Array<float, kNormalBatch, 1>;
+    const std::size_t triangleCount = indices.size() / 3;
+    normals.resize(3 * triangleCount);
+    areas.resize(triangleCount);
+
+    Batch e1[3] = {Batch::Zero(), Batch::Zero(), Batch::Zero()};
+    Batch e2[3] = {Batch::Zero(), Batch::Zero(), Batch::Zero()};
+    for (std::size_t base = 0; base < triangleCount; base += kNormalBatch) {
+        const std::size_t count = std::min<std::size_t>(kNormalBatch, triangleCount - base);
+        for (std::size_t k = 0; k < count; ++k) {
+            const std::uint32_t* tri = &indices[3 * (base + k)];
+            const float* p0 = &positions[3 * static_cast<std::size_t>(tri[0])];
+            const float* p1 = &positions[3 * static_cast<std::size_t>(tri[1])];
+            const float* p2 = &positions[3 * static_cast<std::size_t>(tri[2])];
+            for (int axis = 0; axis < 3; ++axis) {
+                e1[axis][k] = p1[axis] - p0[axis];
+                e2[axis][k] = p2[axis] - p0[axis];
+            }
+        }
 
-struct QuantizedPositionHash {
-    size_t operator()(const QuantizedPosition& key) const noexcept {
-        size_t h1 = std::hash<int64_t>{}(key.x);
-        size_t h2 = std::hash<int64_t>{}(key.y);
-        size_t h3 = std::hash<int64_t>{}(key.z);
-        size_t seed = h1;
-        seed ^= h2 + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
-        seed ^= h3 + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
-        return seed;
+        const Batch cx = e1[1] * e2[2] - e1[2] * e2[1];
+        const Batch cy = e1[2] * e2[0] - e1[0] * e2[2];
+        const Batch cz = e1[0] * e2[1] - e1[1] * e2[0];
+        const Batch length = (cx.square() + cy.square() + cz.square()).sqrt();
+        const Batch area = 0.5f * length;
+        const auto valid = area > 1e-8f;
+        const Batch inverse = valid.select(length.inverse(), 0.0f);
+        const Batch nx = cx * inverse;
+        const Batch ny = cy * inverse;
+        const Batch nz = valid.select(cz * inverse, 1.0f);
+        const Batch weight = valid.select(area, 0.0f);
+
+        for (std::size_t k = 0; k < count; ++k) {
+            float* normal = &normals[3 * (base + k)];
+            normal[0] = nx[k];
+            normal[1] = ny[k];
+            normal[2] = nz[k];
+            areas[base + k] = weight[k];
+        }
     }
-};
-
-inline QuantizedPosition quantizePosition(const QVector3D& v) {
-    auto quantize = [](float f) -> int64_t {
-        return static_cast<int64_t>(std::llround(static_cast<double>(f) * 10000.0));
-    };
-    return {quantize(v.x()), quantize(v.y()), quantize(v.z())};
 }
 
 } // namespace
@@ -179,130 +267,130 @@ inline QuantizedPosition quantizePosition(const QVector3D& v) {
 namespace onecad::render {
 
 void TessellationCache::computeSmoothNormals(SceneMeshStore::Mesh& mesh) {
-    if (mesh.triangles.empty() || mesh.vertices.empty()) {
+    if (mesh.indices.empty() || mesh.positions.empty()) {
         return;
     }
+    const std::size_t triangleCount = mesh.triangleCount();
+    const std::size_t cornerCount = 3 * triangleCount;
+    const std::size_t vertexCount = mesh.vertexCount();
+
+    // Smooth group of every triangle, from the face ranges
+    std::vector<ElementHandle> triangleGroups(triangleCount);
+    for (const auto& range : mesh.faces) {
+        ElementHandle group = range.faceId;  // Fallback: each face is its own group
+        auto it = mesh.faceGroupByFaceId.find(range.faceId);
+        if (it != mesh.faceGroupByFaceId.end()) {
+            group = it->second;
+        }
+        const std::size_t first = range.firstIndex / 3;
+        std::fill_n(triangleGroups.begin() + static_cast<std::ptrdiff_t>(first), range.indexCount / 3, group);
+    }
 
-    // Step 1: Compute face normals for all triangles
-    std::vector<QVector3D> faceNormals(mesh.triangles.size());
-    std::vector<float> faceAreas(mesh.triangles.size());
-
-    for (size_t ti = 0; ti < mesh.triangles.size(); ++ti) {
-        const auto& tri = mesh.triangles[ti];
-        const QVector3D& v0 = mesh.vertices[tri.i0];
-        const QVector3D& v1 = mesh.vertices[tri.i1];
-        const QVector3D& v2 = mesh.vertices[tri.i2];
+    std::vector<float> triangleNormals;
+    std::vector<float> triangleAreas;
+    computeTriangleNormals(mesh.positions, mesh.indices, triangleNormals, triangleAreas);
 
-        QVector3D edge1 = v1 - v0;
-        QVector3D edge2 = v2 - v0;
-        QVector3D cross = QVector3D::crossProduct(edge1, edge2);
-        float area = cross.length() * 0.5f;
+    // Step 1: Weld vertices by quantized position: sort them by key and number the distinct keys
+    std::vector<std::int64_t> keys(mesh.positions.size());
+    std::transform(mesh.positions.begin(), mesh.positions.end(), keys.begin(), quantize);
+    auto sameKey = [&keys](std::uint32_t a, std::uint32_t b) {
+        return std::equal(&keys[3 * a], &keys[3 * a] + 3, &keys[3 * b]);
+    };
+    std::vector<std::uint32_t> order(vertexCount);
+    std::iota(order.begin(), order.end(), 0u);
+    std::sort(order.begin(), order.end(), [&keys](std::uint32_t a, std::uint32_t b) {
+        return std::lexicographical_compare(&keys[3 * a], &keys[3 * a] + 3, &keys[3 * b], &keys[3 * b] + 3);
+    });
+    std::vector<std::uint32_t> welded(vertexCount);
+    std::uint32_t weldedCount = 0;
+    for (std::size_t k = 0; k < vertexCount; ++k) {
+        if (k > 0 && !sameKey(order[k - 1], order[k])) {
+            ++weldedCount;
+        }
+        welded[order[k]] = weldedCount;
+    }
+    ++weldedCount;
 
-        if (area > 1e-8f) {
-            faceNormals[ti] = cross.normalized();
-            faceAreas[ti] = area;
-        } else {
-            faceNormals[ti] = QVector3D(0, 0, 1);
-            faceAreas[ti] = 0.0f;
+    // Step 2: CSR adjacency: the triangle corners around each welded vertex, in corner order
+    std::vector<std::uint32_t> fanStart(weldedCount + 1, 0);
+    for (const std::uint32_t index : mesh.indices) {
+        ++fanStart[welded[index] + 1];
+    }
+    std::partial_sum(fanStart.begin(), fanStart.end(), fanStart.begin());
+    std::vector<std::uint32_t> fanCorners(cornerCount);
+    {
+        std::vector<std::uint32_t> next(fanStart.begin(), fanStart.end() - 1);
+        for (std::size_t corner = 0; corner < cornerCount; ++corner) {
+            fanCorners[next[welded[mesh.indices[corner]]]++] = static_cast<std::uint32_t>(corner);
         }
     }
 
-    // Step 2: Build position -> list of (triangleIdx, vertexSlot) map
-    struct TriVertex {
-        size_t triIdx;
-        int slot;  // 0, 1, or 2
-    };
-    std::unordered_map<QuantizedPosition, std::vector<TriVertex>, QuantizedPositionHash> positionToTriVerts;
-    positionToTriVerts.reserve(mesh.vertices.size());
-
-    for (size_t ti = 0; ti < mesh.triangles.size(); ++ti) {
-        const auto& tri = mesh.triangles[ti];
-        uint32_t indices[3] = {tri.i0, tri.i1, tri.i2};
-        for (int slot = 0; slot < 3; ++slot) {
-            QuantizedPosition posKey = quantizePosition(mesh.vertices[indices[slot]]);
-            positionToTriVerts[posKey].push_back({ti, slot});
-        }
-    }
-
-    // Step 3: For each position, group by smooth group and create split vertices
-    std::vector<QVector3D> newVertices;
-    std::vector<QVector3D> newNormals;
-    newVertices.reserve(mesh.vertices.size());
-    newNormals.reserve(mesh.vertices.size());
-
-    for (const auto& entry : positionToTriVerts) {
-        const auto& triVerts = entry.second;
-        // Group triangles by their smooth group
-        std::unordered_map<std::string, std::vector<TriVertex>> groupToTriVerts;
-        for (const auto& tv : triVerts) {
-            const auto& tri = mesh.triangles[tv.triIdx];
-            std::string group;
-            auto it = mesh.faceGroupByFaceId.find(tri.faceId);
-            if (it != mesh.faceGroupByFaceId.end()) {
-                group = it->second;
-            } else {
-                group = tri.faceId;  // Fallback: each face is its own group
+    // Step 3: Split each fan by smooth group. Groups are already the leaders of the face
+    // disjoint set, so sorting the fan by (group, corner) leaves one run per output vertex.
+    std::vector<float> newPositions;
+    std::vector<float> newNormals;
+    newPositions.reserve(mesh.positions.size());
+    newNormals.reserve(mesh.positions.size());
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> fan;  // (smooth group, corner)
+
+    for (std::uint32_t vertex = 0; vertex < weldedCount; ++vertex) {
+        fan.clear();
+        for (std::uint32_t k = fanStart[vertex]; k < fanStart[vertex + 1]; ++k) {
+            const std::uint32_t corner = fanCorners[k];
+            fan.emplace_back(triangleGroups[corner / 3].value, corner);
+        }
+        std::sort(fan.begin(), fan.end());
+
+        for (std::size_t runStart = 0; runStart < fan.size();) {
+            std::size_t runEnd = runStart + 1;
+            while (runEnd < fan.size() && fan[runEnd].first == fan[runStart].first) {
+                ++runEnd;
             }
-            groupToTriVerts[group].push_back(tv);
-        }
-
-        // For each smooth group at this position, create one vertex with averaged normal
-        for (auto& [group, groupTriVerts] : groupToTriVerts) {
-            // Compute area-weighted average normal
-            QVector3D avgNormal(0, 0, 0);
-            QVector3D pos;
-            bool posSet = false;
-
-            for (const auto& tv : groupTriVerts) {
-                const auto& tri = mesh.triangles[tv.triIdx];
-                uint32_t idx = (tv.slot == 0) ? tri.i0 : (tv.slot == 1) ? tri.i1 : tri.i2;
-                if (!posSet) {
-                    pos = mesh.vertices[idx];
-                    posSet = true;
+
+            // Area-weighted average of the facet normals, summed in corner order
+            float normal[3] = {0.0f, 0.0f, 0.0f};
+            for (std::size_t k = runStart; k < runEnd; ++k) {
+                const std::size_t triangle = fan[k].second / 3;
+                for (int axis = 0; axis < 3; ++axis) {
+                    normal[axis] += triangleNormals[3 * triangle + axis] * triangleAreas[triangle];
                 }
-                avgNormal += faceNormals[tv.triIdx] * faceAreas[tv.triIdx];
             }
-
-            if (avgNormal.lengthSquared() > 1e-8f) {
-                avgNormal.normalize();
+            const float lengthSquared = normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2];
+            if (lengthSquared > 1e-8f) {
+                const float length = std::sqrt(lengthSquared);
+                for (float& component : normal) {
+                    component /= length;
+                }
             } else {
-                avgNormal = QVector3D(0, 0, 1);
+                normal[0] = 0.0f;
+                normal[1] = 0.0f;
+                normal[2] = 1.0f;
             }
 
-            uint32_t newIdx = static_cast<uint32_t>(newVertices.size());
-            newVertices.push_back(pos);
-            newNormals.push_back(avgNormal);
+            const std::uint32_t newIdx = static_cast<std::uint32_t>(newPositions.size() / 3);
+            const float* position = &mesh.positions[3 * static_cast<std::size_t>(mesh.indices[fan[runStart].second])];
+            newPositions.insert(newPositions.end(), position, position + 3);
+            newNormals.insert(newNormals.end(), normal, normal + 3);
 
             // Update triangle indices to point to new vertex
-            for (const auto& tv : groupTriVerts) {
-                auto& tri = mesh.triangles[tv.triIdx];
-                if (tv.slot == 0) tri.i0 = newIdx;
-                else if (tv.slot == 1) tri.i1 = newIdx;
-                else tri.i2 = newIdx;
+            for (std::size_t k = runStart; k < runEnd; ++k) {
+                mesh.indices[fan[k].second] = newIdx;
             }
+            runStart = runEnd;
         }
     }
 
-    mesh.vertices = std::move(newVertices);
+    mesh.positions = std::move(newPositions);
     mesh.normals = std::move(newNormals);
 }
 
-SceneMeshStore::Mesh TessellationCache::buildMesh(const std::string& bodyId,
-                                                  const TopoDS_Shape& shape,
-                                                  kernel::elementmap::ElementMap& elementMap) const {
-    SceneMeshStore::Mesh mesh;
-    mesh.bodyId = bodyId;
-    mesh.modelMatrix.setToIdentity();
-
-    if (shape.IsNull()) {
-        return mesh;
-    }
-
+double TessellationCache::linearDeflectionFor(const TopoDS_Shape& shape) const {
     // Compute adaptive deflection based on bounding box
     double linearDeflection = settings_.linearDeflection;
     if (settings_.adaptive) {
         Bnd_Box bbox;
-        BRepBndLib::Add(shape, bbox);
+        // Geometry only: a triangulation on the shape must not change the deflection it is meshed at.
+        BRepBndLib::Add(shape, bbox, Standard_False);
         if (!bbox.IsVoid()) {
             double xmin, ymin, zmin, xmax, ymax, zmax;
             bbox.Get(xmin, ymin, zmin, xmax, ymax, zmax);
@@ -315,78 +403,205 @@ SceneMeshStore::Mesh TessellationCache::buildMesh(const std::string& bodyId,
             linearDeflection = std::max(linearDeflection, 0.001);
         }
     }
+    return linearDeflection;
+}
 
-    BRepMesh_IncrementalMesh mesher(shape, linearDeflection,
-                                    settings_.parallel, settings_.angularDeflection, true);
-    mesher.Perform();
-    if (!mesher.IsDone()) {
+std::size_t TessellationCache::missingFaceCount(const TopoDS_Shape& shape, std::size_t* faceCount) const {
+    std::size_t faces = 0;
+    std::size_t missing = 0;
+    if (!shape.IsNull()) {
+        const double linearDeflection = linearDeflectionFor(shape);
+        for (TopExp_Explorer faceExp(shape, TopAbs_FACE); faceExp.More(); faceExp.Next()) {
+            ++faces;
+            auto it = cacheEnabled_ ? faceCache_.find(faceExp.Current()) : faceCache_.end();
+            if (it == faceCache_.end() || it->second.linearDeflection != linearDeflection ||
+                it->second.angularDeflection != settings_.angularDeflection) {
+                ++missing;
+            }
+        }
+    }
+    if (faceCount) {
+        *faceCount = faces;
+    }
+    return missing;
+}
+
+SceneMeshStore::Mesh TessellationCache::buildMesh(const std::string& bodyId,
+                                                  const TopoDS_Shape& shape,
+                                                  kernel::elementmap::ElementMap& elementMap,
+                                                  const Message_ProgressRange& progress) const {
+    SceneMeshStore::Mesh mesh;
+    mesh.bodyId = bodyId;
+    mesh.modelMatrix.setToIdentity();
+
+    if (shape.IsNull()) {
         return mesh;
     }
 
+    const double linearDeflection = linearDeflectionFor(shape);
+    mesh.linearDeflection = linearDeflection;
+    const std::size_t threads = settings_.parallel ? std::max(1u, std::thread::hardware_concurrency()) : 1;
+
+    // Look the faces up first, so only the ones missing from the cache are meshed.
+    std::vector<TopoDS_Face> faces;
+    std::vector<const FaceBlock*> blocks;
+    std::vector<TopoDS_Shape> used;
+    BlockMap<FaceBlock> freshFaces;
+    BlockMap<EdgeBlock> freshEdges;
+    TopoDS_Compound missing;
+    BRep_Builder builder;
+    builder.MakeCompound(missing);
+    std::size_t missingCount = 0;
+    for (TopExp_Explorer faceExp(shape, TopAbs_FACE); faceExp.More(); faceExp.Next()) {
+        TopoDS_Face face = TopoDS::Face(faceExp.Current());
+        const FaceBlock* block = nullptr;
+        if (cacheEnabled_) {
+            auto it = faceCache_.find(face);
+            if (it != faceCache_.end() && it->second.linearDeflection == linearDeflection &&
+                it->second.angularDeflection == settings_.angularDeflection) {
+                block = &it->second;
+                ++stats_.faceHits;
+            }
+        }
+        if (!block && freshFaces.find(face) == freshFaces.end()) {
+            ++stats_.faceMisses;
+            freshFaces.emplace(face, FaceBlock{});
+            builder.Add(missing, face);
+            ++missingCount;
+        }
+        faces.push_back(face);
+        blocks.push_back(block);
+        used.push_back(face);
+    }
+
+    if (missingCount > 0) {
+        // Meshing the shape itself when nothing is cached keeps BRepMesh's view of shared edges.
+        const TopoDS_Shape& target = missingCount == faces.size() ? shape : static_cast<const TopoDS_Shape&>(missing);
+        // BRepMesh writes triangulations into the TShapes it meshes, and the document's TShapes are
+        // shared with other bodies, versions and threads. Mesh a topology copy (geometry is shared,
+        // read-only) so the blocks stay keyed by the original faces.
+        BRepBuilderAPI_Copy copier(target, Standard_False, Standard_False);
+        if (!copier.IsDone()) {
+            return mesh;
+        }
+        const TopoDS_Shape copy = copier.Shape();
+        // Keeps the positional constructor's mapping, which passed settings_.parallel as isRelative.
+        IMeshTools_Parameters parameters;
+        parameters.Deflection = linearDeflection;
+        parameters.Angle = settings_.angularDeflection;
+        parameters.Relative = settings_.parallel;
+        parameters.InParallel = Standard_True;
+        BRepMesh_IncrementalMesh mesher(copy, parameters, progress);
+        if (!mesher.IsDone() || progress.UserBreak()) {
+            return mesh;
+        }
+        // The copy has the original's structure, so walking both in step pairs each face with its
+        // copy, locations included.
+        std::vector<std::pair<TopoDS_Face, FaceBlock*>> extract;
+        extract.reserve(freshFaces.size());
+        std::unordered_set<const FaceBlock*> paired;
+        TopExp_Explorer copyExp(copy, TopAbs_FACE);
+        for (TopExp_Explorer faceExp(target, TopAbs_FACE); faceExp.More() && copyExp.More();
+             faceExp.Next(), copyExp.Next()) {
+            auto it = freshFaces.find(faceExp.Current());
+            if (it != freshFaces.end() && paired.insert(&it->second).second) {
+                extract.emplace_back(TopoDS::Face(copyExp.Current()), &it->second);
+            }
+        }
+        parallelFor(extract.size(), threads, [&](std::size_t k) {
+            *extract[k].second = extractFace(extract[k].first, linearDeflection,
+                                             settings_.angularDeflection);
+        });
+    }
+
     // Build edge-to-faces ancestor map to identify visible (sharp) edges
     TopTools_IndexedDataMapOfShapeListOfShape edgeToFacesMap;
     TopExp::MapShapesAndAncestors(shape, TopAbs_EDGE, TopAbs_FACE, edgeToFacesMap);
+    const std::size_t edgeCount = static_cast<std::size_t>(edgeToFacesMap.Extent());
 
     // Collect only edges that represent real boundaries (sharp or open edges)
-    VisibleEdgeSet visibleEdges;
-    for (int i = 1; i <= edgeToFacesMap.Extent(); ++i) {
-        const TopoDS_Edge& edge = TopoDS::Edge(edgeToFacesMap.FindKey(i));
-        const TopTools_ListOfShape& faces = edgeToFacesMap.FindFromIndex(i);
-        if (isVisibleEdge(edge, faces)) {
-            visibleEdges.insert(edge);
+    std::vector<char> visibleEdges(edgeCount, 0);
+    parallelFor(edgeCount, threads, [&](std::size_t k) {
+        const int i = static_cast<int>(k) + 1;
+        visibleEdges[k] = isVisibleEdge(TopoDS::Edge(edgeToFacesMap.FindKey(i)), edgeToFacesMap.FindFromIndex(i));
+    });
+
+    // Sample every visible edge once, however many faces share it.
+    const double step = std::max(settings_.linearDeflection * 2.0, 0.1);
+    std::vector<const EdgeBlock*> edgeBlocks(edgeCount, nullptr);
+    std::vector<std::pair<std::size_t, EdgeBlock*>> sample;
+    for (std::size_t k = 0; k < edgeCount; ++k) {
+        if (!visibleEdges[k]) {
+            continue;
+        }
+        const TopoDS_Shape& edge = edgeToFacesMap.FindKey(static_cast<int>(k) + 1);
+        used.push_back(edge);
+        if (cacheEnabled_) {
+            auto it = edgeCache_.find(edge);
+            if (it != edgeCache_.end() && it->second.step == step) {
+                edgeBlocks[k] = &it->second;
+                ++stats_.edgeHits;
+                continue;
+            }
         }
+        ++stats_.edgeMisses;
+        EdgeBlock& fresh = freshEdges[edge];
+        fresh.step = step;
+        edgeBlocks[k] = &fresh;
+        sample.emplace_back(k, &fresh);
     }
+    parallelFor(sample.size(), threads, [&](std::size_t k) {
+        const int i = static_cast<int>(sample[k].first) + 1;
+        sample[k].second->points = sampleEdge(TopoDS::Edge(edgeToFacesMap.FindKey(i)), step);
+    });
+
+    // Name each face and collect its boundary into its own slot, then merge in face order.
+    for (std::size_t faceIndex = 0; faceIndex < faces.size(); ++faceIndex) {
+        if (!blocks[faceIndex]) {
+            blocks[faceIndex] = &freshFaces.at(faces[faceIndex]);
+        }
+    }
+    std::vector<ElementHandle> faceIds(faces.size());
+    std::vector<SceneMeshStore::FaceTopology> topologies(faces.size());
+    parallelFor(faces.size(), threads, [&](std::size_t faceIndex) {
+        if (blocks[faceIndex]->positions.empty()) {
+            return;
+        }
+        faceIds[faceIndex] = elementMap.findHandleByShape(faces[faceIndex]);
+        topologies[faceIndex] = buildFaceTopology(bodyId, faces[faceIndex], elementMap, edgeToFacesMap, edgeBlocks);
+    });
 
-    std::unordered_map<TopoDS_Face, std::string, TopTools_ShapeMapHasher, TopTools_ShapeMapHasher> faceIdByShape;
+    std::unordered_map<TopoDS_Face, ElementHandle, TopTools_ShapeMapHasher, TopTools_ShapeMapHasher> faceIdByShape;
 
-    for (TopExp_Explorer faceExp(shape, TopAbs_FACE); faceExp.More(); faceExp.Next()) {
-        TopoDS_Face face = TopoDS::Face(faceExp.Current());
-        TopLoc_Location location;
-        Handle(Poly_Triangulation) triangulation = BRep_Tool::Triangulation(face, location);
-        if (triangulation.IsNull()) {
+    for (std::size_t faceIndex = 0; faceIndex < faces.size(); ++faceIndex) {
+        const TopoDS_Face& face = faces[faceIndex];
+        const FaceBlock* block = blocks[faceIndex];
+        if (block->positions.empty()) {
             continue;
         }
 
-        std::string faceId;
-        auto ids = elementMap.findIdsByShape(face);
-        if (!ids.empty()) {
-            faceId = ids.front().value;
-        }
-
-        if (faceId.empty()) {
-            faceId = bodyId + "/face/unknown_" + std::to_string(mesh.triangles.size());
+        ElementHandle faceId = faceIds[faceIndex];
+        if (!faceId.valid()) {
+            faceId = internElementId(bodyId + "/face/unknown_" + std::to_string(mesh.triangleCount()));
         }
 
         faceIdByShape.emplace(face, faceId);
 
-        SceneMeshStore::FaceTopology topology = buildFaceTopology(bodyId, face, elementMap, visibleEdges);
+        SceneMeshStore::FaceTopology& topology = topologies[faceIndex];
         topology.faceId = faceId;
         mesh.topologyByFace[faceId] = std::move(topology);
 
-        const gp_Trsf& trsf = location.Transformation();
-        std::uint32_t nodeOffset = static_cast<std::uint32_t>(mesh.vertices.size());
-        int nodeCount = triangulation->NbNodes();
-        mesh.vertices.reserve(mesh.vertices.size() + nodeCount);
-        for (int i = 1; i <= nodeCount; ++i) {
-            gp_Pnt p = triangulation->Node(i).Transformed(trsf);
-            mesh.vertices.emplace_back(static_cast<float>(p.X()),
-                                       static_cast<float>(p.Y()),
-                                       static_cast<float>(p.Z()));
-        }
-
-        int triCount = triangulation->NbTriangles();
-        mesh.triangles.reserve(mesh.triangles.size() + triCount);
-        for (int i = 1; i <= triCount; ++i) {
-            int n1 = 0;
-            int n2 = 0;
-            int n3 = 0;
-            triangulation->Triangle(i).Get(n1, n2, n3);
-            SceneMeshStore::Triangle tri;
-            tri.i0 = nodeOffset + static_cast<std::uint32_t>(n1 - 1);
-            tri.i1 = nodeOffset + static_cast<std::uint32_t>(n2 - 1);
-            tri.i2 = nodeOffset + static_cast<std::uint32_t>(n3 - 1);
-            tri.faceId = faceId;
-            mesh.triangles.push_back(tri);
+        const auto nodeOffset = static_cast<std::uint32_t>(mesh.vertexCount());
+        mesh.positions.insert(mesh.positions.end(), block->positions.begin(), block->positions.end());
+
+        SceneMeshStore::FaceRange range;
+        range.faceId = faceId;
+        range.firstIndex = static_cast<std::uint32_t>(mesh.indices.size());
+        range.indexCount = static_cast<std::uint32_t>(block->indices.size());
+        mesh.faces.push_back(range);
+        mesh.indices.reserve(mesh.indices.size() + block->indices.size());
+        for (const std::uint32_t index : block->indices) {
+            mesh.indices.push_back(nodeOffset + index);
         }
     }
 
@@ -396,19 +611,18 @@ SceneMeshStore::Mesh TessellationCache::buildMesh(const std::string& bodyId,
     }
 
     for (int i = 1; i <= edgeToFacesMap.Extent(); ++i) {
-        const TopoDS_Edge& edge = TopoDS::Edge(edgeToFacesMap.FindKey(i));
-        if (visibleEdges.find(edge) != visibleEdges.end()) {
+        if (visibleEdges[static_cast<std::size_t>(i - 1)]) {
             continue;
         }
         const TopTools_ListOfShape& faces = edgeToFacesMap.FindFromIndex(i);
-        std::string firstId;
+        ElementHandle firstId;
         for (TopTools_ListIteratorOfListOfShape it(faces); it.More(); it.Next()) {
             TopoDS_Face face = TopoDS::Face(it.Value());
             auto faceIdIt = faceIdByShape.find(face);
             if (faceIdIt == faceIdByShape.end()) {
                 continue;
             }
-            if (firstId.empty()) {
+            if (!firstId.valid()) {
                 firstId = faceIdIt->second;
             } else {
                 faceGroups.unite(firstId, faceIdIt->second);
@@ -417,28 +631,195 @@ SceneMeshStore::Mesh TessellationCache::buildMesh(const std::string& bodyId,
     }
 
     for (const auto& entry : faceIdByShape) {
-        const std::string& faceId = entry.second;
+        const ElementHandle faceId = entry.second;
         mesh.faceGroupByFaceId[faceId] = faceGroups.find(faceId);
     }
 
     // Compute smooth normals with vertex splitting at crease edges
     computeSmoothNormals(mesh);
 
+    if (cacheEnabled_) {
+        retainBody(bodyId, freshFaces, freshEdges, std::move(used));
+    }
+
     return mesh;
 }
 
+TessellationCache::FaceBlock TessellationCache::extractFace(const TopoDS_Face& face,
+                                                            double linearDeflection,
+                                                            double angularDeflection) {
+    FaceBlock block;
+    block.linearDeflection = linearDeflection;
+    block.angularDeflection = angularDeflection;
+
+    TopLoc_Location location;
+    Handle(Poly_Triangulation) triangulation = BRep_Tool::Triangulation(face, location);
+    if (triangulation.IsNull()) {
+        return block;
+    }
+
+    const gp_Trsf& trsf = location.Transformation();
+    int nodeCount = triangulation->NbNodes();
+    block.positions.reserve(3 * static_cast<std::size_t>(nodeCount));
+    for (int i = 1; i <= nodeCount; ++i) {
+        gp_Pnt p = triangulation->Node(i).Transformed(trsf);
+        block.positions.insert(block.positions.end(), {static_cast<float>(p.X()),
+                                                       static_cast<float>(p.Y()),
+                                                       static_cast<float>(p.Z())});
+    }
+
+    int triCount = triangulation->NbTriangles();
+    block.indices.reserve(3 * static_cast<std::size_t>(triCount));
+    for (int i = 1; i <= triCount; ++i) {
+        int n1 = 0;
+        int n2 = 0;
+        int n3 = 0;
+        triangulation->Triangle(i).Get(n1, n2, n3);
+        block.indices.insert(block.indices.end(), {static_cast<std::uint32_t>(n1 - 1),
+                                                   static_cast<std::uint32_t>(n2 - 1),
+                                                   static_cast<std::uint32_t>(n3 - 1)});
+    }
+    return block;
+}
+
+std::vector<QVector3D> TessellationCache::sampleEdge(const TopoDS_Edge& edge, double step) {
+    std::vector<QVector3D> points;
+    BRepAdaptor_Curve curve(edge);
+    double first = curve.FirstParameter();
+    double last = curve.LastParameter();
+    double length = 0.0;
+    try {
+        length = GCPnts_AbscissaPoint::Length(curve, first, last);
+    } catch (const Standard_Failure&) {
+        length = 0.0;
+    }
+    int segments = std::max(2, static_cast<int>(std::ceil(length / step)));
+
+    GCPnts_UniformAbscissa abscissa(curve, segments);
+    if (abscissa.IsDone() && abscissa.NbPoints() > 1) {
+        for (int i = 1; i <= abscissa.NbPoints(); ++i) {
+            double param = abscissa.Parameter(i);
+            gp_Pnt point = curve.Value(param);
+            points.emplace_back(static_cast<float>(point.X()),
+                                static_cast<float>(point.Y()),
+                                static_cast<float>(point.Z()));
+        }
+    } else {
+        gp_Pnt p1 = curve.Value(first);
+        gp_Pnt p2 = curve.Value(last);
+        points.emplace_back(static_cast<float>(p1.X()),
+                            static_cast<float>(p1.Y()),
+                            static_cast<float>(p1.Z()));
+        points.emplace_back(static_cast<float>(p2.X()),
+                            static_cast<float>(p2.Y()),
+                            static_cast<float>(p2.Z()));
+    }
+    return points;
+}
+
+void TessellationCache::retainBody(const std::string& bodyId,
+                                   BlockMap<FaceBlock>& freshFaces,
+                                   BlockMap<EdgeBlock>& freshEdges,
+                                   std::vector<TopoDS_Shape> used) const {
+    for (auto& [face, block] : freshFaces) {
+        FaceBlock& slot = faceCache_[face];
+        const int users = slot.users;
+        slot = std::move(block);
+        slot.users = users;
+    }
+    for (auto& [edge, block] : freshEdges) {
+        EdgeBlock& slot = edgeCache_[edge];
+        const int users = slot.users;
+        slot = std::move(block);
+        slot.users = users;
+    }
+
+    // A face or edge can repeat within a build; each body holds one reference.
+    std::unordered_set<TopoDS_Shape, TopTools_ShapeMapHasher, TopTools_ShapeMapHasher> unique;
+    std::vector<TopoDS_Shape> retained;
+    retained.reserve(used.size());
+    for (auto& shape : used) {
+        if (unique.insert(shape).second) {
+            retained.push_back(std::move(shape));
+        }
+    }
+    // Take the new references before dropping the old ones, so shared blocks survive.
+    for (const auto& shape : retained) {
+        if (shape.ShapeType() == TopAbs_FACE) {
+            ++faceCache_[shape].users;
+        } else {
+            ++edgeCache_[shape].users;
+        }
+    }
+    auto& previous = shapesByBody_[bodyId];
+    std::swap(previous, retained);
+    releaseShapes(retained);
+}
+
+void TessellationCache::releaseShapes(const std::vector<TopoDS_Shape>& shapes) const {
+    for (const auto& shape : shapes) {
+        if (shape.ShapeType() == TopAbs_FACE) {
+            auto it = faceCache_.find(shape);
+            if (it != faceCache_.end() && --it->second.users <= 0) {
+                faceCache_.erase(it);
+                ++stats_.released;
+            }
+        } else {
+            auto it = edgeCache_.find(shape);
+            if (it != edgeCache_.end() && --it->second.users <= 0) {
+                edgeCache_.erase(it);
+                ++stats_.released;
+            }
+        }
+    }
+}
+
+void TessellationCache::setCacheEnabled(bool enabled) {
+    cacheEnabled_ = enabled;
+    if (!enabled) {
+        clearCache();
+    }
+}
+
+TessellationCache::CacheStats TessellationCache::cacheStats() const {
+    CacheStats stats = stats_;
+    stats.faces = faceCache_.size();
+    stats.edges = edgeCache_.size();
+    return stats;
+}
+
+void TessellationCache::resetCacheStats() {
+    stats_ = CacheStats{};
+}
+
+void TessellationCache::releaseBody(const std::string& bodyId) {
+    auto it = shapesByBody_.find(bodyId);
+    if (it == shapesByBody_.end()) {
+        return;
+    }
+    releaseShapes(it->second);
+    shapesByBody_.erase(it);
+}
+
+void TessellationCache::clearCache() {
+    faceCache_.clear();
+    edgeCache_.clear();
+    shapesByBody_.clear();
+}
+
 SceneMeshStore::FaceTopology TessellationCache::buildFaceTopology(
     const std::string& bodyId,
     const TopoDS_Face& face,
-    kernel::elementmap::ElementMap& elementMap,
-    const VisibleEdgeSet& visibleEdges) const {
+    const kernel::elementmap::ElementMap& elementMap,
+    const TopTools_IndexedDataMapOfShapeListOfShape& edgeToFaces,
+    const std::vector<const EdgeBlock*>& edgeBlocks) {
     SceneMeshStore::FaceTopology topology;
 
-    std::unordered_set<std::string> seenEdges;
-    std::unordered_set<std::string> seenVertices;
-    std::unordered_map<TopoDS_Shape, std::string, TopTools_ShapeMapHasher, TopTools_ShapeMapHasher>
+    std::unordered_set<ElementHandle, ElementHandleHash> seenEdges;
+    std::unordered_set<ElementHandle, ElementHandleHash> seenVertices;
+    std::unordered_map<TopoDS_Shape, ElementHandle, TopTools_ShapeMapHasher, TopTools_ShapeMapHasher>
         generatedEdgeIds;
-    std::unordered_map<TopoDS_Shape, std::string, TopTools_ShapeMapHasher, TopTools_ShapeMapHasher>
+    std::unordered_map<TopoDS_Shape, ElementHandle, TopTools_ShapeMapHasher, TopTools_ShapeMapHasher>
         generatedVertexIds;
     int unknownEdgeCount = 0;
     int unknownVertexCount = 0;
@@ -448,22 +829,20 @@ SceneMeshStore::FaceTopology TessellationCache::buildFaceTopology(
         for (BRepTools_WireExplorer edgeExp(wire, face); edgeExp.More(); edgeExp.Next()) {
             TopoDS_Edge edge = edgeExp.Current();
 
-            // Skip edges that are not visible boundaries (tangent/seam edges)
-            if (visibleEdges.find(edge) == visibleEdges.end()) {
+            // Skip edges that are not visible boundaries (tangent/seam edges); those have no samples
+            const int edgeIndex = edgeToFaces.FindIndex(edge);
+            const EdgeBlock* block = edgeIndex > 0 ? edgeBlocks[static_cast<std::size_t>(edgeIndex - 1)] : nullptr;
+            if (!block) {
                 continue;
             }
 
-            std::string edgeId;
-            auto edgeIds = elementMap.findIdsByShape(edge);
-            if (!edgeIds.empty()) {
-                edgeId = edgeIds.front().value;
-            }
-            if (edgeId.empty()) {
+            ElementHandle edgeId = elementMap.findHandleByShape(edge);
+            if (!edgeId.valid()) {
                 auto it = generatedEdgeIds.find(edge);
                 if (it != generatedEdgeIds.end()) {
                     edgeId = it->second;
                 } else {
-                    edgeId = bodyId + "/edge/unknown_" + std::to_string(unknownEdgeCount++);
+                    edgeId = internElementId(bodyId + "/edge/unknown_" + std::to_string(unknownEdgeCount++));
                     generatedEdgeIds.emplace(edge, edgeId);
                 }
             }
@@ -471,38 +850,7 @@ SceneMeshStore::FaceTopology TessellationCache::buildFaceTopology(
             if (seenEdges.find(edgeId) == seenEdges.end()) {
                 SceneMeshStore::EdgePolyline polyline;
                 polyline.edgeId = edgeId;
-
-                BRepAdaptor_Curve curve(edge);
-                double first = curve.FirstParameter();
-                double last = curve.LastParameter();
-                double length = 0.0;
-                try {
-                    length = GCPnts_AbscissaPoint::Length(curve, first, last);
-                } catch (const Standard_Failure&) {
-                    length = 0.0;
-                }
-                double step = std::max(settings_.linearDeflection * 2.0, 0.1);
-                int segments = std::max(2, static_cast<int>(std::ceil(length / step)));
-
-                GCPnts_UniformAbscissa abscissa(curve, segments);
-                if (abscissa.IsDone() && abscissa.NbPoints() > 1) {
-                    for (int i = 1; i <= abscissa.NbPoints(); ++i) {
-                        double param = abscissa.Parameter(i);
-                        gp_Pnt point = curve.Value(param);
-                        polyline.points.emplace_back(static_cast<float>(point.X()),
-                                                     static_cast<float>(point.Y()),
-                                                     static_cast<float>(point.Z()));
-                    }
-                } else {
-                    gp_Pnt p1 = curve.Value(first);
-                    gp_Pnt p2 = curve.Value(last);
-                    polyline.points.emplace_back(static_cast<float>(p1.X()),
-                                                 static_cast<float>(p1.Y()),
-                                                 static_cast<float>(p1.Z()));
-                    polyline.points.emplace_back(static_cast<float>(p2.X()),
-                                                 static_cast<float>(p2.Y()),
-                                                 static_cast<float>(p2.Z()));
-                }
+                polyline.points = block->points;
 
                 if (polyline.points.size() >= 2) {
                     topology.edges.push_back(std::move(polyline));
@@ -518,17 +866,13 @@ SceneMeshStore::FaceTopology TessellationCache::buildFaceTopology(
                 if (vertex.IsNull()) {
                     continue;
                 }
-                std::string vertexId;
-                auto vertexIds = elementMap.findIdsByShape(vertex);
-                if (!vertexIds.empty()) {
-                    vertexId = vertexIds.front().value;
-                }
-                if (vertexId.empty()) {
+                ElementHandle vertexId = elementMap.findHandleByShape(vertex);
+                if (!vertexId.valid()) {
                     auto it = generatedVertexIds.find(vertex);
                     if (it != generatedVertexIds.end()) {
                         vertexId = it->second;
                     } else {
-                        vertexId = bodyId + "/vertex/unknown_" + std::to_string(unknownVertexCount++);
+                        vertexId = internElementId(bodyId + "/vertex/unknown_" + std::to_string(unknownVertexCount++));
                         generatedVertexIds.emplace(vertex, vertexId);
                     }
                 }
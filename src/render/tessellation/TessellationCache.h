@@ -4,16 +4,28 @@
 #include "../scene/SceneMeshStore.h"
 #include "../../kernel/elementmap/ElementMap.h"
 
+#include <Message_ProgressRange.hxx>
 #include <TopoDS_Shape.hxx>
 #include <TopoDS_Face.hxx>
 #include <TopoDS_Edge.hxx>
+#include <TopTools_IndexedDataMapOfShapeListOfShape.hxx>
 #include <TopTools_ShapeMapHasher.hxx>
 
+#include <cstdint>
 #include <string>
-#include <unordered_set>
+#include <unordered_map>
+#include <vector>
 
 namespace onecad::render {
 
+// Meshes bodies for the scene. Triangulated faces and sampled edges are cached by their
+// TShape and Location, so after a regeneration only new or modified faces are meshed and the
+// rest of the body is assembled from cached blocks. Element IDs are looked up on every build,
+// since a renamed face keeps its geometry. With Settings::parallel, a build extracts, names
+// and samples faces and edges on several threads and merges them in face order, so the
+// result does not depend on the thread count. Faces are meshed on a topology copy of the body,
+// so a build leaves no triangulation on the caller's shape and may run while other threads read
+// it. The cache itself is not thread-safe.
 class TessellationCache {
 public:
     struct Settings {
@@ -23,27 +35,96 @@ public:
         bool adaptive = true;             // Auto-adjust based on model bounding box
     };
 
+    // Hit counters of the face and edge caches; see cacheStats().
+    struct CacheStats {
+        std::uint64_t faceHits = 0;
+        std::uint64_t faceMisses = 0;
+        std::uint64_t edgeHits = 0;
+        std::uint64_t edgeMisses = 0;
+        std::uint64_t released = 0;   // Blocks dropped because no body uses them any more
+        std::size_t faces = 0;
+        std::size_t edges = 0;
+
+        double faceHitRate() const {
+            const std::uint64_t lookups = faceHits + faceMisses;
+            return lookups == 0 ? 0.0 : static_cast<double>(faceHits) / static_cast<double>(lookups);
+        }
+    };
+
     TessellationCache() = default;
 
     void setSettings(const Settings& settings) { settings_ = settings; }
     const Settings& settings() const { return settings_; }
 
+    // A build interrupted through @p progress returns an empty mesh and caches nothing.
     SceneMeshStore::Mesh buildMesh(const std::string& bodyId,
                                    const TopoDS_Shape& shape,
-                                   kernel::elementmap::ElementMap& elementMap) const;
+                                   kernel::elementmap::ElementMap& elementMap,
+                                   const Message_ProgressRange& progress = Message_ProgressRange()) const;
 
-private:
-    using VisibleEdgeSet = std::unordered_set<TopoDS_Edge, TopTools_ShapeMapHasher, TopTools_ShapeMapHasher>;
+    // Linear deflection buildMesh() uses for the shape, after adaptive scaling.
+    double linearDeflectionFor(const TopoDS_Shape& shape) const;
+    // Faces of the shape buildMesh() would have to mesh, i.e. not cached at the current settings.
+    std::size_t missingFaceCount(const TopoDS_Shape& shape, std::size_t* faceCount = nullptr) const;
 
-    SceneMeshStore::FaceTopology buildFaceTopology(const std::string& bodyId,
-                                                   const TopoDS_Face& face,
-                                                   kernel::elementmap::ElementMap& elementMap,
-                                                   const VisibleEdgeSet& visibleEdges) const;
+    // Disabling the cache drops it; every build then meshes the whole shape.
+    void setCacheEnabled(bool enabled);
+    bool cacheEnabled() const { return cacheEnabled_; }
+    CacheStats cacheStats() const;
+    void resetCacheStats();
+    // Drops the blocks only the body's last build used. Call when a body goes away for good.
+    void releaseBody(const std::string& bodyId);
+    void clearCache();
 
-    // Compute smooth normals with vertex splitting at crease edges
+    // Welds the mesh's vertices by position and gives them area-weighted normals, splitting a
+    // vertex wherever faces of different smooth groups (faceGroupByFaceId) meet at it.
+    // Replaces positions, normals and indices; the face ranges stay valid.
     static void computeSmoothNormals(SceneMeshStore::Mesh& mesh);
 
+private:
+    // A triangulated face in world coordinates.
+    struct FaceBlock {
+        double linearDeflection = 0.0;
+        double angularDeflection = 0.0;
+        std::vector<float> positions;                         // x, y, z per vertex
+        std::vector<std::uint32_t> indices;                   // Three per triangle, face-local
+        int users = 0;                                        // Bodies whose last build used it
+    };
+
+    struct EdgeBlock {
+        double step = 0.0;
+        std::vector<QVector3D> points;
+        int users = 0;
+    };
+
+    template <typename Block>
+    using BlockMap = std::unordered_map<TopoDS_Shape, Block, TopTools_ShapeMapHasher, TopTools_ShapeMapHasher>;
+
+    // Boundary edges and vertices of a face. Reads only its arguments, so faces can be
+    // processed in parallel; edgeBlocks holds the samples of the visible edges by their
+    // index in edgeToFaces, and null for the others.
+    static SceneMeshStore::FaceTopology buildFaceTopology(
+        const std::string& bodyId,
+        const TopoDS_Face& face,
+        const kernel::elementmap::ElementMap& elementMap,
+        const TopTools_IndexedDataMapOfShapeListOfShape& edgeToFaces,
+        const std::vector<const EdgeBlock*>& edgeBlocks);
+
+    static FaceBlock extractFace(const TopoDS_Face& face, double linearDeflection, double angularDeflection);
+    static std::vector<QVector3D> sampleEdge(const TopoDS_Edge& edge, double step);
+    // Moves freshly built blocks into the cache, then hands the body's references over from
+    // its previous build to @p used, releasing blocks no body uses any more.
+    void retainBody(const std::string& bodyId, BlockMap<FaceBlock>& freshFaces,
+                    BlockMap<EdgeBlock>& freshEdges, std::vector<TopoDS_Shape> used) const;
+    void releaseShapes(const std::vector<TopoDS_Shape>& shapes) const;
+
     Settings settings_{};
+    bool cacheEnabled_ = true;
+    mutable BlockMap<FaceBlock> faceCache_;
+    mutable BlockMap<EdgeBlock> edgeCache_;
+    // Faces and edges each body's last build used, so blocks can be released with the body.
+    mutable std::unordered_map<std::string, std::vector<TopoDS_Shape>> shapesByBody_;
+    mutable CacheStats stats_;
 };
 
 } // namespace onecad::render
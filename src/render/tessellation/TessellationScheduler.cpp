@@ -0,0 +1,301 @@
+#include "TessellationScheduler.h"
+
+#include <Message_ProgressIndicator.hxx>
+#include <Message_ProgressScope.hxx>
+
+#include <QLoggingCategory>
+
+#include <algorithm>
+#include <utility>
+
+namespace onecad::render {
+
+Q_LOGGING_CATEGORY(logTessellationScheduler, "onecad.render.tessellation.scheduler")
+
+namespace {
+
+// Coarse pass: this many times the full-detail linear deflection, and at least this angle.
+constexpr double kCoarseDeflectionScale = 8.0;
+constexpr double kCoarseAngularDeflection = 0.5;
+// The coarse mesh is only shown ahead of the full one when at least this share of the faces
+// has to be meshed.
+constexpr std::size_t kCoarseMissingFaceDivisor = 4;
+// Fine level: the full-detail deflections divided by these.
+constexpr double kFineDeflectionDivisor = 4.0;
+constexpr double kFineAngularDivisor = 2.0;
+
+// Lets BRepMesh stop when a newer request supersedes the running build.
+class CancelIndicator : public Message_ProgressIndicator {
+public:
+    explicit CancelIndicator(std::shared_ptr<std::atomic<bool>> cancelled)
+        : cancelled_(std::move(cancelled)) {}
+
+    Standard_Boolean UserBreak() override { return cancelled_->load(std::memory_order_relaxed); }
+    void Show(const Message_ProgressScope&, const Standard_Boolean) override {}
+
+    DEFINE_STANDARD_RTTI_INLINE(CancelIndicator, Message_ProgressIndicator)
+
+private:
+    std::shared_ptr<std::atomic<bool>> cancelled_;
+};
+
+SceneMeshStore::Lod toLod(const SceneMeshStore::Mesh& mesh) {
+    return {mesh.linearDeflection, mesh.positions, mesh.normals, mesh.indices};
+}
+
+SceneMeshStore::Lod toLod(SceneMeshStore::Mesh&& mesh) {
+    return {mesh.linearDeflection, std::move(mesh.positions), std::move(mesh.normals), std::move(mesh.indices)};
+}
+
+} // namespace
+
+TessellationScheduler::TessellationScheduler(PublishCallback publish)
+    : publish_(std::move(publish)) {
+    fineCache_.setCacheEnabled(false);
+    worker_ = std::thread(&TessellationScheduler::workerLoop, this);
+}
+
+TessellationScheduler::~TessellationScheduler() {
+    shutdown();
+}
+
+std::uint64_t TessellationScheduler::submit(const std::string& bodyId, const TopoDS_Shape& shape,
+                                            std::vector<kernel::elementmap::Entry> elements) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_) {
+        return 0;
+    }
+    if (cancelLocked(bodyId)) {
+        ++superseded_;
+    }
+
+    Job job;
+    job.bodyId = bodyId;
+    job.generation = nextGeneration_++;
+    job.shape = shape;
+    job.elements = std::move(elements);
+    latest_[bodyId] = job.generation;
+    queue_.push_back(std::move(job));
+    cv_.notify_one();
+    return queue_.back().generation;
+}
+
+std::uint64_t TessellationScheduler::requestFine(const std::string& bodyId, const TopoDS_Shape& shape,
+                                                 std::vector<kernel::elementmap::Entry> elements) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_ || latest_.find(bodyId) != latest_.end()) {
+        return 0;
+    }
+
+    Job job;
+    job.detail = Detail::Fine;
+    job.bodyId = bodyId;
+    job.generation = nextGeneration_++;
+    job.shape = shape;
+    job.elements = std::move(elements);
+    latest_[bodyId] = job.generation;
+    queue_.push_back(std::move(job));
+    cv_.notify_one();
+    return queue_.back().generation;
+}
+
+void TessellationScheduler::cancel(const std::string& bodyId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cancelLocked(bodyId);
+    latest_.erase(bodyId);
+}
+
+void TessellationScheduler::releaseBody(const std::string& bodyId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_) {
+        return;
+    }
+    cancelLocked(bodyId);
+    latest_.erase(bodyId);
+    Job job;
+    job.task = Task::Release;
+    job.bodyId = bodyId;
+    queue_.push_back(std::move(job));
+    cv_.notify_one();
+}
+
+void TessellationScheduler::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_) {
+        return;
+    }
+    // The cache is cleared on the tessellation thread, so only builds are dropped here.
+    queue_.erase(std::remove_if(queue_.begin(), queue_.end(),
+                                [](const Job& job) { return job.task == Task::Build; }),
+                 queue_.end());
+    if (runningCancel_) {
+        runningCancel_->store(true, std::memory_order_relaxed);
+    }
+    latest_.clear();
+    Job job;
+    job.task = Task::Clear;
+    queue_.push_back(std::move(job));
+    cv_.notify_one();
+}
+
+void TessellationScheduler::waitForIdle() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idleCv_.wait(lock, [this]() { return stopping_ || (queue_.empty() && !running_); });
+}
+
+std::size_t TessellationScheduler::supersededCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return superseded_;
+}
+
+void TessellationScheduler::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            return;
+        }
+        stopping_ = true;
+        if (runningCancel_) {
+            runningCancel_->store(true, std::memory_order_relaxed);
+        }
+    }
+    cv_.notify_all();
+    idleCv_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+bool TessellationScheduler::cancelLocked(const std::string& bodyId) {
+    const auto end = std::remove_if(queue_.begin(), queue_.end(), [&bodyId](const Job& job) {
+        return job.task == Task::Build && job.bodyId == bodyId;
+    });
+    bool found = end != queue_.end();
+    queue_.erase(end, queue_.end());
+    if (runningCancel_ && runningBody_ == bodyId) {
+        runningCancel_->store(true, std::memory_order_relaxed);
+        found = true;
+    }
+    return found;
+}
+
+void TessellationScheduler::workerLoop() {
+    while (true) {
+        Job job;
+        auto cancelled = std::make_shared<std::atomic<bool>>(false);
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+            if (stopping_) {
+                return;
+            }
+            job = std::move(queue_.front());
+            queue_.pop_front();
+            running_ = true;
+            if (job.task == Task::Build) {
+                runningBody_ = job.bodyId;
+                runningCancel_ = cancelled;
+            }
+        }
+
+        switch (job.task) {
+        case Task::Build:
+            build(job, cancelled);
+            break;
+        case Task::Release:
+            cache_.releaseBody(job.bodyId);
+            coarseCache_.releaseBody(job.bodyId);
+            break;
+        case Task::Clear:
+            cache_.clearCache();
+            coarseCache_.clearCache();
+            break;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_ = false;
+            runningBody_.clear();
+            runningCancel_.reset();
+            if (queue_.empty()) {
+                idleCv_.notify_all();
+            }
+        }
+    }
+}
+
+void TessellationScheduler::build(const Job& job, const std::shared_ptr<std::atomic<bool>>& cancelled) {
+    // The build only needs the body's names, not the whole document's.
+    kernel::elementmap::ElementMap names;
+    names.restoreBodyEntries(job.bodyId, job.elements);
+    Handle(CancelIndicator) indicator = new CancelIndicator(cancelled);
+    const double linearDeflection = cache_.linearDeflectionFor(job.shape);
+
+    if (job.detail == Detail::Fine) {
+        TessellationCache::Settings fine = cache_.settings();
+        fine.linearDeflection = linearDeflection / kFineDeflectionDivisor;
+        fine.angularDeflection /= kFineAngularDivisor;
+        fine.adaptive = false;
+        fineCache_.setSettings(fine);
+        Result result{job.bodyId, job.generation, Detail::Fine, {}, {}};
+        result.lod = toLod(fineCache_.buildMesh(job.bodyId, job.shape, names, indicator->Start()));
+        publishIfCurrent(job, std::move(result), *cancelled);
+        qCDebug(logTessellationScheduler) << "fine:done"
+                                          << "body=" << QString::fromStdString(job.bodyId)
+                                          << "generation=" << job.generation;
+        return;
+    }
+
+    // The coarse level is always built, mostly from cache; it is only shown ahead of the full
+    // mesh when most of the body has to be meshed.
+    std::size_t faceCount = 0;
+    const std::size_t missing = cache_.missingFaceCount(job.shape, &faceCount);
+    TessellationCache::Settings coarse = cache_.settings();
+    coarse.linearDeflection = linearDeflection * kCoarseDeflectionScale;
+    coarse.angularDeflection = std::max(coarse.angularDeflection, kCoarseAngularDeflection);
+    coarse.adaptive = false;
+    coarseCache_.setSettings(coarse);
+    SceneMeshStore::Mesh coarseMesh = coarseCache_.buildMesh(job.bodyId, job.shape, names, indicator->Start());
+    SceneMeshStore::Lod coarseLod;
+    if (missing > 0 && missing * kCoarseMissingFaceDivisor >= faceCount) {
+        coarseLod = toLod(coarseMesh);
+        publishIfCurrent(job, Result{job.bodyId, job.generation, Detail::Coarse, std::move(coarseMesh), {}},
+                         *cancelled);
+    } else {
+        coarseLod = toLod(std::move(coarseMesh));
+    }
+    if (cancelled->load(std::memory_order_relaxed)) {
+        qCDebug(logTessellationScheduler) << "build:superseded"
+                                          << "body=" << QString::fromStdString(job.bodyId)
+                                          << "generation=" << job.generation;
+        return;
+    }
+    Result result{job.bodyId, job.generation, Detail::Full,
+                  cache_.buildMesh(job.bodyId, job.shape, names, indicator->Start()), {}};
+    result.mesh.coarse = std::move(coarseLod);
+    publishIfCurrent(job, std::move(result), *cancelled);
+
+    qCDebug(logTessellationScheduler) << "build:done"
+                                      << "body=" << QString::fromStdString(job.bodyId)
+                                      << "generation=" << job.generation
+                                      << "faces=" << faceCount
+                                      << "meshed=" << missing;
+}
+
+void TessellationScheduler::publishIfCurrent(const Job& job, Result&& result, const std::atomic<bool>& cancelled) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = latest_.find(job.bodyId);
+        if (cancelled.load(std::memory_order_relaxed) || it == latest_.end() || it->second != job.generation) {
+            return;
+        }
+        if (result.detail != Detail::Coarse) {
+            latest_.erase(it);
+        }
+    }
+    if (publish_) {
+        publish_(std::move(result));
+    }
+}
+
+} // namespace onecad::render
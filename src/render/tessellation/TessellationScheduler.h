@@ -0,0 +1,109 @@
+#ifndef ONECAD_RENDER_TESSELLATION_TESSELLATIONSCHEDULER_H
+#define ONECAD_RENDER_TESSELLATION_TESSELLATIONSCHEDULER_H
+
+#include "TessellationCache.h"
+
+#include <TopoDS_Shape.hxx>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace onecad::render {
+
+// Tessellates bodies off the UI thread. A request publishes a coarse mesh first, so the body
+// can be drawn at once, then its full-detail mesh; a body whose faces are mostly cached skips
+// the coarse preview. The full mesh carries the coarse one as its Coarse level of detail, and
+// requestFine() builds a Fine level on demand. A newer request for a body supersedes its
+// queued one and interrupts its running build inside BRepMesh.
+//
+// Builds run one at a time on a single thread, which owns the caches, while BRepMesh meshes
+// their faces in parallel. TessellationCache meshes a copy of each body, so the document's
+// shapes, which the UI and regeneration threads read meanwhile, are never written.
+class TessellationScheduler {
+public:
+    enum class Detail { Coarse, Full, Fine };
+
+    struct Result {
+        std::string bodyId;
+        std::uint64_t generation = 0;
+        Detail detail = Detail::Full;
+        SceneMeshStore::Mesh mesh;  // Coarse and Full results
+        SceneMeshStore::Lod lod;    // Fine results
+    };
+
+    // Runs on the tessellation thread, for results still current when their build finished.
+    using PublishCallback = std::function<void(Result&&)>;
+
+    explicit TessellationScheduler(PublishCallback publish);
+    ~TessellationScheduler();
+
+    // Queues a build of the shape, naming its faces, edges and vertices from @p elements
+    // (the body's ElementMap::bodyEntries()). Returns the request's generation.
+    std::uint64_t submit(const std::string& bodyId, const TopoDS_Shape& shape,
+                         std::vector<kernel::elementmap::Entry> elements);
+    // Queues a finer level of detail of a body whose full mesh has landed; returns 0, queuing
+    // nothing, while a build of the body is still queued or running.
+    std::uint64_t requestFine(const std::string& bodyId, const TopoDS_Shape& shape,
+                              std::vector<kernel::elementmap::Entry> elements);
+    // Drops the body's queued request and interrupts its running build.
+    void cancel(const std::string& bodyId);
+    // Cancels the body's requests, then drops the cache blocks only it used.
+    void releaseBody(const std::string& bodyId);
+    // Cancels every request and empties the cache.
+    void clear();
+
+    // Blocks until nothing is queued or running.
+    void waitForIdle();
+    // Requests dropped or interrupted because a newer one replaced them.
+    std::size_t supersededCount() const;
+    void shutdown();
+
+private:
+    enum class Task { Build, Release, Clear };
+
+    struct Job {
+        Task task = Task::Build;
+        Detail detail = Detail::Full;  // Full or Fine
+        std::string bodyId;
+        std::uint64_t generation = 0;
+        TopoDS_Shape shape;
+        std::vector<kernel::elementmap::Entry> elements;
+    };
+
+    void workerLoop();
+    void build(const Job& job, const std::shared_ptr<std::atomic<bool>>& cancelled);
+    void publishIfCurrent(const Job& job, Result&& result, const std::atomic<bool>& cancelled);
+    // Drops queued builds of the body and interrupts its running one; false if there were none.
+    bool cancelLocked(const std::string& bodyId);
+
+    PublishCallback publish_;
+    TessellationCache cache_;        // Full detail
+    TessellationCache coarseCache_;
+    TessellationCache fineCache_;    // Caching off: fine meshes are large and built once
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::condition_variable idleCv_;
+    std::deque<Job> queue_;
+    std::unordered_map<std::string, std::uint64_t> latest_;  // bodyId -> generation to publish
+    std::string runningBody_;
+    std::shared_ptr<std::atomic<bool>> runningCancel_;
+    bool running_ = false;
+    bool stopping_ = false;
+    std::uint64_t nextGeneration_ = 1;
+    std::size_t superseded_ = 0;
+    std::thread worker_;  // Started last, once the members above exist
+};
+
+} // namespace onecad::render
+
+#endif // ONECAD_RENDER_TESSELLATION_TESSELLATIONSCHEDULER_H
@@ -8,7 +8,6 @@
 #include "../../app/document/Document.h"
 #include "../../app/document/OperationRecord.h"
 #include "../../app/history/RegenerationEngine.h"
-#include "../../core/sketch/Sketch.h"
 #include "../../render/tessellation/TessellationCache.h"
 #include "../viewport/Viewport.h"
 
@@ -33,40 +32,6 @@ constexpr double kMinAngle = -360.0;
 constexpr double kMaxAngle = 360.0;
 constexpr double kMinDraft = -89.0;
 constexpr double kMaxDraft = 89.0;
-
-std::unique_ptr<app::Document> makePreviewDocument(const app::Document& source) {
-    auto preview = std::make_unique<app::Document>();
-
-    preview->elementMap().fromString(source.elementMap().toString());
-
-    for (const auto& sketchId : source.getSketchIds()) {
-        const auto* sketch = source.getSketch(sketchId);
-        if (!sketch) {
-            continue;
-        }
-        auto clone = core::sketch::Sketch::fromJson(sketch->toJson());
-        if (!clone) {
-            continue;
-        }
-        preview->addSketchWithId(sketchId, std::move(clone), source.getSketchName(sketchId));
-    }
-
-    for (const auto& bodyId : source.getBodyIds()) {
-        const TopoDS_Shape* shape = source.getBodyShape(bodyId);
-        if (!shape || shape->IsNull()) {
-            continue;
-        }
-        preview->addBodyWithId(bodyId, *shape, source.getBodyName(bodyId));
-    }
-
-    for (const auto& op : source.operations()) {
-        preview->addOperation(op);
-    }
-
-    preview->setOperationSuppressionState(source.operationSuppressionState());
-    preview->setBaseBodyIds(source.baseBodyIds());
-    return preview;
-}
 } // namespace
 
 EditParameterDialog::EditParameterDialog(app::Document* document,
@@ -250,8 +215,14 @@ void EditParameterDialog::updatePreview() {
         newParams = getRevolveParams();
     }
 
-    auto previewDoc = makePreviewDocument(*document_);
-    auto* op = previewDoc->findOperation(opId_);
+    if (!previewDocument_) {
+        // Forked once per dialog with shapes shared; every later change replays
+        // incrementally on top of the previous preview.
+        previewDocument_ = document_->cloneForRegeneration();
+        previewEngine_ = std::make_unique<app::history::RegenerationEngine>(previewDocument_.get());
+        previewTessellator_ = std::make_unique<render::TessellationCache>();
+    }
+    auto* op = previewDocument_->findOperation(opId_);
     if (!op) {
         qCWarning(logEditParamsDialog) << "updatePreview:operation-not-found"
                                        << QString::fromStdString(opId_);
@@ -259,8 +230,7 @@ void EditParameterDialog::updatePreview() {
     }
     op->params = newParams;
 
-    app::history::RegenerationEngine engine(previewDoc.get());
-    auto result = engine.regenerateAll();
+    auto result = previewEngine_->regenerateIncremental(previewDocument_->appliedOpCount(), {opId_});
     if (result.status == app::history::RegenStatus::CriticalFailure) {
         qCWarning(logEditParamsDialog) << "updatePreview:critical-regeneration-failure"
                                        << "opId=" << QString::fromStdString(opId_);
@@ -268,19 +238,33 @@ void EditParameterDialog::updatePreview() {
         return;
     }
 
-    render::TessellationCache tessellator;
+    // Bodies the preview left untouched reuse the document's meshes; the ones it
+    // rebuilt are meshed here, since the fork does not mesh.
     std::vector<render::SceneMeshStore::Mesh> meshes;
-    for (const auto& bodyId : previewDoc->getBodyIds()) {
-        const TopoDS_Shape* shape = previewDoc->getBodyShape(bodyId);
+    std::size_t reused = 0;
+    for (const auto& bodyId : previewDocument_->getBodyIds()) {
+        const TopoDS_Shape* shape = previewDocument_->getBodyShape(bodyId);
         if (!shape || shape->IsNull()) {
             continue;
         }
-        meshes.push_back(tessellator.buildMesh(bodyId, *shape, previewDoc->elementMap()));
+        const TopoDS_Shape* sourceShape = document_->getBodyShape(bodyId);
+        const render::SceneMeshStore::Mesh* mesh = nullptr;
+        if (sourceShape && sourceShape->IsEqual(*shape)) {
+            mesh = document_->meshStore().findMesh(bodyId);
+            reused += mesh ? 1 : 0;
+        }
+        if (mesh) {
+            meshes.push_back(*mesh);
+        } else {
+            meshes.push_back(previewTessellator_->buildMesh(bodyId, *shape, previewDocument_->elementMap()));
+        }
     }
     viewport_->setModelPreviewMeshes(meshes);
     qCDebug(logEditParamsDialog) << "updatePreview:done"
                                  << "opId=" << QString::fromStdString(opId_)
-                                 << "meshCount=" << meshes.size();
+                                 << "meshCount=" << meshes.size()
+                                 << "reused=" << reused
+                                 << "replayed=" << previewEngine_->lastReplayedOpCount();
 
     emit previewRequested(QString::fromStdString(opId_));
 }
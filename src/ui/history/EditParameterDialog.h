@@ -29,6 +29,10 @@ class RegenerationEngine;
 }
 }
 
+namespace render {
+class TessellationCache;
+}
+
 namespace ui {
 
 class Viewport;
@@ -78,6 +82,12 @@ private:
     std::string opId_;
     QTimer* debounceTimer_ = nullptr;
 
+    // Preview fork of document_, created on the first change
+    std::unique_ptr<app::Document> previewDocument_;
+    std::unique_ptr<app::history::RegenerationEngine> previewEngine_;
+    // Meshes the bodies the preview rebuilds; kept so unchanged faces are reused between edits
+    std::unique_ptr<render::TessellationCache> previewTessellator_;
+
     // Parameter controls
     QVBoxLayout* paramsLayout_ = nullptr;
     QDoubleSpinBox* distanceSpinbox_ = nullptr;   // Extrude
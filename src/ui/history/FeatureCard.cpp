@@ -52,6 +52,13 @@ FeatureCard::FeatureCard(QWidget* parent)
     textLabel_->setAttribute(Qt::WA_TranslucentBackground);
     layout->addWidget(textLabel_, 1);
 
+    costLabel_ = new QLabel(this);
+    costLabel_->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    costLabel_->setAutoFillBackground(false);
+    costLabel_->setAttribute(Qt::WA_TranslucentBackground);
+    costLabel_->hide();
+    layout->addWidget(costLabel_);
+
     statusButton_ = new QToolButton(this);
     statusButton_->setProperty("nav-inline", true);
     statusButton_->setAutoRaise(true);
@@ -117,6 +124,12 @@ void FeatureCard::setSelected(bool selected) {
     updateStyle();
 }
 
+void FeatureCard::setCost(const QString& cost, const QString& tooltip) {
+    costLabel_->setText(cost);
+    costLabel_->setToolTip(tooltip);
+    costLabel_->setVisible(!cost.isEmpty());
+}
+
 void FeatureCard::updateTheme() {
     updateStyle();
 }
@@ -244,6 +257,9 @@ void FeatureCard::updateStyle() {
     overflowButton_->setIcon(QIcon(tintIcon(":/icons/ic_overflow.svg", iconColor)));
     overflowButton_->setVisible(hovered_ || selected_);
 
+    costLabel_->setStyleSheet(QString("QLabel { color: %1; border: none; background: transparent; }")
+                                  .arg(theme.navigator.placeholderText.name()));
+
     // Update main icon
     if (!iconPath_.isEmpty()) {
         iconLabel_->setPixmap(tintIcon(iconPath_, iconColor));
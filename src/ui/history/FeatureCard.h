@@ -26,6 +26,8 @@ public:
     void setFailed(bool failed, const QString& reason = {});
     void setSuppressed(bool suppressed);
     void setSelected(bool selected);
+    // Regeneration cost shown at the right edge, e.g. "12 ms"; empty hides it
+    void setCost(const QString& cost, const QString& tooltip = {});
     void updateTheme();
 
 signals:
@@ -42,6 +44,7 @@ private:
 
     QLabel* iconLabel_ = nullptr;
     QLabel* textLabel_ = nullptr;
+    QLabel* costLabel_ = nullptr;
     QToolButton* statusButton_ = nullptr; 
     QToolButton* overflowButton_ = nullptr;
 
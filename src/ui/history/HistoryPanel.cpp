@@ -8,6 +8,7 @@
 #include "../../app/document/Document.h"
 #include "../../app/document/OperationRecord.h"
 #include "../../app/history/DependencyGraph.h"
+#include "../../app/history/RegenProfile.h"
 #include "../viewport/Viewport.h"
 #include "../theme/ThemeManager.h"
 
@@ -19,6 +20,8 @@
 #include <QLabel>
 #include <QToolButton>
 #include <QMenu>
+#include <QFileDialog>
+#include <QMessageBox>
 #include <QPropertyAnimation>
 #include <QHeaderView>
 #include <QFont>
@@ -28,6 +31,15 @@
 
 namespace onecad::ui {
 
+namespace {
+QString formatMicros(std::int64_t micros) {
+    if (micros < 10000) {
+        return QString("%1 ms").arg(static_cast<double>(micros) / 1000.0, 0, 'f', 1);
+    }
+    return QString("%1 ms").arg((micros + 500) / 1000);
+}
+} // namespace
+
 HistoryPanel::HistoryPanel(QWidget* parent)
     : QWidget(parent) {
     setupUi();
@@ -353,7 +365,33 @@ void HistoryPanel::updateItemState(ItemEntry& entry) {
         entry.card->setFailed(entry.failed, QString::fromStdString(entry.failureReason));
         entry.card->setSuppressed(entry.suppressed);
         entry.card->setSelected(entry.item->isSelected());
+        updateItemCost(entry);
+    }
+}
+
+void HistoryPanel::updateItemCost(ItemEntry& entry) {
+    const app::history::OpProfile* profile =
+        document_ ? document_->regenProfile().find(entry.opId) : nullptr;
+    if (!profile || entry.suppressed) {
+        entry.card->setCost(QString());
+        return;
+    }
+
+    QString tooltip = tr("Last regeneration: %1").arg(formatMicros(profile->totalUs()));
+    if (profile->checkpointHit) {
+        tooltip += tr("\nReused from checkpoint");
+    } else {
+        tooltip += tr("\nKernel build: %1 (CPU %2)")
+                       .arg(formatMicros(profile->buildWallUs), formatMicros(profile->buildCpuUs));
     }
+    tooltip += tr("\nElement map: %1").arg(formatMicros(profile->elementMapUs));
+    tooltip += tr("\nTessellation: %1").arg(formatMicros(profile->tessellationUs));
+    tooltip += tr("\nResult: %1 faces, %2 edges").arg(profile->faceCount).arg(profile->edgeCount);
+    if (profile->residentDeltaBytes != 0) {
+        tooltip += tr("\nMemory: %1 MB")
+                       .arg(static_cast<double>(profile->residentDeltaBytes) / (1024.0 * 1024.0), 0, 'f', 1);
+    }
+    entry.card->setCost(formatMicros(profile->totalUs()), tooltip);
 }
 
 QString HistoryPanel::getOperationName(app::OperationType type) const {
@@ -545,9 +583,33 @@ void HistoryPanel::showContextMenu(const QPoint& pos, QTreeWidgetItem* item) {
         emit deleteRequested(QString::fromStdString(entry->opId));
     });
 
+    menu.addSeparator();
+
+    QAction* traceAction = menu.addAction(tr("Export Regeneration Trace..."));
+    traceAction->setEnabled(document_->regenProfile().isEnabled() &&
+                            !document_->regenProfile().lastRun().empty());
+    connect(traceAction, &QAction::triggered, this, &HistoryPanel::exportRegenerationTrace);
+
     menu.exec(pos);
 }
 
+void HistoryPanel::exportRegenerationTrace() {
+    if (!document_) return;
+
+    QString fileName = QFileDialog::getSaveFileName(this,
+        tr("Export Regeneration Trace"), QString(),
+        tr("Chrome Trace Files (*.json)"));
+    if (fileName.isEmpty()) return;
+    if (!fileName.endsWith(".json", Qt::CaseInsensitive)) {
+        fileName += ".json";
+    }
+
+    std::string error;
+    if (!document_->regenProfile().writeChromeTrace(fileName.toStdString(), error)) {
+        QMessageBox::warning(this, tr("Export Regeneration Trace"), QString::fromStdString(error));
+    }
+}
+
 HistoryPanel::ItemEntry* HistoryPanel::entryForItem(QTreeWidgetItem* item) {
     for (auto& entry : entries_) {
         if (entry.item == item) {
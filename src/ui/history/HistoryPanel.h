@@ -99,6 +99,7 @@ private:
     void applyCollapseState(bool animate);
     FeatureCard* createItemWidget(ItemEntry& entry);
     void updateItemState(ItemEntry& entry);
+    void updateItemCost(ItemEntry& entry);
     QWidget* createSectionHeader(const QString& text);
     QString getOperationName(app::OperationType type) const;
     QString getOperationDetails(const app::OperationRecord& op) const;
@@ -110,6 +111,7 @@ private:
     ItemEntry* entryForId(const std::string& opId);
     void showContextMenu(const QPoint& pos, QTreeWidgetItem* item);
     void showEditDialog(const std::string& opId);
+    void exportRegenerationTrace();
 
     QFrame* panel_ = nullptr;
     QTreeWidget* treeWidget_ = nullptr;
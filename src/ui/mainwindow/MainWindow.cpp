@@ -16,6 +16,7 @@
 #include "../../app/commands/SetOperationSuppressionCommand.h"
 #include "../../app/commands/ToggleVisibilityCommand.h"
 #include "../../app/document/Document.h"
+#include "../../app/history/AsyncRegenerator.h"
 #include "../../app/history/KernelScheduler.h"
 #include "../../app/history/RegenerationEngine.h"
 #include "../navigator/ModelNavigator.h"
@@ -190,6 +191,10 @@ MainWindow::MainWindow(QWidget* parent)
     resize(1280, 800);
     setMinimumSize(800, 600);
 
+    // Bodies are tessellated off the UI thread, in opened documents too, unless
+    // ONECAD_SYNC_TESSELLATION=1.
+    app::Document::setBackgroundTessellationDefault(qEnvironmentVariableIntValue("ONECAD_SYNC_TESSELLATION") != 1);
+
     // Create document model (no Qt parent - unique_ptr manages lifetime)
     m_document = std::make_unique<app::Document>();
     m_commandProcessor = std::make_unique<app::commands::CommandProcessor>();
@@ -235,6 +240,8 @@ MainWindow::MainWindow(QWidget* parent)
 
 MainWindow::~MainWindow() {
     saveSettings();
+    // Joins the regeneration thread while the document it writes to is still alive.
+    m_asyncRegenerator.reset();
 }
 
 void MainWindow::applyTheme() {
@@ -286,6 +293,31 @@ void MainWindow::connectDocumentSignals() {
     }
     connect(m_document.get(), &app::Document::documentCleared,
             m_navigator, [this]() { m_navigator->rebuild(m_document.get()); });
+
+    // Commands commit at once and regenerate on the writer thread, unless ONECAD_SYNC_REGEN=1.
+    if (app::history::AsyncRegenerator::isEnabled() && !m_document->asyncRegenerator()) {
+        m_asyncRegenerator = std::make_unique<app::history::AsyncRegenerator>(m_document.get());
+        auto* regenerator = m_asyncRegenerator.get();
+        connect(regenerator, &app::history::AsyncRegenerator::regenerationStarted, this, [this]() {
+            if (m_toolStatus) {
+                m_toolStatus->setText(tr("Regenerating..."));
+            }
+        });
+        connect(regenerator, &app::history::AsyncRegenerator::regenerationProgress, this,
+                [this](quint64, int permille) {
+                    if (m_toolStatus) {
+                        m_toolStatus->setText(tr("Regenerating... %1%").arg(permille / 10));
+                    }
+                });
+        connect(regenerator, &app::history::AsyncRegenerator::snapshotPublished, this, [this]() {
+            if (m_toolStatus) {
+                m_toolStatus->setText(tr("Ready"));
+            }
+            if (m_historyPanel) {
+                m_historyPanel->rebuild();
+            }
+        });
+    }
 }
 
 void MainWindow::updateDofStatus(core::sketch::Sketch* sketch) {
@@ -1484,7 +1516,8 @@ bool MainWindow::loadDocumentFromPath(const QString& fileName) {
         return false;
     }
 
-    // Replace current document with loaded one
+    // Replace current document with loaded one; its regenerator goes first
+    m_asyncRegenerator.reset();
     m_document = std::move(loadedDoc);
     if (m_commandProcessor) {
         m_commandProcessor->clear();
@@ -1568,7 +1601,9 @@ void MainWindow::handleRegenerationFailures() {
     }
 
     if (changed) {
-        if (kernelSchedulerShadowEnabled()) {
+        if (auto* async = m_document->asyncRegenerator()) {
+            async->requestRegeneration();
+        } else if (kernelSchedulerShadowEnabled()) {
             runSchedulerShadowComparison(m_document.get());
         } else {
             app::history::RegenerationEngine regen(m_document.get());
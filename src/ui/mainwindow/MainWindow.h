@@ -24,6 +24,9 @@ namespace app {
     namespace commands {
         class CommandProcessor;
     }
+    namespace history {
+        class AsyncRegenerator;
+    }
 }
 namespace core::sketch {
     class Sketch;
@@ -145,6 +148,8 @@ private:
     // Document model (owns all sketches)
     std::unique_ptr<app::Document> m_document;
     std::unique_ptr<app::commands::CommandProcessor> m_commandProcessor;
+    // Declared after m_document so it is destroyed first; it detaches from the document.
+    std::unique_ptr<app::history::AsyncRegenerator> m_asyncRegenerator;
 
     // Active editing state
     std::string m_activeSketchId;  // Currently editing sketch ID (empty if not in sketch mode)
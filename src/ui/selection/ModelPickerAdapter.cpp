@@ -7,6 +7,10 @@
 namespace onecad::ui::selection {
 
 namespace {
+using kernel::elementmap::elementIdString;
+using kernel::elementmap::findElementHandle;
+using kernel::elementmap::internElementId;
+
 constexpr int kVertexPriority = 0;
 constexpr int kEdgePriority = 1;
 constexpr int kFacePriority = 2;
@@ -84,21 +88,15 @@ void ModelPickerAdapter::setMeshes(std::vector<Mesh>&& meshes) {
     for (auto& mesh : meshes) {
         MeshCache cache;
         cache.bodyId = mesh.bodyId;
-        cache.vertices = std::move(mesh.vertices);
-        cache.triangles = std::move(mesh.triangles);
-
-        for (const auto& tri : cache.triangles) {
-            if (tri.i0 >= cache.vertices.size() ||
-                tri.i1 >= cache.vertices.size() ||
-                tri.i2 >= cache.vertices.size()) {
+        cache.positions = std::move(mesh.positions);
+        cache.indices = std::move(mesh.indices);
+        cache.faces.reserve(mesh.faces.size());
+        for (const auto& range : mesh.faces) {
+            if (static_cast<std::size_t>(range.firstIndex) + range.indexCount > cache.indices.size()) {
                 continue;
             }
-            std::array<QVector3D, 3> triVerts = {
-                cache.vertices[tri.i0],
-                cache.vertices[tri.i1],
-                cache.vertices[tri.i2]
-            };
-            cache.faceMap[tri.faceId].push_back(triVerts);
+            cache.faceRanges[range.faceId].push_back(cache.faces.size());
+            cache.faces.push_back(range);
         }
 
         if (!mesh.topologyByFace.empty()) {
@@ -126,53 +124,44 @@ void ModelPickerAdapter::setMeshes(std::vector<Mesh>&& meshes) {
                 cache.faceTopology[faceId] = std::move(faceCache);
             }
         } else {
-            std::unordered_map<std::string, std::unordered_map<std::string, int>> edgeCountsByFace;
-            for (const auto& tri : cache.triangles) {
-                if (tri.i0 >= cache.vertices.size() ||
-                    tri.i1 >= cache.vertices.size() ||
-                    tri.i2 >= cache.vertices.size()) {
-                    continue;
-                }
-                std::array<std::pair<std::uint32_t, std::uint32_t>, 3> edges = {{
-                    {tri.i0, tri.i1},
-                    {tri.i1, tri.i2},
-                    {tri.i2, tri.i0}
-                }};
-                for (const auto& edge : edges) {
-                    std::string edgeId = edgeIdForIndices(edge.first, edge.second);
-                    edgeCountsByFace[tri.faceId][edgeId]++;
-                }
+            // Boundary edges of each face, keyed by their sorted vertex indices
+            HandleMap<std::unordered_map<std::uint64_t, int>> edgeCountsByFace;
+            for (const auto& range : cache.faces) {
+                auto& edgeCounts = edgeCountsByFace[range.faceId];
+                cache.forEachTriangle(range, [&edgeCounts](const Triangle& tri) {
+                    std::array<std::pair<std::uint32_t, std::uint32_t>, 3> edges = {{
+                        {tri.i0, tri.i1},
+                        {tri.i1, tri.i2},
+                        {tri.i2, tri.i0}
+                    }};
+                    for (const auto& edge : edges) {
+                        const std::uint32_t a = std::min(edge.first, edge.second);
+                        const std::uint32_t b = std::max(edge.first, edge.second);
+                        edgeCounts[(static_cast<std::uint64_t>(a) << 32) | b]++;
+                    }
+                });
             }
 
             for (const auto& [faceId, edges] : edgeCountsByFace) {
                 MeshCache::FaceTopologyCache faceCache;
-                std::unordered_set<std::string> addedVertices;
-                for (const auto& [edgeId, count] : edges) {
+                std::unordered_set<ElementHandle, ElementHandleHash> addedVertices;
+                for (const auto& [edgeKey, count] : edges) {
                     if (count != 1) {
                         continue;
                     }
-                    size_t underscore = edgeId.find('_');
-                    if (underscore == std::string::npos) {
-                        continue;
-                    }
-                    std::uint32_t a = static_cast<std::uint32_t>(
-                        std::stoul(edgeId.substr(1, underscore - 1)));
-                    std::uint32_t b = static_cast<std::uint32_t>(
-                        std::stoul(edgeId.substr(underscore + 1)));
-                    if (static_cast<size_t>(a) >= cache.vertices.size() ||
-                        static_cast<size_t>(b) >= cache.vertices.size()) {
-                        continue;
-                    }
-                    std::vector<QVector3D> polyline = {cache.vertices[a], cache.vertices[b]};
+                    const auto a = static_cast<std::uint32_t>(edgeKey >> 32);
+                    const auto b = static_cast<std::uint32_t>(edgeKey & 0xffffffffu);
+                    const ElementHandle edgeId = internElementId(edgeIdForIndices(a, b));
+                    std::vector<QVector3D> polyline = {cache.vertex(a), cache.vertex(b)};
                     if (cache.edgePolylines.find(edgeId) == cache.edgePolylines.end()) {
                         cache.edgePolylines[edgeId] = polyline;
                     }
                     faceCache.edgeIds.push_back(edgeId);
 
-                    std::string vA = vertexIdForIndex(a);
-                    std::string vB = vertexIdForIndex(b);
-                    cache.vertexMap[vA] = cache.vertices[a];
-                    cache.vertexMap[vB] = cache.vertices[b];
+                    const ElementHandle vA = internElementId(vertexIdForIndex(a));
+                    const ElementHandle vB = internElementId(vertexIdForIndex(b));
+                    cache.vertexMap[vA] = cache.vertex(a);
+                    cache.vertexMap[vB] = cache.vertex(b);
                     cache.pickableVertices.insert(vA);
                     cache.pickableVertices.insert(vB);
                     if (addedVertices.insert(vA).second) {
@@ -188,13 +177,13 @@ void ModelPickerAdapter::setMeshes(std::vector<Mesh>&& meshes) {
 
         cache.faceGroupLeaderByFaceId = std::move(mesh.faceGroupByFaceId);
         if (cache.faceGroupLeaderByFaceId.empty()) {
-            for (const auto& [faceId, tris] : cache.faceMap) {
-                (void)tris;
+            for (const auto& [faceId, ranges] : cache.faceRanges) {
+                (void)ranges;
                 cache.faceGroupLeaderByFaceId[faceId] = faceId;
             }
         } else {
-            for (const auto& [faceId, tris] : cache.faceMap) {
-                (void)tris;
+            for (const auto& [faceId, ranges] : cache.faceRanges) {
+                (void)ranges;
                 if (cache.faceGroupLeaderByFaceId.find(faceId) == cache.faceGroupLeaderByFaceId.end()) {
                     cache.faceGroupLeaderByFaceId[faceId] = faceId;
                 }
@@ -231,43 +220,39 @@ app::selection::PickResult ModelPickerAdapter::pick(const QPoint& screenPos,
 
     std::vector<FaceHit> faceHits;
     faceHits.reserve(16);
-    std::unordered_map<std::string, size_t> faceIndex;
-
-    for (const auto& mesh : meshes_) {
-        for (const auto& tri : mesh.triangles) {
-            if (tri.i0 >= mesh.vertices.size() ||
-                tri.i1 >= mesh.vertices.size() ||
-                tri.i2 >= mesh.vertices.size()) {
-                continue;
-            }
-            const QVector3D& v0 = mesh.vertices[tri.i0];
-            const QVector3D& v1 = mesh.vertices[tri.i1];
-            const QVector3D& v2 = mesh.vertices[tri.i2];
-            float t = 0.0f;
-            QVector3D normal;
-            if (!rayTriangleIntersect(ray.origin, ray.direction, v0, v1, v2, &t, &normal)) {
-                continue;
-            }
-            std::string key = mesh.bodyId + ":" + tri.faceId;
-            auto it = faceIndex.find(key);
-            if (it == faceIndex.end()) {
-                FaceHit hit;
-                hit.mesh = &mesh;
-                hit.triangle = tri;
-                hit.normal = normal;
-                hit.point = ray.origin + ray.direction * t;
-                hit.t = t;
-                faceIndex[key] = faceHits.size();
-                faceHits.push_back(hit);
-            } else {
-                FaceHit& hit = faceHits[it->second];
-                if (t < hit.t) {
+    std::unordered_map<std::uint64_t, size_t> faceIndex;  // (mesh index, face handle) -> hit
+
+    for (size_t meshIndex = 0; meshIndex < meshes_.size(); ++meshIndex) {
+        const MeshCache& mesh = meshes_[meshIndex];
+        for (const auto& range : mesh.faces) {
+            mesh.forEachTriangle(range, [&](const Triangle& tri) {
+                float t = 0.0f;
+                QVector3D normal;
+                if (!rayTriangleIntersect(ray.origin, ray.direction, mesh.vertex(tri.i0), mesh.vertex(tri.i1),
+                                          mesh.vertex(tri.i2), &t, &normal)) {
+                    return;
+                }
+                const std::uint64_t key = (static_cast<std::uint64_t>(meshIndex) << 32) | tri.faceId.value;
+                auto it = faceIndex.find(key);
+                if (it == faceIndex.end()) {
+                    FaceHit hit;
+                    hit.mesh = &mesh;
                     hit.triangle = tri;
                     hit.normal = normal;
                     hit.point = ray.origin + ray.direction * t;
                     hit.t = t;
+                    faceIndex[key] = faceHits.size();
+                    faceHits.push_back(hit);
+                } else {
+                    FaceHit& hit = faceHits[it->second];
+                    if (t < hit.t) {
+                        hit.triangle = tri;
+                        hit.normal = normal;
+                        hit.point = ray.origin + ray.direction * t;
+                        hit.t = t;
+                    }
                 }
-            }
+            });
         }
     }
 
@@ -299,10 +284,10 @@ app::selection::PickResult ModelPickerAdapter::pick(const QPoint& screenPos,
 
     QPointF clickPoint(screenPos);
     double bestVertexDistance = std::numeric_limits<double>::max();
-    std::string bestVertexId;
+    ElementHandle bestVertexId;
     QVector3D bestVertexPos;
     double bestEdgeDistance = std::numeric_limits<double>::max();
-    std::string bestEdgeId;
+    ElementHandle bestEdgeId;
     QVector3D bestEdgeMid;
     bool usedTopology = false;
     auto topoIt = hitMesh->faceTopology.find(hitTriangle.faceId);
@@ -311,7 +296,7 @@ app::selection::PickResult ModelPickerAdapter::pick(const QPoint& screenPos,
         if (!topo.vertexIds.empty() || !topo.edgeIds.empty()) {
             usedTopology = true;
 
-            for (const auto& vertexId : topo.vertexIds) {
+            for (const ElementHandle vertexId : topo.vertexIds) {
                 auto it = hitMesh->vertexMap.find(vertexId);
                 if (it == hitMesh->vertexMap.end()) {
                     continue;
@@ -328,7 +313,7 @@ app::selection::PickResult ModelPickerAdapter::pick(const QPoint& screenPos,
                 }
             }
 
-            for (const auto& edgeId : topo.edgeIds) {
+            for (const ElementHandle edgeId : topo.edgeIds) {
                 auto polyIt = hitMesh->edgePolylines.find(edgeId);
                 if (polyIt == hitMesh->edgePolylines.end() || polyIt->second.size() < 2) {
                     continue;
@@ -355,9 +340,9 @@ app::selection::PickResult ModelPickerAdapter::pick(const QPoint& screenPos,
     }
 
     if (!usedTopology) {
-        auto vertexA = hitMesh->vertices[hitTriangle.i0];
-        auto vertexB = hitMesh->vertices[hitTriangle.i1];
-        auto vertexC = hitMesh->vertices[hitTriangle.i2];
+        auto vertexA = hitMesh->vertex(hitTriangle.i0);
+        auto vertexB = hitMesh->vertex(hitTriangle.i1);
+        auto vertexC = hitMesh->vertex(hitTriangle.i2);
 
         QPointF screenA, screenB, screenC;
         bool projA = projectToScreen(viewProjection, vertexA, viewportSize, &screenA);
@@ -365,39 +350,43 @@ app::selection::PickResult ModelPickerAdapter::pick(const QPoint& screenPos,
         bool projC = projectToScreen(viewProjection, vertexC, viewportSize, &screenC);
 
         bool restrictVertices = !hitMesh->pickableVertices.empty();
-        auto canPickVertex = [&](const std::string& id) {
+        auto canPickVertex = [&](ElementHandle id) {
             return !restrictVertices || hitMesh->pickableVertices.find(id) != hitMesh->pickableVertices.end();
         };
 
         if (projA) {
             double dist = std::hypot(clickPoint.x() - screenA.x(), clickPoint.y() - screenA.y());
-            if (dist < bestVertexDistance && canPickVertex(vertexIdForIndex(hitTriangle.i0))) {
+            const ElementHandle vertexId = internElementId(vertexIdForIndex(hitTriangle.i0));
+            if (dist < bestVertexDistance && canPickVertex(vertexId)) {
                 bestVertexDistance = dist;
-                bestVertexId = vertexIdForIndex(hitTriangle.i0);
+                bestVertexId = vertexId;
                 bestVertexPos = vertexA;
             }
         }
         if (projB) {
             double dist = std::hypot(clickPoint.x() - screenB.x(), clickPoint.y() - screenB.y());
-            if (dist < bestVertexDistance && canPickVertex(vertexIdForIndex(hitTriangle.i1))) {
+            const ElementHandle vertexId = internElementId(vertexIdForIndex(hitTriangle.i1));
+            if (dist < bestVertexDistance && canPickVertex(vertexId)) {
                 bestVertexDistance = dist;
-                bestVertexId = vertexIdForIndex(hitTriangle.i1);
+                bestVertexId = vertexId;
                 bestVertexPos = vertexB;
             }
         }
         if (projC) {
             double dist = std::hypot(clickPoint.x() - screenC.x(), clickPoint.y() - screenC.y());
-            if (dist < bestVertexDistance && canPickVertex(vertexIdForIndex(hitTriangle.i2))) {
+            const ElementHandle vertexId = internElementId(vertexIdForIndex(hitTriangle.i2));
+            if (dist < bestVertexDistance && canPickVertex(vertexId)) {
                 bestVertexDistance = dist;
-                bestVertexId = vertexIdForIndex(hitTriangle.i2);
+                bestVertexId = vertexId;
                 bestVertexPos = vertexC;
             }
         }
 
+        // Only boundary edges were interned by setMeshes(); an unknown ID cannot be picked.
         if (projA && projB) {
             double dist = distancePointToSegment(clickPoint, screenA, screenB);
             if (dist < bestEdgeDistance) {
-                std::string edgeId = edgeIdForIndices(hitTriangle.i0, hitTriangle.i1);
+                const ElementHandle edgeId = findElementHandle(edgeIdForIndices(hitTriangle.i0, hitTriangle.i1));
                 if (hitMesh->edgePolylines.find(edgeId) != hitMesh->edgePolylines.end()) {
                     bestEdgeDistance = dist;
                     bestEdgeId = edgeId;
@@ -408,7 +397,7 @@ app::selection::PickResult ModelPickerAdapter::pick(const QPoint& screenPos,
         if (projB && projC) {
             double dist = distancePointToSegment(clickPoint, screenB, screenC);
             if (dist < bestEdgeDistance) {
-                std::string edgeId = edgeIdForIndices(hitTriangle.i1, hitTriangle.i2);
+                const ElementHandle edgeId = findElementHandle(edgeIdForIndices(hitTriangle.i1, hitTriangle.i2));
                 if (hitMesh->edgePolylines.find(edgeId) != hitMesh->edgePolylines.end()) {
                     bestEdgeDistance = dist;
                     bestEdgeId = edgeId;
@@ -419,7 +408,7 @@ app::selection::PickResult ModelPickerAdapter::pick(const QPoint& screenPos,
         if (projC && projA) {
             double dist = distancePointToSegment(clickPoint, screenC, screenA);
             if (dist < bestEdgeDistance) {
-                std::string edgeId = edgeIdForIndices(hitTriangle.i2, hitTriangle.i0);
+                const ElementHandle edgeId = findElementHandle(edgeIdForIndices(hitTriangle.i2, hitTriangle.i0));
                 if (hitMesh->edgePolylines.find(edgeId) != hitMesh->edgePolylines.end()) {
                     bestEdgeDistance = dist;
                     bestEdgeId = edgeId;
@@ -429,19 +418,19 @@ app::selection::PickResult ModelPickerAdapter::pick(const QPoint& screenPos,
         }
     }
 
-    if (!bestVertexId.empty() && bestVertexDistance <= tolerancePixels) {
+    if (bestVertexId.valid() && bestVertexDistance <= tolerancePixels) {
         app::selection::SelectionItem item;
         item.kind = app::selection::SelectionKind::Vertex;
-        item.id = {hitMesh->bodyId, bestVertexId};
+        item.id = {hitMesh->bodyId, elementIdString(bestVertexId)};
         item.priority = kVertexPriority;
         item.screenDistance = bestVertexDistance;
         item.depth = static_cast<double>(frontHit.t);
         item.worldPos = {bestVertexPos.x(), bestVertexPos.y(), bestVertexPos.z()};
         result.hits.push_back(item);
-    } else if (!bestEdgeId.empty() && bestEdgeDistance <= tolerancePixels) {
+    } else if (bestEdgeId.valid() && bestEdgeDistance <= tolerancePixels) {
         app::selection::SelectionItem item;
         item.kind = app::selection::SelectionKind::Edge;
-        item.id = {hitMesh->bodyId, bestEdgeId};
+        item.id = {hitMesh->bodyId, elementIdString(bestEdgeId)};
         item.priority = kEdgePriority;
         item.screenDistance = bestEdgeDistance;
         item.depth = static_cast<double>(frontHit.t);
@@ -456,12 +445,12 @@ app::selection::PickResult ModelPickerAdapter::pick(const QPoint& screenPos,
     for (const auto& hit : visibleHits) {
         app::selection::SelectionItem faceItem;
         faceItem.kind = app::selection::SelectionKind::Face;
-        std::string faceId = hit.triangle.faceId;
+        ElementHandle faceId = hit.triangle.faceId;
         auto groupIt = hit.mesh->faceGroupLeaderByFaceId.find(faceId);
         if (groupIt != hit.mesh->faceGroupLeaderByFaceId.end()) {
             faceId = groupIt->second;
         }
-        faceItem.id = {hit.mesh->bodyId, faceId};
+        faceItem.id = {hit.mesh->bodyId, elementIdString(faceId)};
         faceItem.priority = kFacePriority;
         faceItem.screenDistance = 0.0;
         faceItem.depth = static_cast<double>(hit.t);
@@ -495,13 +484,14 @@ app::selection::PickResult ModelPickerAdapter::pick(const QPoint& screenPos,
 }
 
 bool ModelPickerAdapter::getFaceTriangles(const std::string& bodyId,
-                                          const std::string& faceId,
+                                          const std::string& faceIdString,
                                           std::vector<std::array<QVector3D, 3>>& outTriangles) const {
+    const ElementHandle faceId = findElementHandle(faceIdString);
     for (const auto& mesh : meshes_) {
         if (mesh.bodyId != bodyId) {
             continue;
         }
-        std::string groupId = faceId;
+        ElementHandle groupId = faceId;
         auto groupIt = mesh.faceGroupLeaderByFaceId.find(faceId);
         if (groupIt != mesh.faceGroupLeaderByFaceId.end()) {
             groupId = groupIt->second;
@@ -509,17 +499,13 @@ bool ModelPickerAdapter::getFaceTriangles(const std::string& bodyId,
         outTriangles.clear();
         auto membersIt = mesh.faceGroupMembers.find(groupId);
         if (membersIt != mesh.faceGroupMembers.end()) {
-            for (const auto& memberId : membersIt->second) {
-                auto it = mesh.faceMap.find(memberId);
-                if (it != mesh.faceMap.end()) {
-                    outTriangles.insert(outTriangles.end(), it->second.begin(), it->second.end());
-                }
+            for (const ElementHandle memberId : membersIt->second) {
+                appendFaceTriangles(mesh, memberId, outTriangles);
             }
             return !outTriangles.empty();
         }
-        auto it = mesh.faceMap.find(faceId);
-        if (it != mesh.faceMap.end()) {
-            outTriangles = it->second;
+        if (mesh.faceRanges.find(faceId) != mesh.faceRanges.end()) {
+            appendFaceTriangles(mesh, faceId, outTriangles);
             return true;
         }
         return false;
@@ -534,18 +520,33 @@ bool ModelPickerAdapter::getBodyTriangles(const std::string& bodyId,
             continue;
         }
         outTriangles.clear();
-        for (const auto& [faceId, tris] : mesh.faceMap) {
-            (void)faceId;
-            outTriangles.insert(outTriangles.end(), tris.begin(), tris.end());
+        for (const auto& range : mesh.faces) {
+            mesh.forEachTriangle(range, [&](const Triangle& tri) {
+                outTriangles.push_back({mesh.vertex(tri.i0), mesh.vertex(tri.i1), mesh.vertex(tri.i2)});
+            });
         }
         return !outTriangles.empty();
     }
     return false;
 }
 
+void ModelPickerAdapter::appendFaceTriangles(const MeshCache& mesh, ElementHandle faceId,
+                                             std::vector<std::array<QVector3D, 3>>& outTriangles) const {
+    auto it = mesh.faceRanges.find(faceId);
+    if (it == mesh.faceRanges.end()) {
+        return;
+    }
+    for (const std::size_t rangeIndex : it->second) {
+        mesh.forEachTriangle(mesh.faces[rangeIndex], [&](const Triangle& tri) {
+            outTriangles.push_back({mesh.vertex(tri.i0), mesh.vertex(tri.i1), mesh.vertex(tri.i2)});
+        });
+    }
+}
+
 bool ModelPickerAdapter::getEdgeSegment(const std::string& bodyId,
-                                        const std::string& edgeId,
+                                        const std::string& edgeIdString,
                                         std::array<QVector3D, 2>& outSegment) const {
+    const ElementHandle edgeId = findElementHandle(edgeIdString);
     for (const auto& mesh : meshes_) {
         if (mesh.bodyId != bodyId) {
             continue;
@@ -561,8 +562,9 @@ bool ModelPickerAdapter::getEdgeSegment(const std::string& bodyId,
 }
 
 bool ModelPickerAdapter::getEdgePolyline(const std::string& bodyId,
-                                         const std::string& edgeId,
+                                         const std::string& edgeIdString,
                                          std::vector<QVector3D>& outPolyline) const {
+    const ElementHandle edgeId = findElementHandle(edgeIdString);
     for (const auto& mesh : meshes_) {
         if (mesh.bodyId != bodyId) {
             continue;
@@ -578,8 +580,9 @@ bool ModelPickerAdapter::getEdgePolyline(const std::string& bodyId,
 }
 
 bool ModelPickerAdapter::getVertexPosition(const std::string& bodyId,
-                                           const std::string& vertexId,
+                                           const std::string& vertexIdString,
                                            QVector3D& outVertex) const {
+    const ElementHandle vertexId = findElementHandle(vertexIdString);
     for (const auto& mesh : meshes_) {
         if (mesh.bodyId != bodyId) {
             continue;
@@ -595,22 +598,23 @@ bool ModelPickerAdapter::getVertexPosition(const std::string& bodyId,
 }
 
 bool ModelPickerAdapter::getFaceBoundaryEdges(const std::string& bodyId,
-                                               const std::string& faceId,
+                                               const std::string& faceIdString,
                                                std::vector<std::vector<QVector3D>>& outEdges) const {
+    const ElementHandle faceId = findElementHandle(faceIdString);
     for (const auto& mesh : meshes_) {
         if (mesh.bodyId != bodyId) {
             continue;
         }
-        std::string groupId = faceId;
+        ElementHandle groupId = faceId;
         auto groupIt = mesh.faceGroupLeaderByFaceId.find(faceId);
         if (groupIt != mesh.faceGroupLeaderByFaceId.end()) {
             groupId = groupIt->second;
         }
         outEdges.clear();
-        std::unordered_set<std::string> seenEdges;
+        std::unordered_set<ElementHandle, ElementHandleHash> seenEdges;
         auto membersIt = mesh.faceGroupMembers.find(groupId);
         if (membersIt != mesh.faceGroupMembers.end()) {
-            for (const auto& memberId : membersIt->second) {
+            for (const ElementHandle memberId : membersIt->second) {
                 auto topoIt = mesh.faceTopology.find(memberId);
                 if (topoIt == mesh.faceTopology.end()) {
                     continue;
@@ -2,6 +2,7 @@
 #define ONECAD_UI_SELECTION_MODELPICKERADAPTER_H
 
 #include "../../app/selection/SelectionTypes.h"
+#include "../../kernel/elementmap/ElementHandle.h"
 #include <QMatrix4x4>
 #include <QPoint>
 #include <QSize>
@@ -15,22 +16,27 @@
 
 namespace onecad::ui::selection {
 
+// Element IDs are kept as interned handles; pick() and the query methods convert at the
+// boundary, so picking a million-triangle body copies no ID strings.
 class ModelPickerAdapter {
 public:
-    struct Triangle {
-        std::uint32_t i0 = 0;
-        std::uint32_t i1 = 0;
-        std::uint32_t i2 = 0;
-        std::string faceId;
+    using ElementHandle = kernel::elementmap::ElementHandle;
+    using ElementHandleHash = kernel::elementmap::ElementHandleHash;
+
+    // Same layout as render::SceneMeshStore::FaceRange: a face is a range of the index buffer.
+    struct FaceRange {
+        ElementHandle faceId;
+        std::uint32_t firstIndex = 0;
+        std::uint32_t indexCount = 0;
     };
 
     struct EdgePolyline {
-        std::string edgeId;
+        ElementHandle edgeId;
         std::vector<QVector3D> points;
     };
 
     struct VertexSample {
-        std::string vertexId;
+        ElementHandle vertexId;
         QVector3D position;
     };
 
@@ -39,12 +45,14 @@ public:
         std::vector<VertexSample> vertices;
     };
 
+    // World-space copy of a SceneMeshStore mesh's position, index and face arrays.
     struct Mesh {
         std::string bodyId;
-        std::vector<QVector3D> vertices;
-        std::vector<Triangle> triangles;
-        std::unordered_map<std::string, FaceTopology> topologyByFace;
-        std::unordered_map<std::string, std::string> faceGroupByFaceId;
+        std::vector<float> positions;        // x, y, z per vertex
+        std::vector<std::uint32_t> indices;  // Three per triangle
+        std::vector<FaceRange> faces;
+        std::unordered_map<ElementHandle, FaceTopology, ElementHandleHash> topologyByFace;
+        std::unordered_map<ElementHandle, ElementHandle, ElementHandleHash> faceGroupByFaceId;
     };
 
     struct Ray {
@@ -82,23 +90,53 @@ public:
                               std::vector<std::vector<QVector3D>>& outEdges) const;
 
 private:
+    template <typename T>
+    using HandleMap = std::unordered_map<ElementHandle, T, ElementHandleHash>;
+
+    struct Triangle {
+        std::uint32_t i0 = 0;
+        std::uint32_t i1 = 0;
+        std::uint32_t i2 = 0;
+        ElementHandle faceId;
+    };
+
     struct MeshCache {
         std::string bodyId;
-        std::vector<QVector3D> vertices;
-        std::unordered_map<std::string, QVector3D> vertexMap;
-        std::unordered_set<std::string> pickableVertices;
-        std::unordered_map<std::string, std::vector<QVector3D>> edgePolylines;
-        std::unordered_map<std::string, std::vector<std::array<QVector3D, 3>>> faceMap;
-        std::unordered_map<std::string, std::string> faceGroupLeaderByFaceId;
-        std::unordered_map<std::string, std::vector<std::string>> faceGroupMembers;
+        std::vector<float> positions;
+        std::vector<std::uint32_t> indices;
+        std::vector<FaceRange> faces;                       // Ranges past the index buffer dropped
+        HandleMap<std::vector<std::size_t>> faceRanges;     // Face -> its entries in faces
+        HandleMap<QVector3D> vertexMap;
+        std::unordered_set<ElementHandle, ElementHandleHash> pickableVertices;
+        HandleMap<std::vector<QVector3D>> edgePolylines;
+        HandleMap<ElementHandle> faceGroupLeaderByFaceId;
+        HandleMap<std::vector<ElementHandle>> faceGroupMembers;
         struct FaceTopologyCache {
-            std::vector<std::string> edgeIds;
-            std::vector<std::string> vertexIds;
+            std::vector<ElementHandle> edgeIds;
+            std::vector<ElementHandle> vertexIds;
         };
-        std::unordered_map<std::string, FaceTopologyCache> faceTopology;
-        std::vector<Triangle> triangles;
+        HandleMap<FaceTopologyCache> faceTopology;
+
+        std::size_t vertexCount() const { return positions.size() / 3; }
+        QVector3D vertex(std::uint32_t index) const {
+            return QVector3D(positions[3 * index], positions[3 * index + 1], positions[3 * index + 2]);
+        }
+        // Calls func(Triangle) for every triangle of the range whose indices are in bounds.
+        template <typename Func>
+        void forEachTriangle(const FaceRange& range, Func&& func) const {
+            const std::size_t end = static_cast<std::size_t>(range.firstIndex) + range.indexCount;
+            for (std::size_t i = range.firstIndex; i + 2 < end; i += 3) {
+                const Triangle tri{indices[i], indices[i + 1], indices[i + 2], range.faceId};
+                if (tri.i0 < vertexCount() && tri.i1 < vertexCount() && tri.i2 < vertexCount()) {
+                    func(tri);
+                }
+            }
+        }
     };
 
+    void appendFaceTriangles(const MeshCache& mesh, ElementHandle faceId,
+                             std::vector<std::array<QVector3D, 3>>& outTriangles) const;
+
     Ray buildRay(const QPoint& screenPos,
                  const QMatrix4x4& viewProjection,
                  const QSize& viewportSize) const;
@@ -3,6 +3,7 @@
  */
 #include "ExtrudeTool.h"
 
+#include "ToolPreviewLane.h"
 #include "../viewport/Viewport.h"
 #include "../../app/commands/AddOperationCommand.h"
 #include "../../app/commands/CommandProcessor.h"
@@ -37,10 +38,71 @@ namespace {
 constexpr double kMinExtrudeDistance = 1e-3;
 constexpr double kDraftAngleEpsilon = 1e-4;
 constexpr double kSideFaceDotThreshold = 0.9;
+constexpr const char* kPreviewKey = "extrude";
 
 app::BooleanMode signedBooleanMode(double distance) {
     return distance >= 0.0 ? app::BooleanMode::Add : app::BooleanMode::Cut;
 }
+
+// Free of tool state so preview builds can run off the UI thread.
+TopoDS_Shape makeExtrudeShape(const TopoDS_Face& baseFace, const gp_Dir& direction,
+                              const gp_Pln& neutralPlane, double draftAngleDeg, double distance) {
+    if (baseFace.IsNull()) {
+        return TopoDS_Shape();
+    }
+
+    gp_Vec prismVec(direction.X() * distance,
+                    direction.Y() * distance,
+                    direction.Z() * distance);
+    BRepPrimAPI_MakePrism prism(baseFace, prismVec, true);
+    TopoDS_Shape result = prism.Shape();
+
+    if (std::abs(draftAngleDeg) <= kDraftAngleEpsilon) {
+        return result;
+    }
+
+    const double angleRad = qDegreesToRadians(draftAngleDeg);
+    gp_Dir draftDir = direction;
+    if (distance < 0.0) {
+        draftDir.Reverse();
+    }
+
+    BRepOffsetAPI_DraftAngle draft(result);
+    bool anyAdded = false;
+
+    for (TopExp_Explorer exp(result, TopAbs_FACE); exp.More(); exp.Next()) {
+        TopoDS_Face face = TopoDS::Face(exp.Current());
+        BRepAdaptor_Surface surface(face, true);
+        if (surface.GetType() != GeomAbs_Plane) {
+            continue;
+        }
+        gp_Pln plane = surface.Plane();
+        gp_Dir normal = plane.Axis().Direction();
+        if (face.Orientation() == TopAbs_REVERSED) {
+            normal.Reverse();
+        }
+        const double dot = std::abs(normal.Dot(draftDir));
+        if (dot > kSideFaceDotThreshold) {
+            continue;
+        }
+
+        draft.Add(face, draftDir, angleRad, neutralPlane, true);
+        if (draft.AddDone()) {
+            anyAdded = true;
+        } else {
+            draft.Remove(face);
+        }
+    }
+
+    if (anyAdded) {
+        draft.Build();
+        if (draft.IsDone()) {
+            result = draft.Shape();
+        }
+    }
+
+    return result;
+}
 } // namespace
 
 ExtrudeTool::ExtrudeTool(Viewport* viewport, app::Document* document)
@@ -55,6 +117,10 @@ void ExtrudeTool::setCommandProcessor(app::commands::CommandProcessor* processor
     commandProcessor_ = processor;
 }
 
+void ExtrudeTool::setPreviewLane(ToolPreviewLane* lane) {
+    previewLane_ = lane;
+}
+
 void ExtrudeTool::begin(const app::selection::SelectionItem& selection) {
     qCDebug(logExtrudeTool) << "begin"
                             << "selectionKind=" << static_cast<int>(selection.kind)
@@ -451,78 +517,43 @@ void ExtrudeTool::updatePreview(double distance) {
     if (!viewport_) {
         return;
     }
-    TopoDS_Shape tool = buildExtrudeShape(distance);
+    if (previewLane_) {
+        previewLane_->submit(
+            kPreviewKey,
+            [face = baseFace_, direction = direction_, plane = neutralPlane_,
+             draftAngleDeg = draftAngleDeg_, distance]() {
+                return makeExtrudeShape(face, direction, plane, draftAngleDeg, distance);
+            },
+            [this](const app::history::PreviewSnapshot& snapshot) { showPreview(snapshot.shape); });
+        return;
+    }
+    showPreview(buildExtrudeShape(distance));
+}
+
+void ExtrudeTool::showPreview(const TopoDS_Shape& tool) {
+    if (!viewport_) {
+        return;
+    }
     if (tool.IsNull()) {
         clearPreview();
         return;
     }
-    
+
     render::SceneMeshStore::Mesh mesh = previewTessellator_.buildMesh("preview", tool, previewElementMap_);
     viewport_->setModelPreviewMeshes({std::move(mesh)});
 }
 
 void ExtrudeTool::clearPreview() {
+    if (previewLane_) {
+        previewLane_->cancel(kPreviewKey);
+    }
     if (viewport_) {
         viewport_->clearModelPreviewMeshes();
     }
 }
 
 TopoDS_Shape ExtrudeTool::buildExtrudeShape(double distance) const {
-    if (baseFace_.IsNull()) {
-        return TopoDS_Shape();
-    }
-
-    gp_Vec prismVec(direction_.X() * distance,
-                    direction_.Y() * distance,
-                    direction_.Z() * distance);
-    BRepPrimAPI_MakePrism prism(baseFace_, prismVec, true);
-    TopoDS_Shape result = prism.Shape();
-
-    if (std::abs(draftAngleDeg_) <= kDraftAngleEpsilon) {
-        return result;
-    }
-
-    const double angleRad = qDegreesToRadians(draftAngleDeg_);
-    gp_Dir draftDir = direction_;
-    if (distance < 0.0) {
-        draftDir.Reverse();
-    }
-
-    BRepOffsetAPI_DraftAngle draft(result);
-    bool anyAdded = false;
-
-    for (TopExp_Explorer exp(result, TopAbs_FACE); exp.More(); exp.Next()) {
-        TopoDS_Face face = TopoDS::Face(exp.Current());
-        BRepAdaptor_Surface surface(face, true);
-        if (surface.GetType() != GeomAbs_Plane) {
-            continue;
-        }
-        gp_Pln plane = surface.Plane();
-        gp_Dir normal = plane.Axis().Direction();
-        if (face.Orientation() == TopAbs_REVERSED) {
-            normal.Reverse();
-        }
-        const double dot = std::abs(normal.Dot(draftDir));
-        if (dot > kSideFaceDotThreshold) {
-            continue;
-        }
-
-        draft.Add(face, draftDir, angleRad, neutralPlane_, true);
-        if (draft.AddDone()) {
-            anyAdded = true;
-        } else {
-            draft.Remove(face);
-        }
-    }
-
-    if (anyAdded) {
-        draft.Build();
-        if (draft.IsDone()) {
-            result = draft.Shape();
-        }
-    }
-
-    return result;
+    return makeExtrudeShape(baseFace_, direction_, neutralPlane_, draftAngleDeg_, distance);
 }
 
 std::optional<ModelingTool::Indicator> ExtrudeTool::indicator() const {
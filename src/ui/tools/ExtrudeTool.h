@@ -34,12 +34,15 @@ class Viewport;
 
 namespace onecad::ui::tools {
 
+class ToolPreviewLane;
+
 class ExtrudeTool : public ModelingTool {
 public:
     explicit ExtrudeTool(Viewport* viewport, app::Document* document);
 
     void setDocument(app::Document* document);
     void setCommandProcessor(app::commands::CommandProcessor* processor);
+    void setPreviewLane(ToolPreviewLane* lane);
 
     void begin(const app::selection::SelectionItem& selection) override;
     void cancel() override;
@@ -55,6 +58,7 @@ private:
     bool prepareInput(const app::selection::SelectionItem& selection);
     bool isPlanarFace(const TopoDS_Face& face) const;
     void updatePreview(double distance);
+    void showPreview(const TopoDS_Shape& tool);
     void clearPreview();
     TopoDS_Shape buildExtrudeShape(double distance) const;
     void detectBooleanMode(double distance);
@@ -62,6 +66,7 @@ private:
     Viewport* viewport_ = nullptr;
     app::Document* document_ = nullptr;
     app::commands::CommandProcessor* commandProcessor_ = nullptr;
+    ToolPreviewLane* previewLane_ = nullptr;  // Async previews when set
     app::selection::SelectionItem selection_{};
     core::sketch::Sketch* sketch_ = nullptr; // Null if extruding a body face
     std::string targetBodyId_; // ID of the body owning the selected face (if any)
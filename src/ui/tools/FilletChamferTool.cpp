@@ -3,6 +3,7 @@
  */
 #include "FilletChamferTool.h"
 
+#include "ToolPreviewLane.h"
 #include "../viewport/Viewport.h"
 #include "../../app/commands/AddOperationCommand.h"
 #include "../../app/commands/CommandProcessor.h"
@@ -39,6 +40,7 @@ namespace onecad::ui::tools {
 namespace {
 constexpr double kMinValue = 1e-3;
 constexpr double kMaxRadius = 1000.0;
+constexpr const char* kPreviewKey = "fillet-chamfer";
 
 TopoDS_Edge pickClosestEdge(const TopoDS_Shape& shape, const gp_Pnt& point) {
     if (shape.IsNull()) {
@@ -68,6 +70,66 @@ TopoDS_Edge pickClosestEdge(const TopoDS_Shape& shape, const gp_Pnt& point) {
 
     return bestEdge;
 }
+
+// Free of tool state so preview builds can run off the UI thread.
+TopoDS_Shape makeFilletShape(const TopoDS_Shape& targetShape, const std::vector<TopoDS_Edge>& selectedEdges,
+                             double radius) {
+    if (selectedEdges.empty() || targetShape.IsNull() || radius < kMinValue) {
+        return TopoDS_Shape();
+    }
+
+    try {
+        BRepFilletAPI_MakeFillet fillet(targetShape);
+
+        for (const auto& edge : selectedEdges) {
+            fillet.Add(radius, edge);
+        }
+
+        fillet.Build();
+        if (fillet.IsDone()) {
+            return fillet.Shape();
+        }
+    } catch (...) {
+        // Fillet failed (radius too large, geometry issue)
+    }
+
+    return TopoDS_Shape();
+}
+
+TopoDS_Shape makeChamferShape(const TopoDS_Shape& targetShape, const std::vector<TopoDS_Edge>& selectedEdges,
+                              double distance) {
+    if (selectedEdges.empty() || targetShape.IsNull() || distance < kMinValue) {
+        return TopoDS_Shape();
+    }
+
+    try {
+        BRepFilletAPI_MakeChamfer chamfer(targetShape);
+
+        // Build edge-to-face map for chamfer (needs reference face)
+        TopTools_IndexedDataMapOfShapeListOfShape edgeFaceMap;
+        TopExp::MapShapesAndAncestors(targetShape, TopAbs_EDGE, TopAbs_FACE, edgeFaceMap);
+
+        for (const auto& edge : selectedEdges) {
+            int idx = edgeFaceMap.FindIndex(edge);
+            if (idx == 0) continue;
+
+            const TopTools_ListOfShape& faces = edgeFaceMap(idx);
+            if (faces.IsEmpty()) continue;
+
+            TopoDS_Face refFace = TopoDS::Face(faces.First());
+            chamfer.Add(distance, distance, edge, refFace);
+        }
+
+        chamfer.Build();
+        if (chamfer.IsDone()) {
+            return chamfer.Shape();
+        }
+    } catch (...) {
+        // Chamfer failed
+    }
+
+    return TopoDS_Shape();
+}
 } // namespace
 
 FilletChamferTool::FilletChamferTool(Viewport* viewport, app::Document* document)
@@ -82,6 +144,10 @@ void FilletChamferTool::setCommandProcessor(app::commands::CommandProcessor* pro
     commandProcessor_ = processor;
 }
 
+void FilletChamferTool::setPreviewLane(ToolPreviewLane* lane) {
+    previewLane_ = lane;
+}
+
 void FilletChamferTool::begin(const app::selection::SelectionItem& selection) {
     dragging_ = false;
     currentValue_ = 0.0;
@@ -320,11 +386,23 @@ void FilletChamferTool::updatePreview(double value) {
         return;
     }
 
-    TopoDS_Shape previewShape;
-    if (mode_ == Mode::Fillet) {
-        previewShape = buildFilletShape(value);
-    } else {
-        previewShape = buildChamferShape(value);
+    if (previewLane_) {
+        previewLane_->submit(
+            kPreviewKey,
+            [target = targetShape_, edges = selectedEdges_, fillet = mode_ == Mode::Fillet, value]() {
+                return fillet ? makeFilletShape(target, edges, value)
+                              : makeChamferShape(target, edges, value);
+            },
+            [this](const app::history::PreviewSnapshot& snapshot) { showPreview(snapshot.shape); });
+        return;
+    }
+
+    showPreview(mode_ == Mode::Fillet ? buildFilletShape(value) : buildChamferShape(value));
+}
+
+void FilletChamferTool::showPreview(const TopoDS_Shape& previewShape) {
+    if (!viewport_) {
+        return;
     }
 
     if (previewShape.IsNull()) {
@@ -342,66 +420,20 @@ void FilletChamferTool::updatePreview(double value) {
 }
 
 void FilletChamferTool::clearPreview() {
+    if (previewLane_) {
+        previewLane_->cancel(kPreviewKey);
+    }
     if (viewport_) {
         viewport_->clearModelPreviewMeshes();
     }
 }
 
 TopoDS_Shape FilletChamferTool::buildFilletShape(double radius) const {
-    if (selectedEdges_.empty() || targetShape_.IsNull() || radius < kMinValue) {
-        return TopoDS_Shape();
-    }
-
-    try {
-        BRepFilletAPI_MakeFillet fillet(targetShape_);
-
-        for (const auto& edge : selectedEdges_) {
-            fillet.Add(radius, edge);
-        }
-
-        fillet.Build();
-        if (fillet.IsDone()) {
-            return fillet.Shape();
-        }
-    } catch (...) {
-        // Fillet failed (radius too large, geometry issue)
-    }
-
-    return TopoDS_Shape();
+    return makeFilletShape(targetShape_, selectedEdges_, radius);
 }
 
 TopoDS_Shape FilletChamferTool::buildChamferShape(double distance) const {
-    if (selectedEdges_.empty() || targetShape_.IsNull() || distance < kMinValue) {
-        return TopoDS_Shape();
-    }
-
-    try {
-        BRepFilletAPI_MakeChamfer chamfer(targetShape_);
-
-        // Build edge-to-face map for chamfer (needs reference face)
-        TopTools_IndexedDataMapOfShapeListOfShape edgeFaceMap;
-        TopExp::MapShapesAndAncestors(targetShape_, TopAbs_EDGE, TopAbs_FACE, edgeFaceMap);
-
-        for (const auto& edge : selectedEdges_) {
-            int idx = edgeFaceMap.FindIndex(edge);
-            if (idx == 0) continue;
-
-            const TopTools_ListOfShape& faces = edgeFaceMap(idx);
-            if (faces.IsEmpty()) continue;
-
-            TopoDS_Face refFace = TopoDS::Face(faces.First());
-            chamfer.Add(distance, distance, edge, refFace);
-        }
-
-        chamfer.Build();
-        if (chamfer.IsDone()) {
-            return chamfer.Shape();
-        }
-    } catch (...) {
-        // Chamfer failed
-    }
-
-    return TopoDS_Shape();
+    return makeChamferShape(targetShape_, selectedEdges_, distance);
 }
 
 std::optional<ModelingTool::Indicator> FilletChamferTool::indicator() const {
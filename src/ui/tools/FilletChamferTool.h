@@ -29,6 +29,8 @@ class Viewport;
 
 namespace onecad::ui::tools {
 
+class ToolPreviewLane;
+
 class FilletChamferTool : public ModelingTool {
 public:
     enum class Mode { Fillet, Chamfer };
@@ -37,6 +39,7 @@ public:
 
     void setDocument(app::Document* document);
     void setCommandProcessor(app::commands::CommandProcessor* processor);
+    void setPreviewLane(ToolPreviewLane* lane);
 
     void begin(const app::selection::SelectionItem& selection) override;
     void cancel() override;
@@ -55,6 +58,7 @@ private:
     bool prepareInput(const app::selection::SelectionItem& selection);
     void expandEdgeChain();
     void updatePreview(double value);
+    void showPreview(const TopoDS_Shape& previewShape);
     void clearPreview();
     TopoDS_Shape buildFilletShape(double radius) const;
     TopoDS_Shape buildChamferShape(double distance) const;
@@ -63,6 +67,7 @@ private:
     Viewport* viewport_ = nullptr;
     app::Document* document_ = nullptr;
     app::commands::CommandProcessor* commandProcessor_ = nullptr;
+    ToolPreviewLane* previewLane_ = nullptr;  // Async previews when set
 
     std::string targetBodyId_;
     TopoDS_Shape targetShape_;
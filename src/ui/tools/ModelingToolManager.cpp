@@ -6,6 +6,7 @@
 #include "RevolveTool.h"
 #include "FilletChamferTool.h"
 #include "ShellTool.h"
+#include "ToolPreviewLane.h"
 
 #include "../viewport/Viewport.h"
 
@@ -17,6 +18,15 @@ ModelingToolManager::ModelingToolManager(Viewport* viewport, QObject* parent)
     revolveTool_ = std::make_unique<RevolveTool>(viewport_, document_);
     filletTool_ = std::make_unique<FilletChamferTool>(viewport_, document_);
     shellTool_ = std::make_unique<ShellTool>(viewport_, document_);
+
+    // Previews build on the kernel preview lane unless forced synchronous.
+    if (qEnvironmentVariableIntValue("ONECAD_SYNC_TOOL_PREVIEW") != 1) {
+        previewLane_ = std::make_unique<ToolPreviewLane>();
+        extrudeTool_->setPreviewLane(previewLane_.get());
+        revolveTool_->setPreviewLane(previewLane_.get());
+        filletTool_->setPreviewLane(previewLane_.get());
+        shellTool_->setPreviewLane(previewLane_.get());
+    }
 }
 
 ModelingToolManager::~ModelingToolManager() = default;
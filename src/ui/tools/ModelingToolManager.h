@@ -29,6 +29,7 @@ class ExtrudeTool;
 class RevolveTool;
 class FilletChamferTool;
 class ShellTool;
+class ToolPreviewLane;
 
 class ModelingToolManager : public QObject {
     Q_OBJECT
@@ -70,6 +71,7 @@ private:
     std::unique_ptr<RevolveTool> revolveTool_;
     std::unique_ptr<FilletChamferTool> filletTool_;
     std::unique_ptr<ShellTool> shellTool_;
+    std::unique_ptr<ToolPreviewLane> previewLane_;  // Declared after the tools: stops first
     ModelingTool* activeTool_ = nullptr;
     app::selection::SelectionKey activeSelection_{};
 };
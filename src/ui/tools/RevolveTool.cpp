@@ -3,6 +3,7 @@
  */
 #include "RevolveTool.h"
 
+#include "ToolPreviewLane.h"
 #include "../viewport/Viewport.h"
 #include "../../app/commands/AddOperationCommand.h"
 #include "../../app/commands/CommandProcessor.h"
@@ -39,10 +40,25 @@ constexpr double kMinRevolveAngle = 1e-3;
 constexpr double kMaxRevolveAngle = 360.0;
 constexpr double kDefaultRevolveAngle = 360.0;
 constexpr double kAnglePerPixel = 1.0;
+constexpr const char* kPreviewKey = "revolve";
 
 app::BooleanMode signedBooleanMode(double angle) {
     return angle >= 0.0 ? app::BooleanMode::Add : app::BooleanMode::Cut;
 }
+
+// Free of tool state so preview builds can run off the UI thread.
+TopoDS_Shape makeRevolveShape(const TopoDS_Face& baseFace, const gp_Ax1& axis, double angle) {
+    if (baseFace.IsNull()) return TopoDS_Shape();
+    if (std::abs(angle) < kMinRevolveAngle) return TopoDS_Shape();
+
+    try {
+        double rad = qDegreesToRadians(angle);
+        BRepPrimAPI_MakeRevol revol(baseFace, axis, rad);
+        return revol.Shape();
+    } catch (...) {
+        return TopoDS_Shape();
+    }
+}
 } // namespace
 
 RevolveTool::RevolveTool(Viewport* viewport, app::Document* document)
@@ -57,6 +73,10 @@ void RevolveTool::setCommandProcessor(app::commands::CommandProcessor* processor
     commandProcessor_ = processor;
 }
 
+void RevolveTool::setPreviewLane(ToolPreviewLane* lane) {
+    previewLane_ = lane;
+}
+
 void RevolveTool::begin(const app::selection::SelectionItem& selection) {
     qCDebug(logRevolveTool) << "begin"
                             << "selectionKind=" << static_cast<int>(selection.kind)
@@ -373,7 +393,18 @@ bool RevolveTool::setAxis(const app::selection::SelectionItem& selection) {
 
 void RevolveTool::updatePreview(double angle) {
     if (!viewport_) return;
-    TopoDS_Shape shape = buildRevolveShape(angle);
+    if (previewLane_ && axisValid_) {
+        previewLane_->submit(
+            kPreviewKey,
+            [face = baseFace_, axis = axis_, angle]() { return makeRevolveShape(face, axis, angle); },
+            [this](const app::history::PreviewSnapshot& snapshot) { showPreview(snapshot.shape); });
+        return;
+    }
+    showPreview(buildRevolveShape(angle));
+}
+
+void RevolveTool::showPreview(const TopoDS_Shape& shape) {
+    if (!viewport_) return;
     if (shape.IsNull()) {
         clearPreview();
         return;
@@ -383,20 +414,13 @@ void RevolveTool::updatePreview(double angle) {
 }
 
 void RevolveTool::clearPreview() {
+    if (previewLane_) previewLane_->cancel(kPreviewKey);
     if (viewport_) viewport_->clearModelPreviewMeshes();
 }
 
 TopoDS_Shape RevolveTool::buildRevolveShape(double angle) const {
-    if (baseFace_.IsNull() || !axisValid_) return TopoDS_Shape();
-    if (std::abs(angle) < kMinRevolveAngle) return TopoDS_Shape();
-    
-    try {
-        double rad = qDegreesToRadians(angle);
-        BRepPrimAPI_MakeRevol revol(baseFace_, axis_, rad);
-        return revol.Shape();
-    } catch (...) {
-        return TopoDS_Shape();
-    }
+    if (!axisValid_) return TopoDS_Shape();
+    return makeRevolveShape(baseFace_, axis_, angle);
 }
 
 void RevolveTool::detectBooleanMode(double angle) {
@@ -33,12 +33,15 @@ class Viewport;
 
 namespace onecad::ui::tools {
 
+class ToolPreviewLane;
+
 class RevolveTool : public ModelingTool {
 public:
     explicit RevolveTool(Viewport* viewport, app::Document* document);
 
     void setDocument(app::Document* document);
     void setCommandProcessor(app::commands::CommandProcessor* processor);
+    void setPreviewLane(ToolPreviewLane* lane);
 
     void begin(const app::selection::SelectionItem& selection) override;
     void cancel() override;
@@ -64,6 +67,7 @@ private:
     bool setAxis(const app::selection::SelectionItem& selection);
     
     void updatePreview(double angle);
+    void showPreview(const TopoDS_Shape& shape);
     void clearPreview();
     TopoDS_Shape buildRevolveShape(double angle) const;
     void detectBooleanMode(double angle);
@@ -71,6 +75,7 @@ private:
     Viewport* viewport_ = nullptr;
     app::Document* document_ = nullptr;
     app::commands::CommandProcessor* commandProcessor_ = nullptr;
+    ToolPreviewLane* previewLane_ = nullptr;  // Async previews when set
     
     app::selection::SelectionItem profileSelection_{};
     app::selection::SelectionItem axisSelection_{}; // Store axis selection
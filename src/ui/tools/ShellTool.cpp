@@ -3,6 +3,7 @@
  */
 #include "ShellTool.h"
 
+#include "ToolPreviewLane.h"
 #include "../viewport/Viewport.h"
 #include "../../app/commands/AddOperationCommand.h"
 #include "../../app/commands/CommandProcessor.h"
@@ -28,6 +29,43 @@ namespace onecad::ui::tools {
 namespace {
 constexpr double kMinThickness = 1e-3;
 constexpr double kMaxThickness = 100.0;
+constexpr const char* kPreviewKey = "shell";
+
+// Free of tool state so preview builds can run off the UI thread.
+TopoDS_Shape makeShellShape(const TopoDS_Shape& targetShape, const std::vector<TopoDS_Face>& openFaces,
+                            double thickness) {
+    if (targetShape.IsNull() || thickness < kMinThickness) {
+        return TopoDS_Shape();
+    }
+
+    try {
+        TopTools_ListOfShape facesToRemove;
+        for (const auto& face : openFaces) {
+            facesToRemove.Append(face);
+        }
+
+        BRepOffsetAPI_MakeThickSolid shell;
+        shell.MakeThickSolidByJoin(
+            targetShape,
+            facesToRemove,
+            -thickness,         // Negative = shell inward
+            1e-3,               // Tolerance
+            BRepOffset_Skin,
+            Standard_False,     // Intersection
+            Standard_False,     // SelfInter
+            GeomAbs_Arc         // Join type
+        );
+
+        shell.Build();
+        if (shell.IsDone()) {
+            return shell.Shape();
+        }
+    } catch (...) {
+        // Shell operation failed
+    }
+
+    return TopoDS_Shape();
+}
 } // namespace
 
 ShellTool::ShellTool(Viewport* viewport, app::Document* document)
@@ -42,6 +80,10 @@ void ShellTool::setCommandProcessor(app::commands::CommandProcessor* processor)
     commandProcessor_ = processor;
 }
 
+void ShellTool::setPreviewLane(ToolPreviewLane* lane) {
+    previewLane_ = lane;
+}
+
 void ShellTool::begin(const app::selection::SelectionItem& selection) {
     state_ = State::WaitingForBody;
     dragging_ = false;
@@ -274,8 +316,22 @@ void ShellTool::updatePreview(double thickness) {
     if (!viewport_) {
         return;
     }
+    if (previewLane_) {
+        previewLane_->submit(
+            kPreviewKey,
+            [target = targetShape_, faces = openFaces_, thickness]() {
+                return makeShellShape(target, faces, thickness);
+            },
+            [this](const app::history::PreviewSnapshot& snapshot) { showPreview(snapshot.shape); });
+        return;
+    }
+    showPreview(buildShellShape(thickness));
+}
 
-    TopoDS_Shape previewShape = buildShellShape(thickness);
+void ShellTool::showPreview(const TopoDS_Shape& previewShape) {
+    if (!viewport_) {
+        return;
+    }
     if (previewShape.IsNull()) {
         clearPreview();
         return;
@@ -288,43 +344,16 @@ void ShellTool::updatePreview(double thickness) {
 }
 
 void ShellTool::clearPreview() {
+    if (previewLane_) {
+        previewLane_->cancel(kPreviewKey);
+    }
     if (viewport_) {
         viewport_->clearModelPreviewMeshes();
     }
 }
 
 TopoDS_Shape ShellTool::buildShellShape(double thickness) const {
-    if (targetShape_.IsNull() || thickness < kMinThickness) {
-        return TopoDS_Shape();
-    }
-
-    try {
-        TopTools_ListOfShape facesToRemove;
-        for (const auto& face : openFaces_) {
-            facesToRemove.Append(face);
-        }
-
-        BRepOffsetAPI_MakeThickSolid shell;
-        shell.MakeThickSolidByJoin(
-            targetShape_,
-            facesToRemove,
-            -thickness,         // Negative = shell inward
-            1e-3,               // Tolerance
-            BRepOffset_Skin,
-            Standard_False,     // Intersection
-            Standard_False,     // SelfInter
-            GeomAbs_Arc         // Join type
-        );
-
-        shell.Build();
-        if (shell.IsDone()) {
-            return shell.Shape();
-        }
-    } catch (...) {
-        // Shell operation failed
-    }
-
-    return TopoDS_Shape();
+    return makeShellShape(targetShape_, openFaces_, thickness);
 }
 
 std::optional<ModelingTool::Indicator> ShellTool::indicator() const {
@@ -29,6 +29,8 @@ class Viewport;
 
 namespace onecad::ui::tools {
 
+class ToolPreviewLane;
+
 class ShellTool : public ModelingTool {
 public:
     enum class State {
@@ -41,6 +43,7 @@ public:
 
     void setDocument(app::Document* document);
     void setCommandProcessor(app::commands::CommandProcessor* processor);
+    void setPreviewLane(ToolPreviewLane* lane);
 
     void begin(const app::selection::SelectionItem& selection) override;
     void cancel() override;
@@ -64,6 +67,7 @@ public:
 private:
     bool prepareBody(const app::selection::SelectionItem& selection);
     void updatePreview(double thickness);
+    void showPreview(const TopoDS_Shape& previewShape);
     void clearPreview();
     TopoDS_Shape buildShellShape(double thickness) const;
     void commitOperation(double thickness);
@@ -71,6 +75,7 @@ private:
     Viewport* viewport_ = nullptr;
     app::Document* document_ = nullptr;
     app::commands::CommandProcessor* commandProcessor_ = nullptr;
+    ToolPreviewLane* previewLane_ = nullptr;  // Async previews when set
 
     State state_ = State::WaitingForBody;
     std::string targetBodyId_;
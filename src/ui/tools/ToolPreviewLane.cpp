@@ -0,0 +1,74 @@
+/**
+ * @file ToolPreviewLane.cpp
+ */
+#include "ToolPreviewLane.h"
+
+#include <QLoggingCategory>
+#include <QMetaObject>
+#include <QPointer>
+#include <QString>
+
+#include <utility>
+
+namespace onecad::ui::tools {
+
+Q_LOGGING_CATEGORY(logToolPreviewLane, "onecad.ui.tools.previewlane")
+
+ToolPreviewLane::ToolPreviewLane(QObject* parent)
+    : QObject(parent), scheduler_(std::make_unique<app::history::KernelScheduler>()) {
+}
+
+ToolPreviewLane::~ToolPreviewLane() {
+    // Joins the preview thread before members go away.
+    scheduler_->shutdown();
+}
+
+void ToolPreviewLane::submit(const std::string& toolKey, std::function<TopoDS_Shape()> build,
+                             ReadyCallback onReady) {
+    QPointer<ToolPreviewLane> self(this);
+    const app::history::JobId id = scheduler_->submitPreview(
+        app::history::PreviewRequest{toolKey, std::move(build)},
+        [self](std::shared_ptr<const app::history::PreviewSnapshot> snapshot) {
+            if (!self) {
+                return;
+            }
+            QMetaObject::invokeMethod(
+                self.data(),
+                [self, snapshot = std::move(snapshot)]() mutable {
+                    if (self) {
+                        self->deliver(std::move(snapshot));
+                    }
+                },
+                Qt::QueuedConnection);
+        });
+    if (id == 0) {
+        qCWarning(logToolPreviewLane) << "submit:rejected" << QString::fromStdString(toolKey);
+        return;
+    }
+    latest_[toolKey] = id;
+    callbacks_[toolKey] = std::move(onReady);
+}
+
+void ToolPreviewLane::cancel(const std::string& toolKey) {
+    scheduler_->cancelPreviews(toolKey);
+    latest_.erase(toolKey);
+    callbacks_.erase(toolKey);
+}
+
+void ToolPreviewLane::deliver(std::shared_ptr<const app::history::PreviewSnapshot> snapshot) {
+    auto latestIt = latest_.find(snapshot->toolKey);
+    if (latestIt == latest_.end() || latestIt->second != snapshot->id) {
+        qCDebug(logToolPreviewLane) << "deliver:drop-stale"
+                                    << "toolKey=" << QString::fromStdString(snapshot->toolKey)
+                                    << "id=" << snapshot->id;
+        return;
+    }
+    auto callbackIt = callbacks_.find(snapshot->toolKey);
+    if (callbackIt != callbacks_.end() && callbackIt->second) {
+        // Copy: the callback may submit or cancel and replace the stored one.
+        ReadyCallback callback = callbackIt->second;
+        callback(*snapshot);
+    }
+}
+
+} // namespace onecad::ui::tools
@@ -0,0 +1,57 @@
+/**
+ * @file ToolPreviewLane.h
+ * @brief Asynchronous, latest-wins preview builds for modeling tools.
+ */
+#ifndef ONECAD_UI_TOOLS_TOOLPREVIEWLANE_H
+#define ONECAD_UI_TOOLS_TOOLPREVIEWLANE_H
+
+#include "../../app/history/KernelScheduler.h"
+
+#include <QObject>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace onecad::ui::tools {
+
+/**
+ * @brief Runs tool preview builds on the KernelScheduler preview lane and
+ * hands the snapshots back on the UI thread.
+ *
+ * A snapshot is delivered only if no newer request or cancel() for the same
+ * tool key happened in the meantime, so tools can submit on every mouse move.
+ */
+class ToolPreviewLane : public QObject {
+    Q_OBJECT
+
+public:
+    using ReadyCallback = std::function<void(const app::history::PreviewSnapshot&)>;
+
+    explicit ToolPreviewLane(QObject* parent = nullptr);
+    ~ToolPreviewLane() override;
+
+    /**
+     * @brief Build a preview off the UI thread.
+     * @param build Must not touch the Document; capture inputs by value.
+     * @param onReady Invoked on the UI thread with the latest snapshot.
+     */
+    void submit(const std::string& toolKey, std::function<TopoDS_Shape()> build, ReadyCallback onReady);
+
+    /**
+     * @brief Forget pending work of a tool; late results are dropped.
+     */
+    void cancel(const std::string& toolKey);
+
+private:
+    void deliver(std::shared_ptr<const app::history::PreviewSnapshot> snapshot);
+
+    std::unique_ptr<app::history::KernelScheduler> scheduler_;
+    std::unordered_map<std::string, app::history::JobId> latest_;  // UI-thread view
+    std::unordered_map<std::string, ReadyCallback> callbacks_;
+};
+
+} // namespace onecad::ui::tools
+
+#endif // ONECAD_UI_TOOLS_TOOLPREVIEWLANE_H
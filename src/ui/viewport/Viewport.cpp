@@ -81,6 +81,8 @@ constexpr float kThumbnailCameraAngle = 45.0f;
 constexpr float kGridDepthScaleMin = 1.0f;
 constexpr float kGridDepthScaleMax = 8.0f;
 constexpr float kGridBoundsMaxScale = 6.0f;
+// Level-of-detail error allowed while navigating, as a multiple of the still view's.
+constexpr float kNavigationDeflectionScale = 4.0f;
 constexpr std::array<sketch::SnapType, 8> kPointDragSnapTypes = {
     sketch::SnapType::Vertex,
     sketch::SnapType::Endpoint,
@@ -700,14 +702,23 @@ void Viewport::paintGL() {
         style.nearPlane = m_camera->nearPlane();
         style.farPlane = m_camera->farPlane();
         style.isOrtho = (m_camera->projectionType() == render::Camera3D::ProjectionType::Orthographic);
+        style.viewportWidth = static_cast<int>(m_width * ratio);
+        style.viewportHeight = static_cast<int>(m_height * ratio);
 
         // Dynamic quality: reduce during navigation for better responsiveness
         if (m_isNavigating) {
             style.drawEdges = false;
             style.drawGlow = false;
+            style.maxDeflectionPixels *= kNavigationDeflectionScale;
         }
 
         m_bodyRenderer->render(viewProjection, view, style);
+        // Bodies zoomed in on past their mesh's detail get a fine level in the background.
+        if (m_document) {
+            for (const std::string& bodyId : m_bodyRenderer->takeFineDetailRequests()) {
+                m_document->requestFineMesh(bodyId);
+            }
+        }
     }
 
     // Render sketch(es)
@@ -3732,6 +3743,17 @@ void Viewport::setDocument(app::Document* document) {
             syncModelMeshes();
             update();
         });
+        connect(m_document, &app::Document::bodyMeshDetailChanged, this, [this]() {
+            // Only the drawn triangles changed; picking keeps the standard mesh.
+            if (m_bodyRenderer) {
+                m_bodyRenderer->setMeshes(visibleModelMeshes());
+            }
+            update();
+        });
+        connect(m_document, &app::Document::modelSnapshotPublished, this, [this]() {
+            syncModelMeshes();
+            update();
+        });
         connect(m_document, &app::Document::bodyVisibilityChanged, this, [this]() {
             syncModelMeshes();
             update();
@@ -3849,20 +3871,27 @@ void Viewport::clearPreviewHiddenBody() {
     update();
 }
 
-void Viewport::syncModelMeshes() {
-    if (!m_document || !m_modelPicker) {
-        return;
-    }
-    const auto& store = m_document->meshStore();
-
-    // Build filtered list of visible body meshes
+std::vector<render::SceneMeshStore::Mesh> Viewport::visibleModelMeshes() const {
     std::vector<render::SceneMeshStore::Mesh> visibleMeshes;
-    store.forEachMesh([&](const render::SceneMeshStore::Mesh& mesh) {
+    if (!m_document) {
+        return visibleMeshes;
+    }
+    m_document->meshStore().forEachMesh([&](const render::SceneMeshStore::Mesh& mesh) {
         if (m_document->isBodyVisible(mesh.bodyId) &&
             (m_previewHiddenBodyId.empty() || mesh.bodyId != m_previewHiddenBodyId)) {
             visibleMeshes.push_back(mesh);
         }
     });
+    return visibleMeshes;
+}
+
+void Viewport::syncModelMeshes() {
+    if (!m_document || !m_modelPicker) {
+        return;
+    }
+
+    // Build filtered list of visible body meshes
+    const std::vector<render::SceneMeshStore::Mesh> visibleMeshes = visibleModelMeshes();
 
     if (m_bodyRenderer) {
         m_bodyRenderer->setMeshes(visibleMeshes);
@@ -3873,19 +3902,19 @@ void Viewport::syncModelMeshes() {
     for (const auto& mesh : visibleMeshes) {
         selection::ModelPickerAdapter::Mesh pickMesh;
         pickMesh.bodyId = mesh.bodyId;
-        pickMesh.vertices.reserve(mesh.vertices.size());
-        for (const auto& v : mesh.vertices) {
-            QVector4D transformed = mesh.modelMatrix * QVector4D(v, 1.0f);
-            pickMesh.vertices.emplace_back(transformed.x(), transformed.y(), transformed.z());
-        }
-        pickMesh.triangles.reserve(mesh.triangles.size());
-        for (const auto& tri : mesh.triangles) {
-            selection::ModelPickerAdapter::Triangle pickTri;
-            pickTri.i0 = tri.i0;
-            pickTri.i1 = tri.i1;
-            pickTri.i2 = tri.i2;
-            pickTri.faceId = tri.faceId;
-            pickMesh.triangles.push_back(pickTri);
+        if (mesh.modelMatrix.isIdentity()) {
+            pickMesh.positions = mesh.positions;
+        } else {
+            pickMesh.positions.reserve(mesh.positions.size());
+            for (std::size_t i = 0; i < mesh.vertexCount(); ++i) {
+                QVector4D transformed = mesh.modelMatrix * QVector4D(mesh.position(static_cast<std::uint32_t>(i)), 1.0f);
+                pickMesh.positions.insert(pickMesh.positions.end(), {transformed.x(), transformed.y(), transformed.z()});
+            }
+        }
+        pickMesh.indices = mesh.indices;
+        pickMesh.faces.reserve(mesh.faces.size());
+        for (const auto& range : mesh.faces) {
+            pickMesh.faces.push_back({range.faceId, range.firstIndex, range.indexCount});
         }
         for (const auto& [faceId, topo] : mesh.topologyByFace) {
             selection::ModelPickerAdapter::FaceTopology faceTopo;
@@ -266,6 +266,7 @@ private:
     void drawModelToolOverlay(const QMatrix4x4& viewProjection);
     QMatrix4x4 buildViewProjection() const;
     QSize viewportSize() const;
+    std::vector<render::SceneMeshStore::Mesh> visibleModelMeshes() const;
     void syncModelMeshes();
     std::string resolveActiveSketchId() const;
     void updateSketchSelectionFromManager();
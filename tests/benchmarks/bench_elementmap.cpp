@@ -0,0 +1,482 @@
+/**
+ * @file bench_elementmap.cpp
+ * @brief ElementMap stress benchmark on synthetic topologies (onecad_bench_elementmap).
+ *
+ * Generates parametric shapes of growing size and times the ElementMap
+ * operations topological naming depends on: registerElement() over every
+ * sub-shape, rebindBody() of a fresh and of a modified shape, update() after
+ * a boolean, and v1 text / v2 binary write and read. Every case also checks
+ * that IDs are stable: repeated runs must assign identical IDs and both
+ * formats must round-trip them. Results are printed as JSON (median/p95 per
+ * phase plus an ID digest) so runs can be compared across commits; a change
+ * of idDigest for the same case means naming changed.
+ *
+ * Synthetic cases:
+ * - prism-N: N-sided prism, cut by a cylinder through its axis
+ * - pocket-M: plate with M patterned pockets cut in one boolean
+ * - boss-M: plate with M patterned bosses fused in one boolean
+ * - fillet-K: K-sided prism with its top edge chain filleted (rebind only)
+ *
+ * Usage:
+ *   onecad_bench_elementmap [--iterations N] [--warmup N] [--prisms 8,64,256]
+ *                           [--pockets 4,16,64] [--bosses 4,16,64]
+ *                           [--fillets 4,8,16] [--output FILE]
+ */
+
+#include "kernel/elementmap/ElementMap.h"
+
+#include <BRepAlgoAPI_Cut.hxx>
+#include <BRepAlgoAPI_Fuse.hxx>
+#include <BRepBuilderAPI_MakeFace.hxx>
+#include <BRepBuilderAPI_MakePolygon.hxx>
+#include <BRepFilletAPI_MakeFillet.hxx>
+#include <BRepPrimAPI_MakeBox.hxx>
+#include <BRepPrimAPI_MakeCylinder.hxx>
+#include <BRepPrimAPI_MakePrism.hxx>
+#include <BRep_Builder.hxx>
+#include <BRep_Tool.hxx>
+#include <TopExp.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Compound.hxx>
+#include <gp_Ax2.hxx>
+#include <gp_Pnt.hxx>
+#include <gp_Vec.hxx>
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSysInfo>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+
+using onecad::kernel::elementmap::ElementId;
+using onecad::kernel::elementmap::ElementKind;
+using onecad::kernel::elementmap::ElementMap;
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kPitch = 10.0;       // Pattern cell size
+constexpr double kPlateHeight = 5.0;
+const std::string kBodyId = "body";
+
+struct StressCase {
+    std::string name;
+    std::string family;
+    int size = 0;
+    TopoDS_Shape base;
+    TopoDS_Shape modified;
+    std::unique_ptr<BRepAlgoAPI_BooleanOperation> boolean;  // Produces modified; null for fillets
+};
+
+struct Samples {
+    std::vector<double> millis;
+    QString skipped;  // Reason the phase did not run
+};
+
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    // Nearest-rank, so small sample counts report an observed value.
+    const std::size_t rank = static_cast<std::size_t>(std::ceil(p * static_cast<double>(sorted.size())));
+    return sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1];
+}
+
+/**
+ * @brief Run @p body warmup + iterations times, timing the iterations only.
+ *
+ * @p setup runs before every call and is not timed.
+ */
+Samples measure(int warmup, int iterations, const std::function<void()>& setup,
+                const std::function<void()>& body) {
+    Samples samples;
+    for (int i = 0; i < warmup; ++i) {
+        setup();
+        body();
+    }
+    for (int i = 0; i < iterations; ++i) {
+        setup();
+        const auto start = std::chrono::steady_clock::now();
+        body();
+        const auto end = std::chrono::steady_clock::now();
+        samples.millis.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return samples;
+}
+
+QJsonObject summarize(const Samples& samples) {
+    QJsonObject json;
+    if (!samples.skipped.isEmpty()) {
+        json["skipped"] = samples.skipped;
+        return json;
+    }
+
+    std::vector<double> sorted = samples.millis;
+    std::sort(sorted.begin(), sorted.end());
+    const double total = std::accumulate(sorted.begin(), sorted.end(), 0.0);
+    json["samples"] = static_cast<int>(sorted.size());
+    json["medianMs"] = percentile(sorted, 0.5);
+    json["p95Ms"] = percentile(sorted, 0.95);
+    json["minMs"] = sorted.empty() ? 0.0 : sorted.front();
+    json["maxMs"] = sorted.empty() ? 0.0 : sorted.back();
+    json["meanMs"] = sorted.empty() ? 0.0 : total / static_cast<double>(sorted.size());
+    return json;
+}
+
+/**
+ * @brief FNV-1a over the sorted IDs with their kind and opId: equal digests mean equal naming.
+ */
+std::uint64_t idDigest(const ElementMap& emap) {
+    std::vector<ElementId> ids = emap.ids();
+    std::sort(ids.begin(), ids.end(), [](const ElementId& a, const ElementId& b) { return a.value < b.value; });
+    std::uint64_t hash = 1469598103934665603ULL;
+    auto mix = [&hash](const std::string& value) {
+        for (const unsigned char c : value) {
+            hash = (hash ^ c) * 1099511628211ULL;
+        }
+        hash = (hash ^ 0xffu) * 1099511628211ULL;
+    };
+    for (const auto& id : ids) {
+        const auto* entry = emap.find(id);
+        mix(id.value);
+        mix(std::to_string(static_cast<int>(entry->kind)));
+        mix(entry->opId);
+    }
+    return hash;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Synthetic topologies
+// ─────────────────────────────────────────────────────────────────────────────
+
+TopoDS_Shape makePrism(int sides, double radius, double height) {
+    BRepBuilderAPI_MakePolygon polygon;
+    for (int i = 0; i < sides; ++i) {
+        const double angle = 2.0 * kPi * i / sides;
+        polygon.Add(gp_Pnt(radius * std::cos(angle), radius * std::sin(angle), 0.0));
+    }
+    polygon.Close();
+    BRepBuilderAPI_MakeFace face(polygon.Wire(), true);
+    return BRepPrimAPI_MakePrism(face.Face(), gp_Vec(0.0, 0.0, height)).Shape();
+}
+
+/**
+ * @brief Plate holding a square grid of at least @p count cells, and one box per cell.
+ */
+std::pair<TopoDS_Shape, TopoDS_Compound> makePattern(int count, double toolZ0, double toolZ1) {
+    const int columns = std::max(1, static_cast<int>(std::ceil(std::sqrt(count))));
+    const int rows = (count + columns - 1) / columns;
+    const TopoDS_Shape plate =
+        BRepPrimAPI_MakeBox(gp_Pnt(0.0, 0.0, 0.0), gp_Pnt(columns * kPitch, rows * kPitch, kPlateHeight)).Shape();
+
+    BRep_Builder builder;
+    TopoDS_Compound tools;
+    builder.MakeCompound(tools);
+    for (int i = 0; i < count; ++i) {
+        const double x = (i % columns) * kPitch + 3.0;
+        const double y = (i / columns) * kPitch + 3.0;
+        builder.Add(tools, BRepPrimAPI_MakeBox(gp_Pnt(x, y, toolZ0), gp_Pnt(x + 4.0, y + 4.0, toolZ1)).Shape());
+    }
+    return {plate, tools};
+}
+
+bool finishBoolean(StressCase& stress) {
+    stress.boolean->Build();
+    if (!stress.boolean->IsDone()) {
+        return false;
+    }
+    stress.modified = stress.boolean->Shape();
+    return !stress.modified.IsNull();
+}
+
+std::unique_ptr<StressCase> makePrismCase(int sides) {
+    auto stress = std::make_unique<StressCase>();
+    stress->name = "prism-" + std::to_string(sides);
+    stress->family = "prism";
+    stress->size = sides;
+    stress->base = makePrism(sides, 20.0, 10.0);
+    const TopoDS_Shape hole =
+        BRepPrimAPI_MakeCylinder(gp_Ax2(gp_Pnt(0.0, 0.0, -1.0), gp::DZ()), 5.0, 12.0).Shape();
+    stress->boolean = std::make_unique<BRepAlgoAPI_Cut>(stress->base, hole, Message_ProgressRange(), false);
+    return finishBoolean(*stress) ? std::move(stress) : nullptr;
+}
+
+std::unique_ptr<StressCase> makePocketCase(int count) {
+    auto stress = std::make_unique<StressCase>();
+    stress->name = "pocket-" + std::to_string(count);
+    stress->family = "pocket";
+    stress->size = count;
+    auto [plate, pockets] = makePattern(count, 2.0, kPlateHeight + 1.0);
+    stress->base = plate;
+    stress->boolean = std::make_unique<BRepAlgoAPI_Cut>(plate, pockets, Message_ProgressRange(), false);
+    return finishBoolean(*stress) ? std::move(stress) : nullptr;
+}
+
+std::unique_ptr<StressCase> makeBossCase(int count) {
+    auto stress = std::make_unique<StressCase>();
+    stress->name = "boss-" + std::to_string(count);
+    stress->family = "boss";
+    stress->size = count;
+    auto [plate, bosses] = makePattern(count, kPlateHeight - 1.0, kPlateHeight + 3.0);
+    stress->base = plate;
+    stress->boolean = std::make_unique<BRepAlgoAPI_Fuse>(plate, bosses, Message_ProgressRange(), false);
+    return finishBoolean(*stress) ? std::move(stress) : nullptr;
+}
+
+std::unique_ptr<StressCase> makeFilletCase(int sides) {
+    auto stress = std::make_unique<StressCase>();
+    stress->name = "fillet-" + std::to_string(sides);
+    stress->family = "fillet";
+    stress->size = sides;
+    constexpr double kRadius = 20.0;
+    constexpr double kHeight = 10.0;
+    stress->base = makePrism(sides, kRadius, kHeight);
+
+    // Fillet the closed chain of top edges, well below the shortest side.
+    const double side = 2.0 * kRadius * std::sin(kPi / sides);
+    BRepFilletAPI_MakeFillet fillet(stress->base);
+    TopTools_IndexedMapOfShape edges;
+    TopExp::MapShapes(stress->base, TopAbs_EDGE, edges);
+    for (int i = 1; i <= edges.Extent(); ++i) {
+        const TopoDS_Edge& edge = TopoDS::Edge(edges(i));
+        if (std::abs(BRep_Tool::Pnt(TopExp::FirstVertex(edge)).Z() - kHeight) < 1e-6 &&
+            std::abs(BRep_Tool::Pnt(TopExp::LastVertex(edge)).Z() - kHeight) < 1e-6) {
+            fillet.Add(std::min(0.1 * side, 1.0), edge);
+        }
+    }
+    fillet.Build();
+    if (!fillet.IsDone()) {
+        return nullptr;
+    }
+    stress->modified = fillet.Shape();
+    return stress;
+}
+
+std::vector<int> parseCounts(const QString& text) {
+    std::vector<int> counts;
+    for (const QString& part : text.split(',', Qt::SkipEmptyParts)) {
+        bool ok = false;
+        const int value = part.trimmed().toInt(&ok);
+        if (ok && value > 0) {
+            counts.push_back(value);
+        }
+    }
+    return counts;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Phases
+// ─────────────────────────────────────────────────────────────────────────────
+
+void registerAll(ElementMap& emap, const TopoDS_Shape& shape) {
+    emap.registerElement(ElementId{kBodyId}, ElementKind::Body, shape, "op-base");
+    const std::pair<TopAbs_ShapeEnum, ElementKind> kinds[] = {
+        {TopAbs_FACE, ElementKind::Face}, {TopAbs_EDGE, ElementKind::Edge}, {TopAbs_VERTEX, ElementKind::Vertex}};
+    for (const auto& [shapeType, kind] : kinds) {
+        TopTools_IndexedMapOfShape map;
+        TopExp::MapShapes(shape, shapeType, map);
+        const char* tag = kind == ElementKind::Face ? "/face/" : kind == ElementKind::Edge ? "/edge/" : "/vertex/";
+        for (int i = 1; i <= map.Extent(); ++i) {
+            emap.registerElement(ElementId{kBodyId + tag + std::to_string(i)}, kind, map(i), "op-base");
+        }
+    }
+}
+
+/**
+ * @brief Name the base shape, then follow it through the case's modification.
+ */
+void applyModification(ElementMap& emap, StressCase& stress) {
+    if (stress.boolean) {
+        emap.update(*stress.boolean, "op-modify");
+    }
+    // update() follows history only; the body is then rebound to the result as on regeneration.
+    emap.rebindBody(kBodyId, stress.modified, "op-modify");
+}
+
+QJsonObject runCase(StressCase& stress, int warmup, int iterations) {
+    QJsonObject phases;
+    ElementMap emap;
+    bool stable = true;
+    std::vector<std::uint64_t> digests;
+    auto recordDigest = [&]() {
+        digests.push_back(idDigest(emap));
+        stable = stable && digests.front() == digests.back();
+    };
+
+    phases["registerElement"] = summarize(measure(
+        warmup, iterations, [&]() { emap.clear(); }, [&]() { registerAll(emap, stress.base); }));
+
+    phases["rebindInitial"] = summarize(measure(
+        warmup, iterations, [&]() { emap.clear(); }, [&]() { emap.rebindBody(kBodyId, stress.base, "op-base"); }));
+
+    // Rebind of the modified shape by descriptor matching only.
+    phases["rebind"] = summarize(measure(
+        warmup, iterations,
+        [&]() {
+            emap.clear();
+            emap.rebindBody(kBodyId, stress.base, "op-base");
+        },
+        [&]() { emap.rebindBody(kBodyId, stress.modified, "op-modify"); }));
+
+    Samples update;
+    if (stress.boolean) {
+        // Each run's naming is compared with the first: the setup of the next run records it.
+        emap.clear();
+        update = measure(
+            warmup, iterations,
+            [&]() {
+                if (!emap.ids().empty()) {
+                    recordDigest();
+                }
+                emap.clear();
+                emap.rebindBody(kBodyId, stress.base, "op-base");
+            },
+            [&]() { emap.update(*stress.boolean, "op-modify"); });
+        recordDigest();
+    } else {
+        update.skipped = "not a boolean";
+    }
+    phases["update"] = summarize(update);
+
+    // Final naming, checked against an independent run on a fresh map.
+    emap.clear();
+    emap.rebindBody(kBodyId, stress.base, "op-base");
+    applyModification(emap, stress);
+    const std::uint64_t digest = idDigest(emap);
+    {
+        ElementMap again;
+        again.rebindBody(kBodyId, stress.base, "op-base");
+        applyModification(again, stress);
+        stable = stable && idDigest(again) == digest;
+    }
+
+    std::string text;
+    std::string binary;
+    ElementMap restored;
+    phases["writeText"] = summarize(measure(warmup, iterations, []() {}, [&]() { text = emap.toString(); }));
+    phases["readText"] = summarize(measure(
+        warmup, iterations, [&]() { restored.clear(); }, [&]() { restored.fromString(text); }));
+    const bool textRoundTrip = idDigest(restored) == digest;
+    phases["writeBinary"] = summarize(measure(warmup, iterations, []() {}, [&]() { binary = emap.toBinary(); }));
+    phases["readBinary"] = summarize(measure(
+        warmup, iterations, [&]() { restored.clear(); },
+        [&]() { restored.fromBinary(binary.data(), binary.size()); }));
+    const bool binaryRoundTrip = idDigest(restored) == digest;
+
+    std::size_t counts[4] = {0, 0, 0, 0};
+    for (const auto& id : emap.ids()) {
+        const auto kind = emap.find(id)->kind;
+        if (kind != ElementKind::Unknown) {
+            ++counts[static_cast<int>(kind)];
+        }
+    }
+
+    QJsonObject json;
+    json["name"] = QString::fromStdString(stress.name);
+    json["family"] = QString::fromStdString(stress.family);
+    json["size"] = stress.size;
+    json["elements"] = QJsonObject{
+        {"total", static_cast<double>(emap.ids().size())},
+        {"faces", static_cast<double>(counts[static_cast<int>(ElementKind::Face)])},
+        {"edges", static_cast<double>(counts[static_cast<int>(ElementKind::Edge)])},
+        {"vertices", static_cast<double>(counts[static_cast<int>(ElementKind::Vertex)])}};
+    json["textBytes"] = static_cast<double>(text.size());
+    json["binaryBytes"] = static_cast<double>(binary.size());
+    json["phases"] = phases;
+    json["idDigest"] = QString::number(digest, 16);
+    json["stable"] = stable;
+    json["textRoundTrip"] = textRoundTrip;
+    json["binaryRoundTrip"] = binaryRoundTrip;
+    return json;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("onecad_bench_elementmap");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("ElementMap stress benchmark on synthetic topologies.");
+    parser.addHelpOption();
+    const QCommandLineOption iterationsOption("iterations", "Timed runs per phase.", "n", "5");
+    const QCommandLineOption warmupOption("warmup", "Untimed runs per phase.", "n", "1");
+    const QCommandLineOption prismsOption("prisms", "Prism side counts.", "list", "8,64,256");
+    const QCommandLineOption pocketsOption("pockets", "Patterned pocket counts.", "list", "4,16,64");
+    const QCommandLineOption bossesOption("bosses", "Patterned boss counts.", "list", "4,16,64");
+    const QCommandLineOption filletsOption("fillets", "Filleted prism side counts.", "list", "4,8,16");
+    const QCommandLineOption outputOption("output", "Write JSON here instead of stdout.", "file");
+    parser.addOptions({iterationsOption, warmupOption, prismsOption, pocketsOption, bossesOption, filletsOption,
+                       outputOption});
+    parser.process(app);
+
+    const int iterations = std::max(1, parser.value(iterationsOption).toInt());
+    const int warmup = std::max(0, parser.value(warmupOption).toInt());
+
+    std::vector<std::unique_ptr<StressCase>> cases;
+    auto addCases = [&](const QCommandLineOption& option, const char* family,
+                        const std::function<std::unique_ptr<StressCase>(int)>& make) {
+        for (int size : parseCounts(parser.value(option))) {
+            if (auto stress = make(size)) {
+                cases.push_back(std::move(stress));
+            } else {
+                std::cerr << "Failed to build synthetic " << family << "-" << size << "\n";
+            }
+        }
+    };
+    addCases(prismsOption, "prism", makePrismCase);
+    addCases(pocketsOption, "pocket", makePocketCase);
+    addCases(bossesOption, "boss", makeBossCase);
+    addCases(filletsOption, "fillet", makeFilletCase);
+    if (cases.empty()) {
+        std::cerr << "Nothing to benchmark\n";
+        return 1;
+    }
+
+    QJsonArray results;
+    bool allStable = true;
+    for (auto& stress : cases) {
+        std::cerr << "Running " << stress->name << "...\n";
+        const QJsonObject result = runCase(*stress, warmup, iterations);
+        allStable = allStable && result["stable"].toBool() && result["textRoundTrip"].toBool() &&
+                    result["binaryRoundTrip"].toBool();
+        results.append(result);
+    }
+
+    QJsonObject report;
+    report["benchmark"] = "onecad_bench_elementmap";
+    report["schemaVersion"] = 1;
+    report["iterations"] = iterations;
+    report["warmup"] = warmup;
+    report["platform"] = QSysInfo::prettyProductName();
+    report["cpuArchitecture"] = QSysInfo::currentCpuArchitecture();
+    report["stable"] = allStable;
+    report["cases"] = results;
+    const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+
+    if (parser.isSet(outputOption)) {
+        QFile file(parser.value(outputOption));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(json) != json.size()) {
+            std::cerr << "Failed to write " << file.fileName().toStdString() << "\n";
+            return 1;
+        }
+    } else {
+        std::cout << json.toStdString();
+    }
+    // Unstable naming fails the run, so scripts can gate on the exit code.
+    return allStable ? 0 : 2;
+}
@@ -0,0 +1,572 @@
+/**
+ * @file bench_regen.cpp
+ * @brief Headless regeneration benchmark (onecad_bench_regen).
+ *
+ * Loads .onecad packages, v1 history fixture directories and generated
+ * synthetic histories, then times full regeneration, incremental
+ * regeneration after a parameter edit, rollback/roll-forward and cold
+ * tessellation. Results are printed as JSON (median/p95 per scenario plus
+ * resident memory) so runs can be compared across commits.
+ *
+ * Synthetic cases:
+ * - stack-N: one body built from N stacked extrude+fillet pairs
+ * - pattern-M: M independent bodies, each an extrude+fillet pair
+ *
+ * Usage:
+ *   onecad_bench_regen [--iterations N] [--warmup N] [--stack 4,8,16]
+ *                      [--bodies 4,16] [--no-synthetic] [--output FILE] [PATH...]
+ */
+
+#include "app/commands/RollbackCommand.h"
+#include "app/document/Document.h"
+#include "app/history/RegenProfile.h"
+#include "app/history/RegenerationEngine.h"
+#include "core/loop/LoopDetector.h"
+#include "core/loop/RegionUtils.h"
+#include "core/sketch/Sketch.h"
+#include "io/HistoryIO.h"
+#include "io/OneCADFileIO.h"
+#include "render/tessellation/TessellationCache.h"
+
+#include <BRep_Tool.hxx>
+#include <BRepAdaptor_Curve.hxx>
+#include <BRepTools.hxx>
+#include <TopExp.hxx>
+#include <TopoDS.hxx>
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QSysInfo>
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <variant>
+#include <vector>
+
+using namespace onecad;
+
+namespace {
+
+constexpr double kLevelHeight = 1.0;
+constexpr double kFilletRadius = 0.25;
+constexpr double kEditDelta = 0.5;
+
+struct BenchCase {
+    std::string name;
+    std::string source;
+    std::unique_ptr<app::Document> document;
+};
+
+struct Samples {
+    std::vector<double> millis;
+    std::int64_t residentDeltaBytes = 0;
+    app::history::RegenStatus status = app::history::RegenStatus::Success;
+    std::size_t failedOps = 0;
+    QString skipped;  // Reason the scenario did not run
+};
+
+const char* statusName(app::history::RegenStatus status) {
+    switch (status) {
+    case app::history::RegenStatus::Success: return "Success";
+    case app::history::RegenStatus::PartialFailure: return "PartialFailure";
+    case app::history::RegenStatus::CriticalFailure: return "CriticalFailure";
+    case app::history::RegenStatus::Cancelled: return "Cancelled";
+    }
+    return "Unknown";
+}
+
+std::int64_t peakResidentBytes() {
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#if defined(__APPLE__)
+    return static_cast<std::int64_t>(usage.ru_maxrss);  // Bytes on macOS
+#else
+    return static_cast<std::int64_t>(usage.ru_maxrss) * 1024;  // Kilobytes on Linux
+#endif
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    // Nearest-rank, so small sample counts report an observed value.
+    const std::size_t rank = static_cast<std::size_t>(std::ceil(p * static_cast<double>(sorted.size())));
+    return sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1];
+}
+
+/**
+ * @brief Run @p body warmup + iterations times, timing the iterations only.
+ *
+ * @p setup runs before every call and is not timed.
+ */
+Samples measure(int warmup, int iterations, const std::function<void()>& setup,
+                const std::function<app::history::RegenResult()>& body) {
+    Samples samples;
+    for (int i = 0; i < warmup; ++i) {
+        setup();
+        body();
+    }
+    const std::int64_t residentBefore = app::history::RegenProfile::residentBytes();
+    for (int i = 0; i < iterations; ++i) {
+        setup();
+        const auto start = std::chrono::steady_clock::now();
+        const app::history::RegenResult result = body();
+        const auto end = std::chrono::steady_clock::now();
+        samples.millis.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        samples.status = result.status;
+        samples.failedOps = result.failedOps.size();
+    }
+    samples.residentDeltaBytes = app::history::RegenProfile::residentBytes() - residentBefore;
+    return samples;
+}
+
+QJsonObject summarize(const Samples& samples) {
+    QJsonObject json;
+    if (!samples.skipped.isEmpty()) {
+        json["skipped"] = samples.skipped;
+        return json;
+    }
+
+    std::vector<double> sorted = samples.millis;
+    std::sort(sorted.begin(), sorted.end());
+    const double total = std::accumulate(sorted.begin(), sorted.end(), 0.0);
+    json["samples"] = static_cast<int>(sorted.size());
+    json["medianMs"] = percentile(sorted, 0.5);
+    json["p95Ms"] = percentile(sorted, 0.95);
+    json["minMs"] = sorted.empty() ? 0.0 : sorted.front();
+    json["maxMs"] = sorted.empty() ? 0.0 : sorted.back();
+    json["meanMs"] = sorted.empty() ? 0.0 : total / static_cast<double>(sorted.size());
+    json["residentDeltaBytes"] = static_cast<double>(samples.residentDeltaBytes);
+    json["status"] = statusName(samples.status);
+    json["failedOps"] = static_cast<int>(samples.failedOps);
+    return json;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Synthetic histories
+// ─────────────────────────────────────────────────────────────────────────────
+
+std::string addSquareSketch(app::Document& doc, double centerX, double centerY, double size, double z) {
+    core::sketch::SketchPlane plane = core::sketch::SketchPlane::XY();
+    plane.origin.z = z;
+    auto sketch = std::make_unique<core::sketch::Sketch>(plane);
+    const double half = size / 2.0;
+    auto p1 = sketch->addPoint(centerX - half, centerY - half);
+    auto p2 = sketch->addPoint(centerX + half, centerY - half);
+    auto p3 = sketch->addPoint(centerX + half, centerY + half);
+    auto p4 = sketch->addPoint(centerX - half, centerY + half);
+    sketch->addLine(p1, p2);
+    sketch->addLine(p2, p3);
+    sketch->addLine(p3, p4);
+    sketch->addLine(p4, p1);
+    return doc.addSketch(std::move(sketch));
+}
+
+std::string firstRegionId(core::sketch::Sketch& sketch) {
+    core::loop::LoopDetector detector(core::loop::makeRegionDetectionConfig());
+    auto loops = detector.detect(sketch);
+    auto regions = core::loop::buildRegionDefinitions(loops, core::sketch::constants::COINCIDENCE_TOLERANCE);
+    return regions.empty() ? std::string() : regions.front().id;
+}
+
+app::OperationRecord makeExtrude(app::Document& doc, const std::string& opId, const std::string& sketchId,
+                                 const std::string& bodyId, app::BooleanMode mode) {
+    app::OperationRecord op;
+    op.opId = opId;
+    op.type = app::OperationType::Extrude;
+    op.input = app::SketchRegionRef{sketchId, firstRegionId(*doc.getSketch(sketchId))};
+    op.params = app::ExtrudeParams{kLevelHeight, 0.0, mode, mode == app::BooleanMode::NewBody ? std::string() : bodyId};
+    op.resultBodyIds.push_back(bodyId);
+    return op;
+}
+
+/**
+ * @brief ElementMap ID of a straight edge of @p bodyId lying at height @p z.
+ */
+std::string findTopEdge(const app::Document& doc, const std::string& bodyId, double z) {
+    for (const auto& entry : doc.elementMap().bodyEntries(bodyId)) {
+        if (entry.kind != kernel::elementmap::ElementKind::Edge || entry.shape.IsNull()) {
+            continue;
+        }
+        const TopoDS_Edge edge = TopoDS::Edge(entry.shape);
+        if (BRepAdaptor_Curve(edge).GetType() != GeomAbs_Line) {
+            continue;
+        }
+        const gp_Pnt first = BRep_Tool::Pnt(TopExp::FirstVertex(edge));
+        const gp_Pnt last = BRep_Tool::Pnt(TopExp::LastVertex(edge));
+        if (std::abs(first.Z() - z) < 1e-6 && std::abs(last.Z() - z) < 1e-6) {
+            return entry.id.value;
+        }
+    }
+    return {};
+}
+
+/**
+ * @brief Extrude a square at (@p x, @p y, @p z), regenerate, then fillet one of its top edges.
+ */
+bool appendExtrudeFillet(app::Document& doc, const std::string& prefix, const std::string& bodyId,
+                         double x, double y, double z, double size, app::BooleanMode mode) {
+    const std::string sketchId = addSquareSketch(doc, x, y, size, z);
+    doc.addOperation(makeExtrude(doc, prefix + "-extrude", sketchId, bodyId, mode));
+    {
+        app::history::RegenerationEngine engine(&doc);
+        if (engine.regenerateAll().status != app::history::RegenStatus::Success) {
+            return false;
+        }
+    }
+
+    const std::string edgeId = findTopEdge(doc, bodyId, z + kLevelHeight);
+    if (edgeId.empty()) {
+        return false;
+    }
+    app::OperationRecord fillet;
+    fillet.opId = prefix + "-fillet";
+    fillet.type = app::OperationType::Fillet;
+    fillet.input = app::BodyRef{bodyId};
+    app::FilletChamferParams params;
+    params.mode = app::FilletChamferParams::Mode::Fillet;
+    params.radius = kFilletRadius;
+    params.edgeIds = {edgeId};
+    params.chainTangentEdges = false;
+    fillet.params = params;
+    fillet.resultBodyIds.push_back(bodyId);
+    doc.addOperation(fillet);
+
+    app::history::RegenerationEngine engine(&doc);
+    return engine.regenerateAll().status == app::history::RegenStatus::Success;
+}
+
+std::unique_ptr<app::Document> makeStack(int levels) {
+    auto doc = std::make_unique<app::Document>();
+    const std::string bodyId = "stack-body";
+    for (int level = 0; level < levels; ++level) {
+        // Each boss is inset from the one below, clear of its filleted edge.
+        const double size = 2.0 * (levels - level) + 2.0;
+        const auto mode = level == 0 ? app::BooleanMode::NewBody : app::BooleanMode::Add;
+        if (!appendExtrudeFillet(*doc, "level-" + std::to_string(level), bodyId, 0.0, 0.0,
+                                 level * kLevelHeight, size, mode)) {
+            return nullptr;
+        }
+    }
+    return doc;
+}
+
+std::unique_ptr<app::Document> makePattern(int bodies) {
+    auto doc = std::make_unique<app::Document>();
+    const int columns = std::max(1, static_cast<int>(std::ceil(std::sqrt(bodies))));
+    for (int b = 0; b < bodies; ++b) {
+        const double x = 15.0 * (b % columns);
+        const double y = 15.0 * (b / columns);
+        if (!appendExtrudeFillet(*doc, "body-" + std::to_string(b), "pattern-body-" + std::to_string(b),
+                                 x, y, 0.0, 10.0, app::BooleanMode::NewBody)) {
+            return nullptr;
+        }
+    }
+    return doc;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Inputs
+// ─────────────────────────────────────────────────────────────────────────────
+
+/**
+ * @brief Load a v1 history fixture directory (history_ops*.jsonl + history_state*.json).
+ *
+ * Fixtures carry history only; ops referencing absent sketches or bodies
+ * fail during replay and are reported as failedOps.
+ */
+std::unique_ptr<app::Document> loadHistoryFixture(const QString& path, QString& errorOut) {
+    const QDir dir(path);
+    const QStringList opsFiles = dir.entryList({"history_ops*.jsonl"}, QDir::Files, QDir::Name);
+    if (opsFiles.isEmpty()) {
+        errorOut = QString("No history_ops*.jsonl in %1").arg(path);
+        return nullptr;
+    }
+
+    QFile opsFile(dir.filePath(opsFiles.front()));
+    if (!opsFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        errorOut = QString("Failed to open %1").arg(opsFile.fileName());
+        return nullptr;
+    }
+    auto doc = std::make_unique<app::Document>();
+    while (!opsFile.atEnd()) {
+        const QByteArray line = opsFile.readLine().trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+        const QJsonDocument json = QJsonDocument::fromJson(line);
+        if (!json.isObject()) {
+            errorOut = QString("Invalid operation line in %1").arg(opsFile.fileName());
+            return nullptr;
+        }
+        doc->addOperation(io::HistoryIO::deserializeOperation(json.object()));
+    }
+
+    const QStringList stateFiles = dir.entryList({"history_state*.json"}, QDir::Files, QDir::Name);
+    if (!stateFiles.isEmpty()) {
+        QFile stateFile(dir.filePath(stateFiles.front()));
+        if (stateFile.open(QIODevice::ReadOnly)) {
+            const QJsonObject state = QJsonDocument::fromJson(stateFile.readAll()).object();
+            for (const auto& opId : state["suppressedOps"].toArray()) {
+                doc->setOperationSuppressed(opId.toString().toStdString(), true);
+            }
+            const QJsonObject cursor = state["cursor"].toObject();
+            if (cursor.contains("appliedOpCount")) {
+                doc->setAppliedOpCount(static_cast<std::size_t>(cursor["appliedOpCount"].toInteger()));
+            }
+        }
+    }
+    return doc;
+}
+
+std::vector<BenchCase> loadInputs(const QStringList& paths) {
+    std::vector<BenchCase> cases;
+    for (const QString& path : paths) {
+        const QFileInfo info(path);
+        QString error;
+        std::unique_ptr<app::Document> doc;
+        std::string source;
+        if (info.isDir() && !QFileInfo::exists(QDir(path).filePath("manifest.json"))) {
+            doc = loadHistoryFixture(path, error);
+            source = "fixture";
+        } else {
+            doc = io::OneCADFileIO::load(path, error);
+            source = "onecad";
+        }
+        if (!doc) {
+            std::cerr << "Skipping " << path.toStdString() << ": " << error.toStdString() << "\n";
+            continue;
+        }
+        cases.push_back({info.fileName().toStdString(), source, std::move(doc)});
+    }
+    return cases;
+}
+
+std::vector<int> parseCounts(const QString& text) {
+    std::vector<int> counts;
+    for (const QString& part : text.split(',', Qt::SkipEmptyParts)) {
+        bool ok = false;
+        const int value = part.trimmed().toInt(&ok);
+        if (ok && value > 0) {
+            counts.push_back(value);
+        }
+    }
+    return counts;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Scenarios
+// ─────────────────────────────────────────────────────────────────────────────
+
+const app::OperationRecord* lastExtrude(const app::Document& doc) {
+    const auto& ops = doc.operations();
+    const std::size_t applied = std::min(doc.appliedOpCount(), ops.size());
+    for (std::size_t i = applied; i > 0; --i) {
+        if (std::holds_alternative<app::ExtrudeParams>(ops[i - 1].params)) {
+            return &ops[i - 1];
+        }
+    }
+    return nullptr;
+}
+
+QJsonObject runCase(BenchCase& bench, int warmup, int iterations) {
+    app::Document& doc = *bench.document;
+    QJsonObject scenarios;
+
+    // Full: cold replay on a copy without checkpoint or prefix snapshot caches.
+    std::unique_ptr<app::Document> copy;
+    scenarios["full"] = summarize(measure(
+        warmup, iterations, [&]() { copy = doc.cloneForRegeneration(); },
+        [&]() {
+            app::history::RegenerationEngine engine(copy.get());
+            return engine.regenerateToAppliedCount(copy->appliedOpCount());
+        }));
+    copy.reset();
+
+    // Bring the document itself up to date so the scenarios below start warm.
+    {
+        app::history::RegenerationEngine engine(&doc);
+        engine.regenerateToAppliedCount(doc.appliedOpCount());
+    }
+
+    // Incremental: toggle the last extrude's distance and replay what depends on it.
+    Samples incremental;
+    if (const app::OperationRecord* op = lastExtrude(doc)) {
+        const std::string opId = op->opId;
+        app::ExtrudeParams original = std::get<app::ExtrudeParams>(op->params);
+        bool grown = false;
+        incremental = measure(
+            warmup, iterations,
+            [&]() {
+                app::ExtrudeParams params = original;
+                grown = !grown;
+                params.distance += grown ? kEditDelta : 0.0;
+                doc.updateOperationParams(opId, params);
+            },
+            [&]() {
+                app::history::RegenerationEngine engine(&doc);
+                return engine.regenerateIncremental(doc.appliedOpCount(), {opId});
+            });
+        doc.updateOperationParams(opId, original);
+        app::history::RegenerationEngine engine(&doc);
+        engine.regenerateIncremental(doc.appliedOpCount(), {opId});
+    } else {
+        incremental.skipped = "no applied extrude to edit";
+    }
+    scenarios["incremental"] = summarize(incremental);
+
+    // Rollback: roll back to the middle of the history and forward again.
+    Samples rollback;
+    const std::size_t applied = std::min(doc.appliedOpCount(), doc.operations().size());
+    if (applied >= 2) {
+        const std::string targetOpId = doc.operations()[applied / 2 - 1].opId;
+        rollback = measure(warmup, iterations, []() {}, [&]() {
+            app::commands::RollbackCommand command(&doc, targetOpId);
+            command.execute();
+            command.undo();
+            return app::history::RegenResult{};
+        });
+    } else {
+        rollback.skipped = "fewer than two applied operations";
+    }
+    scenarios["rollback"] = summarize(rollback);
+
+    // Tessellation: cold meshing of every body.
+    std::vector<std::pair<std::string, TopoDS_Shape>> bodies;
+    for (const auto& bodyId : doc.getBodyIds()) {
+        if (const TopoDS_Shape* shape = doc.getBodyShape(bodyId)) {
+            bodies.emplace_back(bodyId, *shape);
+        }
+    }
+    kernel::elementmap::ElementMap elements;
+    render::TessellationCache tessellator;
+    std::size_t triangles = 0;
+    scenarios["tessellation"] = summarize(measure(
+        warmup, iterations,
+        [&]() {
+            elements = doc.elementMap();
+            tessellator.clearCache();
+            for (auto& [bodyId, shape] : bodies) {
+                (void)bodyId;
+                BRepTools::Clean(shape);
+            }
+        },
+        [&]() {
+            triangles = 0;
+            for (const auto& [bodyId, shape] : bodies) {
+                triangles += tessellator.buildMesh(bodyId, shape, elements).triangleCount();
+            }
+            return app::history::RegenResult{};
+        }));
+
+    const auto descriptorCache = doc.elementMap().descriptorCacheStats();
+
+    QJsonObject json;
+    json["name"] = QString::fromStdString(bench.name);
+    json["source"] = QString::fromStdString(bench.source);
+    json["operations"] = static_cast<int>(doc.operations().size());
+    json["appliedOperations"] = static_cast<int>(applied);
+    json["bodies"] = static_cast<int>(bodies.size());
+    json["triangles"] = static_cast<double>(triangles);
+    json["scenarios"] = scenarios;
+    json["descriptorCache"] = QJsonObject{
+        {"hits", static_cast<double>(descriptorCache.hits)},
+        {"misses", static_cast<double>(descriptorCache.misses)},
+        {"hitRate", descriptorCache.hitRate()},
+        {"entries", static_cast<double>(descriptorCache.size)}};
+    return json;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("onecad_bench_regen");
+    // Per-op logging would dominate the timings.
+    QLoggingCategory::setFilterRules("onecad.*.debug=false\nonecad.*.info=false");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Headless regeneration and tessellation benchmark.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("paths", "Optional .onecad packages or v1 history fixture directories.",
+                                 "[PATH...]");
+    const QCommandLineOption iterationsOption("iterations", "Timed runs per scenario.", "n", "5");
+    const QCommandLineOption warmupOption("warmup", "Untimed runs per scenario.", "n", "1");
+    const QCommandLineOption stackOption("stack", "Synthetic stacked extrude+fillet depths.", "list", "4,8,16");
+    const QCommandLineOption bodiesOption("bodies", "Synthetic independent body counts.", "list", "4,16");
+    const QCommandLineOption noSyntheticOption("no-synthetic", "Skip generated histories.");
+    const QCommandLineOption outputOption("output", "Write JSON here instead of stdout.", "file");
+    parser.addOptions({iterationsOption, warmupOption, stackOption, bodiesOption, noSyntheticOption, outputOption});
+    parser.process(app);
+
+    const int iterations = std::max(1, parser.value(iterationsOption).toInt());
+    const int warmup = std::max(0, parser.value(warmupOption).toInt());
+
+    std::vector<BenchCase> cases = loadInputs(parser.positionalArguments());
+    if (!parser.isSet(noSyntheticOption)) {
+        for (int levels : parseCounts(parser.value(stackOption))) {
+            if (auto doc = makeStack(levels)) {
+                cases.push_back({"stack-" + std::to_string(levels), "synthetic", std::move(doc)});
+            } else {
+                std::cerr << "Failed to build synthetic stack-" << levels << "\n";
+            }
+        }
+        for (int bodies : parseCounts(parser.value(bodiesOption))) {
+            if (auto doc = makePattern(bodies)) {
+                cases.push_back({"pattern-" + std::to_string(bodies), "synthetic", std::move(doc)});
+            } else {
+                std::cerr << "Failed to build synthetic pattern-" << bodies << "\n";
+            }
+        }
+    }
+    if (cases.empty()) {
+        std::cerr << "Nothing to benchmark\n";
+        return 1;
+    }
+
+    QJsonArray results;
+    for (auto& bench : cases) {
+        std::cerr << "Running " << bench.name << "...\n";
+        results.append(runCase(bench, warmup, iterations));
+    }
+
+    QJsonObject report;
+    report["benchmark"] = "onecad_bench_regen";
+    report["schemaVersion"] = 1;
+    report["iterations"] = iterations;
+    report["warmup"] = warmup;
+    report["platform"] = QSysInfo::prettyProductName();
+    report["cpuArchitecture"] = QSysInfo::currentCpuArchitecture();
+    report["peakResidentBytes"] = static_cast<double>(peakResidentBytes());
+    report["cases"] = results;
+    const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+
+    if (parser.isSet(outputOption)) {
+        QFile file(parser.value(outputOption));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(json) != json.size()) {
+            std::cerr << "Failed to write " << file.fileName().toStdString() << "\n";
+            return 1;
+        }
+    } else {
+        std::cout << json.toStdString();
+    }
+    return 0;
+}
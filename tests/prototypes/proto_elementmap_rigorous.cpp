@@ -1,5 +1,6 @@
 #include <algorithm>
 #include <cmath>
+#include <limits>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -7,12 +8,15 @@
 // OCCT
 #include <BRepAlgoAPI_Cut.hxx>
 #include <BRepPrimAPI_MakeBox.hxx>
+#include <BRepPrimAPI_MakeCylinder.hxx>
 #include <BRep_Tool.hxx>
 #include <TopExp.hxx>
 #include <TopExp_Explorer.hxx>
 #include <TopoDS.hxx>
 #include <TopoDS_Edge.hxx>
 #include <TopoDS_Face.hxx>
+#include <gp.hxx>
+#include <gp_Ax2.hxx>
 #include <gp_Pnt.hxx>
 
 #include "kernel/elementmap/ElementMap.h"
@@ -218,6 +222,244 @@ void testReverseMapMultiId(TestContext& ctx) {
     ctx.expect(hasA && hasB, "Reverse map should keep multiple IDs for same shape");
 }
 
+TopoDS_Shape makePerforatedPlate(int holesPerSide, double holeRadius) {
+    TopoDS_Shape plate = BRepPrimAPI_MakeBox(gp_Pnt(0.0, 0.0, 0.0), gp_Pnt(100.0, 100.0, 5.0)).Shape();
+    const double pitch = 100.0 / holesPerSide;
+    for (int i = 0; i < holesPerSide; ++i) {
+        for (int j = 0; j < holesPerSide; ++j) {
+            const gp_Ax2 axis(gp_Pnt((i + 0.5) * pitch, (j + 0.5) * pitch, -1.0), gp::DZ());
+            plate = BRepAlgoAPI_Cut(plate, BRepPrimAPI_MakeCylinder(axis, holeRadius, 7.0).Shape()).Shape();
+        }
+    }
+    return plate;
+}
+
+void testIndexedRebindMatchesLinear(TestContext& ctx) {
+    // Enough holes that every kind crosses the index threshold.
+    const TopoDS_Shape before = makePerforatedPlate(6, 2.0);
+    const TopoDS_Shape after = makePerforatedPlate(6, 2.5);
+
+    ElementMap linear;
+    ElementMap indexed;
+    linear.setIndexedRebindThreshold(std::numeric_limits<std::size_t>::max());
+    indexed.setIndexedRebindThreshold(0);
+    for (ElementMap* emap : {&linear, &indexed}) {
+        emap->rebindBody("body", before, "op-plate");
+        emap->rebindBody("body", after, "op-holes");
+    }
+
+    auto linearIds = linear.ids();
+    auto indexedIds = indexed.ids();
+    ctx.expect(linearIds.size() > ElementMap::kIndexedRebindThreshold,
+               "Perforated plate should exceed the index threshold");
+    ctx.expect(linearIds.size() == indexedIds.size(), "Indexed rebind should create the same number of IDs");
+    for (const auto& id : linearIds) {
+        const auto* expected = linear.find(id);
+        const auto* actual = indexed.find(id);
+        ctx.expect(actual != nullptr, "Indexed rebind should assign ID " + id.value);
+        if (!expected || !actual) {
+            continue;
+        }
+        ctx.expect(expected->shape.IsSame(actual->shape), "Indexed rebind should bind the same shape to " + id.value);
+        ctx.expect(expected->opId == actual->opId, "Indexed rebind should keep the same opId for " + id.value);
+    }
+}
+
+void testDescriptorCacheReusesUntouchedFaces(TestContext& ctx) {
+    const TopoDS_Shape box = BRepPrimAPI_MakeBox(10.0, 10.0, 10.0).Shape();
+    // Notch one corner: three faces are cut, the other three pass through unchanged.
+    const TopoDS_Shape notched =
+        BRepAlgoAPI_Cut(box, BRepPrimAPI_MakeBox(gp_Pnt(8.0, 8.0, 8.0), gp_Pnt(12.0, 12.0, 12.0)).Shape()).Shape();
+
+    ElementMap cached;
+    ElementMap uncached;
+    uncached.setDescriptorCacheEnabled(false);
+    for (ElementMap* emap : {&cached, &uncached}) {
+        emap->rebindBody("body", box, "op-box");
+    }
+    cached.resetDescriptorCacheStats();
+    for (ElementMap* emap : {&cached, &uncached}) {
+        emap->rebindBody("body", notched, "op-notch");
+    }
+
+    const auto stats = cached.descriptorCacheStats();
+    ctx.expect(stats.hits > 0, "Rebinding after a boolean should reuse descriptors of untouched faces");
+    ctx.expect(stats.misses > 0, "Faces created by the boolean should be measured");
+    ctx.expect(uncached.descriptorCacheStats().size == 0, "Disabled cache should stay empty");
+
+    for (const auto& id : uncached.ids()) {
+        const auto* expected = uncached.find(id);
+        const auto* actual = cached.find(id);
+        ctx.expect(actual != nullptr, "Cached map should assign ID " + id.value);
+        if (!expected || !actual) {
+            continue;
+        }
+        ctx.expect(expected->descriptor.center.IsEqual(actual->descriptor.center, 0.0) &&
+                       expected->descriptor.size == actual->descriptor.size &&
+                       expected->descriptor.magnitude == actual->descriptor.magnitude &&
+                       expected->descriptor.adjacencyHash == actual->descriptor.adjacencyHash,
+                   "Cached descriptor should equal a fresh measurement for " + id.value);
+    }
+}
+
+void testParallelUpdateMatchesSerial(TestContext& ctx) {
+    const TopoDS_Shape plate = makePerforatedPlate(8, 2.0);
+    // A slab through a row of holes splits faces and edges and generates new ones.
+    BRepAlgoAPI_Cut cut(plate, BRepPrimAPI_MakeBox(gp_Pnt(40.0, -1.0, 2.0), gp_Pnt(60.0, 101.0, 6.0)).Shape());
+    ctx.expect(cut.IsDone(), "Slab cut should succeed");
+
+    ElementMap serial;
+    ElementMap parallel;
+    serial.setUpdateThreads(1);
+    parallel.setUpdateThreads(4);
+    std::vector<ElementId> deleted[2];
+    ElementMap* maps[2] = {&serial, &parallel};
+    for (int i = 0; i < 2; ++i) {
+        maps[i]->rebindBody("body", plate, "op-plate");
+        deleted[i] = maps[i]->update(cut, "op-slab");
+    }
+
+    ctx.expect(serial.ids().size() > ElementMap::kParallelUpdateMinEntries,
+               "Perforated plate should exceed the parallel update threshold");
+    ctx.expect(deleted[0].size() == deleted[1].size(), "Parallel update should delete the same IDs");
+    ctx.expect(serial.ids().size() == parallel.ids().size(), "Parallel update should create the same IDs");
+    for (const auto& id : serial.ids()) {
+        const auto* expected = serial.find(id);
+        const auto* actual = parallel.find(id);
+        ctx.expect(actual != nullptr, "Parallel update should produce ID " + id.value);
+        if (!expected || !actual) {
+            continue;
+        }
+        ctx.expect(expected->shape.IsSame(actual->shape), "Parallel update should bind the same shape to " + id.value);
+        ctx.expect(expected->opId == actual->opId, "Parallel update should keep the same opId for " + id.value);
+        ctx.expect(expected->sources.size() == actual->sources.size(),
+                   "Parallel update should record the same sources for " + id.value);
+    }
+}
+
+void testBinaryRoundTrip(TestContext& ctx) {
+    const TopoDS_Shape plate = makePerforatedPlate(4, 2.0);
+    BRepAlgoAPI_Cut cut(plate, BRepPrimAPI_MakeBox(gp_Pnt(40.0, -1.0, 2.0), gp_Pnt(60.0, 101.0, 6.0)).Shape());
+    ctx.expect(cut.IsDone(), "Slab cut should succeed");
+
+    ElementMap emap;
+    emap.rebindBody("body", plate, "op-plate");
+    emap.update(cut, "op-slab");
+
+    const std::string image = emap.toBinary();
+    onecad::kernel::elementmap::format::ElementMapView view;
+    ctx.expect(view.open(image.data(), image.size()), "v2 image should open in place");
+    ctx.expect(view.entryCount() == emap.ids().size(), "v2 image should hold every entry");
+    const auto* section = view.findBody("body");
+    ctx.expect(section != nullptr && section->entryCount == emap.bodyEntries("body").size(),
+               "Body section should cover the body's entries");
+    ctx.expect(view.findBody("missing") == nullptr, "Unknown body should have no section");
+
+    ElementMap fromBinary;
+    ElementMap fromText;
+    ElementMap fromImageString;
+    ctx.expect(fromBinary.fromBinary(image.data(), image.size()), "v2 image should load");
+    ctx.expect(fromText.fromString(emap.toString()), "v1 text should still load");
+    ctx.expect(fromImageString.fromString(image), "fromString() should accept a v2 image");
+    ctx.expect(!ElementMap().fromBinary(image.data(), image.size() - 8), "Truncated v2 image should be rejected");
+
+    for (const ElementMap* restored : {&fromBinary, &fromImageString}) {
+        ctx.expect(restored->ids().size() == fromText.ids().size(), "v2 and v1 should restore the same IDs");
+        for (const auto& id : fromText.ids()) {
+            const auto* expected = fromText.find(id);
+            const auto* actual = restored->find(id);
+            ctx.expect(actual != nullptr, "v2 image should restore ID " + id.value);
+            if (!expected || !actual) {
+                continue;
+            }
+            bool sameSources = expected->sources.size() == actual->sources.size();
+            for (std::size_t i = 0; sameSources && i < expected->sources.size(); ++i) {
+                sameSources = expected->sources[i].value == actual->sources[i].value;
+            }
+            const auto& a = expected->descriptor;
+            const auto& b = actual->descriptor;
+            ctx.expect(expected->kind == actual->kind && expected->opId == actual->opId && sameSources,
+                       "v2 image should restore kind, opId and sources of " + id.value);
+            ctx.expect(a.shapeType == b.shapeType && a.surfaceType == b.surfaceType && a.curveType == b.curveType &&
+                           nearlyEqual(a.center.Distance(b.center), 0.0) && nearlyEqual(a.size, b.size) &&
+                           nearlyEqual(a.magnitude, b.magnitude) && a.hasNormal == b.hasNormal &&
+                           a.hasTangent == b.hasTangent && a.adjacencyHash == b.adjacencyHash,
+                       "v2 image should restore the descriptor of " + id.value);
+        }
+    }
+}
+
+void testElementHandles(TestContext& ctx) {
+    using onecad::kernel::elementmap::elementIdString;
+    using onecad::kernel::elementmap::findElementHandle;
+    using onecad::kernel::elementmap::internElementId;
+
+    const TopoDS_Shape box = BRepPrimAPI_MakeBox(10.0, 10.0, 10.0).Shape();
+    const TopoDS_Face topFace = findTopFace(box);
+    ElementMap emap;
+    emap.registerElement(ElementId{"body-handles/face-top"}, ElementKind::Face, topFace, "op-box");
+
+    const auto handle = emap.findHandleByShape(topFace);
+    ctx.expect(handle.valid(), "Bound shape should have a handle");
+    ctx.expect(handle == internElementId("body-handles/face-top"), "Interning the same ID should return the same handle");
+    ctx.expect(elementIdString(handle) == "body-handles/face-top", "Handle should resolve to its ID");
+    ctx.expect(!findElementHandle("body-handles/never-interned").valid(), "Unknown ID should have no handle");
+    ctx.expect(!emap.findHandleByShape(BRepPrimAPI_MakeBox(1.0, 1.0, 1.0).Shape()).valid(),
+               "Unbound shape should have no handle");
+    ctx.expect(elementIdString({}).empty(), "Invalid handle should resolve to an empty ID");
+}
+
+std::vector<std::string> scanBodyIds(const ElementMap& emap, const std::string& bodyId) {
+    std::vector<std::string> out;
+    for (const auto& id : emap.ids()) {
+        if (id.value == bodyId || startsWith(id.value, bodyId + "/")) {
+            out.push_back(id.value);
+        }
+    }
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+std::vector<std::string> indexedBodyIds(const ElementMap& emap, const std::string& bodyId) {
+    std::vector<std::string> out;
+    for (const auto& entry : emap.bodyEntries(bodyId)) {
+        out.push_back(entry.id.value);
+    }
+    return out;
+}
+
+void testBodyIndexTracksEntries(TestContext& ctx) {
+    const TopoDS_Shape plate = makePerforatedPlate(3, 2.0);
+    BRepAlgoAPI_Cut cut(plate, BRepPrimAPI_MakeBox(gp_Pnt(40.0, -1.0, 2.0), gp_Pnt(60.0, 101.0, 6.0)).Shape());
+    ctx.expect(cut.IsDone(), "Slab cut should succeed");
+
+    ElementMap emap;
+    emap.rebindBody("plate", plate, "op-plate");
+    emap.rebindBody("box", BRepPrimAPI_MakeBox(5.0, 5.0, 5.0).Shape(), "op-box");
+    emap.update(cut, "op-slab");
+    for (const std::string bodyId : {"plate", "box"}) {
+        ctx.expect(!indexedBodyIds(emap, bodyId).empty(), "Body " + bodyId + " should have indexed entries");
+        ctx.expect(indexedBodyIds(emap, bodyId) == scanBodyIds(emap, bodyId),
+                   "Body index should match a scan after update() for " + bodyId);
+    }
+
+    // A copy cannot share the index and rebuilds its own.
+    ElementMap copy = emap;
+    ctx.expect(indexedBodyIds(copy, "plate") == scanBodyIds(emap, "plate"), "Copied map should index the same entries");
+
+    const std::size_t boxCount = scanBodyIds(emap, "box").size();
+    emap.removeElementsForBody("plate");
+    ctx.expect(scanBodyIds(emap, "plate").empty() && indexedBodyIds(emap, "plate").empty(),
+               "Removing a body should drop all of its entries");
+    ctx.expect(scanBodyIds(emap, "box").size() == boxCount && indexedBodyIds(emap, "box").size() == boxCount,
+               "Removing a body should keep the other body's entries");
+    ctx.expect(indexedBodyIds(copy, "plate").size() == scanBodyIds(copy, "plate").size(),
+               "Removing from the original should not touch the copy");
+
+    emap.restoreBodyEntries("plate", copy.bodyEntries("plate"));
+    ctx.expect(indexedBodyIds(emap, "plate") == scanBodyIds(copy, "plate"), "Restored body should be indexed again");
+}
+
 } // namespace
 
 int main() {
@@ -229,6 +471,12 @@ int main() {
     testDeterministicIds(ctx);
     testSerializationRoundTrip(ctx);
     testReverseMapMultiId(ctx);
+    testIndexedRebindMatchesLinear(ctx);
+    testDescriptorCacheReusesUntouchedFaces(ctx);
+    testParallelUpdateMatchesSerial(ctx);
+    testBinaryRoundTrip(ctx);
+    testElementHandles(ctx);
+    testBodyIndexTracksEntries(ctx);
 
     if (ctx.failures > 0) {
         std::cerr << "Tests failed: " << ctx.failures << std::endl;
@@ -7,6 +7,7 @@
 
 using onecad::ui::selection::ModelPickerAdapter;
 using onecad::app::selection::SelectionKind;
+using onecad::kernel::elementmap::internElementId;
 
 namespace {
 bool hasKind(const onecad::app::selection::PickResult& result, SelectionKind kind) {
@@ -24,16 +25,14 @@ int main() {
 
     ModelPickerAdapter::Mesh mesh;
     mesh.bodyId = "body0";
-    mesh.vertices = {
-        {-0.5f, -0.5f, 0.0f},
-        {0.5f, -0.5f, 0.0f},
-        {0.5f, 0.5f, 0.0f},
-        {-0.5f, 0.5f, 0.0f}
-    };
-    mesh.triangles = {
-        {0, 1, 2, "face0"},
-        {0, 2, 3, "face0"}
+    mesh.positions = {
+        -0.5f, -0.5f, 0.0f,
+        0.5f, -0.5f, 0.0f,
+        0.5f, 0.5f, 0.0f,
+        -0.5f, 0.5f, 0.0f
     };
+    mesh.indices = {0, 1, 2, 0, 2, 3};
+    mesh.faces = {{internElementId("face0"), 0, 6}};
     picker.setMeshes({mesh});
 
     QMatrix4x4 viewProjection;
@@ -73,16 +72,14 @@ int main() {
 
     ModelPickerAdapter::Mesh meshBack;
     meshBack.bodyId = "body1";
-    meshBack.vertices = {
-        {-0.5f, -0.5f, 0.6f},
-        {0.5f, -0.5f, 0.6f},
-        {0.5f, 0.5f, 0.6f},
-        {-0.5f, 0.5f, 0.6f}
-    };
-    meshBack.triangles = {
-        {0, 1, 2, "face1"},
-        {0, 2, 3, "face1"}
+    meshBack.positions = {
+        -0.5f, -0.5f, 0.6f,
+        0.5f, -0.5f, 0.6f,
+        0.5f, 0.5f, 0.6f,
+        -0.5f, 0.5f, 0.6f
     };
+    meshBack.indices = {0, 1, 2, 0, 2, 3};
+    meshBack.faces = {{internElementId("face1"), 0, 6}};
     picker.setMeshes({mesh, meshBack});
 
     auto overlapPick = picker.pick(QPoint(50, 50), tolerance, viewProjection, viewportSize);
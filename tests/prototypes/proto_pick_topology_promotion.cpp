@@ -28,15 +28,10 @@ int main(int argc, char** argv) {
     onecad::ui::selection::ModelPickerAdapter picker;
     onecad::ui::selection::ModelPickerAdapter::Mesh pickMesh;
     pickMesh.bodyId = mesh->bodyId;
-    pickMesh.vertices = mesh->vertices;
-    pickMesh.triangles.reserve(mesh->triangles.size());
-    for (const auto& tri : mesh->triangles) {
-        onecad::ui::selection::ModelPickerAdapter::Triangle t;
-        t.i0 = tri.i0;
-        t.i1 = tri.i1;
-        t.i2 = tri.i2;
-        t.faceId = tri.faceId;
-        pickMesh.triangles.push_back(t);
+    pickMesh.positions = mesh->positions;
+    pickMesh.indices = mesh->indices;
+    for (const auto& range : mesh->faces) {
+        pickMesh.faces.push_back({range.faceId, range.firstIndex, range.indexCount});
     }
     for (const auto& [faceId, topo] : mesh->topologyByFace) {
         onecad::ui::selection::ModelPickerAdapter::FaceTopology faceTopo;
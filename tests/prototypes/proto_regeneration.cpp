@@ -7,10 +7,34 @@
  * 2. Chain: extrude→fillet→regen→verify
  * 3. Failure: delete sketch→regen→verify failure reported
  * 4. Topology: extrude→fillet by ElementMap ID→modify extrude→regen→verify
+ * 5. Incremental: edit/suppress one of two independent extrudes→verify only it
+ *    replays and the result matches a full replay
+ * 6. Checkpoints: remove/re-add an op→verify its cached result is reused
+ * 7. Rollback: scrub the applied cursor→verify prefix snapshots are restored
+ * 8. Parallel: independent bodies built concurrently→verify serial-identical result
+ * 9. Preview lane: rapid previews for one tool→verify only the latest is delivered
+ * 10. Cancellation: cancel mid-run→verify the document is left unchanged
+ * 11. Async: queue regens off the UI thread→verify only the latest snapshot is applied
+ * 12. Profiling: regenerate→verify per-op costs and the Chrome trace export
+ * 13. Graph: long chains and incremental add/remove→verify queries and relinking
+ * 14. Element-level: edit an op that leaves a referenced face untouched→verify
+ *     the face's reader is not replayed
+ * 15. Preview layer: preview then discard/commit a param edit→verify only the
+ *     touched body is saved and restored
+ * 16. Background meshing: regenerate while bodies tessellate→verify the document's
+ *     shapes never receive a triangulation
+ * 17. Stale cancels: cancel finished and queued regen jobs→verify no id is kept
  */
 
+#include "app/commands/RollbackCommand.h"
 #include "app/document/Document.h"
+#include "app/history/AsyncRegenerator.h"
 #include "app/history/DependencyGraph.h"
+#include "app/history/KernelScheduler.h"
+#include "app/history/OperationCheckpointCache.h"
+#include "app/history/PrefixSnapshotCache.h"
+#include "app/history/RegenProfile.h"
+#include "app/history/RegenProgress.h"
 #include "app/history/RegenerationEngine.h"
 #include "app/selection/SelectionManager.h"
 #include "core/loop/LoopDetector.h"
@@ -19,19 +43,33 @@
 #include "io/HistoryIO.h"
 
 #include <BRepCheck_Analyzer.hxx>
+#include <BRep_Tool.hxx>
 #include <BRepGProp.hxx>
 #include <BRepPrimAPI_MakeBox.hxx>
 #include <GProp_GProps.hxx>
+#include <Poly_Triangulation.hxx>
+#include <TopLoc_Location.hxx>
 #include <TopExp_Explorer.hxx>
 #include <TopoDS.hxx>
 
 #include <QCoreApplication>
+#include <QEventLoop>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QUuid>
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cmath>
+#include <cstdint>
+#include <future>
 #include <iostream>
+#include <memory>
 #include <optional>
+#include <string>
 #include <utility>
 
 using namespace onecad;
@@ -95,6 +133,30 @@ findTopPlanarFace(const app::Document& doc, const std::string& bodyId) {
     return best;
 }
 
+std::string addRectangleSketch(app::Document& doc, double x0, double y0, double size) {
+    auto sketch = std::make_unique<core::sketch::Sketch>();
+    auto p1 = sketch->addPoint(x0, y0);
+    auto p2 = sketch->addPoint(x0 + size, y0);
+    auto p3 = sketch->addPoint(x0 + size, y0 + size);
+    auto p4 = sketch->addPoint(x0, y0 + size);
+    sketch->addLine(p1, p2);
+    sketch->addLine(p2, p3);
+    sketch->addLine(p3, p4);
+    sketch->addLine(p4, p1);
+    return doc.addSketch(std::move(sketch));
+}
+
+app::OperationRecord makeNewBodyExtrude(app::Document& doc, const std::string& sketchId,
+                                        double distance) {
+    app::OperationRecord op;
+    op.opId = newId();
+    op.type = app::OperationType::Extrude;
+    op.input = app::SketchRegionRef{sketchId, firstRegionId(*doc.getSketch(sketchId))};
+    op.params = app::ExtrudeParams{distance, 0.0, app::BooleanMode::NewBody};
+    op.resultBodyIds.push_back(newId());
+    return op;
+}
+
 } // namespace
 
 void testSingleExtrude() {
@@ -830,6 +892,815 @@ void testProjectedReferenceGeometryIsLocked() {
     std::cout << " PASS\n";
 }
 
+void testIncrementalRegeneration() {
+    std::cout << "Test 18: Incremental regeneration replays only dirty ops..." << std::flush;
+
+    app::Document doc;
+    const std::string sketchA = addRectangleSketch(doc, 0.0, 0.0, 10.0);
+    const std::string sketchB = addRectangleSketch(doc, 50.0, 0.0, 10.0);
+    app::OperationRecord opA = makeNewBodyExtrude(doc, sketchA, 10.0);
+    app::OperationRecord opB = makeNewBodyExtrude(doc, sketchB, 5.0);
+    doc.addOperation(opA);
+    doc.addOperation(opB);
+
+    {
+        app::history::RegenerationEngine engine(&doc);
+        auto result = engine.regenerateIncremental(doc.appliedOpCount(), {opA.opId});
+        assert(result.status == app::history::RegenStatus::Success);
+        assert(!engine.lastRunWasIncremental());  // Cache not primed yet
+        assert(engine.lastReplayedOpCount() == 2);
+    }
+
+    const std::string bodyA = opA.resultBodyIds.front();
+    const std::string bodyB = opB.resultBodyIds.front();
+    const TopoDS_Shape untouchedB = *doc.getBodyShape(bodyB);
+
+    // Re-parameterize A: only A replays, B keeps its exact shape.
+    assert(doc.updateOperationParams(opA.opId, app::ExtrudeParams{30.0, 0.0, app::BooleanMode::NewBody}));
+    {
+        app::history::RegenerationEngine engine(&doc);
+        engine.setVerifyIncremental(true);
+        auto result = engine.regenerateIncremental(doc.appliedOpCount(), {opA.opId});
+        assert(result.status == app::history::RegenStatus::Success);
+        assert(engine.lastRunWasIncremental());
+        assert(engine.lastReplayedOpCount() == 1);
+        assert(result.succeededOps.size() == 2);
+        assert(engine.lastVerification().performed);
+        assert(engine.lastVerification().matches);
+    }
+    assert(nearlyEqual(shapeVolume(*doc.getBodyShape(bodyA)), 3000.0));
+    assert(nearlyEqual(shapeVolume(*doc.getBodyShape(bodyB)), 500.0));
+
+    // Suppress B incrementally: its body disappears, A is untouched.
+    const TopoDS_Shape shapeA = *doc.getBodyShape(bodyA);
+    assert(doc.setOperationSuppressed(opB.opId, true));
+    {
+        app::history::RegenerationEngine engine(&doc);
+        auto result = engine.regenerateIncremental(doc.appliedOpCount(), {opB.opId});
+        assert(result.status == app::history::RegenStatus::Success);
+        assert(engine.lastRunWasIncremental());
+        assert(engine.lastReplayedOpCount() == 1);
+        assert(result.skippedOps.size() == 1 && result.skippedOps[0] == opB.opId);
+    }
+    assert(doc.getBodyShape(bodyB) == nullptr);
+    assert(doc.getBodyShape(bodyA)->IsEqual(shapeA));
+
+    // Unsuppress B; a body edited outside regeneration forces a full replay.
+    assert(doc.setOperationSuppressed(opB.opId, false));
+    {
+        app::history::RegenerationEngine engine(&doc);
+        auto result = engine.regenerateIncremental(doc.appliedOpCount(), {opB.opId});
+        assert(result.status == app::history::RegenStatus::Success);
+        assert(engine.lastRunWasIncremental());
+    }
+    assert(nearlyEqual(shapeVolume(*doc.getBodyShape(bodyB)), 500.0));
+    assert(doc.updateBodyShape(bodyB, untouchedB));
+    {
+        app::history::RegenerationEngine engine(&doc);
+        engine.regenerateIncremental(doc.appliedOpCount(), {opA.opId});
+        assert(!engine.lastRunWasIncremental());
+    }
+
+    std::cout << " PASS\n";
+}
+
+void testOperationCheckpointCache() {
+    std::cout << "Test 19: Checkpoint cache reuses results for repeated op inputs..." << std::flush;
+
+    app::Document doc;
+    const std::string sketchA = addRectangleSketch(doc, 0.0, 0.0, 10.0);
+    const std::string sketchB = addRectangleSketch(doc, 50.0, 0.0, 10.0);
+    app::OperationRecord opA = makeNewBodyExtrude(doc, sketchA, 10.0);
+    app::OperationRecord opB = makeNewBodyExtrude(doc, sketchB, 5.0);
+    doc.addOperation(opA);
+    doc.addOperation(opB);
+
+    auto& checkpoints = doc.checkpointCache();
+    checkpoints.resetStats();
+    {
+        app::history::RegenerationEngine engine(&doc);
+        assert(engine.regenerateAll().status == app::history::RegenStatus::Success);
+    }
+    assert(checkpoints.stats().hits == 0);
+    assert(checkpoints.stats().insertions == 2);
+
+    const std::string bodyB = opB.resultBodyIds.front();
+    const TopoDS_Shape firstB = *doc.getBodyShape(bodyB);
+    std::vector<std::string> firstIdsB;
+    for (const auto& entry : doc.elementMap().bodyEntries(bodyB)) {
+        firstIdsB.push_back(entry.id.value);
+    }
+
+    // Undo/redo of B: the re-added op sees the same inputs and reuses its result.
+    assert(doc.removeOperation(opB.opId));
+    {
+        app::history::RegenerationEngine engine(&doc);
+        assert(engine.regenerateAll().status == app::history::RegenStatus::Success);
+    }
+    assert(doc.getBodyShape(bodyB) == nullptr);
+    doc.addOperation(opB);
+    const std::size_t hitsBefore = checkpoints.stats().hits;
+    {
+        app::history::RegenerationEngine engine(&doc);
+        assert(engine.regenerateAll().status == app::history::RegenStatus::Success);
+    }
+    assert(checkpoints.stats().hits > hitsBefore);
+    assert(doc.getBodyShape(bodyB)->IsEqual(firstB));
+    std::vector<std::string> replayedIdsB;
+    for (const auto& entry : doc.elementMap().bodyEntries(bodyB)) {
+        replayedIdsB.push_back(entry.id.value);
+    }
+    assert(replayedIdsB == firstIdsB);
+    assert(nearlyEqual(shapeVolume(*doc.getBodyShape(bodyB)), 500.0));
+
+    // Changed params miss and replay for real.
+    assert(doc.updateOperationParams(opB.opId, app::ExtrudeParams{8.0, 0.0, app::BooleanMode::NewBody}));
+    {
+        app::history::RegenerationEngine engine(&doc);
+        assert(engine.regenerateAll().status == app::history::RegenStatus::Success);
+    }
+    assert(nearlyEqual(shapeVolume(*doc.getBodyShape(bodyB)), 800.0));
+
+    // Shrinking the budget evicts least recently used checkpoints; 0 disables caching.
+    assert(checkpoints.stats().entryCount > 0);
+    checkpoints.setMemoryBudget(1);
+    assert(checkpoints.stats().entryCount == 0);
+    assert(checkpoints.stats().evictions > 0);
+    checkpoints.setMemoryBudget(0);
+    const std::size_t insertionsBefore = checkpoints.stats().insertions;
+    {
+        app::history::RegenerationEngine engine(&doc);
+        assert(engine.regenerateAll().status == app::history::RegenStatus::Success);
+    }
+    assert(checkpoints.stats().insertions == insertionsBefore);
+
+    std::cout << " PASS\n";
+}
+
+void testRollbackPrefixSnapshots() {
+    std::cout << "Test 20: Rollback restores the nearest prefix snapshot..." << std::flush;
+
+    app::Document doc;
+    doc.prefixSnapshots().setInterval(2);
+    std::vector<app::OperationRecord> ops;
+    for (int i = 0; i < 5; ++i) {
+        const std::string sketchId = addRectangleSketch(doc, 20.0 * i, 0.0, 10.0);
+        ops.push_back(makeNewBodyExtrude(doc, sketchId, 1.0 + i));
+        doc.addOperation(ops.back());
+    }
+
+    {
+        app::history::RegenerationEngine engine(&doc);
+        assert(engine.regenerateAll().status == app::history::RegenStatus::Success);
+        assert(engine.lastRestoredOpCount() == 0);
+        assert(engine.lastReplayedOpCount() == 5);
+    }
+
+    // Rolling back to the third op resumes from the grid snapshot after two ops.
+    app::commands::RollbackCommand rollback(&doc, ops[2].opId);
+    assert(rollback.execute());
+    assert(doc.appliedOpCount() == 3);
+    assert(doc.bodyCount() == 3);
+    assert(nearlyEqual(shapeVolume(*doc.getBodyShape(ops[2].resultBodyIds.front())), 300.0));
+
+    // The rollback position itself is now a snapshot.
+    {
+        app::history::RegenerationEngine engine(&doc);
+        auto result = engine.regenerateToAppliedCount(doc.appliedOpCount());
+        assert(result.status == app::history::RegenStatus::Success);
+        assert(result.succeededOps.size() == 3);
+        assert(engine.lastRestoredOpCount() == 3);
+        assert(engine.lastReplayedOpCount() == 0);
+    }
+
+    // Undo brings back the end-of-history snapshot, including removed bodies.
+    assert(rollback.undo());
+    assert(doc.appliedOpCount() == 5);
+    assert(doc.bodyCount() == 5);
+    assert(nearlyEqual(shapeVolume(*doc.getBodyShape(ops[4].resultBodyIds.front())), 500.0));
+
+    // Editing an early op invalidates every snapshot past it.
+    assert(doc.updateOperationParams(ops[1].opId, app::ExtrudeParams{4.0, 0.0, app::BooleanMode::NewBody}));
+    {
+        app::history::RegenerationEngine engine(&doc);
+        assert(engine.regenerateAll().status == app::history::RegenStatus::Success);
+        assert(engine.lastRestoredOpCount() == 0);
+        assert(engine.lastReplayedOpCount() == 5);
+    }
+    assert(nearlyEqual(shapeVolume(*doc.getBodyShape(ops[1].resultBodyIds.front())), 400.0));
+
+    std::cout << " PASS\n";
+}
+
+void testParallelBranchRegeneration() {
+    std::cout << "Test 21: Parallel branches regenerate like a serial replay..." << std::flush;
+
+    // Three independent bodies, each a base extrude plus an overlapping Add boss.
+    auto buildDocument = [](app::Document& doc) {
+        doc.checkpointCache().setMemoryBudget(0);
+        doc.prefixSnapshots().setInterval(0);
+        std::vector<app::OperationRecord> bosses;
+        for (int b = 0; b < 3; ++b) {
+            const std::string bodyId = "body-" + std::to_string(b);
+            const std::string baseSketch = addRectangleSketch(doc, 40.0 * b, 0.0, 10.0);
+            app::OperationRecord base = makeNewBodyExtrude(doc, baseSketch, 5.0);
+            base.opId = "base-" + std::to_string(b);
+            base.resultBodyIds = {bodyId};
+            doc.addOperation(base);
+
+            const std::string bossSketch = addRectangleSketch(doc, 40.0 * b + 5.0, 0.0, 10.0);
+            app::OperationRecord boss = makeNewBodyExtrude(doc, bossSketch, 10.0);
+            boss.opId = "boss-" + std::to_string(b);
+            boss.params = app::ExtrudeParams{10.0, 0.0, app::BooleanMode::Add, bodyId};
+            boss.resultBodyIds = {bodyId};
+            bosses.push_back(boss);
+        }
+        for (const auto& boss : bosses) {
+            doc.addOperation(boss);
+        }
+    };
+    auto elementIds = [](const app::Document& doc, const std::string& bodyId) {
+        std::vector<std::string> ids;
+        for (const auto& entry : doc.elementMap().bodyEntries(bodyId)) {
+            ids.push_back(entry.id.value);
+        }
+        return ids;
+    };
+
+    app::Document serialDoc;
+    app::Document parallelDoc;
+    buildDocument(serialDoc);
+    buildDocument(parallelDoc);
+    {
+        app::history::RegenerationEngine engine(&serialDoc);
+        engine.setMaxParallelOps(1);
+        assert(engine.regenerateAll().status == app::history::RegenStatus::Success);
+    }
+    {
+        app::history::RegenerationEngine engine(&parallelDoc);
+        engine.setMaxParallelOps(4);
+        auto result = engine.regenerateAll();
+        assert(result.status == app::history::RegenStatus::Success);
+        assert(result.succeededOps.size() == 6);
+        assert(result.succeededOps.front() == "base-0");
+        assert(result.succeededOps.back() == "boss-2");
+    }
+
+    for (int b = 0; b < 3; ++b) {
+        const std::string bodyId = "body-" + std::to_string(b);
+        const TopoDS_Shape* serialShape = serialDoc.getBodyShape(bodyId);
+        const TopoDS_Shape* parallelShape = parallelDoc.getBodyShape(bodyId);
+        assert(serialShape && parallelShape);
+        assert(shapeValid(*parallelShape));
+        assert(nearlyEqual(shapeVolume(*serialShape), 1250.0));
+        assert(nearlyEqual(shapeVolume(*parallelShape), 1250.0));
+        assert(elementIds(serialDoc, bodyId) == elementIds(parallelDoc, bodyId));
+    }
+
+    std::cout << " PASS\n";
+}
+
+void testPreviewLaneLatestWins() {
+    std::cout << "Test 22: Preview lane coalesces superseded tool previews..." << std::flush;
+
+    app::history::KernelScheduler scheduler;
+    std::promise<void> started;
+    std::promise<void> gate;
+    std::shared_future<void> gateFuture = gate.get_future().share();
+    std::atomic<int> deliveries{0};
+    std::promise<std::shared_ptr<const app::history::PreviewSnapshot>> delivered;
+
+    auto onReady = [&](std::shared_ptr<const app::history::PreviewSnapshot> snapshot) {
+        if (deliveries.fetch_add(1) == 0) {
+            delivered.set_value(std::move(snapshot));
+        }
+    };
+
+    // The first build blocks the lane while newer requests for the same tool arrive.
+    const app::history::JobId first = scheduler.submitPreview(
+        {"extrude", [&]() {
+             started.set_value();
+             gateFuture.wait();
+             return BRepPrimAPI_MakeBox(1.0, 1.0, 1.0).Shape();
+         }},
+        onReady);
+    assert(first != 0);
+    started.get_future().wait();
+
+    app::history::JobId last = 0;
+    for (int i = 2; i <= 4; ++i) {
+        const double size = static_cast<double>(i);
+        last = scheduler.submitPreview(
+            {"extrude", [size]() { return BRepPrimAPI_MakeBox(size, size, size).Shape(); }}, onReady);
+    }
+    assert(scheduler.supersededPreviewCount() == 2);  // Queued requests 2 and 3 dropped
+    gate.set_value();
+
+    auto resultFuture = delivered.get_future();
+    assert(resultFuture.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+    auto snapshot = resultFuture.get();
+    assert(snapshot->id == last);
+    assert(snapshot->toolKey == "extrude");
+    assert(nearlyEqual(shapeVolume(snapshot->shape), 64.0));
+
+    scheduler.shutdown();
+    assert(deliveries.load() == 1);
+    assert(scheduler.supersededPreviewCount() == 3);  // Running request 1 discarded
+
+    std::cout << " PASS\n";
+}
+
+void testCancelledRegenerationRestoresDocument() {
+    std::cout << "Test 23: Cancelled regeneration leaves the document unchanged..." << std::flush;
+
+    app::Document doc;
+    doc.checkpointCache().setMemoryBudget(0);
+    doc.prefixSnapshots().setInterval(0);
+    std::vector<app::OperationRecord> ops;
+    for (int i = 0; i < 3; ++i) {
+        const std::string sketchId = addRectangleSketch(doc, 20.0 * i, 0.0, 10.0);
+        ops.push_back(makeNewBodyExtrude(doc, sketchId, 1.0));
+        doc.addOperation(ops.back());
+    }
+    {
+        app::history::RegenerationEngine engine(&doc);
+        assert(engine.regenerateAll().status == app::history::RegenStatus::Success);
+    }
+    const std::string bodyId = ops[0].resultBodyIds.front();
+    const TopoDS_Shape before = *doc.getBodyShape(bodyId);
+    const auto elementsBefore = doc.elementMap().bodyEntries(bodyId);
+
+    // Cancel as soon as the first op has reported progress.
+    assert(doc.updateOperationParams(ops[0].opId, app::ExtrudeParams{7.0, 0.0, app::BooleanMode::NewBody}));
+    auto token = std::make_shared<app::history::CancellationToken>();
+    int reports = 0;
+    {
+        app::history::RegenerationEngine engine(&doc);
+        engine.setMaxParallelOps(1);
+        engine.setCancellationToken(token);
+        engine.setProgressCallback([&](int current, int total, const std::string&) {
+            assert(total == app::history::RegenProgressIndicator::kScale);
+            assert(current >= 0 && current <= total);
+            ++reports;
+            if (current > 0) {
+                token->cancel();
+            }
+        });
+        auto result = engine.regenerateToAppliedCount(doc.appliedOpCount());
+        assert(result.status == app::history::RegenStatus::Cancelled);
+    }
+    assert(reports > 0);
+    assert(doc.bodyCount() == 3);
+    assert(doc.getBodyShape(bodyId)->IsEqual(before));
+    assert(nearlyEqual(shapeVolume(*doc.getBodyShape(bodyId)), 100.0));
+    const auto elementsAfter = doc.elementMap().bodyEntries(bodyId);
+    assert(elementsAfter.size() == elementsBefore.size());
+    for (std::size_t i = 0; i < elementsBefore.size(); ++i) {
+        assert(elementsAfter[i].id.value == elementsBefore[i].id.value);
+    }
+
+    // A pre-cancelled token stops before the first op; a fresh run completes.
+    {
+        app::history::RegenerationEngine engine(&doc);
+        engine.setCancellationToken(token);
+        auto result = engine.regenerateToAppliedCount(doc.appliedOpCount());
+        assert(result.status == app::history::RegenStatus::Cancelled);
+        assert(doc.getBodyShape(bodyId)->IsEqual(before));
+    }
+    {
+        app::history::RegenerationEngine engine(&doc);
+        engine.setCancellationToken(std::make_shared<app::history::CancellationToken>());
+        assert(engine.regenerateToAppliedCount(doc.appliedOpCount()).status ==
+               app::history::RegenStatus::Success);
+    }
+    assert(nearlyEqual(shapeVolume(*doc.getBodyShape(bodyId)), 700.0));
+
+    std::cout << " PASS\n";
+}
+
+void testAsyncRegenerationSnapshots() {
+    std::cout << "Test 24: Async regeneration publishes the latest snapshot..." << std::flush;
+
+    app::Document doc;
+    std::vector<app::OperationRecord> ops;
+    for (int i = 0; i < 2; ++i) {
+        const std::string sketchId = addRectangleSketch(doc, 20.0 * i, 0.0, 10.0);
+        ops.push_back(makeNewBodyExtrude(doc, sketchId, 1.0));
+        doc.addOperation(ops.back());
+    }
+    {
+        app::history::RegenerationEngine engine(&doc);
+        assert(engine.regenerateAll().status == app::history::RegenStatus::Success);
+    }
+    const std::string bodyId = ops[0].resultBodyIds.front();
+    const std::string otherBodyId = ops[1].resultBodyIds.front();
+    const TopoDS_Shape otherBefore = *doc.getBodyShape(otherBodyId);
+
+    app::history::AsyncRegenerator regenerator(&doc);
+    assert(doc.asyncRegenerator() == &regenerator);
+    int published = 0;
+    QObject::connect(&regenerator, &app::history::AsyncRegenerator::snapshotPublished,
+                     [&published](quint64) { ++published; });
+    int progressReports = 0;
+    int lastPermille = -1;
+    QObject::connect(&regenerator, &app::history::AsyncRegenerator::regenerationProgress,
+                     [&](quint64, int permille) {
+                         assert(permille >= 0 && permille <= app::history::RegenProgressIndicator::kScale);
+                         ++progressReports;
+                         lastPermille = permille;
+                     });
+    auto waitForIdle = [&regenerator]() {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+        while (regenerator.isRegenerating() && std::chrono::steady_clock::now() < deadline) {
+            QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+        }
+        return !regenerator.isRegenerating();
+    };
+
+    // The edit is committed at once; the document keeps the last valid model until publish.
+    assert(doc.updateOperationParams(ops[0].opId, app::ExtrudeParams{3.0, 0.0, app::BooleanMode::NewBody}));
+    const std::uint64_t first = regenerator.requestRegeneration({ops[0].opId});
+    assert(regenerator.isRegenerating());
+    assert(nearlyEqual(shapeVolume(*doc.getBodyShape(bodyId)), 100.0));
+    assert(waitForIdle());
+    assert(published == 1);
+    assert(progressReports > 0 && lastPermille > 0);  // Relayed to this thread before the snapshot
+    assert(doc.publishedModelVersion() == first);
+    assert(nearlyEqual(shapeVolume(*doc.getBodyShape(bodyId)), 300.0));
+    assert(doc.getBodyShape(otherBodyId)->IsEqual(otherBefore));
+    assert(doc.meshStore().findMesh(bodyId) != nullptr);
+    assert(!doc.elementMap().bodyEntries(bodyId).empty());
+    assert(regenerator.latestSnapshot()->result.status == app::history::RegenStatus::Success);
+
+    // Back-to-back edits: only the last request's snapshot reaches the document.
+    assert(doc.updateOperationParams(ops[0].opId, app::ExtrudeParams{4.0, 0.0, app::BooleanMode::NewBody}));
+    regenerator.requestRegeneration({ops[0].opId});
+    assert(doc.updateOperationParams(ops[1].opId, app::ExtrudeParams{6.0, 0.0, app::BooleanMode::NewBody}));
+    const std::uint64_t last = regenerator.requestRegeneration({ops[1].opId});
+    assert(waitForIdle());
+    assert(published == 2);
+    assert(doc.publishedModelVersion() == last);
+    assert(nearlyEqual(shapeVolume(*doc.getBodyShape(bodyId)), 400.0));
+    assert(nearlyEqual(shapeVolume(*doc.getBodyShape(otherBodyId)), 600.0));
+
+    std::cout << " PASS\n";
+}
+
+void testRegenerationProfile() {
+    std::cout << "Test 25: Regeneration records per-operation profiles..." << std::flush;
+
+    app::Document doc;
+    doc.regenProfile().setEnabled(true);
+    std::vector<app::OperationRecord> ops;
+    for (int i = 0; i < 2; ++i) {
+        const std::string sketchId = addRectangleSketch(doc, 20.0 * i, 0.0, 10.0);
+        ops.push_back(makeNewBodyExtrude(doc, sketchId, 1.0));
+        doc.addOperation(ops.back());
+    }
+
+    app::history::RegenerationEngine engine(&doc);
+    assert(engine.regenerateAll().status == app::history::RegenStatus::Success);
+    const auto& profile = doc.regenProfile();
+    assert(profile.lastRun().size() == 2);
+    for (const auto& op : ops) {
+        const app::history::OpProfile* entry = profile.find(op.opId);
+        assert(entry != nullptr);
+        assert(entry->name == "Extrude");
+        assert(entry->faceCount == 6);
+        assert(entry->edgeCount == 12);
+        assert(entry->buildWallUs >= 0 && entry->applyWallUs >= 0);
+        assert(entry->elementMapUs + entry->tessellationUs <= entry->applyWallUs + 1);
+    }
+
+    // An incremental run replaces only the replayed op's cost; the trace covers that run.
+    assert(doc.updateOperationParams(ops[0].opId, app::ExtrudeParams{2.0, 0.0, app::BooleanMode::NewBody}));
+    assert(engine.regenerateIncremental(doc.appliedOpCount(), {ops[0].opId}).status ==
+           app::history::RegenStatus::Success);
+    assert(profile.lastRun().size() == 1);
+    assert(profile.lastRun().front().opId == ops[0].opId);
+    assert(profile.find(ops[1].opId) != nullptr);
+
+    const QJsonDocument trace = QJsonDocument::fromJson(QByteArray::fromStdString(profile.toChromeTrace()));
+    assert(trace.isObject());
+    int completeEvents = 0;
+    for (const auto& value : trace.object()["traceEvents"].toArray()) {
+        const QJsonObject event = value.toObject();
+        if (event["ph"].toString() == "X") {
+            assert(event["name"].toString() == "Extrude");
+            assert(event["args"].toObject()["opId"].toString() == QString::fromStdString(ops[0].opId));
+            ++completeEvents;
+        }
+    }
+    assert(completeEvents == 2);  // Build and apply
+
+    std::cout << " PASS\n";
+}
+
+void testDependencyGraphIncrementalUpdates() {
+    std::cout << "Test 26: Dependency graph scales and updates incrementally..." << std::flush;
+
+    auto makeOp = [](const std::string& opId, const std::string& inputBody, const std::string& outputBody) {
+        app::OperationRecord op;
+        op.opId = opId;
+        op.type = inputBody.empty() ? app::OperationType::Extrude : app::OperationType::Fillet;
+        if (inputBody.empty()) {
+            op.params = app::ExtrudeParams{1.0, 0.0, app::BooleanMode::NewBody};
+        } else {
+            op.input = app::BodyRef{inputBody};
+            op.params = app::FilletChamferParams{};
+        }
+        op.resultBodyIds.push_back(outputBody);
+        return op;
+    };
+
+    // A long single-body chain plus an unrelated body.
+    constexpr int kChainLength = 5000;
+    std::vector<app::OperationRecord> ops;
+    ops.push_back(makeOp("chain-0", "", "chain-body"));
+    for (int i = 1; i < kChainLength; ++i) {
+        ops.push_back(makeOp("chain-" + std::to_string(i), "chain-body", "chain-body"));
+    }
+    ops.push_back(makeOp("other", "", "other-body"));
+
+    app::history::DependencyGraph graph;
+    graph.rebuildFromOperations(ops);
+    assert(graph.size() == ops.size());
+    assert(!graph.hasCycle());
+    const auto sorted = graph.topologicalSort();
+    assert(sorted.size() == ops.size());
+    assert(sorted.front() == "chain-0" && sorted.back() == "other");
+    assert(graph.getDownstream("chain-0").size() == kChainLength - 1);
+    assert(graph.getUpstream("chain-" + std::to_string(kChainLength - 1)).size() == kChainLength - 1);
+    assert(graph.getUpstream("chain-1") == std::vector<std::string>{"chain-0"});
+    assert(graph.getDownstream("other").empty());
+
+    graph.setFailed("chain-10", true, "boom");
+    assert(graph.hasFailedUpstream("chain-11"));
+    assert(graph.hasFailedUpstream("chain-4000"));
+    assert(!graph.hasFailedUpstream("chain-10"));
+    assert(!graph.hasFailedUpstream("other"));
+    graph.clearFailures();
+
+    // Removing a link relinks its consumer to the previous producer.
+    graph.removeOperation("chain-1");
+    assert(graph.size() == ops.size() - 1);
+    assert(graph.getUpstream("chain-2") == std::vector<std::string>{"chain-0"});
+    assert(graph.getDownstream("chain-0").size() == kChainLength - 2);
+
+    // Appending links to the latest producer only.
+    graph.addOperation(makeOp("tail", "other-body", "other-body"));
+    assert(graph.getUpstream("tail") == std::vector<std::string>{"other"});
+    assert(graph.getDownstream("other") == std::vector<std::string>{"tail"});
+    assert(graph.topologicalSort().back() == "tail");
+
+    // Re-adding an op moves it to the end instead of duplicating it.
+    graph.addOperation(makeOp("other", "", "other-body"));
+    assert(graph.size() == ops.size());
+    assert(graph.getAllOpIds().back() == "other");
+    assert(graph.getUpstream("tail").empty());
+
+    std::cout << " PASS\n";
+}
+
+void testElementLevelInvalidation() {
+    std::cout << "Test 27: Element-level invalidation skips ops reading untouched faces..." << std::flush;
+
+    app::Document doc;
+    const std::string baseSketch = addRectangleSketch(doc, 0.0, 0.0, 10.0);
+    const std::string sideSketch = addRectangleSketch(doc, 30.0, 0.0, 5.0);
+    app::OperationRecord base = makeNewBodyExtrude(doc, baseSketch, 10.0);
+    const std::string bodyId = base.resultBodyIds.front();
+    app::OperationRecord side = makeNewBodyExtrude(doc, sideSketch, 5.0);
+    side.params = app::ExtrudeParams{5.0, 0.0, app::BooleanMode::Add, bodyId};
+    side.resultBodyIds = {bodyId};
+    doc.addOperation(base);
+    doc.addOperation(side);
+    {
+        app::history::RegenerationEngine engine(&doc);
+        assert(engine.regenerateAll().status == app::history::RegenStatus::Success);
+    }
+
+    // Extrude the base block's top face into a body of its own.
+    std::string topFaceId;
+    for (const auto& id : doc.elementMap().ids()) {
+        const auto* entry = doc.elementMap().find(id);
+        if (entry && entry->kind == kernel::elementmap::ElementKind::Face &&
+            id.value.rfind(bodyId + "/", 0) == 0 &&
+            nearlyEqual(entry->descriptor.center.Z(), 10.0) && entry->descriptor.center.X() < 10.0) {
+            topFaceId = id.value;
+        }
+    }
+    assert(!topFaceId.empty());
+    app::OperationRecord lid;
+    lid.opId = newId();
+    lid.type = app::OperationType::Extrude;
+    lid.input = app::FaceRef{bodyId, topFaceId};
+    lid.params = app::ExtrudeParams{5.0, 0.0, app::BooleanMode::NewBody};
+    lid.resultBodyIds.push_back(newId());
+    doc.addOperation(lid);
+    {
+        app::history::RegenerationEngine engine(&doc);
+        auto result = engine.regenerateIncremental(doc.appliedOpCount(), {lid.opId});
+        assert(result.status == app::history::RegenStatus::Success);
+        assert(engine.lastRunWasIncremental());
+    }
+    const std::string lidBody = lid.resultBodyIds.front();
+    const TopoDS_Shape lidShape = *doc.getBodyShape(lidBody);
+    assert(nearlyEqual(shapeVolume(lidShape), 500.0));
+
+    // The side boss rewrites the body but not the top face: the lid is not replayed.
+    assert(doc.updateOperationParams(side.opId, app::ExtrudeParams{8.0, 0.0, app::BooleanMode::Add, bodyId}));
+    {
+        app::history::RegenerationEngine engine(&doc);
+        engine.setVerifyIncremental(true);
+        auto result = engine.regenerateIncremental(doc.appliedOpCount(), {side.opId});
+        assert(result.status == app::history::RegenStatus::Success);
+        assert(engine.lastRunWasIncremental());
+        assert(engine.lastReplayedOpCount() == 1);
+        assert(engine.lastAvoidedOpCount() == 1);
+        assert(engine.graph().getUpstream(lid.opId) == std::vector<std::string>{base.opId});
+        assert(engine.lastVerification().performed);
+        assert(engine.lastVerification().matches);
+    }
+    assert(doc.getBodyShape(lidBody)->IsEqual(lidShape));
+    assert(nearlyEqual(shapeVolume(*doc.getBodyShape(bodyId)), 1000.0 + 200.0));
+
+    // Editing the op that produced the face replays the lid.
+    assert(doc.updateOperationParams(base.opId, app::ExtrudeParams{12.0, 0.0, app::BooleanMode::NewBody}));
+    {
+        app::history::RegenerationEngine engine(&doc);
+        engine.setVerifyIncremental(true);
+        auto result = engine.regenerateIncremental(doc.appliedOpCount(), {base.opId});
+        assert(result.status == app::history::RegenStatus::Success);
+        assert(engine.lastReplayedOpCount() == 3);
+        assert(engine.lastAvoidedOpCount() == 0);
+        assert(engine.lastVerification().matches);
+    }
+    assert(nearlyEqual(shapeVolume(*doc.getBodyShape(lidBody)), 500.0));
+    assert(!doc.getBodyShape(lidBody)->IsEqual(lidShape));
+
+    // Body-level invalidation replays the lid for the same edit.
+    assert(doc.updateOperationParams(side.opId, app::ExtrudeParams{4.0, 0.0, app::BooleanMode::Add, bodyId}));
+    {
+        app::history::RegenerationEngine engine(&doc);
+        engine.setElementLevelInvalidation(false);
+        auto result = engine.regenerateIncremental(doc.appliedOpCount(), {side.opId});
+        assert(result.status == app::history::RegenStatus::Success);
+        assert(engine.lastReplayedOpCount() == 2);
+        assert(engine.lastAvoidedOpCount() == 0);
+    }
+
+    std::cout << " PASS\n";
+}
+
+void testPreviewBodyLayer() {
+    std::cout << "Test 28: Preview saves and restores only the bodies it touches..." << std::flush;
+
+    app::Document doc;
+    const std::string sketchA = addRectangleSketch(doc, 0.0, 0.0, 10.0);
+    const std::string sketchB = addRectangleSketch(doc, 30.0, 0.0, 10.0);
+    app::OperationRecord opA = makeNewBodyExtrude(doc, sketchA, 10.0);
+    app::OperationRecord opB = makeNewBodyExtrude(doc, sketchB, 10.0);
+    doc.addOperation(opA);
+    doc.addOperation(opB);
+    app::history::RegenerationEngine engine(&doc);
+    assert(engine.regenerateAll().status == app::history::RegenStatus::Success);
+
+    const std::string bodyA = opA.resultBodyIds.front();
+    const std::string bodyB = opB.resultBodyIds.front();
+    const TopoDS_Shape shapeA = *doc.getBodyShape(bodyA);
+    const TopoDS_Shape shapeB = *doc.getBodyShape(bodyB);
+    const auto elementsA = doc.elementMap().bodyEntries(bodyA);
+    assert(!elementsA.empty());
+    doc.setModified(false);
+
+    auto preview = engine.previewFrom(opA.opId, app::ExtrudeParams{20.0, 0.0, app::BooleanMode::NewBody});
+    assert(preview.status == app::history::RegenStatus::Success);
+    assert(engine.isPreviewActive());
+    assert(doc.hasBodyLayer());
+    assert(doc.bodyLayerChanges() == std::vector<std::string>{bodyA});
+    assert(nearlyEqual(shapeVolume(*doc.getBodyShape(bodyA)), 2000.0));
+    assert(doc.getBodyShape(bodyB)->IsEqual(shapeB));
+
+    engine.discardPreview();
+    assert(!engine.isPreviewActive());
+    assert(!doc.hasBodyLayer());
+    assert(!doc.isModified());
+    assert(doc.getBodyShape(bodyA)->IsEqual(shapeA));
+    assert(doc.meshStore().findMesh(bodyA) != nullptr);
+    const auto restored = doc.elementMap().bodyEntries(bodyA);
+    assert(restored.size() == elementsA.size());
+    for (const auto& entry : elementsA) {
+        const auto* now = doc.elementMap().find(entry.id);
+        assert(now && now->shape.IsSame(entry.shape));
+    }
+    const auto* params = std::get_if<app::ExtrudeParams>(&doc.findOperation(opA.opId)->params);
+    assert(params && nearlyEqual(params->distance, 10.0));
+
+    // Committing keeps the preview and closes the layer.
+    engine.previewFrom(opA.opId, app::ExtrudeParams{15.0, 0.0, app::BooleanMode::NewBody});
+    engine.commitPreview();
+    assert(!doc.hasBodyLayer());
+    assert(nearlyEqual(shapeVolume(*doc.getBodyShape(bodyA)), 1500.0));
+    assert(doc.getBodyShape(bodyB)->IsEqual(shapeB));
+
+    std::cout << " PASS\n";
+}
+
+void testRegenerationDuringTessellation() {
+    std::cout << "Test 29: Regenerating while bodies tessellate leaves their shapes unmeshed..." << std::flush;
+
+    app::Document doc;
+    doc.setBackgroundTessellation(true);
+    const std::string sketchA = addRectangleSketch(doc, 0.0, 0.0, 10.0);
+    const std::string sketchB = addRectangleSketch(doc, 30.0, 0.0, 10.0);
+    app::OperationRecord opA = makeNewBodyExtrude(doc, sketchA, 10.0);
+    app::OperationRecord opB = makeNewBodyExtrude(doc, sketchB, 10.0);
+    doc.addOperation(opA);
+    doc.addOperation(opB);
+    {
+        app::history::RegenerationEngine engine(&doc);
+        assert(engine.regenerateAll().status == app::history::RegenStatus::Success);
+    }
+
+    // Each pass rebinds names by measuring the shapes the worker is meshing.
+    for (int i = 0; i < 8 && doc.hasPendingMeshes(); ++i) {
+        const double distance = 11.0 + i;
+        assert(doc.updateOperationParams(opA.opId, app::ExtrudeParams{distance, 0.0, app::BooleanMode::NewBody}));
+        app::history::RegenerationEngine engine(&doc);
+        assert(engine.regenerateIncremental(doc.appliedOpCount(), {opA.opId}).status ==
+               app::history::RegenStatus::Success);
+    }
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (doc.hasPendingMeshes() && std::chrono::steady_clock::now() < deadline) {
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+    }
+    assert(!doc.hasPendingMeshes());
+
+    for (const auto& bodyId : {opA.resultBodyIds.front(), opB.resultBodyIds.front()}) {
+        const auto* mesh = doc.meshStore().findMesh(bodyId);
+        assert(mesh != nullptr && mesh->triangleCount() > 0);
+        for (TopExp_Explorer exp(*doc.getBodyShape(bodyId), TopAbs_FACE); exp.More(); exp.Next()) {
+            TopLoc_Location location;
+            assert(BRep_Tool::Triangulation(TopoDS::Face(exp.Current()), location).IsNull());
+        }
+    }
+    // Body A is meshed at its last regenerated height, not a superseded one.
+    const auto* mesh = doc.meshStore().findMesh(opA.resultBodyIds.front());
+    float height = 0.0f;
+    for (std::size_t i = 2; i < mesh->positions.size(); i += 3) {
+        height = std::max(height, mesh->positions[i]);
+    }
+    assert(nearlyEqual(height, shapeVolume(*doc.getBodyShape(opA.resultBodyIds.front())) / 100.0, 1e-3));
+
+    std::cout << " PASS\n";
+}
+
+void testCancelFinishedRegenJobs() {
+    std::cout << "Test 30: Cancelling finished regeneration jobs keeps nothing..." << std::flush;
+
+    app::Document doc;
+    const std::string sketchId = addRectangleSketch(doc, 0.0, 0.0, 10.0);
+    doc.addOperation(makeNewBodyExtrude(doc, sketchId, 1.0));
+
+    app::history::KernelScheduler scheduler;
+    std::promise<void> finishedDone;
+    const app::history::JobId finished = scheduler.submitRegen(
+        {}, [&finishedDone](const app::history::RegenJobResult&) { finishedDone.set_value(); });
+    finishedDone.get_future().wait();
+
+    // The running job's progress hook holds the writer thread, so the next one stays queued.
+    std::promise<void> started;
+    std::promise<void> gate;
+    std::shared_future<void> gateFuture = gate.get_future().share();
+    std::atomic<bool> blocked{false};
+    app::history::RegenRequest blocking;
+    blocking.document = &doc;
+    blocking.appliedOpCount = doc.appliedOpCount();
+    blocking.progress = [&](int, int, const std::string&) {
+        if (!blocked.exchange(true)) {
+            started.set_value();
+            gateFuture.wait();
+        }
+    };
+    const app::history::JobId running = scheduler.submitRegen(blocking);
+    const app::history::JobId queued = scheduler.submitRegen({});
+    started.get_future().wait();
+
+    scheduler.cancel(finished);
+    scheduler.cancel(queued + 1);  // Never submitted
+    assert(scheduler.pendingCancellationCount() == 0);
+    scheduler.cancel(running);
+    scheduler.cancel(queued);
+    assert(scheduler.pendingCancellationCount() == 2);
+
+    gate.set_value();
+    scheduler.shutdown();
+    assert(scheduler.pendingCancellationCount() == 0);
+
+    std::cout << " PASS\n";
+}
+
 int main(int argc, char* argv[]) {
     QCoreApplication app(argc, argv);
 
@@ -852,6 +1723,19 @@ int main(int argc, char* argv[]) {
     testSketchHostProjectionVersionRequired();
     testSelectionPriorityPrefersSketchRegion();
     testProjectedReferenceGeometryIsLocked();
+    testIncrementalRegeneration();
+    testOperationCheckpointCache();
+    testRollbackPrefixSnapshots();
+    testParallelBranchRegeneration();
+    testPreviewLaneLatestWins();
+    testCancelledRegenerationRestoresDocument();
+    testAsyncRegenerationSnapshots();
+    testRegenerationProfile();
+    testDependencyGraphIncrementalUpdates();
+    testElementLevelInvalidation();
+    testPreviewBodyLayer();
+    testRegenerationDuringTessellation();
+    testCancelFinishedRegenJobs();
 
     std::cout << "\n=== All tests passed! ===\n\n";
     return 0;
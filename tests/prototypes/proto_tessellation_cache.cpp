@@ -2,15 +2,31 @@
 
 #include <BRepPrimAPI_MakeBox.hxx>
 #include <BRepPrimAPI_MakeCylinder.hxx>
+#include <BRep_Builder.hxx>
+#include <BRep_Tool.hxx>
+#include <Poly_Triangulation.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopLoc_Location.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Compound.hxx>
+#include <gp_Ax2.hxx>
 #include <QCoreApplication>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <exception>
 #include <iostream>
+#include <limits>
+#include <string>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 namespace {
 
 std::size_t countFaceGroups(const onecad::render::SceneMeshStore::Mesh& mesh) {
-    std::unordered_set<std::string> groups;
+    std::unordered_set<onecad::kernel::elementmap::ElementHandle,
+                       onecad::kernel::elementmap::ElementHandleHash> groups;
     if (!mesh.faceGroupByFaceId.empty()) {
         for (const auto& [faceId, groupId] : mesh.faceGroupByFaceId) {
             (void)faceId;
@@ -18,17 +34,368 @@ std::size_t countFaceGroups(const onecad::render::SceneMeshStore::Mesh& mesh) {
         }
         return groups.size();
     }
-    for (const auto& tri : mesh.triangles) {
-        groups.insert(tri.faceId);
+    for (const auto& range : mesh.faces) {
+        groups.insert(range.faceId);
     }
     return groups.size();
 }
 
+TopoDS_Shape makeCompound(const TopoDS_Shape& a, const TopoDS_Shape& b) {
+    BRep_Builder builder;
+    TopoDS_Compound compound;
+    builder.MakeCompound(compound);
+    builder.Add(compound, a);
+    builder.Add(compound, b);
+    return compound;
+}
+
+// Rebuilding a body after one of its solids changed must reuse the untouched faces.
+bool checkFaceReuse() {
+    onecad::render::TessellationCache cache;
+    onecad::kernel::elementmap::ElementMap elementMap;
+    const TopoDS_Shape kept = BRepPrimAPI_MakeBox(10.0, 10.0, 10.0).Shape();
+    const TopoDS_Shape replaced = BRepPrimAPI_MakeBox(gp_Pnt(20.0, 0.0, 0.0), 5.0, 5.0, 5.0).Shape();
+    const TopoDS_Shape replacement = BRepPrimAPI_MakeBox(gp_Pnt(20.0, 0.0, 0.0), 6.0, 5.0, 5.0).Shape();
+
+    const auto first = cache.buildMesh("body", makeCompound(kept, replaced), elementMap);
+    auto stats = cache.cacheStats();
+    if (stats.faceHits != 0 || stats.faceMisses != 12 || stats.faces != 12) {
+        std::cerr << "Expected 12 cached faces after the first build, got " << stats.faces << ".\n";
+        return false;
+    }
+
+    const auto again = cache.buildMesh("body", makeCompound(kept, replaced), elementMap);
+    stats = cache.cacheStats();
+    if (stats.faceHits != 12 || stats.faceMisses != 12 ||
+        again.indices.size() != first.indices.size() || again.positions.size() != first.positions.size()) {
+        std::cerr << "Rebuilding an unchanged body did not come from the cache.\n";
+        return false;
+    }
+
+    cache.resetCacheStats();
+    const auto modified = cache.buildMesh("body", makeCompound(kept, replacement), elementMap);
+    stats = cache.cacheStats();
+    if (stats.faceHits != 6 || stats.faceMisses != 6 || stats.faces != 12 || stats.released == 0 ||
+        modified.indices.size() != first.indices.size()) {
+        std::cerr << "Expected 6 reused and 6 meshed faces after the change, got " << stats.faceHits
+                  << " and " << stats.faceMisses << ".\n";
+        return false;
+    }
+
+    cache.releaseBody("body");
+    if (cache.cacheStats().faces != 0 || cache.cacheStats().edges != 0) {
+        std::cerr << "Releasing the body left cached blocks behind.\n";
+        return false;
+    }
+    return true;
+}
+
+// Faces and edges are processed on several threads; repeated builds must still merge
+// them into the same mesh, in face order.
+bool checkParallelMergeOrder() {
+    BRep_Builder builder;
+    TopoDS_Compound compound;
+    builder.MakeCompound(compound);
+    for (int i = 0; i < 24; ++i) {
+        builder.Add(compound, BRepPrimAPI_MakeCylinder(gp_Ax2(gp_Pnt(12.0 * i, 0.0, 0.0), gp::DZ()), 5.0, 10.0).Shape());
+    }
+    onecad::render::TessellationCache cache;
+    cache.setCacheEnabled(false);
+    onecad::kernel::elementmap::ElementMap elementMap;
+    const auto first = cache.buildMesh("body", compound, elementMap);
+    for (int run = 0; run < 4; ++run) {
+        const auto again = cache.buildMesh("body", compound, elementMap);
+        bool same = again.positions == first.positions && again.indices == first.indices &&
+                    again.faces.size() == first.faces.size() &&
+                    again.topologyByFace.size() == first.topologyByFace.size();
+        for (std::size_t i = 0; same && i < first.faces.size(); ++i) {
+            same = again.faces[i].faceId == first.faces[i].faceId &&
+                   again.faces[i].firstIndex == first.faces[i].firstIndex &&
+                   again.faces[i].indexCount == first.faces[i].indexCount;
+        }
+        if (!same) {
+            std::cerr << "Parallel builds of the same shape differ.\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+// In the background a new body gets a coarse mesh, then the full one; a change made
+// before the mesh lands supersedes the stale build.
+bool checkBackgroundTessellation() {
+    onecad::app::Document document;
+    document.setBackgroundTessellation(true);
+    std::vector<std::size_t> triangleCounts;
+    QObject::connect(&document, &onecad::app::Document::bodyUpdated, [&](const QString& id) {
+        triangleCounts.push_back(document.meshStore().findMesh(id.toStdString())->triangleCount());
+    });
+    auto settle = [&document]() {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+        while (document.hasPendingMeshes() && std::chrono::steady_clock::now() < deadline) {
+            QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+        }
+        return !document.hasPendingMeshes();
+    };
+
+    const std::string bodyId = document.addBody(BRepPrimAPI_MakeCylinder(5.0, 10.0).Shape());
+    if (document.meshStore().findMesh(bodyId) != nullptr) {
+        std::cerr << "Background tessellation meshed the body inline.\n";
+        return false;
+    }
+    if (!settle() || triangleCounts.size() != 2 || triangleCounts[0] >= triangleCounts[1]) {
+        std::cerr << "Expected a coarse mesh, then a finer full mesh.\n";
+        return false;
+    }
+    onecad::app::Document inlineDocument;
+    const std::string inlineId = inlineDocument.addBody(BRepPrimAPI_MakeCylinder(5.0, 10.0).Shape());
+    if (inlineDocument.meshStore().findMesh(inlineId)->triangleCount() != triangleCounts[1]) {
+        std::cerr << "The full background mesh differs from the inline one.\n";
+        return false;
+    }
+
+    document.updateBodyShape(bodyId, BRepPrimAPI_MakeBox(10.0, 10.0, 10.0).Shape());
+    document.updateBodyShape(bodyId, BRepPrimAPI_MakeBox(20.0, 20.0, 20.0).Shape());
+    if (!settle()) {
+        std::cerr << "Superseded body mesh never landed.\n";
+        return false;
+    }
+    const auto* mesh = document.meshStore().findMesh(bodyId);
+    const float extent = *std::max_element(mesh->positions.begin(), mesh->positions.end());
+    if (mesh->triangleCount() != 12 || std::abs(extent - 20.0f) > 1e-3f) {
+        std::cerr << "The body kept a mesh of a superseded shape.\n";
+        return false;
+    }
+    return true;
+}
+
+// A body meshed in the background keeps its coarse mesh as a level of detail; a fine level is
+// built on request and dropped when the body changes.
+bool checkLevelsOfDetail() {
+    onecad::app::Document document;
+    document.setBackgroundTessellation(true);
+    bool detailChanged = false;
+    QObject::connect(&document, &onecad::app::Document::bodyMeshDetailChanged,
+                     [&detailChanged](const QString&) { detailChanged = true; });
+    auto settle = [](auto&& done) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+        while (!done() && std::chrono::steady_clock::now() < deadline) {
+            QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+        }
+        return done();
+    };
+    auto meshesLanded = [&document]() { return !document.hasPendingMeshes(); };
+
+    const std::string bodyId = document.addBody(BRepPrimAPI_MakeCylinder(5.0, 10.0).Shape());
+    if (!settle(meshesLanded)) {
+        std::cerr << "Body mesh never landed.\n";
+        return false;
+    }
+    const auto* mesh = document.meshStore().findMesh(bodyId);
+    if (mesh->coarse.empty() || mesh->coarse.triangleCount() >= mesh->triangleCount() ||
+        mesh->coarse.linearDeflection <= mesh->linearDeflection) {
+        std::cerr << "Expected a coarse level of detail below the full mesh.\n";
+        return false;
+    }
+
+    document.requestFineMesh(bodyId);
+    if (!settle([&detailChanged]() { return detailChanged; })) {
+        std::cerr << "Fine level of detail never landed.\n";
+        return false;
+    }
+    mesh = document.meshStore().findMesh(bodyId);
+    if (mesh->fine.triangleCount() <= mesh->triangleCount() ||
+        mesh->fine.normals.size() != mesh->fine.positions.size()) {
+        std::cerr << "Expected a fine level of detail above the full mesh.\n";
+        return false;
+    }
+    // Every level is meshed on a copy; the document's faces never carry a triangulation that
+    // would leak into naming through their bounding boxes.
+    for (TopExp_Explorer exp(*document.getBodyShape(bodyId), TopAbs_FACE); exp.More(); exp.Next()) {
+        TopLoc_Location location;
+        if (!BRep_Tool::Triangulation(TopoDS::Face(exp.Current()), location).IsNull()) {
+            std::cerr << "A level of detail left a triangulation on the document's shape.\n";
+            return false;
+        }
+    }
+
+    document.updateBodyShape(bodyId, BRepPrimAPI_MakeBox(10.0, 10.0, 10.0).Shape());
+    if (!settle(meshesLanded)) {
+        std::cerr << "Changed body mesh never landed.\n";
+        return false;
+    }
+    mesh = document.meshStore().findMesh(bodyId);
+    if (!mesh->fine.empty() || mesh->coarse.empty()) {
+        std::cerr << "A changed body kept the fine level of its old shape.\n";
+        return false;
+    }
+    return true;
+}
+
+using Mesh = onecad::render::SceneMeshStore::Mesh;
+using ElementHandle = onecad::kernel::elementmap::ElementHandle;
+using ElementHandleHash = onecad::kernel::elementmap::ElementHandleHash;
+
+// A gridSize x gridSize patchwork of faces on a wavy surface, each patch its own quads with
+// its border vertices duplicated, as faces come out of BRepMesh. Neighbouring columns share
+// a smooth group, so every other column border is a crease.
+Mesh makeWavyMesh(int gridSize, int quadsPerFace) {
+    Mesh mesh;
+    for (int fi = 0; fi < gridSize; ++fi) {
+        for (int fj = 0; fj < gridSize; ++fj) {
+            const auto firstVertex = static_cast<std::uint32_t>(mesh.vertexCount());
+            const auto firstIndex = static_cast<std::uint32_t>(mesh.indices.size());
+            for (int i = 0; i <= quadsPerFace; ++i) {
+                for (int j = 0; j <= quadsPerFace; ++j) {
+                    const float x = 0.1f * static_cast<float>(fi * quadsPerFace + i);
+                    const float y = 0.1f * static_cast<float>(fj * quadsPerFace + j);
+                    mesh.positions.insert(mesh.positions.end(), {x, y, 0.5f * std::sin(x) * std::cos(y)});
+                }
+            }
+            const auto row = static_cast<std::uint32_t>(quadsPerFace + 1);
+            for (int i = 0; i < quadsPerFace; ++i) {
+                for (int j = 0; j < quadsPerFace; ++j) {
+                    const std::uint32_t v = firstVertex + static_cast<std::uint32_t>(i) * row + static_cast<std::uint32_t>(j);
+                    mesh.indices.insert(mesh.indices.end(), {v, v + row, v + 1, v + 1, v + row, v + row + 1});
+                }
+            }
+            const std::string suffix = std::to_string(fi) + "_" + std::to_string(fj);
+            const ElementHandle faceId = onecad::kernel::elementmap::internElementId("bench/face/" + suffix);
+            mesh.faces.push_back({faceId, firstIndex, static_cast<std::uint32_t>(mesh.indices.size()) - firstIndex});
+            mesh.faceGroupByFaceId[faceId] = onecad::kernel::elementmap::internElementId(
+                "bench/group/" + std::to_string(fi / 2) + "_" + std::to_string(fj));
+        }
+    }
+    return mesh;
+}
+
+// The hash-map smoothing computeSmoothNormals() replaced, kept as the reference it must match.
+void legacySmoothNormals(Mesh& mesh) {
+    struct Key {
+        std::int64_t x;
+        std::int64_t y;
+        std::int64_t z;
+        bool operator==(const Key& other) const { return x == other.x && y == other.y && z == other.z; }
+    };
+    struct KeyHash {
+        std::size_t operator()(const Key& key) const noexcept {
+            std::size_t seed = std::hash<std::int64_t>{}(key.x);
+            seed ^= std::hash<std::int64_t>{}(key.y) + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+            seed ^= std::hash<std::int64_t>{}(key.z) + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+            return seed;
+        }
+    };
+    auto quantize = [](float f) { return static_cast<std::int64_t>(std::llround(static_cast<double>(f) * 10000.0)); };
+
+    std::vector<ElementHandle> triangleGroups(mesh.triangleCount());
+    for (const auto& range : mesh.faces) {
+        auto it = mesh.faceGroupByFaceId.find(range.faceId);
+        const ElementHandle group = it != mesh.faceGroupByFaceId.end() ? it->second : range.faceId;
+        std::fill_n(triangleGroups.begin() + range.firstIndex / 3, range.indexCount / 3, group);
+    }
+    std::vector<QVector3D> triangleNormals;
+    std::vector<float> triangleAreas;
+    for (std::size_t t = 0; t < mesh.triangleCount(); ++t) {
+        const QVector3D v0 = mesh.position(mesh.indices[3 * t]);
+        const QVector3D cross = QVector3D::crossProduct(mesh.position(mesh.indices[3 * t + 1]) - v0,
+                                                        mesh.position(mesh.indices[3 * t + 2]) - v0);
+        const float area = cross.length() * 0.5f;
+        triangleNormals.push_back(area > 1e-8f ? cross.normalized() : QVector3D(0, 0, 1));
+        triangleAreas.push_back(area > 1e-8f ? area : 0.0f);
+    }
+
+    std::unordered_map<Key, std::vector<std::size_t>, KeyHash> cornersByPosition;
+    for (std::size_t corner = 0; corner < mesh.indices.size(); ++corner) {
+        const QVector3D p = mesh.position(mesh.indices[corner]);
+        cornersByPosition[{quantize(p.x()), quantize(p.y()), quantize(p.z())}].push_back(corner);
+    }
+    std::vector<float> positions;
+    std::vector<float> normals;
+    for (const auto& [key, corners] : cornersByPosition) {
+        std::unordered_map<ElementHandle, std::vector<std::size_t>, ElementHandleHash> cornersByGroup;
+        for (const std::size_t corner : corners) {
+            cornersByGroup[triangleGroups[corner / 3]].push_back(corner);
+        }
+        for (const auto& [group, groupCorners] : cornersByGroup) {
+            QVector3D normal(0, 0, 0);
+            for (const std::size_t corner : groupCorners) {
+                normal += triangleNormals[corner / 3] * triangleAreas[corner / 3];
+            }
+            normal = normal.lengthSquared() > 1e-8f ? normal.normalized() : QVector3D(0, 0, 1);
+            const QVector3D p = mesh.position(mesh.indices[groupCorners.front()]);
+            const auto vertex = static_cast<std::uint32_t>(positions.size() / 3);
+            positions.insert(positions.end(), {p.x(), p.y(), p.z()});
+            normals.insert(normals.end(), {normal.x(), normal.y(), normal.z()});
+            for (const std::size_t corner : groupCorners) {
+                mesh.indices[corner] = vertex;
+            }
+        }
+    }
+    mesh.positions = std::move(positions);
+    mesh.normals = std::move(normals);
+}
+
+// The sorted-adjacency smoothing must split the same vertices as the hash-map one and give
+// them the same positions and normals; only the vertex order may differ.
+bool checkSmoothNormalsMatchLegacy() {
+    Mesh expected = makeWavyMesh(6, 8);
+    Mesh actual = expected;
+    legacySmoothNormals(expected);
+    onecad::render::TessellationCache::computeSmoothNormals(actual);
+
+    if (actual.vertexCount() != expected.vertexCount() || actual.normals.size() != actual.positions.size()) {
+        std::cerr << "Smoothing split " << actual.vertexCount() << " vertices, expected "
+                  << expected.vertexCount() << ".\n";
+        return false;
+    }
+    constexpr std::uint32_t unmapped = std::numeric_limits<std::uint32_t>::max();
+    std::vector<std::uint32_t> actualByExpected(expected.vertexCount(), unmapped);
+    for (std::size_t corner = 0; corner < expected.indices.size(); ++corner) {
+        const std::uint32_t e = expected.indices[corner];
+        const std::uint32_t a = actual.indices[corner];
+        if (actualByExpected[e] == unmapped) {
+            actualByExpected[e] = a;
+        }
+        if (actualByExpected[e] != a || actual.position(a) != expected.position(e) ||
+            (actual.normal(a) - expected.normal(e)).length() > 1e-5f) {
+            std::cerr << "Smoothed vertex differs from the reference at corner " << corner << ".\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Times the reference and current smoothing on a mesh of about @p triangles triangles.
+void benchmarkSmoothNormals(std::size_t triangles) {
+    constexpr int gridSize = 10;
+    const int quadsPerFace = std::max(1, static_cast<int>(std::lround(
+        std::sqrt(static_cast<double>(triangles) / (2.0 * gridSize * gridSize)))));
+    const Mesh input = makeWavyMesh(gridSize, quadsPerFace);
+    auto time = [&input](auto&& smooth) {
+        Mesh mesh = input;
+        const auto start = std::chrono::steady_clock::now();
+        smooth(mesh);
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+    const double legacyMs = time(legacySmoothNormals);
+    const double currentMs = time(onecad::render::TessellationCache::computeSmoothNormals);
+    std::cout << "Benchmark: smooth normals, " << input.triangleCount() << " triangles: hash maps "
+              << legacyMs << " ms, sorted adjacency " << currentMs << " ms (" << legacyMs / currentMs
+              << "x)" << std::endl;
+}
+
 } // namespace
 
 int main(int argc, char** argv) {
     QCoreApplication app(argc, argv);
 
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--benchmark") {
+            benchmarkSmoothNormals(i + 1 < argc ? std::stoul(argv[i + 1]) : 1000000);
+            return 0;
+        }
+    }
+
     onecad::app::Document document;
     TopoDS_Shape shape = BRepPrimAPI_MakeBox(10.0, 10.0, 10.0).Shape();
     std::string bodyId = document.addBody(shape);
@@ -44,25 +411,50 @@ int main(int argc, char** argv) {
         std::cerr << "Mesh not found for body.\n";
         return 1;
     }
-    if (mesh->triangles.empty()) {
+    if (mesh->indices.empty()) {
         std::cerr << "No triangles generated.\n";
         return 1;
     }
+    if (mesh->normals.size() != mesh->positions.size()) {
+        std::cerr << "Expected one normal per vertex.\n";
+        return 1;
+    }
+
+    // Face ranges must tile the index buffer in order.
+    std::uint32_t nextIndex = 0;
+    for (const auto& range : mesh->faces) {
+        if (range.firstIndex != nextIndex || range.indexCount % 3 != 0) {
+            std::cerr << "Face ranges do not tile the index buffer.\n";
+            return 1;
+        }
+        nextIndex += range.indexCount;
+    }
+    if (nextIndex != mesh->indices.size()) {
+        std::cerr << "Face ranges do not cover every triangle.\n";
+        return 1;
+    }
+    for (const std::uint32_t index : mesh->indices) {
+        if (index >= mesh->vertexCount()) {
+            std::cerr << "Index past the vertex buffer.\n";
+            return 1;
+        }
+    }
 
-    for (const auto& tri : mesh->triangles) {
-        if (tri.faceId.empty()) {
-            std::cerr << "Triangle missing faceId.\n";
+    for (const auto& range : mesh->faces) {
+        const std::string& faceId = onecad::kernel::elementmap::elementIdString(range.faceId);
+        if (faceId.empty()) {
+            std::cerr << "Face range missing faceId.\n";
             return 1;
         }
         try {
             onecad::kernel::elementmap::ElementId id =
-                onecad::kernel::elementmap::ElementId::From(tri.faceId);
+                onecad::kernel::elementmap::ElementId::From(faceId);
             if (!document.elementMap().contains(id)) {
                 std::cerr << "FaceId not found in ElementMap.\n";
                 return 1;
             }
         } catch (const std::exception& ex) {
-            std::cerr << "Invalid faceId: " << tri.faceId << " (" << ex.what() << ")\n";
+            std::cerr << "Invalid faceId: " << faceId << " (" << ex.what() << ")\n";
             return 1;
         }
     }
@@ -87,6 +479,22 @@ int main(int argc, char** argv) {
         return 1;
     }
 
+    if (!checkFaceReuse()) {
+        return 1;
+    }
+    if (!checkParallelMergeOrder()) {
+        return 1;
+    }
+    if (!checkBackgroundTessellation()) {
+        return 1;
+    }
+    if (!checkLevelsOfDetail()) {
+        return 1;
+    }
+    if (!checkSmoothNormalsMatchLegacy()) {
+        return 1;
+    }
+
     std::cout << "Tessellation cache prototype passed.\n";
     return 0;
 }